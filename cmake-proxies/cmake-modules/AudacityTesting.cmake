@@ -125,6 +125,87 @@ if( ${_OPT}has_tests )
       endif()
    endfunction()
 
+   #[[
+      add_benchmark(NAME name [MOCK_PREFS] SOURCES file1 ... LIBRARIES lib1 ...)
+
+      Creates an executable called ${name}-benchmark from the source files
+      ${file1}, ... and linked to libraries ${lib1}, ...  The sources supply
+      their own main().
+
+      Creates a CTest test called ${name}-benchmark, labeled "benchmarks",
+      that runs every benchmark once with --quick, so that they keep working.
+      Run the executable directly, with --json, for measurements.
+   ]]
+   function( add_benchmark )
+      cmake_parse_arguments(
+         ADD_BENCHMARK # Prefix
+         "MOCK_PREFS" # Options
+         "NAME" # One value keywords
+         "SOURCES;LIBRARIES"
+         ${ARGN}
+      )
+
+      if( NOT ADD_BENCHMARK_NAME )
+         message( FATAL_ERROR "Missing required NAME parameter for the add_benchmark")
+      endif()
+
+      set( benchmark_executable_name "${ADD_BENCHMARK_NAME}-benchmark" )
+
+      add_executable( ${benchmark_executable_name} ${ADD_BENCHMARK_SOURCES} )
+      target_link_libraries( ${benchmark_executable_name} PRIVATE ${ADD_BENCHMARK_LIBRARIES} )
+
+      if (ADD_BENCHMARK_MOCK_PREFS)
+         target_compile_definitions( ${benchmark_executable_name} PRIVATE MOCK_PREFS )
+         target_sources( ${benchmark_executable_name} PRIVATE "${CMAKE_SOURCE_DIR}/tests/MockedPrefs.cpp" "${CMAKE_SOURCE_DIR}/tests/MockedPrefs.h" )
+         target_include_directories( ${benchmark_executable_name} PRIVATE "${CMAKE_SOURCE_DIR}/tests" )
+         target_link_libraries( ${benchmark_executable_name} PRIVATE lib-preferences-interface )
+      endif()
+
+      set( OPTIONS )
+      audacity_append_common_compiler_options( OPTIONS NO )
+      target_compile_options( ${benchmark_executable_name} ${OPTIONS} )
+
+      set_target_properties(
+         ${benchmark_executable_name}
+         PROPERTIES
+            FOLDER "tests" # for IDE organization
+            RUNTIME_OUTPUT_DIRECTORY "${TESTS_DIR}"
+            BUILD_RPATH "${_DESTDIR}/${_PKGLIB}"
+            VS_DEBUGGER_ENVIRONMENT "PATH=${_DESTDIR}/${_PKGLIB};%PATH%"
+      )
+
+      add_test(
+         NAME
+            ${benchmark_executable_name}
+         COMMAND
+            ${benchmark_executable_name} --quick
+         WORKING_DIRECTORY
+            ${CMAKE_SOURCE_DIR}
+      )
+
+      set_tests_properties(
+         ${benchmark_executable_name}
+         PROPERTIES
+            LABELS "benchmarks"
+      )
+
+      if( WIN32 )
+         string(REPLACE ";" "\\;" escaped_path "$ENV{PATH}")
+
+         set_tests_properties(
+            ${benchmark_executable_name}
+            PROPERTIES
+               ENVIRONMENT "PATH=$<SHELL_PATH:${CMAKE_RUNTIME_OUTPUT_DIRECTORY}/$<CONFIG>>\\;${escaped_path}"
+         )
+      elseif( APPLE )
+         set_tests_properties(
+            ${benchmark_executable_name}
+            PROPERTIES
+               ENVIRONMENT "DYLD_FALLBACK_LIBRARY_PATH=$<SHELL_PATH:${CMAKE_BINARY_DIR}/$<CONFIG>/${_APPDIR}/Frameworks>"
+         )
+      endif()
+   endfunction()
+
    set( JOURNAL_TEST_TIMEOUT_SECONDS 180 )
 
    #[[
@@ -174,6 +255,9 @@ else()
    function(add_unit_test)
    endfunction()
 
+   function(add_benchmark)
+   endfunction()
+
    function( add_journal_test journal_file )
    endfunction()
 endif()
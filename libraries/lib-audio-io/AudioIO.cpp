@@ -109,6 +109,8 @@ time warp info and AudioIOListener and whether the playback is looped.
 #include "Project.h"
 #include "TransactionScope.h"
 
+#include "concurrency/WorkerPool.h"
+
 #include "RealtimeEffectManager.h"
 #include "QualitySettings.h"
 #include "BasicUI.h"
@@ -926,6 +928,7 @@ int AudioIO::StartStream(const TransportSequences &sequences,
    mPlaybackBuffers.clear();
    mScratchBuffers.clear();
    mScratchPointers.clear();
+   mPlaybackPrefetcher.Stop();
    mPlaybackMixers.clear();
    mCaptureBuffers.clear();
    mResample.clear();
@@ -1325,6 +1328,13 @@ bool AudioIO::AllocateBuffers(
                   ));
             }
 
+            if (mPlaybackMixers.size() > 1 && !mPlaybackWorkers)
+               mPlaybackWorkers =
+                  std::make_unique<audacity::concurrency::WorkerPool>();
+
+            mPlaybackPrefetcher.SetDepth(AudioIOPrefetchDepth.Read());
+            mPlaybackPrefetcher.Start(mPlaybackSequences);
+
             const auto timeQueueSize = 1 +
                (playbackBufferSize + TimeQueueGrainSize - 1)
                   / TimeQueueGrainSize;
@@ -1395,6 +1405,7 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
    mPlaybackBuffers.clear();
    mScratchBuffers.clear();
    mScratchPointers.clear();
+   mPlaybackPrefetcher.Stop();
    mPlaybackMixers.clear();
    mCaptureBuffers.clear();
    mResample.clear();
@@ -1558,6 +1569,7 @@ void AudioIO::StopStream()
    mPlaybackBuffers.clear();
    mScratchBuffers.clear();
    mScratchPointers.clear();
+   mPlaybackPrefetcher.Stop();
    mPlaybackMixers.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
@@ -1951,6 +1963,9 @@ void AudioIO::FillPlayBuffers()
       // Might increase because the reader consumed some
       nAvailable = GetCommonlyFreePlayback();
    }
+
+   // Request what the next passes will read
+   mPlaybackPrefetcher.Update(mPlaybackSchedule);
 }
 
 #define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
@@ -1975,6 +1990,16 @@ bool AudioIO::ProcessPlaybackSlices(
    for(unsigned n = 0; n < mProcessingBuffers.size(); ++n)
       processingBufferOffsets[n] = mProcessingBuffers[n].size();
 
+   // first processing buffer of each sequence
+   const auto processingBufferIndices =
+      stackAllocate(size_t, mPlaybackSequences.size());
+   for (size_t iSequence = 0, iBuffer = 0;
+      iSequence < mPlaybackSequences.size(); ++iSequence)
+   {
+      processingBufferIndices[iSequence] = iBuffer;
+      iBuffer += mPlaybackSequences[iSequence]->NChannels();
+   }
+
    do {
       const auto slice =
          policy.GetPlaybackSlice(mPlaybackSchedule, available);
@@ -1989,48 +2014,56 @@ bool AudioIO::ProcessPlaybackSlices(
       mPlaybackSchedule.mTimeQueue.Producer(mPlaybackSchedule, slice);
 
       // mPlaybackMixers correspond one-to-one with mPlaybackSequences
-      size_t iSequence = 0;
-      // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
-      size_t iBuffer = 0;
-      for (auto &mixer : mPlaybackMixers) {
-         // The mixer here isn't actually mixing: it's just doing
-         // resampling, format conversion, and possibly time track
-         // warping
-         if (frames > 0) {
-            size_t produced = 0;
-
-            if (toProduce)
-               produced = mixer->Process(toProduce);
-
-            //wxASSERT(produced <= toProduce);
-            // Copy (non-interleaved) mixer outputs to one or more ring buffers
-            const auto nChannels = mPlaybackSequences[iSequence]->NChannels();
-
-            const auto appendPos = mProcessingBuffers[iBuffer].size();
-            for (size_t j = 0; j < nChannels; ++j)
-            {
-               // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
-               auto& buffer = mProcessingBuffers[iBuffer + j];
-               //Sufficient size should have been reserved in AllocateBuffers
-               //But for some latency values (> aprox. 100ms) pre-allocated
-               //buffer could be not large enough.
-               //Preserve what was written to the buffer during previous pass, don't discard
-               buffer.resize(buffer.size() + frames, 0);
-
-               const auto warpedSamples = mixer->GetBuffer(j);
-               std::copy_n(
-                  reinterpret_cast<const float*>(warpedSamples),
-                  produced,
-                  buffer.data() + appendPos);
-               std::fill_n(
-                  buffer.data() + appendPos + produced,
-                  frames - produced,
-                  .0f);
-            }
-
-            iBuffer += nChannels;
-            ++iSequence;
+      // The mixer here isn't actually mixing: it's just doing
+      // resampling, format conversion, and possibly time track
+      // warping
+      const auto processMixer = [&](size_t iSequence) {
+         auto &mixer = mPlaybackMixers[iSequence];
+         size_t produced = 0;
+
+         if (toProduce)
+            produced = mixer->Process(toProduce);
+
+         //wxASSERT(produced <= toProduce);
+         // Copy (non-interleaved) mixer outputs to one or more ring buffers
+         const auto nChannels = mPlaybackSequences[iSequence]->NChannels();
+         // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
+         const auto iBuffer = processingBufferIndices[iSequence];
+
+         const auto appendPos = mProcessingBuffers[iBuffer].size();
+         for (size_t j = 0; j < nChannels; ++j)
+         {
+            auto& buffer = mProcessingBuffers[iBuffer + j];
+            //Sufficient size should have been reserved in AllocateBuffers
+            //But for some latency values (> aprox. 100ms) pre-allocated
+            //buffer could be not large enough.
+            //Preserve what was written to the buffer during previous pass, don't discard
+            buffer.resize(buffer.size() + frames, 0);
+
+            const auto warpedSamples = mixer->GetBuffer(j);
+            std::copy_n(
+               reinterpret_cast<const float*>(warpedSamples),
+               produced,
+               buffer.data() + appendPos);
+            std::fill_n(
+               buffer.data() + appendPos + produced,
+               frames - produced,
+               .0f);
          }
+      };
+
+      if (frames > 0) {
+         // Each mixer reads its own sequence and writes only its own
+         // processing buffers, so they can all run at once; the join is
+         // complete before repositioning and before anything is put into
+         // the ring buffers
+         if (mPlaybackWorkers)
+            mPlaybackWorkers->ParallelFor(
+               mPlaybackMixers.size(), processMixer);
+         else
+            for (size_t iSequence = 0;
+               iSequence < mPlaybackMixers.size(); ++iSequence)
+               processMixer(iSequence);
       }
 
       available -= frames;
@@ -3368,3 +3401,4 @@ bool AudioIO::IsCapturing() const
 }
 
 BoolSetting SoundActivatedRecord{ "/AudioIO/SoundActivatedRecord", false };
+DoubleSetting AudioIOPrefetchDepth{ "/AudioIO/PrefetchDepth", 4.0 };
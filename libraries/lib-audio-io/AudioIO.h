@@ -15,6 +15,7 @@
 
 #include "AudioIOBase.h" // to inherit
 #include "AudioIOSequences.h"
+#include "PlaybackPrefetcher.h" // member variable
 #include "PlaybackSchedule.h" // member variable
 
 #include <functional>
@@ -41,6 +42,8 @@ class Resample;
 
 class AudacityProject;
 
+namespace audacity::concurrency { class WorkerPool; }
+
 struct PaStreamCallbackTimeInfo;
 typedef unsigned long PaStreamCallbackFlags;
 typedef int PaError;
@@ -274,6 +277,12 @@ public:
    std::vector<float *> mScratchPointers; //!< pointing into mScratchBuffers
 
    std::vector<std::unique_ptr<Mixer>> mPlaybackMixers;
+   //! Runs the Process() of the playback mixers concurrently
+   /*! Used only by the audio thread; created on demand when there is more
+    than one playback mixer */
+   std::unique_ptr<audacity::concurrency::WorkerPool> mPlaybackWorkers;
+   //! Reads ahead of the playback mixers
+   PlaybackPrefetcher mPlaybackPrefetcher;
 
    std::atomic<float>  mMixerOutputVol{ 1.0 };
    static int          mNextStreamToken;
@@ -567,6 +576,10 @@ public:
     */
    double GetStreamTime();
 
+   //! How well sample data are read ahead of the current playback
+   PlaybackPrefetcher::Statistics GetPrefetchStatistics() const
+   { return mPlaybackPrefetcher.GetStatistics(); }
+
    static void AudioThread(std::atomic<bool> &finish);
 
    static void Init();
@@ -655,5 +668,7 @@ private:
 };
 
 AUDIO_IO_API extern BoolSetting SoundActivatedRecord;
+//! Seconds of samples to read ahead of playback; zero disables
+AUDIO_IO_API extern DoubleSetting AudioIOPrefetchDepth;
 
 #endif
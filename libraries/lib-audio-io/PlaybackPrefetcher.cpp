@@ -0,0 +1,208 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PlaybackPrefetcher.cpp
+
+**********************************************************************/
+#include "PlaybackPrefetcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "PlaybackSchedule.h"
+#include "concurrency/WorkerPool.h"
+
+namespace {
+//! Granularity of the requests, as a fraction of the depth
+constexpr auto ChunksPerDepth = 4;
+//! Limits the requests when a looped region is very short
+constexpr size_t MaxChunks = 64;
+}
+
+struct PlaybackPrefetcher::Chunk {
+   Chunk(double t0, double t1) : t0{ t0 }, t1{ t1 } {}
+
+   //! t0 <= t1, regardless of direction of play
+   const double t0, t1;
+   //! Set when the play position passes the chunk before its fetching
+   std::atomic<bool> cancelled{ false };
+
+   // Guarded by PlaybackPrefetcher::mMutex
+   bool ready{ false };
+   std::vector<std::shared_ptr<const void>> data;
+};
+
+PlaybackPrefetcher::PlaybackPrefetcher()
+   : mpWorker{ std::make_unique<audacity::concurrency::WorkerPool>(1) }
+{
+}
+
+PlaybackPrefetcher::~PlaybackPrefetcher()
+{
+   Stop();
+}
+
+void PlaybackPrefetcher::SetDepth(double seconds)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mDepth = std::max(0.0, seconds);
+}
+
+double PlaybackPrefetcher::GetDepth() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mDepth;
+}
+
+void PlaybackPrefetcher::Start(const ConstPlayableSequences &sequences)
+{
+   Stop();
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mSequences = sequences;
+   mStatistics = {};
+}
+
+void PlaybackPrefetcher::Stop()
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   Discard(mChunks.end());
+   mSequences.clear();
+   // Sequences may refer to tracks that do not outlive the playback, so
+   // wait until no job uses them
+   mIdle.wait(lock, [this]{ return mPending == 0; });
+}
+
+void PlaybackPrefetcher::Update(const PlaybackSchedule &schedule)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (mSequences.empty() || mDepth <= 0)
+      return;
+
+   const auto time = schedule.mTimeQueue.GetLastTime();
+   const auto reversed = schedule.ReversedTime();
+   const auto looping = schedule.GetPolicy().Looping(schedule);
+   const auto begin = std::min(schedule.mT0, schedule.mT1);
+   const auto end = std::max(schedule.mT0, schedule.mT1);
+
+   const auto ahead = [&](const Chunk &chunk) {
+      return reversed
+         ? std::max(0.0, std::min(time, chunk.t1) - chunk.t0)
+         : std::max(0.0, chunk.t1 - std::max(time, chunk.t0));
+   };
+   const auto current = std::find_if(mChunks.begin(), mChunks.end(),
+      [&](const ChunkPtr &pChunk) {
+         return reversed
+            ? pChunk->t0 < time && time <= pChunk->t1
+            : pChunk->t0 <= time && time < pChunk->t1;
+      });
+
+   if (current == mChunks.end()) {
+      // First update, or a seek, or scrubbing, or a change of the looped
+      // region, or the play position overtook all the requests
+      if (!mChunks.empty() && begin < time && time < end)
+         ++mStatistics.stalls;
+      Discard(mChunks.end());
+      mFrontier = time;
+   }
+   else {
+      if (!(*current)->ready)
+         ++mStatistics.stalls;
+      Discard(current);
+   }
+
+   // How much is requested, and how much is ready without gaps
+   auto requested = 0.0;
+   mStatistics.depth = 0;
+   bool contiguous = true;
+   for (const auto &pChunk : mChunks) {
+      const auto length = ahead(*pChunk);
+      requested += length;
+      contiguous = contiguous && pChunk->ready;
+      if (contiguous)
+         mStatistics.depth += length;
+   }
+
+   const auto chunkLength = mDepth / ChunksPerDepth;
+   while (requested < mDepth && mChunks.size() < MaxChunks) {
+      double t0, t1;
+      if (!reversed) {
+         if (mFrontier >= end) {
+            if (!(looping && end > begin))
+               break;
+            mFrontier = begin;
+         }
+         t0 = mFrontier;
+         t1 = mFrontier = std::min(end, mFrontier + chunkLength);
+      }
+      else {
+         if (mFrontier <= begin) {
+            if (!(looping && end > begin))
+               break;
+            mFrontier = end;
+         }
+         t1 = mFrontier;
+         t0 = mFrontier = std::max(begin, mFrontier - chunkLength);
+      }
+      Request(t0, t1);
+      requested += t1 - t0;
+   }
+}
+
+auto PlaybackPrefetcher::GetStatistics() const -> Statistics
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mStatistics;
+}
+
+void PlaybackPrefetcher::Request(double t0, double t1)
+{
+   auto pChunk = std::make_shared<Chunk>(t0, t1);
+   mChunks.push_back(pChunk);
+   ++mPending;
+   mpWorker->Post([this, pChunk]{ Fetch(*pChunk); });
+}
+
+void PlaybackPrefetcher::Fetch(Chunk &chunk)
+{
+   ConstPlayableSequences sequences;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (!chunk.cancelled.load(std::memory_order_relaxed))
+         sequences = mSequences;
+   }
+
+   std::vector<std::shared_ptr<const void>> data;
+   data.reserve(sequences.size());
+   for (const auto &pSequence : sequences) {
+      if (chunk.cancelled.load(std::memory_order_relaxed))
+         break;
+      try {
+         data.push_back(pSequence->Prefetch(chunk.t0, chunk.t1));
+      }
+      catch (...) {
+         // The audio thread will meet the error, if it persists
+      }
+   }
+   // Release before Stop() can return
+   sequences.clear();
+
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (!chunk.cancelled.load(std::memory_order_relaxed)) {
+         chunk.data = std::move(data);
+         chunk.ready = true;
+         ++mStatistics.fetches;
+      }
+      --mPending;
+      mIdle.notify_all();
+   }
+}
+
+void PlaybackPrefetcher::Discard(std::deque<ChunkPtr>::iterator end)
+{
+   for (auto iter = mChunks.begin(); iter != end; ++iter)
+      (*iter)->cancelled.store(true, std::memory_order_relaxed);
+   mChunks.erase(mChunks.begin(), end);
+}
@@ -0,0 +1,91 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PlaybackPrefetcher.h
+
+  @brief Reads the samples that playback will need next on a worker thread
+
+**********************************************************************/
+#ifndef __AUDACITY_PLAYBACK_PREFETCHER__
+#define __AUDACITY_PLAYBACK_PREFETCHER__
+
+#include "AudioIOSequences.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace audacity::concurrency { class WorkerPool; }
+struct PlaybackSchedule;
+
+//! Fetches sample data of the playback sequences ahead of the audio thread
+/*!
+ A background thread calls PlayableSequence::Prefetch for the ranges of
+ sequence time that the audio thread will read next, in the direction of
+ play, and wrapping around to the start of a looped region before the play
+ position gets there.  The fetched data stay in memory until the play
+ position passes them, so that the audio thread does not wait for storage.
+ */
+class AUDIO_IO_API PlaybackPrefetcher final
+{
+public:
+   struct Statistics {
+      //! Seconds of sequence time ready ahead of the play position
+      double depth{};
+      //! Count of updates that found the play position in data not yet
+      //! fetched
+      size_t stalls{};
+      //! Count of ranges fetched since Start()
+      size_t fetches{};
+   };
+
+   PlaybackPrefetcher();
+   ~PlaybackPrefetcher();
+
+   //! Seconds of sequence time to keep fetched ahead; zero disables
+   void SetDepth(double seconds);
+   double GetDepth() const;
+
+   //! Called in the main thread before the audio thread begins to play
+   void Start(const ConstPlayableSequences &sequences);
+
+   //! Called in the main thread after the audio thread stops playing
+   /*! Waits for any fetching in progress, then releases the fetched data and
+    the sequences */
+   void Stop();
+
+   //! Called by the audio thread after each filling of the playback buffers
+   void Update(const PlaybackSchedule &schedule);
+
+   Statistics GetStatistics() const;
+
+private:
+   struct Chunk;
+   using ChunkPtr = std::shared_ptr<Chunk>;
+
+   //! @pre mMutex is locked
+   void Request(double t0, double t1);
+   //! Called in the worker thread
+   void Fetch(Chunk &chunk);
+   //! @pre mMutex is locked
+   void Discard(std::deque<ChunkPtr>::iterator end);
+
+   mutable std::mutex mMutex;
+   std::condition_variable mIdle;
+
+   ConstPlayableSequences mSequences;
+   //! In order of play
+   std::deque<ChunkPtr> mChunks;
+   //! The sequence time at which to continue requesting
+   double mFrontier{};
+   double mDepth{ 0 };
+   size_t mPending{ 0 };
+   Statistics mStatistics;
+
+   //! Destroyed first, so its thread finishes before other members go away
+   const std::unique_ptr<audacity::concurrency::WorkerPool> mpWorker;
+};
+
+#endif
@@ -58,6 +58,14 @@ auto BassTrebleBase::RealtimeSupport() const -> RealtimeSince
    return RealtimeSince::After_3_1;
 }
 
+// PerTrackEffect implementation
+
+bool BassTrebleBase::IsInstanceSafe() const
+{
+   // All state is in the instances
+   return true;
+}
+
 unsigned BassTrebleBase::Instance::GetAudioInCount() const
 {
    return 1;
@@ -67,6 +67,10 @@ public:
    EffectType GetType() const override;
    RealtimeSince RealtimeSupport() const override;
 
+   // PerTrackEffect implementation
+
+   bool IsInstanceSafe() const override;
+
    // Effect Implementation
 
    bool CheckWhetherSkipEffect(const EffectSettings& settings) const override;
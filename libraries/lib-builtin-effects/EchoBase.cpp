@@ -53,6 +53,14 @@ EffectType EchoBase::GetType() const
    return EffectTypeProcess;
 }
 
+// PerTrackEffect implementation
+
+bool EchoBase::IsInstanceSafe() const
+{
+   // All state is in the instances
+   return true;
+}
+
 bool EchoBase::Instance::ProcessInitialize(
    EffectSettings& settings, double sampleRate, ChannelNames)
 {
@@ -45,6 +45,10 @@ public:
 
    EffectType GetType() const override;
 
+   // PerTrackEffect implementation
+
+   bool IsInstanceSafe() const override;
+
    struct BUILTIN_EFFECTS_API Instance :
        public PerTrackEffect::Instance,
        public EffectInstanceWithBlockSize
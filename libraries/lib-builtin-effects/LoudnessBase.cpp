@@ -335,13 +335,9 @@ void LoudnessBase::LoadBufferBlock(
 /// (for loudness).
 bool LoudnessBase::AnalyseBufferBlock(EBUR128& loudnessProcessor)
 {
-   for (size_t i = 0; i < mTrackBufferLen; i++)
-   {
-      loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[0][i], 0);
-      if (mProcStereo)
-         loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[1][i], 1);
-      loudnessProcessor.NextSample();
-   }
+   const float* const channels[] { mTrackBuffer[0].get(),
+                                   mTrackBuffer[1].get() };
+   loudnessProcessor.ProcessBlock(channels, mProcStereo ? 2 : 1, mTrackBufferLen);
 
    if (!UpdateProgress())
       return false;
@@ -0,0 +1,191 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: WorkerPool.cpp
+ */
+
+#include "WorkerPool.h"
+
+#include <atomic>
+
+namespace audacity::concurrency
+{
+struct WorkerPool::Batch final
+{
+   Batch(size_t count, IndexedJobRef job)
+       : count { count }
+       , job { job }
+   {
+   }
+
+   const size_t count;
+   const IndexedJobRef job;
+
+   std::atomic<size_t> next { 0 };
+
+   // Guarded by WorkerPool::mMutex
+   size_t participants { 0 };
+   std::exception_ptr exception;
+   Batch* nextBatch { nullptr };
+};
+
+size_t WorkerPool::DefaultThreadCount()
+{
+   const auto hardwareThreads = std::thread::hardware_concurrency();
+   return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+WorkerPool::WorkerPool(size_t nThreads)
+{
+   mThreads.reserve(nThreads);
+   for (size_t i = 0; i < nThreads; ++i)
+      mThreads.emplace_back([this] { ThreadFunction(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+   {
+      auto lock = std::lock_guard { mMutex };
+      mStop = true;
+   }
+   mWorkAvailable.notify_all();
+
+   for (auto& thread : mThreads)
+      thread.join();
+}
+
+size_t WorkerPool::GetThreadCount() const noexcept
+{
+   return mThreads.size();
+}
+
+void WorkerPool::DoParallelFor(size_t count, IndexedJobRef job)
+{
+   if (count == 0)
+      return;
+
+   if (count == 1 || mThreads.empty())
+   {
+      for (size_t i = 0; i < count; ++i)
+         job(i);
+      return;
+   }
+
+   Batch batch { count, job };
+
+   {
+      auto lock = std::lock_guard { mMutex };
+      batch.nextBatch = mBatches;
+      mBatches = &batch;
+   }
+   mWorkAvailable.notify_all();
+
+   RunBatch(batch);
+
+   {
+      auto lock = std::unique_lock { mMutex };
+      // No thread may join the batch after this
+      auto ppBatch = &mBatches;
+      while (*ppBatch != &batch)
+         ppBatch = &(*ppBatch)->nextBatch;
+      *ppBatch = batch.nextBatch;
+      mBatchReleased.wait(lock, [&] { return batch.participants == 0; });
+   }
+
+   if (batch.exception)
+      std::rethrow_exception(batch.exception);
+}
+
+void WorkerPool::Post(Job job)
+{
+   {
+      auto lock = std::lock_guard { mMutex };
+      mJobs.push_back(std::move(job));
+   }
+   mWorkAvailable.notify_one();
+}
+
+void WorkerPool::ThreadFunction()
+{
+   auto lock = std::unique_lock { mMutex };
+
+   while (true)
+   {
+      Batch* batch = nullptr;
+
+      mWorkAvailable.wait(
+         lock,
+         [&]
+         {
+            batch = FindBatch();
+            return batch != nullptr || !mJobs.empty() || mStop;
+         });
+
+      if (batch != nullptr)
+      {
+         ++batch->participants;
+         lock.unlock();
+         RunBatch(*batch);
+         lock.lock();
+
+         if (--batch->participants == 0)
+            mBatchReleased.notify_all();
+      }
+      else if (!mJobs.empty())
+      {
+         auto job = std::move(mJobs.front());
+         mJobs.pop_front();
+         lock.unlock();
+
+         try
+         {
+            job();
+         }
+         catch (...)
+         {
+         }
+
+         lock.lock();
+      }
+      else
+         return;
+   }
+}
+
+WorkerPool::Batch* WorkerPool::FindBatch() const
+{
+   // Batches are preferred to detached jobs, because some thread waits
+   // for them
+   for (auto batch = mBatches; batch != nullptr; batch = batch->nextBatch)
+   {
+      if (batch->next.load(std::memory_order_relaxed) < batch->count)
+         return batch;
+   }
+
+   return nullptr;
+}
+
+void WorkerPool::RunBatch(Batch& batch)
+{
+   while (true)
+   {
+      const auto index = batch.next.fetch_add(1, std::memory_order_relaxed);
+
+      if (index >= batch.count)
+         return;
+
+      try
+      {
+         batch.job(index);
+      }
+      catch (...)
+      {
+         // Skip whatever was not yet started
+         batch.next.store(batch.count, std::memory_order_relaxed);
+
+         auto lock = std::lock_guard { mMutex };
+         if (!batch.exception)
+            batch.exception = std::current_exception();
+      }
+   }
+}
+} // namespace audacity::concurrency
@@ -0,0 +1,117 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: WorkerPool.h
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace audacity::concurrency
+{
+//! A fixed set of threads executing fork/join batches and detached jobs
+/*!
+ Items of a batch submitted with ParallelFor are handed out one at a time from
+ a shared counter, so that idle threads take the next pending item as soon as
+ they finish the previous one, and one slow item does not hold up the others.
+ The submitting thread participates in the batch too, so nested or concurrent
+ batches from different threads can never deadlock.
+ */
+class CONCURRENCY_API WorkerPool final
+{
+public:
+   //! One less than the number of hardware threads, but at least one
+   static size_t DefaultThreadCount();
+
+   explicit WorkerPool(size_t nThreads = DefaultThreadCount());
+   ~WorkerPool();
+
+   WorkerPool(const WorkerPool&)            = delete;
+   WorkerPool(WorkerPool&&)                 = delete;
+   WorkerPool& operator=(const WorkerPool&) = delete;
+   WorkerPool& operator=(WorkerPool&&)      = delete;
+
+   //! Number of threads, not counting the callers of ParallelFor
+   size_t GetThreadCount() const noexcept;
+
+   //! Calls job(i) for each i in [0, count), returning only when all are done
+   /*!
+    The calling thread executes items as well.  Allocates no memory: the job
+    is referenced, not copied, so that this may be called from the audio
+    thread.
+    If any item throws, items not yet begun are skipped, and the first
+    exception is rethrown to the caller after all running items finish.
+    */
+   template<typename Function>
+   void ParallelFor(size_t count, Function&& job)
+   {
+      DoParallelFor(count, IndexedJobRef { job });
+   }
+
+   using Job = std::function<void()>;
+
+   //! Queue a job to be run by one of the threads, in FIFO order
+   /*!
+    Exceptions escaping the job are swallowed.
+    Jobs that are still queued when the pool is destroyed are run before
+    the threads are joined.
+    */
+   void Post(Job job);
+
+private:
+   //! Non-owning, type-erased reference to a callable taking an index
+   class IndexedJobRef final
+   {
+   public:
+      template<
+         typename Function,
+         typename = std::enable_if_t<!std::is_same_v<
+            std::remove_const_t<Function>, IndexedJobRef>>>
+      explicit IndexedJobRef(Function& function) noexcept
+          : mFunction { const_cast<void*>(
+               static_cast<const void*>(std::addressof(function))) }
+          , mInvoke { [](void* pFunction, size_t index) {
+             (*static_cast<std::remove_reference_t<Function>*>(pFunction))(
+                index);
+          } }
+      {
+      }
+
+      void operator()(size_t index) const
+      {
+         mInvoke(mFunction, index);
+      }
+
+   private:
+      void* mFunction;
+      void (*mInvoke)(void*, size_t);
+   };
+
+   struct Batch;
+
+   void DoParallelFor(size_t count, IndexedJobRef job);
+
+   void ThreadFunction();
+   Batch* FindBatch() const;
+   void RunBatch(Batch& batch);
+
+   std::vector<std::thread> mThreads;
+
+   mutable std::mutex mMutex;
+   std::condition_variable mWorkAvailable;
+   std::condition_variable mBatchReleased;
+   //! Intrusive list of the batches being run, so that none is allocated
+   Batch* mBatches { nullptr };
+   std::deque<Job> mJobs;
+   bool mStop { false };
+}; // class WorkerPool
+} // namespace audacity::concurrency
@@ -30,6 +30,13 @@
 #include "WaveTrack.h"
 #include "WaveTrackSink.h"
 #include "WideSampleSource.h"
+#include "concurrency/WorkerPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 
 PerTrackEffect::Instance::~Instance() = default;
 
@@ -89,19 +96,49 @@ bool PerTrackEffect::Process(
    return bGoodResult;
 }
 
+//! Buffers and instances that one thread reuses for successive tracks
+struct PerTrackEffect::Worker {
+   Worker(std::shared_ptr<EffectInstance> pInstance,
+      unsigned numAudioIn, unsigned numAudioOut
+   )  : recycledInstances{ move(pInstance) }
+      , numAudioIn{ numAudioIn }, numAudioOut{ numAudioOut }
+   {}
+
+   EffectInstance &GetInstance() const { return *recycledInstances[0]; }
+
+   // Instances that can be reused in each loop pass
+   // First one is the given one; any others pushed onto here are
+   // discarded when the pass ends
+   std::vector<std::shared_ptr<EffectInstance>> recycledInstances;
+   const unsigned numAudioIn;
+   const unsigned numAudioOut;
+
+   Buffers inBuffers, outBuffers;
+   ChannelName map[3];
+   size_t prevBufferSize = 0;
+   bool clear = false;
+};
+
+namespace {
+//! Shared by all projects, to process tracks concurrently
+audacity::concurrency::WorkerPool &EffectWorkers()
+{
+   static audacity::concurrency::WorkerPool workers;
+   return workers;
+}
+}
+
+bool PerTrackEffect::IsInstanceSafe() const
+{
+   return false;
+}
+
 bool PerTrackEffect::ProcessPass(TrackList &outputs,
    Instance &instance, EffectSettings &settings)
 {
    const auto duration = settings.extra.GetDuration();
    bool bGoodResult = true;
-   bool isGenerator = GetType() == EffectTypeGenerate;
-   bool isProcessor = GetType() == EffectTypeProcess;
-
-   Buffers inBuffers, outBuffers;
-   ChannelName map[3];
-   size_t prevBufferSize = 0;
    int count = 0;
-   bool clear = false;
 
    // It's possible that the number of channels the effect expects changed based on
    // the parameters (the Audacity Reverb effect does when the stereo width is 0).
@@ -110,205 +147,46 @@ bool PerTrackEffect::ProcessPass(TrackList &outputs,
    if (numAudioOut < 1)
       return false;
 
-   // Instances that can be reused in each loop pass
-   std::vector<std::shared_ptr<EffectInstance>> recycledInstances{
-      // First one is the given one; any others pushed onto here are
-      // discarded when we exit
-      std::dynamic_pointer_cast<EffectInstanceEx>(instance.shared_from_this())
+   if (GetType() == EffectTypeProcess && IsInstanceSafe())
+      if (const auto result =
+         ProcessPassInParallel(outputs, instance, settings))
+         return *result;
+
+   Worker worker{
+      std::dynamic_pointer_cast<EffectInstanceEx>(instance.shared_from_this()),
+      numAudioIn, numAudioOut
    };
 
    const bool multichannel = numAudioIn > 1;
    int iChannel = 0;
    TrackListHolder results;
+   const auto progress = [&](unsigned numChannels, double fraction) {
+      if (numChannels > 1)
+         return TrackGroupProgress(count, fraction);
+      else
+         return TrackProgress(count, fraction);
+   };
    const auto waveTrackVisitor =
       [&](WaveTrack &wt, WaveChannel &chan, bool isFirst) {
          if (isFirst)
             iChannel = 0;
 
-         sampleCount len = 0;
-         sampleCount start = 0;
-         WaveChannel *pRight{};
-
          const int channel = (multichannel ? -1 : iChannel++);
-         const auto numChannels = MakeChannelMap(wt.NChannels(), channel, map);
-         if (multichannel) {
-            assert(numAudioIn > 1);
-            if (numChannels == 2) {
-               // TODO: more-than-two-channels
-               pRight = (*wt.Channels().rbegin()).get();
-               clear = false;
-            }
-         }
-
-         if (!isGenerator) {
-            GetBounds(wt, &start, &len);
-            mSampleCnt = len;
-            if (len > 0 && numAudioIn < 1) {
-               bGoodResult = false;
-               return;
-            }
-         }
-         else
-            mSampleCnt = wt.TimeToLongSamples(duration);
-
-         const auto sampleRate = wt.GetRate();
-
-         // Get the block size the client wants to use
-         auto max = wt.GetMaxBlockSize() * 2;
-         const auto blockSize = instance.SetBlockSize(max);
-         if (blockSize == 0) {
-            bGoodResult = false;
-            return;
-         }
-
-         // Calculate the buffer size to be at least the max rounded up to the clients
-         // selected block size.
-         const auto bufferSize =
-            ((max + (blockSize - 1)) / blockSize) * blockSize;
-         if (bufferSize == 0) {
-            bGoodResult = false;
-            return;
-         }
-
-         // Always create the number of input buffers the client expects even
-         // if we don't have
-         // the same number of channels.
-         // (These resizes may do nothing after the first track)
-
-         if (len > 0)
-            assert(numAudioIn > 0); // checked above
-         inBuffers.Reinit(
-            // TODO fix this hack for making Generator progress work without
-            // assertion violations.  Make a dummy Source class that doesn't
-            // care about the buffers.
-            std::max(1u, numAudioIn),
-            blockSize,
-            std::max<size_t>(1, bufferSize / blockSize));
-         if (len > 0)
-            // post of Reinit later satisfies pre of Source::Acquire()
-            assert(inBuffers.Channels() > 0);
-
-         if (prevBufferSize != bufferSize) {
-            // Buffer size has changed
-            // We won't be using more than the first 2 buffers,
-            // so clear the rest (if any)
-            for (size_t i = 2; i < numAudioIn; i++)
-               inBuffers.ClearBuffer(i, bufferSize);
-         }
-         prevBufferSize = bufferSize;
-
-         // Always create the number of output buffers the client expects
-         // even if we don't have the same number of channels.
-         // (These resizes may do nothing after the first track)
-         // Output buffers get an extra blockSize worth to give extra room if
-         // the plugin adds latency -- PRL:  actually not important to do
-         assert(numAudioOut > 0); // checked above
-         outBuffers.Reinit(numAudioOut, blockSize,
-            (bufferSize / blockSize) + 1);
-         // post of Reinit satisfies pre of ProcessTrack
-         assert(outBuffers.Channels() > 0);
-
-         // (Re)Set the input buffer positions
-         inBuffers.Rewind();
-
-         // Clear unused input buffers
-         if (!pRight && !clear && numAudioIn > 1) {
-            inBuffers.ClearBuffer(1, bufferSize);
-            clear = true;
-         }
-
-         const auto genLength = [this, &settings, &wt, isGenerator](
-         ) -> std::optional<sampleCount> {
-            double genDur = 0;
-            if (isGenerator) {
-               const auto duration = settings.extra.GetDuration();
-               if (IsPreviewing()) {
-                  gPrefs->Read(wxT("/AudioIO/EffectsPreviewLen"), &genDur, 6.0);
-                  genDur = std::min(duration, CalcPreviewInputLength(settings, genDur));
-               }
-               else
-                  genDur = duration;
-               // round to nearest sample
-               return sampleCount{ (wt.GetRate() * genDur) + 0.5 };
-            }
-            else
-               return {};
-         }();
-
-         const auto pollUser = [this, numChannels, count, start,
-            length = (genLength ? *genLength : len).as_double()
-         ](sampleCount inPos){
-            if (numChannels > 1) {
-               if (TrackGroupProgress(
-                  count, (inPos - start).as_double() / length)
-               )
-                  return false;
-            }
+         std::shared_ptr<WaveTrack> pGenerated;
+         bGoodResult = ProcessChannels(worker, wt, chan, channel, settings,
+            progress, &mSampleCnt, pGenerated);
+         if (bGoodResult && pGenerated) {
+            if (!results)
+               results = TrackList::Temporary(nullptr, pGenerated);
             else {
-               if (TrackProgress(count, (inPos - start).as_double() / length))
-                  return false;
-            }
-            return true;
-         };
-
-         // Assured above
-         assert(len == 0 || inBuffers.Channels() > 0);
-         // TODO fix this hack to make the time remaining of the generator
-         // progress dialog correct
-         if (len == 0 && genLength)
-            len = *genLength;
-         WideSampleSequence *pSeq = &chan;
-         if (pRight)
-            pSeq = &wt;
-         WideSampleSource source{
-            *pSeq, size_t(pRight ? 2 : 1), start, len, pollUser };
-         // Assert source is safe to Acquire inBuffers
-         assert(source.AcceptsBuffers(inBuffers));
-         assert(source.AcceptsBlockSize(inBuffers.BlockSize()));
-
-         // Make "wide" or "narrow" copy of the track if generating
-         // Old generator code may still proceed "interval-major" and later
-         // join mono into stereo
-         auto wideTrack =
-            (pRight && isGenerator) ? wt.EmptyCopy() : nullptr;
-         auto narrowTrack =
-            (!pRight && isGenerator) ? wt.EmptyCopy(1) : nullptr;
-         const auto pGenerated = wideTrack
-            ? wideTrack
-            : narrowTrack;
-
-         WaveTrackSink sink{ chan, pRight, pGenerated.get(), start, isProcessor,
-            instance.NeedsDither() ? widestSampleFormat : narrowestSampleFormat
-         };
-         assert(sink.AcceptsBuffers(outBuffers));
-
-         // Go process the track(s)
-         const auto factory =
-         [this, &recycledInstances, counter = 0]() mutable {
-            auto index = counter++;
-            if (index < recycledInstances.size())
-               return recycledInstances[index];
-            else
-               return recycledInstances.emplace_back(MakeInstance());
-         };
-         bGoodResult = ProcessTrack(channel, factory, settings, source, sink,
-            genLength, sampleRate, wt, inBuffers, outBuffers);
-         if (bGoodResult) {
-            sink.Flush(outBuffers);
-            bGoodResult = sink.IsOk();
-            if (bGoodResult && pGenerated) {
-               if (!results)
-                  results = TrackList::Temporary(nullptr, pGenerated);
-               else {
-                  results->Add(pGenerated);
-                  if (!multichannel && !isFirst && narrowTrack) {
-                     // Generated a stereo track, in channel-major fashion.
-                     // Get the last track but one -- generated in the previous
-                     // pass
-                     const auto pLast =
-                        static_cast<WaveTrack*>(*std::next(results->rbegin()));
-                     pLast->ZipClips();
-                  }
+               results->Add(pGenerated);
+               if (!multichannel && !isFirst) {
+                  // Generated a stereo track, in channel-major fashion.
+                  // Get the last track but one -- generated in the previous
+                  // pass
+                  const auto pLast =
+                     static_cast<WaveTrack*>(*std::next(results->rbegin()));
+                  pLast->ZipClips();
                }
             }
          }
@@ -355,6 +233,289 @@ bool PerTrackEffect::ProcessPass(TrackList &outputs,
    return bGoodResult;
 }
 
+std::optional<bool> PerTrackEffect::ProcessPassInParallel(
+   TrackList &outputs, Instance &instance, EffectSettings &settings)
+{
+   const auto duration = settings.extra.GetDuration();
+   const auto numAudioIn = instance.GetAudioInCount();
+   const auto numAudioOut = instance.GetAudioOutCount();
+   const bool multichannel = numAudioIn > 1;
+
+   std::vector<WaveTrack *> tracks;
+   for (const auto pTrack : outputs.Selected<WaveTrack>())
+      tracks.push_back(pTrack);
+   auto &pool = EffectWorkers();
+   const auto nWorkers = std::min(tracks.size(), pool.GetThreadCount());
+   if (nWorkers < 2)
+      return {};
+
+   // Each thread writes only the output tracks it processes; the main thread
+   // reports progress meanwhile, and EffectOutputTracks::Commit() happens
+   // after all are done
+   std::vector<Worker> workers;
+   workers.reserve(nWorkers);
+   workers.emplace_back(
+      std::dynamic_pointer_cast<EffectInstanceEx>(instance.shared_from_this()),
+      numAudioIn, numAudioOut);
+   while (workers.size() < nWorkers)
+      workers.emplace_back(MakeInstance(), numAudioIn, numAudioOut);
+   std::vector<EffectSettings> settingsCopies(nWorkers - 1, settings);
+
+   std::vector<std::atomic<double>> fractions(tracks.size());
+   std::atomic<size_t> next{ 0 };
+   std::atomic<bool> cancelled{ false };
+   std::atomic<bool> failed{ false };
+   std::mutex mutex;
+   std::condition_variable finished;
+   size_t running = nWorkers;
+   std::exception_ptr pException;
+
+   for (size_t iWorker = 0; iWorker < nWorkers; ++iWorker)
+      pool.Post([&, iWorker]{
+         auto &worker = workers[iWorker];
+         auto &workerSettings =
+            iWorker == 0 ? settings : settingsCopies[iWorker - 1];
+         try {
+            for (size_t ii; !failed && (ii = next++) < tracks.size();) {
+               auto &wt = *tracks[ii];
+               const auto nPasses = multichannel ? 1 : wt.NChannels();
+               int channel = 0;
+               for (const auto pChannel : wt.Channels()) {
+                  const auto progress =
+                  [&, ii, channel](unsigned, double fraction) {
+                     fractions[ii].store((channel + fraction) / nPasses,
+                        std::memory_order_relaxed);
+                     return cancelled.load(std::memory_order_relaxed);
+                  };
+                  std::shared_ptr<WaveTrack> pGenerated;
+                  if (!ProcessChannels(worker, wt, *pChannel,
+                     multichannel ? -1 : channel, workerSettings, progress,
+                     nullptr, pGenerated)
+                  ) {
+                     failed = true;
+                     break;
+                  }
+                  if (multichannel)
+                     break;
+                  ++channel;
+               }
+            }
+         }
+         catch (...) {
+            std::lock_guard<std::mutex> lock{ mutex };
+            if (!pException)
+               pException = std::current_exception();
+            failed = true;
+         }
+         // Notify under the lock, so that the main thread can't yet return
+         // and destroy the condition variable
+         std::lock_guard<std::mutex> lock{ mutex };
+         --running;
+         finished.notify_one();
+      });
+
+   {
+      std::unique_lock<std::mutex> lock{ mutex };
+      while (running > 0) {
+         finished.wait_for(lock, std::chrono::milliseconds{ 50 });
+         lock.unlock();
+         double total = 0;
+         for (const auto &fraction : fractions)
+            total += fraction.load(std::memory_order_relaxed);
+         try {
+            if (TotalProgress(total / tracks.size()))
+               cancelled = true;
+         }
+         catch (...) {
+            // Can't unwind yet while the workers use this stack frame
+            cancelled = true;
+            std::lock_guard<std::mutex> guard{ mutex };
+            if (!pException)
+               pException = std::current_exception();
+         }
+         lock.lock();
+      }
+   }
+   if (pException)
+      std::rethrow_exception(pException);
+   if (failed)
+      return false;
+
+   for (const auto pTrack : outputs.Any())
+      if (!(pTrack->GetSelected() && dynamic_cast<WaveTrack*>(pTrack)) &&
+         SyncLock::IsSyncLockSelected(*pTrack))
+         pTrack->SyncLockAdjust(mT1, mT0 + duration);
+
+   return true;
+}
+
+bool PerTrackEffect::ProcessChannels(Worker &worker,
+   WaveTrack &wt, WaveChannel &chan, int channel, EffectSettings &settings,
+   const Progress &progress, sampleCount *pSampleCnt,
+   std::shared_ptr<WaveTrack> &pGenerated)
+{
+   const bool isGenerator = GetType() == EffectTypeGenerate;
+   const bool isProcessor = GetType() == EffectTypeProcess;
+   const auto numAudioIn = worker.numAudioIn;
+   const auto numAudioOut = worker.numAudioOut;
+   auto &instance = worker.GetInstance();
+   auto &inBuffers = worker.inBuffers;
+   auto &outBuffers = worker.outBuffers;
+
+   sampleCount len = 0;
+   sampleCount start = 0;
+   WaveChannel *pRight{};
+
+   const auto numChannels =
+      MakeChannelMap(wt.NChannels(), channel, worker.map);
+   if (channel < 0) {
+      assert(numAudioIn > 1);
+      if (numChannels == 2) {
+         // TODO: more-than-two-channels
+         pRight = (*wt.Channels().rbegin()).get();
+         worker.clear = false;
+      }
+   }
+
+   if (!isGenerator) {
+      GetBounds(wt, &start, &len);
+      if (pSampleCnt)
+         *pSampleCnt = len;
+      if (len > 0 && numAudioIn < 1)
+         return false;
+   }
+   else if (pSampleCnt)
+      *pSampleCnt = wt.TimeToLongSamples(settings.extra.GetDuration());
+
+   const auto sampleRate = wt.GetRate();
+
+   // Get the block size the client wants to use
+   auto max = wt.GetMaxBlockSize() * 2;
+   const auto blockSize = instance.SetBlockSize(max);
+   if (blockSize == 0)
+      return false;
+
+   // Calculate the buffer size to be at least the max rounded up to the clients
+   // selected block size.
+   const auto bufferSize =
+      ((max + (blockSize - 1)) / blockSize) * blockSize;
+   if (bufferSize == 0)
+      return false;
+
+   // Always create the number of input buffers the client expects even
+   // if we don't have
+   // the same number of channels.
+   // (These resizes may do nothing after the first track)
+
+   if (len > 0)
+      assert(numAudioIn > 0); // checked above
+   inBuffers.Reinit(
+      // TODO fix this hack for making Generator progress work without
+      // assertion violations.  Make a dummy Source class that doesn't
+      // care about the buffers.
+      std::max(1u, numAudioIn),
+      blockSize,
+      std::max<size_t>(1, bufferSize / blockSize));
+   if (len > 0)
+      // post of Reinit later satisfies pre of Source::Acquire()
+      assert(inBuffers.Channels() > 0);
+
+   if (worker.prevBufferSize != bufferSize) {
+      // Buffer size has changed
+      // We won't be using more than the first 2 buffers,
+      // so clear the rest (if any)
+      for (size_t i = 2; i < numAudioIn; i++)
+         inBuffers.ClearBuffer(i, bufferSize);
+   }
+   worker.prevBufferSize = bufferSize;
+
+   // Always create the number of output buffers the client expects
+   // even if we don't have the same number of channels.
+   // (These resizes may do nothing after the first track)
+   // Output buffers get an extra blockSize worth to give extra room if
+   // the plugin adds latency -- PRL:  actually not important to do
+   assert(numAudioOut > 0); // checked above
+   outBuffers.Reinit(numAudioOut, blockSize,
+      (bufferSize / blockSize) + 1);
+   // post of Reinit satisfies pre of ProcessTrack
+   assert(outBuffers.Channels() > 0);
+
+   // (Re)Set the input buffer positions
+   inBuffers.Rewind();
+
+   // Clear unused input buffers
+   if (!pRight && !worker.clear && numAudioIn > 1) {
+      inBuffers.ClearBuffer(1, bufferSize);
+      worker.clear = true;
+   }
+
+   const auto genLength = [this, &settings, &wt, isGenerator](
+   ) -> std::optional<sampleCount> {
+      double genDur = 0;
+      if (isGenerator) {
+         const auto duration = settings.extra.GetDuration();
+         if (IsPreviewing()) {
+            gPrefs->Read(wxT("/AudioIO/EffectsPreviewLen"), &genDur, 6.0);
+            genDur = std::min(duration, CalcPreviewInputLength(settings, genDur));
+         }
+         else
+            genDur = duration;
+         // round to nearest sample
+         return sampleCount{ (wt.GetRate() * genDur) + 0.5 };
+      }
+      else
+         return {};
+   }();
+
+   const auto pollUser = [&progress, numChannels, start,
+      length = (genLength ? *genLength : len).as_double()
+   ](sampleCount inPos){
+      return !progress(numChannels, (inPos - start).as_double() / length);
+   };
+
+   // Assured above
+   assert(len == 0 || inBuffers.Channels() > 0);
+   // TODO fix this hack to make the time remaining of the generator
+   // progress dialog correct
+   if (len == 0 && genLength)
+      len = *genLength;
+   WideSampleSequence *pSeq = &chan;
+   if (pRight)
+      pSeq = &wt;
+   WideSampleSource source{
+      *pSeq, size_t(pRight ? 2 : 1), start, len, pollUser };
+   // Assert source is safe to Acquire inBuffers
+   assert(source.AcceptsBuffers(inBuffers));
+   assert(source.AcceptsBlockSize(inBuffers.BlockSize()));
+
+   // Make "wide" or "narrow" copy of the track if generating
+   // Old generator code may still proceed "interval-major" and later
+   // join mono into stereo
+   if (isGenerator)
+      pGenerated = pRight ? wt.EmptyCopy() : wt.EmptyCopy(1);
+
+   WaveTrackSink sink{ chan, pRight, pGenerated.get(), start, isProcessor,
+      instance.NeedsDither() ? widestSampleFormat : narrowestSampleFormat
+   };
+   assert(sink.AcceptsBuffers(outBuffers));
+
+   // Go process the track(s)
+   const auto factory =
+   [this, &recycledInstances = worker.recycledInstances, counter = 0](
+   ) mutable {
+      auto index = counter++;
+      if (index < recycledInstances.size())
+         return recycledInstances[index];
+      else
+         return recycledInstances.emplace_back(MakeInstance());
+   };
+   if (!ProcessTrack(channel, factory, settings, source, sink,
+      genLength, sampleRate, wt, inBuffers, outBuffers))
+      return false;
+   sink.Flush(outBuffers);
+   return sink.IsOk();
+}
+
 bool PerTrackEffect::ProcessTrack(int channel, const Factory &factory,
    EffectSettings &settings,
    AudioGraph::Source &upstream, AudioGraph::Sink &sink,
@@ -21,9 +21,12 @@
 #include "SampleCount.h"
 #include <functional>
 #include <memory>
+#include <optional>
 
 class EffectOutputTracks;
 class SampleTrack;
+class WaveChannel;
+class WaveTrack;
 
 //! Base class for Effects that treat each (mono or stereo) track independently
 //! of other tracks.
@@ -58,6 +61,15 @@ public:
       const PerTrackEffect &mProcessor;
    };
 
+   //! Whether instances made by MakeInstance() share no mutable state while
+   //! processing, so that several tracks may be processed at once
+   /*!
+    If true, a processing effect applied to more than one track gives each
+    worker thread its own instance and copy of the settings, and must not
+    depend on mSampleCnt.  Default returns false.
+    */
+   virtual bool IsInstanceSafe() const;
+
 protected:
    // These were overridables but the generality wasn't used yet
    /* virtual */ bool DoPass1() const;
@@ -76,9 +88,27 @@ protected:
 
 private:
    using Buffers = AudioGraph::Buffers;
+   struct Worker;
+   //! Receives the number of channels processed together and the fraction
+   //! done; returns true if the user cancelled
+   using Progress = std::function<bool(unsigned, double)>;
 
    bool ProcessPass(TrackList &outputs,
       Instance &instance, EffectSettings &settings);
+   //! Process the selected tracks concurrently, each by one worker thread
+   /*!
+    @return nullopt if there are too few tracks, and nothing was done
+    */
+   std::optional<bool> ProcessPassInParallel(TrackList &outputs,
+      Instance &instance, EffectSettings &settings);
+   /*!
+    @param channel selects one channel if non-negative; else all channels
+    @param pSampleCnt if not null, receives the length to be processed
+    @param pGenerated receives the new track, if generating
+    */
+   bool ProcessChannels(Worker &worker, WaveTrack &wt, WaveChannel &chan,
+      int channel, EffectSettings &settings, const Progress &progress,
+      sampleCount *pSampleCnt, std::shared_ptr<WaveTrack> &pGenerated);
    using Factory = std::function<std::shared_ptr<EffectInstance>()>;
    /*!
     Previous contents of inBuffers and outBuffers are ignored
@@ -38,12 +38,17 @@
 
 #include "RealFFTf.h"
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
 #include <vector>
 #include <stdlib.h>
 #include <math.h>
 
 #include <wx/thread.h>
 
+#include "PowerSpectrumGetter.h"
+
 #ifndef M_PI
 #define	M_PI		3.14159265358979323846  /* pi */
 #endif
@@ -90,9 +95,84 @@ HFFT InitializeFFT(size_t fftlen)
          h->pow2Bits = i;
 #endif
 
+   // pffft asserts, rather than fails, for unsupported sizes, so check first.
+   // It is worth the copying only if it has SIMD.
+   if (pffft_simd_size() > 1 && fftlen <= INT_MAX &&
+       fftlen % pffft_min_fft_size(PFFFT_REAL) == 0)
+   {
+      if (auto pSetup = pffft_new_setup(static_cast<int>(fftlen), PFFFT_REAL))
+         h->pSetup = { pSetup, pffft_destroy_setup };
+   }
+
    return h;
 }
 
+namespace {
+std::atomic<bool> sVectorized{ true };
+
+//! Aligned space for pffft, for the transform and its work area
+float *Scratch(size_t points)
+{
+   // GetFFT shares the tables among threads, so the space can't be there
+   thread_local PffftFloatVector scratch;
+   const auto size = 4 * points;
+   if (scratch.size() < size)
+      scratch.resize(size);
+   return scratch.data();
+}
+
+void VectorizedRealFFTf(
+   fft_type *buffer, size_t nFrames, size_t stride, const FFTParam *h)
+{
+   const auto n = h->Points * 2;
+   const auto z = Scratch(h->Points), work = z + n;
+   const auto br = h->BitReversed.get();
+   for (; nFrames--; buffer += stride) {
+      std::copy(buffer, buffer + n, z);
+      pffft_transform_ordered(h->pSetup.get(), z, z, work, PFFFT_FORWARD);
+
+      // pffft orders the output like the input of InverseRealFFTf, with DC
+      // and Fs/2 first; scatter it into the bit-reversed order of RealFFTf
+      buffer[0] = z[0];
+      buffer[1] = z[1];
+      for (size_t i = 1; i < h->Points; ++i) {
+         buffer[br[i]    ] = z[2 * i    ];
+         buffer[br[i] + 1] = z[2 * i + 1];
+      }
+   }
+}
+
+void VectorizedInverseRealFFTf(
+   fft_type *buffer, size_t nFrames, size_t stride, const FFTParam *h)
+{
+   const auto n = h->Points * 2;
+   const auto z = Scratch(h->Points), work = z + n;
+   const auto br = h->BitReversed.get();
+   // pffft does not scale the inverse
+   const auto scale = 1.0f / n;
+   for (; nFrames--; buffer += stride) {
+      std::copy(buffer, buffer + n, z);
+      pffft_transform_ordered(h->pSetup.get(), z, z, work, PFFFT_BACKWARD);
+
+      for (size_t i = 0; i < h->Points; ++i) {
+         buffer[br[i]    ] = z[2 * i    ] * scale;
+         buffer[br[i] + 1] = z[2 * i + 1] * scale;
+      }
+   }
+}
+}
+
+bool IsFFTVectorized()
+{
+   return sVectorized.load(std::memory_order_relaxed) &&
+      pffft_simd_size() > 1;
+}
+
+void SetFFTVectorized(bool vectorized)
+{
+   sVectorized.store(vectorized, std::memory_order_relaxed);
+}
+
 enum : size_t { MAX_HFFT = 10 };
 
 // Maintain a pool:
@@ -160,6 +240,9 @@ void FFTDeleter::operator() (FFTParam *hFFT) const
 */
 void RealFFTf(fft_type *buffer, const FFTParam *h)
 {
+   if (h->pSetup && sVectorized.load(std::memory_order_relaxed))
+      return VectorizedRealFFTf(buffer, 1, 0, h);
+
    fft_type *A,*B;
    const fft_type *sptr;
    const fft_type *endptr1,*endptr2;
@@ -262,6 +345,9 @@ void RealFFTf(fft_type *buffer, const FFTParam *h)
 */
 void InverseRealFFTf(fft_type *buffer, const FFTParam *h)
 {
+   if (h->pSetup && sVectorized.load(std::memory_order_relaxed))
+      return VectorizedInverseRealFFTf(buffer, 1, 0, h);
+
    fft_type *A,*B;
    const fft_type *sptr;
    const fft_type *endptr1,*endptr2;
@@ -343,6 +429,26 @@ void InverseRealFFTf(fft_type *buffer, const FFTParam *h)
    }
 }
 
+void RealFFTfFrames(
+   fft_type *buffer, size_t nFrames, size_t stride, const FFTParam *h)
+{
+   if (h->pSetup && sVectorized.load(std::memory_order_relaxed))
+      VectorizedRealFFTf(buffer, nFrames, stride, h);
+   else
+      for (; nFrames--; buffer += stride)
+         RealFFTf(buffer, h);
+}
+
+void InverseRealFFTfFrames(
+   fft_type *buffer, size_t nFrames, size_t stride, const FFTParam *h)
+{
+   if (h->pSetup && sVectorized.load(std::memory_order_relaxed))
+      VectorizedInverseRealFFTf(buffer, nFrames, stride, h);
+   else
+      for (; nFrames--; buffer += stride)
+         InverseRealFFTf(buffer, h);
+}
+
 void ReorderToFreq(const FFTParam *hFFT, const fft_type *buffer,
 		   fft_type *RealOut, fft_type *ImagOut)
 {
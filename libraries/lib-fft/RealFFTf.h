@@ -3,11 +3,17 @@
 
 #include "MemoryX.h"
 
+struct PFFFT_Setup;
+
 using fft_type = float;
 struct FFTParam {
    ArrayOf<int> BitReversed;
    ArrayOf<fft_type> SinTable;
    size_t Points;
+   //! Vectorized transform of the same size, used by RealFFTf and
+   //! InverseRealFFTf instead of the tables; null if the size or the build
+   //! does not allow it
+   std::shared_ptr<PFFFT_Setup> pSetup;
 #ifdef EXPERIMENTAL_EQ_SSE_THREADED
    int pow2Bits;
 #endif
@@ -24,9 +30,30 @@ using HFFT = std::unique_ptr<
 FFT_API HFFT GetFFT(size_t);
 FFT_API void RealFFTf(fft_type *, const FFTParam *);
 FFT_API void InverseRealFFTf(fft_type *, const FFTParam *);
+
+//! Transform several frames, each as by RealFFTf
+/*!
+ The frames are transformed one after another; this saves only the lookup of
+ the setup and scratch buffer per frame, and is not faster than RealFFTf
+ @param buffer the start of the first of nFrames frames
+ @param stride distance between starts of frames, at least 2 * h->Points
+ */
+FFT_API void RealFFTfFrames(
+   fft_type *buffer, size_t nFrames, size_t stride, const FFTParam *h);
+//! Transform several frames, each as by InverseRealFFTf
+/*! @copydetails RealFFTfFrames */
+FFT_API void InverseRealFFTfFrames(
+   fft_type *buffer, size_t nFrames, size_t stride, const FFTParam *h);
 FFT_API void ReorderToTime(const FFTParam *hFFT, const fft_type *buffer, fft_type *TimeOut);
 FFT_API void ReorderToFreq(const FFTParam *hFFT, const fft_type *buffer,
 		   fft_type *RealOut, fft_type *ImagOut);
 
+//! Whether RealFFTf and InverseRealFFTf may use SIMD instructions
+/*! The results are the same, up to rounding, in the same bit-reversed order.
+ The default is true, if the build enables SIMD for this processor */
+FFT_API bool IsFFTVectorized();
+//! Allow or forbid SIMD in all threads, for comparisons
+FFT_API void SetFFTVectorized(bool vectorized);
+
 #endif
 
@@ -0,0 +1,217 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealFFTfTests.cpp
+
+**********************************************************************/
+#include "RealFFTf.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr auto pi = 3.14159265358979323846;
+
+std::vector<float> MakeSignal(size_t size)
+{
+   std::mt19937 engine { 42 };
+   std::uniform_real_distribution<float> distribution { -1.f, 1.f };
+   std::vector<float> signal(size);
+   std::generate(
+      signal.begin(), signal.end(), [&] { return distribution(engine); });
+   return signal;
+}
+
+//! Restores the default at the end of a test
+struct VectorizedSetter
+{
+   explicit VectorizedSetter(bool vectorized)
+   {
+      SetFFTVectorized(vectorized);
+   }
+   ~VectorizedSetter()
+   {
+      SetFFTVectorized(true);
+   }
+};
+
+std::vector<float> Forward(std::vector<float> buffer, bool vectorized)
+{
+   const VectorizedSetter setter { vectorized };
+   const auto hFFT = GetFFT(buffer.size());
+   RealFFTf(buffer.data(), hFFT.get());
+   return buffer;
+}
+
+std::vector<float> Inverse(std::vector<float> buffer, bool vectorized)
+{
+   const VectorizedSetter setter { vectorized };
+   const auto hFFT = GetFFT(buffer.size());
+   InverseRealFFTf(buffer.data(), hFFT.get());
+   return buffer;
+}
+
+//! InverseRealFFTf takes the spectrum in normal order
+std::vector<float>
+ToNormalOrder(const std::vector<float>& spectrum, const FFTParam& param)
+{
+   std::vector<float> result(spectrum.size());
+   result[0] = spectrum[0];
+   result[1] = spectrum[1];
+   for (size_t k = 1; k < param.Points; ++k)
+   {
+      result[2 * k] = spectrum[param.BitReversed[k]];
+      result[2 * k + 1] = spectrum[param.BitReversed[k] + 1];
+   }
+   return result;
+}
+
+float MaxAbs(const std::vector<float>& values)
+{
+   float result = 0;
+   for (auto value : values)
+      result = std::max(result, std::abs(value));
+   return result;
+}
+
+float MaxDifference(const std::vector<float>& a, const std::vector<float>& b)
+{
+   float result = 0;
+   for (size_t i = 0; i < a.size(); ++i)
+      result = std::max(result, std::abs(a[i] - b[i]));
+   return result;
+}
+} // namespace
+
+TEST_CASE("RealFFTf")
+{
+   const auto size = GENERATE(as<size_t> {}, 8, 16, 32, 64, 512, 2048, 16384);
+   const auto signal = MakeSignal(size);
+   const auto hFFT = GetFFT(size);
+
+   SECTION("agrees with the definition of the DFT")
+   {
+      const auto spectrum = Forward(signal, true);
+      const auto tolerance = 1e-4 * size;
+      for (size_t k : { size_t(1), size / 4, size / 2 - 1 })
+      {
+         double re = 0, im = 0;
+         for (size_t n = 0; n < size; ++n)
+         {
+            const auto angle = 2 * pi * k * n / size;
+            re += signal[n] * std::cos(angle);
+            im -= signal[n] * std::sin(angle);
+         }
+         REQUIRE(
+            std::abs(spectrum[hFFT->BitReversed[k]] - re) < tolerance);
+         REQUIRE(
+            std::abs(spectrum[hFFT->BitReversed[k] + 1] - im) < tolerance);
+      }
+   }
+
+   SECTION("vectorized and scalar transforms agree")
+   {
+      const auto scalar = Forward(signal, false);
+      const auto vectorized = Forward(signal, true);
+      REQUIRE(MaxDifference(scalar, vectorized) < 1e-6 * MaxAbs(scalar));
+
+      const auto scalarInverse = Inverse(scalar, false);
+      const auto vectorizedInverse = Inverse(scalar, true);
+      REQUIRE(MaxDifference(scalarInverse, vectorizedInverse) < 1e-5);
+   }
+
+   SECTION("inverse undoes forward")
+   {
+      const auto spectrum = Forward(signal, true);
+      auto result = Inverse(ToNormalOrder(spectrum, *hFFT), true);
+      std::vector<float> time(size);
+      ReorderToTime(hFFT.get(), result.data(), time.data());
+      REQUIRE(MaxDifference(signal, time) < 1e-5);
+   }
+}
+
+TEST_CASE("RealFFTfFrames")
+{
+   const auto size = GENERATE(as<size_t> {}, 16, 256, 4096);
+   const auto vectorized = GENERATE(false, true);
+   const VectorizedSetter setter { vectorized };
+   const auto hFFT = GetFFT(size);
+
+   // Leave a gap between frames, which must be untouched
+   constexpr size_t nFrames = 5;
+   const auto stride = size + 3;
+   const auto frames = MakeSignal(nFrames * stride);
+
+   auto batched = frames;
+   RealFFTfFrames(batched.data(), nFrames, stride, hFFT.get());
+   auto restored = batched;
+   InverseRealFFTfFrames(restored.data(), nFrames, stride, hFFT.get());
+
+   for (size_t ii = 0; ii < nFrames; ++ii)
+   {
+      const auto begin = frames.begin() + ii * stride;
+      std::vector<float> frame(begin, begin + size);
+      auto spectrum = frame;
+      RealFFTf(spectrum.data(), hFFT.get());
+      REQUIRE(std::equal(
+         spectrum.begin(), spectrum.end(), batched.begin() + ii * stride));
+      REQUIRE(std::equal(
+         begin + size, begin + stride, batched.begin() + ii * stride + size));
+
+      InverseRealFFTf(spectrum.data(), hFFT.get());
+      REQUIRE(std::equal(
+         spectrum.begin(), spectrum.end(), restored.begin() + ii * stride));
+   }
+}
+
+// Run explicitly, with `lib-fft-test "[benchmark]"`
+TEST_CASE("RealFFTf benchmark", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   std::cout << "size\tscalar (us)\tvectorized (us)\tframes (us)\n";
+   for (size_t size = 32; size <= 65536; size *= 2)
+   {
+      auto buffer = MakeSignal(size);
+      const auto hFFT = GetFFT(size);
+      const auto repetitions = std::max<size_t>(16, (1 << 22) / size);
+      const auto measure = [&](bool vectorized) {
+         const VectorizedSetter setter { vectorized };
+         const auto start = steady_clock::now();
+         for (size_t ii = 0; ii < repetitions; ++ii)
+         {
+            RealFFTf(buffer.data(), hFFT.get());
+            InverseRealFFTf(buffer.data(), hFFT.get());
+         }
+         return duration<double, std::micro>(steady_clock::now() - start)
+                   .count() /
+                repetitions;
+      };
+      const auto scalar = measure(false);
+      const auto vectorized = measure(true);
+
+      // The same number of transforms, in batches of up to 64 frames
+      const auto nFrames = std::min<size_t>(64, repetitions);
+      auto frames = MakeSignal(nFrames * size);
+      const auto start = steady_clock::now();
+      for (size_t ii = 0; ii < repetitions; ii += nFrames)
+      {
+         RealFFTfFrames(frames.data(), nFrames, size, hFFT.get());
+         InverseRealFFTfFrames(frames.data(), nFrames, size, hFFT.get());
+      }
+      const auto batched =
+         duration<double, std::micro>(steady_clock::now() - start).count() /
+         repetitions;
+
+      std::cout << size << "\t" << scalar << "\t" << vectorized << "\t"
+                << batched << "\n";
+   }
+}
@@ -320,7 +320,19 @@ FilePath GetUserTargetDir(DirTarget target, bool allowRoaming)
 } // End of implementation for user directories
 
 FilePath FileNames::CacheDir() { return GetUserTargetDir(DirTarget::Cache, false); }
-FilePath FileNames::ConfigDir() { return GetUserTargetDir(DirTarget::Config, true); }
+static FilePath sSessionConfigDir;
+
+FilePath FileNames::ConfigDir()
+{
+   if (!sSessionConfigDir.empty())
+      return sSessionConfigDir;
+   return GetUserTargetDir(DirTarget::Config, true);
+}
+
+void FileNames::SetSessionConfigDir(const FilePath &path)
+{
+   sSessionConfigDir = path;
+}
 FilePath FileNames::DataDir() { return GetUserTargetDir(DirTarget::Data, true); }
 FilePath FileNames::StateDir() { return GetUserTargetDir(DirTarget::State, false); }
 
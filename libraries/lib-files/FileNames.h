@@ -117,6 +117,11 @@ namespace FileNames
     * Where audacity keeps its settigns squirreled away, by default ~/.config/audacity/
     * on Unix, Application Data/Audacity on windows system */
    FILES_API FilePath ConfigDir();
+   /** \brief Override ConfigDir() for this session only
+    *
+    * Call it before preferences are loaded.  Files outside ConfigDir(), such
+    * as macros, are found where they are for other sessions. */
+   FILES_API void SetSessionConfigDir(const FilePath &path);
    /** \brief Audacity user data directory
     *
     * Where audacity keeps its user data squirreled away, by default ~/.local/share/audacity/
@@ -76,6 +76,11 @@ void TempDirectory::ResetTempDir()
    TempDirPath().clear();
 }
 
+void TempDirectory::SetSessionTempDir( const FilePath &path )
+{
+   TempDirPath() = path;
+}
+
 /** \brief Default temp directory */
 static FilePath sDefaultTempDir;
 
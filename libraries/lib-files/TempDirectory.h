@@ -24,6 +24,9 @@ namespace TempDirectory
 {
    FILES_API wxString TempDir();
    FILES_API void ResetTempDir();
+   //! Use the given directory until the end of the session, or until
+   //! ResetTempDir(), without changing the preference
+   FILES_API void SetSessionTempDir( const FilePath &path );
 
    FILES_API const FilePath &DefaultTempDir();
    FILES_API void SetDefaultTempDir( const FilePath &tempDir );
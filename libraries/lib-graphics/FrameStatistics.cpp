@@ -97,11 +97,17 @@ FrameStatistics::CreateStopwatch(SectionID section) noexcept
       instance.mSections[size_t(SectionID::WaveDataCache)] = {};
       instance.mSections[size_t(SectionID::WaveBitmapCachePreprocess)] = {};
       instance.mSections[size_t(SectionID::WaveBitmapCache)] = {};
+      instance.mSections[size_t(SectionID::WaveBitmapDraw)] = {};
    }
 
    return Stopwatch(section);
 }
 
+void FrameStatistics::AddMeasurement(SectionID section, Duration duration)
+{
+   GetInstance().AddEvent(section, duration);
+}
+
 const FrameStatistics::Section&
 FrameStatistics::GetSection(SectionID section) noexcept
 {
@@ -42,6 +42,12 @@ public:
       WaveBitmapCachePreprocess,
       //! Time required to access the wave bitmaps cache
       WaveBitmapCache,
+      //! Time required to copy the cached bitmaps of a clip to the screen
+      WaveBitmapDraw,
+      //! Time taken by a worker thread to compute an element of the data
+      //! cache, reported when the main thread receives it. Not reset on
+      //! new frames, because the work is not done within any
+      WaveDataCacheFill,
       //! Number of the sections
       Count
    };
@@ -102,6 +108,9 @@ public:
 
    //! Create a Stopwatch for the section specified
    static Stopwatch CreateStopwatch(SectionID section) noexcept;
+   //! Add an event measured elsewhere, as on a worker thread. Must be
+   //! called on the main thread
+   static void AddMeasurement(SectionID section, Duration duration);
    //! Get the section data
    static const Section& GetSection(SectionID section) noexcept;
    //! Subscribe to sections update
@@ -0,0 +1,181 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportScheduler.cpp
+
+**********************************************************************/
+#include "ExportScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "ExportPlugin.h"
+#include "concurrency/WorkerPool.h"
+
+namespace {
+//! What the tasks of one call to Process() share
+struct Progress
+{
+   Progress(ExportProcessorDelegate& delegate, size_t count)
+      : delegate{ delegate }
+      , count{ count }
+      , fractions{ std::make_unique<double[]>(count) }
+   {
+   }
+
+   void Update(size_t index, double fraction)
+   {
+      // The delegate expects calls from one thread at a time, and the total
+      // should not appear to decrease
+      std::lock_guard<std::mutex> lock{ mutex };
+      fractions[index] = fraction;
+      double sum = 0;
+      for (size_t ii = 0; ii < count; ++ii)
+         sum += fractions[ii];
+      delegate.OnProgress(sum / count);
+   }
+
+   ExportProcessorDelegate& delegate;
+   const size_t count;
+   std::mutex mutex;
+   //! Guarded by mutex
+   const std::unique_ptr<double[]> fractions;
+};
+
+//! Forwards to the delegate of Process(), contributing one task's share of
+//! the progress
+class TaskDelegate final : public ExportProcessorDelegate
+{
+public:
+   TaskDelegate(Progress& progress, size_t index)
+      : mProgress{ progress }
+      , mIndex{ index }
+   {
+   }
+
+   bool IsCancelled() const override
+   {
+      return mProgress.delegate.IsCancelled();
+   }
+
+   bool IsStopped() const override
+   {
+      // Stopping the whole lets each running task finish its file, so that
+      // no file is truncated; Process() starts no more tasks
+      return false;
+   }
+
+   void SetStatusString(const TranslatableString& str) override
+   {
+      // Shows the status of the task that most recently changed it
+      std::lock_guard<std::mutex> lock{ mProgress.mutex };
+      mProgress.delegate.SetStatusString(str);
+   }
+
+   void OnProgress(double progress) override
+   {
+      mProgress.Update(mIndex, std::clamp(progress, 0.0, 1.0));
+   }
+
+private:
+   Progress& mProgress;
+   const size_t mIndex;
+};
+}
+
+size_t ExportScheduler::DefaultConcurrency()
+{
+   return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ExportScheduler::ExportScheduler(size_t maxConcurrency)
+   : mMaxConcurrency{ std::max<size_t>(1, maxConcurrency) }
+{
+}
+
+ExportScheduler::~ExportScheduler() = default;
+
+std::shared_future<ExportResult> ExportScheduler::Add(ExportTask task)
+{
+   auto future = task.get_future().share();
+   mPending.push_back({ std::move(task), future });
+   return future;
+}
+
+bool ExportScheduler::HasPending() const
+{
+   return !mPending.empty();
+}
+
+ExportResult ExportScheduler::Process(ExportProcessorDelegate& delegate)
+{
+   const auto count = mPending.size();
+   if (count == 0)
+      return ExportResult::Success;
+
+   Progress progress{ delegate, count };
+   // Written by one thread each, and read after all are joined
+   std::vector<char> started(count, false);
+   std::vector<ExportResult> results(count, ExportResult::Success);
+   std::atomic<bool> halt{ false };
+
+   // The calling thread runs tasks too
+   audacity::concurrency::WorkerPool pool{
+      std::min(mMaxConcurrency, count) - 1 };
+   pool.ParallelFor(count, [&](size_t ii) {
+      if (halt || delegate.IsCancelled() || delegate.IsStopped())
+         return;
+      started[ii] = true;
+
+      auto& entry = mPending[ii];
+      TaskDelegate taskDelegate{ progress, ii };
+      entry.task(taskDelegate);
+      try {
+         results[ii] = entry.future.get();
+      }
+      catch (...) {
+         // The caller learns of the exception from its own future
+         results[ii] = ExportResult::Error;
+      }
+      progress.Update(ii, 1.0);
+      if (results[ii] != ExportResult::Success)
+         halt = true;
+   });
+
+   auto result = ExportResult::Success;
+   const auto merge = [&](ExportResult other) {
+      if (other == ExportResult::Cancelled ||
+          (other == ExportResult::Error &&
+             result != ExportResult::Cancelled) ||
+          (other == ExportResult::Stopped &&
+             result == ExportResult::Success))
+         result = other;
+   };
+
+   std::vector<Entry> pending;
+   for (size_t ii = 0; ii < count; ++ii) {
+      if (started[ii])
+         merge(results[ii]);
+      else
+         pending.push_back(std::move(mPending[ii]));
+   }
+   // Tasks that did not start are reported as the delegate would have made
+   // them end; a stop is reported even if all tasks had started, so that the
+   // caller knows not to add more
+   if (!pending.empty() && delegate.IsCancelled())
+      merge(ExportResult::Cancelled);
+   else if (delegate.IsStopped())
+      merge(ExportResult::Stopped);
+   mPending.swap(pending);
+   return result;
+}
+
+void ExportScheduler::DiscardPending()
+{
+   mPending.clear();
+}
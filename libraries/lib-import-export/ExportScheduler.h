@@ -0,0 +1,78 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportScheduler.h
+
+  @brief Runs independent export tasks concurrently
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <vector>
+
+#include "ExportTypes.h"
+
+class ExportProcessorDelegate;
+
+//! Runs independent export tasks concurrently, reporting to one delegate
+/*!
+ Each task made by ExportTaskBuilder::Build() has its own processor and
+ mixer, so tasks that export different tracks or ranges to different files
+ share nothing but the project, which they only read.  Encoding usually costs
+ the most in exporting, so exporting many files at once scales nearly with
+ the count of processors.
+
+ The delegate passed to Process() receives the average progress of the tasks,
+ and its cancellation applies to all of the running tasks.  Stopping it lets
+ the running tasks finish their files, but starts no more.
+ */
+class IMPORT_EXPORT_API ExportScheduler final
+{
+public:
+   //! The number of hardware threads, but at least one
+   static size_t DefaultConcurrency();
+
+   explicit ExportScheduler(size_t maxConcurrency = DefaultConcurrency());
+   ~ExportScheduler();
+
+   ExportScheduler(const ExportScheduler&) = delete;
+   ExportScheduler& operator=(const ExportScheduler&) = delete;
+
+   //! Add a task for the next call to Process()
+   /*!
+    @return the result of the task, ready when the task has run; if the task
+    throws, so does get()
+    */
+   std::shared_future<ExportResult> Add(ExportTask task);
+
+   //! Whether some tasks have not yet run
+   bool HasPending() const;
+
+   //! Runs the pending tasks in order of addition, at most maxConcurrency of
+   //! them at once, returning when all that started are done
+   /*!
+    Tasks no longer start after the delegate is cancelled or stopped, or
+    after any task does not succeed.  Those remain pending for another call.
+    @return Cancelled if any task was cancelled, else Error if any failed,
+    else Stopped if the delegate was stopped, else Success
+    */
+   ExportResult Process(ExportProcessorDelegate& delegate);
+
+   //! Destroys the tasks that have not run, closing their files; their
+   //! futures then throw std::future_error
+   void DiscardPending();
+
+private:
+   struct Entry
+   {
+      ExportTask task;
+      std::shared_future<ExportResult> future;
+   };
+
+   const size_t mMaxConcurrency;
+   std::vector<Entry> mPending;
+};
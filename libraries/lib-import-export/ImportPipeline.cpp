@@ -0,0 +1,203 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportPipeline.cpp
+
+**********************************************************************/
+#include "ImportPipeline.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "Dither.h"
+#include "MemoryX.h"
+#include "concurrency/WorkerPool.h"
+
+namespace {
+audacity::concurrency::WorkerPool &ImportWorkers()
+{
+   static audacity::concurrency::WorkerPool workers;
+   return workers;
+}
+
+//! Enough chunks to keep all the workers busy while one is being read and
+//! another appended, but not so many that large chunks use much memory
+size_t ChunkCount()
+{
+   return std::clamp<size_t>(ImportWorkers().GetThreadCount() + 2, 3, 8);
+}
+}
+
+samplePtr ImportPipeline::Chunk::Raw(size_t bytes)
+{
+   if (mRaw.size() < bytes)
+      mRaw.resize(bytes);
+   return mRaw.data();
+}
+
+void ImportPipeline::Chunk::Reset()
+{
+   stream = 0;
+   nChannels = 0;
+   frames = 0;
+   format = floatSample;
+   progress = -1;
+   mConverted = false;
+   mException = nullptr;
+}
+
+void ImportPipeline::Chunk::ReserveChannels()
+{
+   if (mChannels.size() < nChannels)
+      mChannels.resize(nChannels);
+   const auto bytes = frames * SAMPLE_SIZE(format);
+   for (size_t ii = 0; ii < nChannels; ++ii)
+      if (mChannels[ii].size() < bytes)
+         mChannels[ii].resize(bytes);
+}
+
+void ImportPipeline::Deinterleave(Chunk& chunk)
+{
+   const auto size = SAMPLE_SIZE(chunk.format);
+   for (size_t ii = 0; ii < chunk.nChannels; ++ii)
+      CopySamples(chunk.Raw() + ii * size, chunk.format, chunk.Channel(ii),
+         chunk.format, chunk.frames, DitherType::none, chunk.nChannels, 1);
+}
+
+ImportPipeline::ImportPipeline(Converter converter)
+   : mConverter{ std::move(converter) }
+{
+   const auto count = ChunkCount();
+   mChunks.reserve(count);
+   for (size_t ii = 0; ii < count; ++ii)
+      mChunks.push_back(std::make_unique<Chunk>());
+}
+
+ImportPipeline::~ImportPipeline() = default;
+
+void ImportPipeline::Run(const Reader& reader, const Committer& committer)
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mFree.clear();
+      for (auto& pChunk : mChunks)
+         mFree.push_back(pChunk.get());
+      mPending.clear();
+      mStopping = false;
+      mReaderDone = false;
+   }
+
+   std::exception_ptr readerException;
+   std::thread readerThread{ [&]{
+      try {
+         reader(*this);
+      }
+      catch (...) {
+         readerException = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mReaderDone = true;
+      mChanged.notify_all();
+   } };
+
+   {
+      // The reader and the converters use the chunks, and what the reader and
+      // the converter refer to, so wait for them however this function exits
+      auto cleanup = finally([&]{
+         {
+            std::lock_guard<std::mutex> lock{ mMutex };
+            mStopping = true;
+            mChanged.notify_all();
+         }
+         readerThread.join();
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mChanged.wait(lock, [this]{ return mConverting == 0; });
+      });
+
+      while (true) {
+         Chunk* pChunk{};
+         {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            mChanged.wait(lock, [this]{
+               return mPending.empty()
+                  ? mReaderDone
+                  : mPending.front()->mConverted;
+            });
+            if (mPending.empty())
+               break;
+            pChunk = mPending.front();
+            mPending.pop_front();
+         }
+         if (pChunk->mException)
+            std::rethrow_exception(pChunk->mException);
+         const auto more = committer(*pChunk);
+         {
+            std::lock_guard<std::mutex> lock{ mMutex };
+            Release(*pChunk);
+         }
+         if (!more)
+            break;
+      }
+   }
+   // Now the reader thread is joined
+   if (readerException)
+      std::rethrow_exception(readerException);
+}
+
+auto ImportPipeline::Acquire() -> Chunk*
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   mChanged.wait(lock, [this]{ return mStopping || !mFree.empty(); });
+   if (mStopping)
+      return nullptr;
+   const auto pChunk = mFree.back();
+   mFree.pop_back();
+   pChunk->Reset();
+   return pChunk;
+}
+
+void ImportPipeline::Submit(Chunk& chunk)
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (chunk.frames == 0 || mStopping) {
+         Release(chunk);
+         return;
+      }
+      mPending.push_back(&chunk);
+      ++mConverting;
+   }
+   try {
+      ImportWorkers().Post([this, &chunk]{ Convert(chunk); });
+   }
+   catch (...) {
+      // Convert in this thread instead
+      Convert(chunk);
+   }
+}
+
+void ImportPipeline::Convert(Chunk& chunk)
+{
+   try {
+      chunk.ReserveChannels();
+      if (mConverter)
+         mConverter(chunk);
+   }
+   catch (...) {
+      chunk.mException = std::current_exception();
+   }
+   // Notify while locked, because Run() may return and destroy this as soon
+   // as the count is zero
+   std::lock_guard<std::mutex> lock{ mMutex };
+   chunk.mConverted = true;
+   --mConverting;
+   mChanged.notify_all();
+}
+
+void ImportPipeline::Release(Chunk& chunk)
+{
+   mFree.push_back(&chunk);
+   mChanged.notify_all();
+}
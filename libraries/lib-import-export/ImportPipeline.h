@@ -0,0 +1,136 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportPipeline.h
+
+  @brief Overlaps decoding, conversion and appending of imported samples
+
+**********************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "SampleFormat.h"
+
+//! Runs the stages of an import concurrently, with a bounded number of chunks
+//! of samples in flight
+/*!
+ A reader thread decodes the file into chunks, one at a time and in order.
+ Worker threads convert the chunks to the formats and layouts of the
+ channels, several at once.  The thread that calls Run() appends the
+ converted chunks to the tracks in the order they were read, so that
+ appending, and the creation of sample blocks, stays on that thread as
+ before, and so do reports of progress.
+
+ The reader waits when all chunks are in use, so memory use does not grow
+ when the tracks take samples more slowly than the file gives them.
+ */
+class IMPORT_EXPORT_API ImportPipeline final
+{
+public:
+   //! Samples passing through the stages of the pipeline
+   /*!
+    Chunks are reused, and their buffers keep their capacity from one use
+    to the next.
+    */
+   class IMPORT_EXPORT_API Chunk final
+   {
+   public:
+      //! Which of several streams of the file receives the samples
+      size_t stream{ 0 };
+      //! Count of channels, and of samples in each channel
+      size_t nChannels{ 0 };
+      size_t frames{ 0 };
+      //! Format of the converted samples of each channel
+      sampleFormat format{ floatSample };
+      //! Fraction of the file read through this chunk, if not negative
+      double progress{ -1 };
+
+      //! Buffer for the reader's output, in the layout the converter expects
+      /*! @return at least `bytes` of memory, preserving any contents */
+      samplePtr Raw(size_t bytes);
+      constSamplePtr Raw() const { return mRaw.data(); }
+
+      //! Buffer for `frames` samples of `format`, filled by the converter
+      /*! @pre `iChannel < nChannels` */
+      samplePtr Channel(size_t iChannel)
+      {
+         return mChannels[iChannel].data();
+      }
+      constSamplePtr Channel(size_t iChannel) const
+      {
+         return mChannels[iChannel].data();
+      }
+
+   private:
+      friend ImportPipeline;
+      void Reset();
+      void ReserveChannels();
+
+      std::vector<char> mRaw;
+      std::vector<std::vector<char>> mChannels;
+      bool mConverted{ false };
+      std::exception_ptr mException;
+   };
+
+   //! Called in the reader thread, repeatedly calling Acquire() and Submit()
+   //! until the end of the file or until Acquire() gives null
+   using Reader = std::function<void(ImportPipeline&)>;
+   //! Called in worker threads, filling the channels of the chunk
+   using Converter = std::function<void(Chunk&)>;
+   //! Called in the thread of Run(), in order of reading; returns false to
+   //! stop the import
+   using Committer = std::function<bool(const Chunk&)>;
+
+   //! Converter for chunks whose raw samples are interleaved, in the format
+   //! of the chunk
+   static void Deinterleave(Chunk& chunk);
+
+   explicit ImportPipeline(Converter converter = Deinterleave);
+   ~ImportPipeline();
+
+   ImportPipeline(const ImportPipeline&) = delete;
+   ImportPipeline& operator=(const ImportPipeline&) = delete;
+
+   //! Runs the stages, returning when the reader has returned and all of its
+   //! chunks are committed, or else when the committer returns false
+   /*!
+    Exceptions from any of the stages are rethrown, after the reader and the
+    converters are done.
+    */
+   void Run(const Reader& reader, const Committer& committer);
+
+   //! Called by the reader for a chunk to fill, waiting until one is free
+   /*! @return null if the import stops; then the reader should return */
+   Chunk* Acquire();
+
+   //! Called by the reader to pass a chunk from Acquire() to the converters
+   /*! A chunk without frames is only released */
+   void Submit(Chunk& chunk);
+
+private:
+   void Convert(Chunk& chunk);
+   //! @pre mMutex is locked
+   void Release(Chunk& chunk);
+
+   const Converter mConverter;
+
+   std::mutex mMutex;
+   std::condition_variable mChanged;
+   std::vector<std::unique_ptr<Chunk>> mChunks;
+   std::vector<Chunk*> mFree;
+   //! Submitted chunks, in order of reading
+   std::deque<Chunk*> mPending;
+   size_t mConverting{ 0 };
+   bool mStopping{ false };
+   bool mReaderDone{ false };
+};
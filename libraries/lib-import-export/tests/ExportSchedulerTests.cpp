@@ -0,0 +1,177 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportSchedulerTests.cpp
+
+**********************************************************************/
+#include "ExportScheduler.h"
+#include "ExportPlugin.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+class TestDelegate final : public ExportProcessorDelegate
+{
+public:
+   bool IsCancelled() const override { return cancelled; }
+   bool IsStopped() const override { return stopped; }
+   void SetStatusString(const TranslatableString&) override { }
+   void OnProgress(double value) override
+   {
+      // Called from other threads, so don't use REQUIRE here
+      if (value < progress)
+         decreased = true;
+      progress = value;
+   }
+
+   std::atomic<bool> cancelled { false };
+   std::atomic<bool> stopped { false };
+   double progress { 0 };
+   bool decreased { false };
+};
+
+//! Counts the tasks running at once
+struct Counter
+{
+   std::atomic<int> running { 0 };
+   std::atomic<int> most { 0 };
+   std::atomic<int> runs { 0 };
+};
+
+ExportTask MakeTask(Counter& counter, ExportResult result = ExportResult::Success)
+{
+   return ExportTask { [&counter, result](ExportProcessorDelegate& delegate) {
+      const auto running = ++counter.running;
+      ++counter.runs;
+      auto most = counter.most.load();
+      while (running > most && !counter.most.compare_exchange_weak(most, running))
+         ;
+      for (int ii = 1; ii <= 10; ++ii)
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+         delegate.OnProgress(ii / 10.0);
+         if (delegate.IsStopped())
+         {
+            --counter.running;
+            return ExportResult::Stopped;
+         }
+      }
+      --counter.running;
+      return result;
+   } };
+}
+} // namespace
+
+TEST_CASE("ExportScheduler runs tasks concurrently up to a limit")
+{
+   const size_t limit = GENERATE(1, 3);
+   ExportScheduler scheduler { limit };
+   Counter counter;
+   std::vector<std::shared_future<ExportResult>> futures;
+   for (int ii = 0; ii < 12; ++ii)
+      futures.push_back(scheduler.Add(MakeTask(counter)));
+
+   TestDelegate delegate;
+   REQUIRE(scheduler.Process(delegate) == ExportResult::Success);
+   REQUIRE(!scheduler.HasPending());
+   REQUIRE(counter.runs == 12);
+   REQUIRE(counter.most <= int(limit));
+   REQUIRE(delegate.progress == Approx(1.0));
+   REQUIRE(!delegate.decreased);
+   for (auto& future : futures)
+      REQUIRE(future.get() == ExportResult::Success);
+}
+
+TEST_CASE("ExportScheduler stops starting tasks after a failure")
+{
+   ExportScheduler scheduler { 1 };
+   Counter counter;
+   scheduler.Add(MakeTask(counter));
+   scheduler.Add(MakeTask(counter, ExportResult::Error));
+   const auto last = scheduler.Add(MakeTask(counter));
+   TestDelegate delegate;
+   REQUIRE(scheduler.Process(delegate) == ExportResult::Error);
+   REQUIRE(counter.runs == 2);
+   REQUIRE(scheduler.HasPending());
+   REQUIRE(last.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::timeout);
+
+   scheduler.DiscardPending();
+   REQUIRE(!scheduler.HasPending());
+   REQUIRE_THROWS_AS(last.get(), std::future_error);
+}
+
+TEST_CASE("ExportScheduler leaves stopped tasks pending for another run")
+{
+   ExportScheduler scheduler { 2 };
+   Counter counter;
+   for (int ii = 0; ii < 6; ++ii)
+      scheduler.Add(MakeTask(counter));
+
+   TestDelegate delegate;
+   delegate.stopped = true;
+   REQUIRE(scheduler.Process(delegate) == ExportResult::Stopped);
+   REQUIRE(counter.runs == 0);
+   REQUIRE(scheduler.HasPending());
+
+   TestDelegate another;
+   REQUIRE(scheduler.Process(another) == ExportResult::Success);
+   REQUIRE(counter.runs == 6);
+   REQUIRE(!scheduler.HasPending());
+}
+
+TEST_CASE("ExportScheduler lets running tasks finish when stopped")
+{
+   ExportScheduler scheduler { 1 };
+   Counter counter;
+   TestDelegate delegate;
+   const auto first = scheduler.Add(ExportTask {
+      [&](ExportProcessorDelegate& taskDelegate) {
+         delegate.stopped = true;
+         // The task does not see the stop, and writes all of its file
+         auto task = MakeTask(counter);
+         auto result = task.get_future();
+         task(taskDelegate);
+         return result.get();
+      } });
+   for (int ii = 0; ii < 2; ++ii)
+      scheduler.Add(MakeTask(counter));
+
+   REQUIRE(scheduler.Process(delegate) == ExportResult::Stopped);
+   REQUIRE(first.get() == ExportResult::Success);
+   REQUIRE(counter.runs == 1);
+   REQUIRE(scheduler.HasPending());
+}
+
+TEST_CASE("ExportScheduler reports a stop after all tasks started")
+{
+   ExportScheduler scheduler { 1 };
+   TestDelegate delegate;
+   scheduler.Add(ExportTask { [&](ExportProcessorDelegate&) {
+      delegate.stopped = true;
+      return ExportResult::Success;
+   } });
+
+   REQUIRE(scheduler.Process(delegate) == ExportResult::Stopped);
+   REQUIRE(!scheduler.HasPending());
+}
+
+TEST_CASE("ExportScheduler passes exceptions to the futures")
+{
+   ExportScheduler scheduler { 2 };
+   const auto future = scheduler.Add(ExportTask {
+      [](ExportProcessorDelegate&) -> ExportResult {
+         throw std::runtime_error { "export" };
+      } });
+   TestDelegate delegate;
+   REQUIRE(scheduler.Process(delegate) == ExportResult::Error);
+   REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+}
@@ -0,0 +1,166 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportPipelineTests.cpp
+
+**********************************************************************/
+#include "ImportPipeline.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr size_t nChannels = 3;
+constexpr auto all = std::numeric_limits<size_t>::max();
+
+//! Interleaved values that identify the frame and the channel
+void Fill(ImportPipeline::Chunk& chunk, size_t first, size_t frames)
+{
+   chunk.nChannels = nChannels;
+   chunk.frames = frames;
+   chunk.format = floatSample;
+   const auto buffer = reinterpret_cast<float*>(
+      chunk.Raw(frames * nChannels * sizeof(float)));
+   for (size_t ii = 0; ii < frames; ++ii)
+      for (size_t jj = 0; jj < nChannels; ++jj)
+         buffer[ii * nChannels + jj] = float((first + ii) * 10 + jj);
+}
+
+//! Reads chunks of varying lengths, totalling `total` frames
+ImportPipeline::Reader MakeReader(size_t total, size_t& read)
+{
+   return [total, &read](ImportPipeline& pipeline) {
+      std::mt19937 engine { 1 };
+      read = 0;
+      while (read < total)
+      {
+         const auto pChunk = pipeline.Acquire();
+         if (!pChunk)
+            return;
+         const auto frames = std::min(
+            total - read,
+            std::uniform_int_distribution<size_t> { 0, 1000 }(engine));
+         Fill(*pChunk, read, frames);
+         pChunk->progress = double(read + frames) / total;
+         pipeline.Submit(*pChunk);
+         read += frames;
+      }
+   };
+}
+
+//! Checks that chunks arrive in order, deinterleaved
+ImportPipeline::Committer MakeCommitter(size_t& committed, size_t stopAfter)
+{
+   return [&committed, stopAfter, chunks = size_t {}](
+             const ImportPipeline::Chunk& chunk) mutable {
+      REQUIRE(chunk.frames > 0);
+      REQUIRE(chunk.nChannels == nChannels);
+      for (size_t jj = 0; jj < nChannels; ++jj)
+      {
+         const auto channel =
+            reinterpret_cast<const float*>(chunk.Channel(jj));
+         for (size_t ii = 0; ii < chunk.frames; ++ii)
+            REQUIRE(channel[ii] == float((committed + ii) * 10 + jj));
+      }
+      committed += chunk.frames;
+      return ++chunks < stopAfter;
+   };
+}
+
+//! Converter that takes unequal times, so that chunks finish out of order
+void SlowDeinterleave(ImportPipeline::Chunk& chunk)
+{
+   std::this_thread::sleep_for(
+      std::chrono::microseconds((chunk.frames * 7919) % 500));
+   ImportPipeline::Deinterleave(chunk);
+}
+} // namespace
+
+TEST_CASE("ImportPipeline commits all chunks in order")
+{
+   ImportPipeline pipeline { SlowDeinterleave };
+   constexpr size_t total = 100000;
+   size_t read = 0, committed = 0;
+   pipeline.Run(MakeReader(total, read), MakeCommitter(committed, all));
+   REQUIRE(read == total);
+   REQUIRE(committed == total);
+
+   // The pipeline may run again
+   committed = 0;
+   pipeline.Run(MakeReader(total / 2, read), MakeCommitter(committed, all));
+   REQUIRE(committed == total / 2);
+}
+
+TEST_CASE("ImportPipeline stops when the committer returns false")
+{
+   ImportPipeline pipeline;
+   size_t read = 0, committed = 0;
+   pipeline.Run(MakeReader(10000000, read), MakeCommitter(committed, 5));
+   REQUIRE(committed > 0);
+   REQUIRE(committed < read);
+   // The reader stopped soon, because only a few chunks may be in use
+   REQUIRE(read < 100000);
+}
+
+TEST_CASE("ImportPipeline rethrows exceptions of the stages")
+{
+   ImportPipeline pipeline { SlowDeinterleave };
+   size_t read = 0, committed = 0;
+
+   SECTION("from the reader")
+   {
+      const auto reader = MakeReader(5000, read);
+      REQUIRE_THROWS_AS(
+         pipeline.Run(
+            [&](ImportPipeline& pipeline) {
+               reader(pipeline);
+               throw std::runtime_error { "reader" };
+            },
+            MakeCommitter(committed, all)),
+         std::runtime_error);
+      // Chunks read before the exception were committed
+      REQUIRE(committed == 5000);
+   }
+
+   SECTION("from the converter")
+   {
+      ImportPipeline throwing { [](ImportPipeline::Chunk& chunk) {
+         if (chunk.progress > 0.5)
+            throw std::runtime_error { "converter" };
+         ImportPipeline::Deinterleave(chunk);
+      } };
+      REQUIRE_THROWS_AS(
+         throwing.Run(MakeReader(50000, read), MakeCommitter(committed, all)),
+         std::runtime_error);
+      REQUIRE(committed > 0);
+      REQUIRE(committed <= 25000);
+   }
+
+   SECTION("from the committer")
+   {
+      const auto committer = MakeCommitter(committed, all);
+      REQUIRE_THROWS_AS(
+         pipeline.Run(
+            MakeReader(50000, read),
+            [&](const ImportPipeline::Chunk& chunk) -> bool {
+               committer(chunk);
+               throw std::runtime_error { "committer" };
+            }),
+         std::runtime_error);
+   }
+
+   // Still usable after an exception
+   committed = 0;
+   pipeline.Run(MakeReader(5000, read), MakeCommitter(committed, all));
+   REQUIRE(committed == 5000);
+}
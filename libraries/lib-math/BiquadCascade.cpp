@@ -0,0 +1,267 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BiquadCascade.cpp
+
+**********************************************************************/
+#include "BiquadCascade.h"
+#include "SampleVectors.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace {
+std::atomic<bool> sVectorized{ true };
+
+//! Operations on one lane of doubles
+struct Scalar {
+   using Type = double;
+   static double Add(double a, double b) { return a + b; }
+   static double Sub(double a, double b) { return a - b; }
+   static double Mul(double a, double b) { return a * b; }
+   static double RoundToFloat(double x) { return static_cast<float>(x); }
+   //! Element index of each of the arrays, one per lane
+   static double Gather(const double *const *arrays, size_t index)
+      { return arrays[0][index]; }
+   static void Scatter(double x, double *const *arrays, size_t index)
+      { arrays[0][index] = x; }
+};
+
+#ifdef SAMPLE_VECTORS
+//! Operations on two lanes of doubles
+struct Vector {
+   using Type = SampleVectors::Vec2d;
+   static Type Add(Type a, Type b) { return SampleVectors::Add(a, b); }
+   static Type Sub(Type a, Type b) { return SampleVectors::Sub(a, b); }
+   static Type Mul(Type a, Type b) { return SampleVectors::Mul(a, b); }
+   static Type RoundToFloat(Type x) { return SampleVectors::RoundToFloat(x); }
+   static Type Gather(const double *const *arrays, size_t index)
+      { return SampleVectors::Make2d(arrays[0][index], arrays[1][index]); }
+   static void Scatter(Type x, double *const *arrays, size_t index)
+   {
+      arrays[0][index] = SampleVectors::Lane0(x);
+      arrays[1][index] = SampleVectors::Lane1(x);
+   }
+};
+
+using namespace SampleVectors;
+#endif
+
+//! One biquad section in each lane of Lanes::Type, with its state held in
+//! registers while it filters a block
+template<typename Lanes, bool transposed> struct Section : Lanes {
+   using V = typename Lanes::Type;
+   using Lanes::Add, Lanes::Sub, Lanes::Mul, Lanes::RoundToFloat,
+      Lanes::Gather, Lanes::Scatter;
+
+   Section(const double *const coefficients[], double *const states[])
+      : b0{ Gather(coefficients, 0) }
+      , b1{ Gather(coefficients, 1) }
+      , b2{ Gather(coefficients, 2) }
+      , a1{ Gather(coefficients, 3) }
+      , a2{ Gather(coefficients, 4) }
+      , z1{ Gather(states, 0) }, z2{ Gather(states, 1) }
+      , z3{ Gather(states, 2) }, z4{ Gather(states, 3) }
+      , states{ states }
+   {}
+   ~Section()
+   {
+      Scatter(z1, states, 0), Scatter(z2, states, 1);
+      Scatter(z3, states, 2), Scatter(z4, states, 3);
+   }
+
+   //! @param x an input already of float precision
+   //! @return the output rounded to float precision
+   V Process(V x)
+   {
+      if constexpr (transposed) {
+         const auto y = Add(Mul(x, b0), z1);
+         z1 = Sub(Add(Mul(x, b1), z2), Mul(y, a1));
+         z2 = Sub(Mul(x, b2), Mul(y, a2));
+         return RoundToFloat(y);
+      }
+      else {
+         // Associate as Biquad::ProcessOne does, for identical results
+         const auto y = Sub(Sub(
+            Add(Add(Mul(x, b0), Mul(z1, b1)), Mul(z2, b2)),
+            Mul(z3, a1)), Mul(z4, a2));
+         z2 = z1, z1 = x, z4 = z3, z3 = y;
+         return RoundToFloat(y);
+      }
+   }
+
+   const V b0, b1, b2, a1, a2;
+   V z1, z2, z3, z4;
+   double *const *const states;
+};
+
+template<bool transposed>
+float ProcessScalar(const double *coefficients, double *state, float x)
+{
+   return Section<Scalar, transposed>{ &coefficients, &state }.Process(x);
+}
+}
+
+BiquadCascade::BiquadCascade(
+   const Biquad *sections, size_t nSections, size_t nChannels, Form form)
+   : mChannels{ nChannels }
+   , mForm{ form }
+   , mStates(nChannels * nSections)
+{
+   mCoefficients.reserve(nSections);
+   for (size_t ii = 0; ii < nSections; ++ii) {
+      auto &section = sections[ii];
+      mCoefficients.push_back({
+         section.fNumerCoeffs[Biquad::B0], section.fNumerCoeffs[Biquad::B1],
+         section.fNumerCoeffs[Biquad::B2], section.fDenomCoeffs[Biquad::A1],
+         section.fDenomCoeffs[Biquad::A2] });
+   }
+}
+
+void BiquadCascade::Reset()
+{
+   std::fill(mStates.begin(), mStates.end(), State{});
+}
+
+void BiquadCascade::Process(
+   const float *const *in, float *const *out, size_t len)
+{
+   size_t channel = 0;
+#ifdef SAMPLE_VECTORS
+   if (sVectorized.load(std::memory_order_relaxed))
+      for (; channel + 1 < mChannels; channel += 2) {
+         if (mForm == Form::DirectI)
+            ProcessChannels<false>(channel, in[channel], in[channel + 1],
+               out[channel], out[channel + 1], len);
+         else
+            ProcessChannels<true>(channel, in[channel], in[channel + 1],
+               out[channel], out[channel + 1], len);
+      }
+#endif
+   for (; channel < mChannels; ++channel)
+      Process(channel, in[channel], out[channel], len);
+}
+
+void BiquadCascade::Process(
+   size_t channel, const float *in, float *out, size_t len)
+{
+   assert(channel < mChannels);
+   if (mForm == Form::DirectI)
+      ProcessChannel<false>(channel, in, out, len);
+   else
+      ProcessChannel<true>(channel, in, out, len);
+}
+
+float BiquadCascade::ProcessOne(size_t channel, float x)
+{
+   assert(channel < mChannels);
+   for (size_t section = 0; section < mCoefficients.size(); ++section) {
+      const auto coefficients = mCoefficients[section].data();
+      const auto state = GetState(channel, section).data();
+      x = (mForm == Form::DirectI)
+         ? ProcessScalar<false>(coefficients, state, x)
+         : ProcessScalar<true>(coefficients, state, x);
+   }
+   return x;
+}
+
+template<bool transposed>
+void BiquadCascade::ProcessChannel(
+   size_t channel, const float *in, float *out, size_t len)
+{
+   const auto nSections = mCoefficients.size();
+   if (nSections == 0) {
+      if (in != out)
+         std::copy(in, in + len, out);
+      return;
+   }
+   size_t section = 0;
+#ifdef SAMPLE_VECTORS
+   if (sVectorized.load(std::memory_order_relaxed))
+      // Filter a pair of sections at once, the second in the pair lagging
+      // behind, so that its input was computed well before and is not in the
+      // chain of dependencies of each step.  (It would be, with no lag,
+      // because x * b0 comes first in the sum.)
+      for (; section + 1 < nSections; section += 2, in = out) {
+         const double *const coefficients[]{
+            mCoefficients[section].data(), mCoefficients[section + 1].data() };
+         double *const states[]{
+            GetState(channel, section).data(),
+            GetState(channel, section + 1).data() };
+         constexpr size_t lag = 16;
+         const auto lead = std::min(lag, len);
+         // Fill the pipeline
+         for (size_t ii = 0; ii < lead; ++ii)
+            out[ii] =
+               ProcessScalar<transposed>(coefficients[0], states[0], in[ii]);
+         {
+            Section<Vector, transposed> pair{ coefficients, states };
+            for (size_t ii = lag; ii < len; ++ii) {
+               // Reading in[ii] comes before writing out[ii], which may be
+               // the same sample; and out[ii - lag] holds the output of the
+               // first section
+               const auto y = pair.Process(Make2d(in[ii], out[ii - lag]));
+               out[ii] = Lane0(y);
+               out[ii - lag] = Lane1(y);
+            }
+         }
+         // Drain it
+         for (size_t ii = len - lead; ii < len; ++ii)
+            out[ii] =
+               ProcessScalar<transposed>(coefficients[1], states[1], out[ii]);
+      }
+#endif
+   for (; section < nSections; ++section, in = out) {
+      const double *const coefficients[]{ mCoefficients[section].data() };
+      double *const states[]{ GetState(channel, section).data() };
+      Section<Scalar, transposed> single{ coefficients, states };
+      for (size_t ii = 0; ii < len; ++ii)
+         out[ii] = single.Process(in[ii]);
+   }
+}
+
+template<bool transposed>
+void BiquadCascade::ProcessChannels(size_t channel,
+   const float *in0, const float *in1, float *out0, float *out1, size_t len)
+{
+#ifdef SAMPLE_VECTORS
+   const auto nSections = mCoefficients.size();
+   if (nSections == 0) {
+      ProcessChannel<transposed>(channel, in0, out0, len);
+      ProcessChannel<transposed>(channel + 1, in1, out1, len);
+      return;
+   }
+   // Section by section over the whole block, rounding to float between
+   // sections as scalar code does
+   for (size_t section = 0; section < nSections;
+        ++section, in0 = out0, in1 = out1) {
+      const auto coefficients = mCoefficients[section].data();
+      const double *const lanes[]{ coefficients, coefficients };
+      double *const states[]{
+         GetState(channel, section).data(),
+         GetState(channel + 1, section).data() };
+      Section<Vector, transposed> pair{ lanes, states };
+      for (size_t ii = 0; ii < len; ++ii) {
+         const auto y = pair.Process(Make2d(in0[ii], in1[ii]));
+         out0[ii] = Lane0(y);
+         out1[ii] = Lane1(y);
+      }
+   }
+#endif
+}
+
+bool BiquadCascade::IsVectorized()
+{
+#ifdef SAMPLE_VECTORS
+   return sVectorized.load(std::memory_order_relaxed);
+#else
+   return false;
+#endif
+}
+
+void BiquadCascade::SetVectorized(bool vectorized)
+{
+   sVectorized.store(vectorized, std::memory_order_relaxed);
+}
@@ -0,0 +1,91 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BiquadCascade.h
+
+**********************************************************************/
+#ifndef __AUDACITY_BIQUAD_CASCADE__
+#define __AUDACITY_BIQUAD_CASCADE__
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Biquad.h"
+
+//! Applies the same biquad sections, in series, to each of several channels,
+//! a block of samples at a time
+/*!
+ The recursion of each section allows no vectorization over time, so
+ vector instructions instead filter two channels at once, in the lanes of
+ vectors; or, for a channel left without a partner, two consecutive
+ sections at once, the second some samples behind the first.
+
+ In the direct form, results are the same as from Biquad::Process() on each
+ section in turn, rounding to float between sections.
+ */
+class MATH_API BiquadCascade final
+{
+public:
+   enum class Form {
+      //! As Biquad::ProcessOne() computes
+      DirectI,
+      //! Fewer operations and less state, but results differ in rounding
+      TransposedDirectII,
+   };
+
+   //! Copy the coefficients of the sections, for each channel, with cleared
+   //! state
+   BiquadCascade(const Biquad *sections, size_t nSections, size_t nChannels,
+      Form form = Form::DirectI);
+
+   size_t GetChannels() const { return mChannels; }
+   size_t GetSections() const { return mCoefficients.size(); }
+
+   //! Clear the state of all channels
+   void Reset();
+
+   //! Filter len samples of each channel
+   /*!
+    @param in may equal out, or not; but blocks must not overlap otherwise
+    */
+   void Process(const float *const *in, float *const *out, size_t len);
+
+   //! Filter len samples of one channel
+   void Process(size_t channel, const float *in, float *out, size_t len);
+
+   //! Filter one sample of one channel
+   float ProcessOne(size_t channel, float x);
+
+   //! Whether Process() uses vector instructions
+   static bool IsVectorized();
+   //! Choose between vector and scalar code, for testing and benchmarks.
+   //! Has no effect if no vector instructions were compiled.
+   static void SetVectorized(bool vectorized);
+
+private:
+   //! b0, b1, b2, a1, a2
+   using Coefficients = std::array<double, 5>;
+   //! x[n-1], x[n-2], y[n-1], y[n-2] in the direct form; the two delays of
+   //! the transposed form and two unused
+   using State = std::array<double, 4>;
+
+   State &GetState(size_t channel, size_t section)
+      { return mStates[channel * mCoefficients.size() + section]; }
+
+   template<bool transposed>
+   void ProcessChannel(size_t channel, const float *in, float *out,
+      size_t len);
+   template<bool transposed>
+   void ProcessChannels(size_t channel, const float *in0, const float *in1,
+      float *out0, float *out1, size_t len);
+
+   const size_t mChannels;
+   const Form mForm;
+   std::vector<Coefficients> mCoefficients;
+   //! For each channel, for each section
+   std::vector<State> mStates;
+};
+
+#endif
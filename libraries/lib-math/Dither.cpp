@@ -48,12 +48,16 @@ and get deterministic behaviour.
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
 //#include <sys/types.h>
 //#include <memory.h>
 //#include <assert.h>
 
 #include <wx/defs.h>
 
+#include "SampleVectors.h"
+
 //////////////////////////////////////////////////////////////////////////
 
 // Constants for the noise shaping buffer
@@ -178,6 +182,159 @@ static inline void DITHER( Ditherer dither, State &state,
     else { wxASSERT(false); }
 }
 
+//////////////////////////////////////////////////////////////////////////
+
+// Vectorized conversions of contiguous samples, four at a time.  They give
+// the same results as the scalar code above, because scaling by powers of
+// two is exact, the default rounding of the vector instructions agrees with
+// lrintf, and clipping before rounding agrees with clipping after it.
+
+static std::atomic<bool> sVectorized{ true };
+
+#ifdef SAMPLE_VECTORS
+
+namespace {
+using namespace SampleVectors;
+
+// Convert integer samples to float
+template<typename srcType>
+void VectorToFloat(const srcType *src, float *dst, size_t len)
+{
+   constexpr auto divisor =
+      sizeof(srcType) == sizeof(short) ? CONVERT_DIV16 : CONVERT_DIV24;
+   const auto scale = Splat(1 / divisor);
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4)
+      Store(dst + ii, Mul(ToFloats(Load(src + ii)), scale));
+   for (; ii < len; ++ii)
+      dst[ii] = src[ii] / divisor;
+}
+
+// Promote 16 bit to 24 bit
+void VectorInt16ToInt24(const short *src, int *dst, size_t len)
+{
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4)
+      Store(dst + ii, ShiftLeft8(Load(src + ii)));
+   for (; ii < len; ++ii)
+      dst[ii] = ((int)src[ii]) << 8;
+}
+
+// The ditherers that do not need the previous outputs
+enum class Noise { none, rectangle, triangle };
+
+// Load samples to dither, as FROM_FLOAT or FROM_INT24 do
+inline Vec4f LoadToDither(const float *src)
+{
+   return Max(Splat(-1.0f), Min(Splat(1.0f), Load(src)));
+}
+
+inline Vec4f LoadToDither(const int *src)
+{
+   return Mul(ToFloats(Load(src)), Splat(1 / CONVERT_DIV24));
+}
+
+// One step of the scalar dither, given noises[1] for this sample and
+// noises[0] for the previous one
+template<Noise noise, typename srcType, typename dstType>
+inline void DitherStep(const srcType *src, dstType *dst, const float *noises)
+{
+   constexpr bool to16 = sizeof(dstType) == sizeof(short);
+   float sample = (to16 ? CONVERT_DIV16 : CONVERT_DIV24) *
+      (std::is_same<srcType, float>::value
+         ? FROM_FLOAT(reinterpret_cast<const float*>(src))
+         : FROM_INT24(reinterpret_cast<const int*>(src)));
+   if (noise == Noise::rectangle)
+      sample = sample - noises[1];
+   else if (noise == Noise::triangle)
+      sample = sample + noises[1] - noises[0];
+   if (to16)
+      IMPLEMENT_STORE<dstType>(dst, sample, dstType(-32768), dstType(32767));
+   else
+      IMPLEMENT_STORE<dstType>(dst, sample, dstType(-8388608), dstType(8388607));
+}
+
+template<Noise noise, typename srcType, typename dstType>
+void VectorDither(State &state, const srcType *src, dstType *dst, size_t len)
+{
+   constexpr bool to16 = sizeof(dstType) == sizeof(short);
+   const auto scale = Splat(to16 ? CONVERT_DIV16 : CONVERT_DIV24);
+   const auto minBound = Splat(to16 ? -32768.0f : -8388608.0f);
+   const auto maxBound = Splat(to16 ? 32767.0f : 8388607.0f);
+
+   // Noise is made in blocks, in the same sequence as by the scalar code;
+   // noises[0] holds the noise for the sample before the block
+   constexpr size_t BlockSize = 256;
+   float noises[1 + BlockSize];
+   noises[0] = state.mTriangleState;
+   while (len > 0) {
+      const auto count = std::min(len, BlockSize);
+      if (noise != Noise::none)
+         for (size_t ii = 1; ii <= count; ++ii)
+            noises[ii] = DITHER_NOISE();
+
+      size_t ii = 0;
+      for (; ii + 4 <= count; ii += 4) {
+         auto sample = LoadToDither(src + ii);
+         if (AnyNaN(sample)) {
+            // Rounding of NaN differs, so let lrintf decide
+            for (auto jj = ii; jj < ii + 4; ++jj)
+               DitherStep<noise>(src + jj, dst + jj, noises + jj);
+            continue;
+         }
+         sample = Mul(sample, scale);
+         if (noise == Noise::rectangle)
+            sample = Sub(sample, Load(noises + 1 + ii));
+         else if (noise == Noise::triangle)
+            sample = Sub(Add(sample, Load(noises + 1 + ii)), Load(noises + ii));
+         Store(dst + ii, RoundToInts(Max(minBound, Min(maxBound, sample))));
+      }
+      for (; ii < count; ++ii)
+         DitherStep<noise>(src + ii, dst + ii, noises + ii);
+
+      noises[0] = noises[count];
+      src += count;
+      dst += count;
+      len -= count;
+   }
+   if (noise == Noise::triangle)
+      state.mTriangleState = noises[0];
+}
+
+// Vectorized counterpart of DITHER
+template<Noise noise>
+void VECTOR_DITHER(State &state,
+   samplePtr dst, sampleFormat dstFormat,
+   constSamplePtr src, sampleFormat srcFormat, size_t len)
+{
+    if (srcFormat == int24Sample && dstFormat == int16Sample)
+        VectorDither<noise>(state,
+            reinterpret_cast<const int*>(src), reinterpret_cast<short*>(dst), len);
+    else if (srcFormat == floatSample && dstFormat == int16Sample)
+        VectorDither<noise>(state,
+            reinterpret_cast<const float*>(src), reinterpret_cast<short*>(dst), len);
+    else if (srcFormat == floatSample && dstFormat == int24Sample)
+        VectorDither<noise>(state,
+            reinterpret_cast<const float*>(src), reinterpret_cast<int*>(dst), len);
+    else { wxASSERT(false); }
+}
+}
+#endif
+
+bool Dither::IsVectorized()
+{
+#ifdef SAMPLE_VECTORS
+   return sVectorized.load(std::memory_order_relaxed);
+#else
+   return false;
+#endif
+}
+
+void Dither::SetVectorized(bool vectorized)
+{
+   sVectorized.store(vectorized, std::memory_order_relaxed);
+}
+
 
 static inline float NoDither(State &, float sample);
 static inline float RectangleDither(State &, float sample);
@@ -236,6 +393,11 @@ void Dither::Apply(enum DitherType ditherType,
     if (len == 0)
         return; // nothing to do
 
+#ifdef SAMPLE_VECTORS
+    const bool vectorize =
+        IsVectorized() && sourceStride == 1 && destStride == 1;
+#endif
+
     if (destFormat == sourceFormat)
     {
         // No need to dither, because source and destination
@@ -281,12 +443,20 @@ void Dither::Apply(enum DitherType ditherType,
         if (sourceFormat == int16Sample)
         {
             auto s = (const short*)source;
+#ifdef SAMPLE_VECTORS
+            if (vectorize)
+                return VectorToFloat(s, d, len);
+#endif
             for (i = 0; i < len; i++, d += destStride, s += sourceStride)
                 *d = FROM_INT16(s);
         } else
         if (sourceFormat == int24Sample)
         {
             auto s = (const int*)source;
+#ifdef SAMPLE_VECTORS
+            if (vectorize)
+                return VectorToFloat(s, d, len);
+#endif
             for (i = 0; i < len; i++, d += destStride, s += sourceStride)
                 *d = FROM_INT24(s);
         } else {
@@ -298,6 +468,10 @@ void Dither::Apply(enum DitherType ditherType,
         // Special case when promoting 16 bit to 24 bit
         auto d = (int*)dest;
         auto s = (const short*)source;
+#ifdef SAMPLE_VECTORS
+        if (vectorize)
+            return VectorInt16ToInt24(s, d, len);
+#endif
         for (i = 0; i < len; i++, d += destStride, s += sourceStride)
             *d = ((int)*s) << 8;
     } else
@@ -306,16 +480,30 @@ void Dither::Apply(enum DitherType ditherType,
         switch (ditherType)
         {
         case DitherType::none:
+#ifdef SAMPLE_VECTORS
+            if (vectorize)
+                return VECTOR_DITHER<Noise::none>(mState, dest, destFormat, source, sourceFormat, len);
+#endif
             DITHER(NoDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::rectangle:
+#ifdef SAMPLE_VECTORS
+            if (vectorize)
+                return VECTOR_DITHER<Noise::rectangle>(mState, dest, destFormat, source, sourceFormat, len);
+#endif
             DITHER(RectangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::triangle:
             Reset(); // reset dither filter for this NEW conversion
+#ifdef SAMPLE_VECTORS
+            if (vectorize)
+                return VECTOR_DITHER<Noise::triangle>(mState, dest, destFormat, source, sourceFormat, len);
+#endif
             DITHER(TriangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::shaped:
+            // The error feedback makes each sample depend on the previous
+            // output, so this is not vectorized
             Reset(); // reset dither filter for this NEW conversion
             DITHER(ShapedDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
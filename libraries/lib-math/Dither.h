@@ -44,6 +44,13 @@ public:
                unsigned int len,
                unsigned int sourceStride = 1,
                unsigned int destStride = 1);
+
+    /// Whether Apply() uses vector instructions for contiguous samples,
+    /// which give the same results as the scalar code
+    static bool IsVectorized();
+    /// Choose between vector and scalar code, for testing and benchmarks.
+    /// Has no effect if no vector instructions were compiled.
+    static void SetVectorized(bool vectorized);
 };
 
 #endif /* __AUDACITY_DITHER_H__ */
@@ -9,26 +9,67 @@ Max Maisel
 ***********************************************************************/
 
 #include "EBUR128.h"
+
+#include <algorithm>
+#include <cassert>
 #include <cstring>
 
+namespace {
+//! Polyphase interpolation filter for four times oversampling, from
+//! ITU-R BS.1770-4, Annex 2
+constexpr size_t TruePeakPhases = 4;
+constexpr float TruePeakCoefficients[TruePeakPhases][12] = {
+   {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,
+      0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+      0.9721679687500f, -0.1022949218750f,  0.0476074218750f,
+     -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+   { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,
+      0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+      0.7797851562500f, -0.2003173828125f,  0.1015625000000f,
+     -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+   { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,
+      0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+      0.4650878906250f, -0.1665039062500f,  0.0891113281250f,
+     -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+   { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,
+      0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+      0.1373291015625f, -0.0594482421875f,  0.0332031250000f,
+     -0.0196533203125f,  0.0109863281250f,  0.0017089843750f },
+};
+
+//! Greatest magnitude of the interpolated values between the last two of
+//! twelve samples, oldest first
+inline float OversampledPeak(const float *window)
+{
+   float peak = 0;
+   for (const auto &coefficients : TruePeakCoefficients) {
+      float y = 0;
+      for (size_t ii = 0; ii < 12; ++ii)
+         y += coefficients[ii] * window[11 - ii];
+      peak = std::max(peak, std::abs(y));
+   }
+   return peak;
+}
+}
+
 EBUR128::EBUR128(double rate, size_t channels)
    : mChannelCount{ channels }
    , mRate{ rate }
    , mBlockSize( ceil(0.4 * mRate) ) // 400 ms blocks
    , mBlockOverlap( ceil(0.1 * mRate) ) // 100 ms overlap
+   , mWeightingFilter{ CalcWeightingFilter(mRate).get(), 2, mChannelCount }
 {
    mLoudnessHist.reinit(HIST_BIN_COUNT, false);
    mBlockRingBuffer.reinit(mBlockSize);
-   mWeightingFilter.reinit(mChannelCount, false);
-   for(size_t channel = 0; channel < mChannelCount; ++channel)
-      mWeightingFilter[channel] = CalcWeightingFilter(mRate);
 
    memset(mLoudnessHist.get(), 0, HIST_BIN_COUNT*sizeof(long int));
+
+   // No segment of ProcessBlock() crosses the end of a hop
+   mWeighted.reinit(mChannelCount * mBlockOverlap);
+   mWeightedChannels.reinit(mChannelCount);
+   mInputChannels.reinit(mChannelCount);
    for(size_t channel = 0; channel < mChannelCount; ++channel)
-   {
-      mWeightingFilter[channel][0].Reset();
-      mWeightingFilter[channel][1].Reset();
-   }
+      mWeightedChannels[channel] = &mWeighted[channel * mBlockOverlap];
 }
 
 // fs: sample rate
@@ -82,9 +123,7 @@ ArrayOf<Biquad> EBUR128::CalcWeightingFilter(double fs)
 
 void EBUR128::ProcessSampleFromChannel(float x_in, size_t channel) const
 {
-   double value;
-   value = mWeightingFilter[channel][0].ProcessOne(x_in);
-   value = mWeightingFilter[channel][1].ProcessOne(value);
+   double value = mWeightingFilter.ProcessOne(channel, x_in);
    if(channel == 0)
       mBlockRingBuffer[mBlockRingPos] = value * value;
    else
@@ -93,10 +132,14 @@ void EBUR128::ProcessSampleFromChannel(float x_in, size_t channel) const
       // As a result, stereo tracks appear about 3 LUFS louder, as specified.
       mBlockRingBuffer[mBlockRingPos] += value * value;
    }
+   if (mTruePeakEnabled)
+      AddToTruePeak(&x_in, 1, channel);
 }
 
 void EBUR128::NextSample()
 {
+   mHopSum += mBlockRingBuffer[mBlockRingPos];
+   ++mHopLength;
    ++mBlockRingPos;
    ++mBlockRingSize;
 
@@ -105,6 +148,7 @@ void EBUR128::NextSample()
       // A new full block of samples was submitted.
       if(mBlockRingSize >= mBlockSize)
          AddBlockToHistogram(mBlockSize);
+      EndHop();
    }
    // Close the ring.
    if(mBlockRingPos == mBlockSize)
@@ -112,6 +156,124 @@ void EBUR128::NextSample()
    ++mSampleCount;
 }
 
+void EBUR128::ProcessBlock(
+   const float *const *channels, size_t nChannels, size_t len)
+{
+   assert(nChannels == mChannelCount);
+   size_t offset = 0;
+   while (offset < len) {
+      // Go as far as NextSample() would before it does anything but count:
+      // the end of a hop, or of the ring
+      const auto count = std::min({ len - offset,
+         mBlockOverlap - mBlockRingPos % mBlockOverlap,
+         mBlockSize - mBlockRingPos });
+      WeightBlock(channels, offset, count);
+      if (mTruePeakEnabled)
+         for (size_t channel = 0; channel < mChannelCount; ++channel)
+            AddToTruePeak(channels[channel] + offset, count, channel);
+      for (size_t ii = 0; ii < count; ++ii)
+         mHopSum += mBlockRingBuffer[mBlockRingPos + ii];
+      mHopLength += count;
+      mBlockRingPos += count;
+      mBlockRingSize += count;
+      mSampleCount += count;
+      offset += count;
+
+      if (mBlockRingPos % mBlockOverlap == 0) {
+         if (mBlockRingSize >= mBlockSize)
+            AddBlockToHistogram(mBlockSize);
+         EndHop();
+      }
+      if (mBlockRingPos == mBlockSize)
+         mBlockRingPos = 0;
+   }
+}
+
+void EBUR128::WeightBlock(
+   const float *const *channels, size_t offset, size_t len) const
+{
+   for (size_t channel = 0; channel < mChannelCount; ++channel)
+      mInputChannels[channel] = channels[channel] + offset;
+   mWeightingFilter.Process(
+      mInputChannels.get(), mWeightedChannels.get(), len);
+
+   // Sums of squares accumulate in the order of the channels, as in
+   // ProcessSampleFromChannel()
+   const auto power = &mBlockRingBuffer[mBlockRingPos];
+   for (size_t channel = 0; channel < mChannelCount; ++channel) {
+      const auto weighted = mWeightedChannels[channel];
+      for (size_t ii = 0; ii < len; ++ii) {
+         const double value = weighted[ii];
+         if (channel == 0)
+            power[ii] = value * value;
+         else
+            power[ii] += value * value;
+      }
+   }
+}
+
+void EBUR128::EnableTruePeak()
+{
+   assert(mSampleCount == 0);
+   mTruePeakEnabled = true;
+   mTruePeakHistory.reinit(mChannelCount * TRUE_PEAK_TAPS, true);
+}
+
+void EBUR128::AddToTruePeak(
+   const float *samples, size_t len, size_t channel) const
+{
+   // Slide the window of the last samples along the new ones
+   const auto history = &mTruePeakHistory[channel * TRUE_PEAK_TAPS];
+   float window[2 * TRUE_PEAK_TAPS];
+   std::copy(history, history + TRUE_PEAK_TAPS, window);
+   float peak = 0;
+   while (len > 0) {
+      const auto count = std::min(len, TRUE_PEAK_TAPS);
+      std::copy(samples, samples + count, window + TRUE_PEAK_TAPS);
+      for (size_t ii = 1; ii <= count; ++ii)
+         peak = std::max(peak, OversampledPeak(window + ii));
+      std::copy(window + count, window + count + TRUE_PEAK_TAPS, window);
+      samples += count;
+      len -= count;
+   }
+   std::copy(window, window + TRUE_PEAK_TAPS, history);
+   mTruePeak = std::max<double>(mTruePeak, peak);
+}
+
+void EBUR128::EndHop()
+{
+   mHopSums[mHopPos] = mHopSum;
+   mHopLengths[mHopPos] = mHopLength;
+   mHopPos = (mHopPos + 1) % HOP_COUNT;
+   mHopSum = 0;
+   mHopLength = 0;
+}
+
+double EBUR128::RecentLoudness(size_t nHops) const
+{
+   double sum = 0;
+   size_t length = 0;
+   for (size_t ii = 1; ii <= nHops; ++ii) {
+      const auto pos = (mHopPos + HOP_COUNT - ii) % HOP_COUNT;
+      sum += mHopSums[pos];
+      length += mHopLengths[pos];
+   }
+   if (length == 0)
+      return 0;
+   // As in IntegrativeLoudness(), 10^(-0.691/10) times the mean square
+   return 0.8529037031 * sum / length;
+}
+
+double EBUR128::MomentaryLoudness() const
+{
+   return RecentLoudness(4);
+}
+
+double EBUR128::ShortTermLoudness() const
+{
+   return RecentLoudness(HOP_COUNT);
+}
+
 double EBUR128::IntegrativeLoudness()
 {
    // EBU R128: z_i = mean square without root
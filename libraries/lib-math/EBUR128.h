@@ -11,7 +11,7 @@ Max Maisel
 #ifndef __EBUR128_H__
 #define __EBUR128_H__
 
-#include "Biquad.h"
+#include "BiquadCascade.h"
 #include <memory>
 #include "SampleFormat.h"
 
@@ -29,13 +29,45 @@ public:
    static ArrayOf<Biquad> CalcWeightingFilter(double fs);
    void ProcessSampleFromChannel(float x_in, size_t channel) const;
    void NextSample();
+
+   //! Same as ProcessSampleFromChannel() for each channel, then NextSample(),
+   //! for each of len samples, with the same results, but much faster
+   /*!
+    @param channels pointers to len samples of each channel
+    @pre `nChannels` equals the count given to the constructor
+    */
+   void ProcessBlock(
+      const float *const *channels, size_t nChannels, size_t len);
+
    double IntegrativeLoudness();
+   //! Loudness of the last 400 ms, in the units of IntegrativeLoudness()
+   /*! Updated every 100 ms; 0 until then */
+   double MomentaryLoudness() const;
+   //! Loudness of the last 3 s, in the units of IntegrativeLoudness()
+   /*! Updated every 100 ms; 0 until then */
+   double ShortTermLoudness() const;
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
 
+   //! Start measuring the true peak, as ITU-R BS.1770 specifies, at some
+   //! cost in speed
+   /*! @pre No samples were processed yet */
+   void EnableTruePeak();
+   //! Greatest magnitude of the signal of any channel, oversampled four
+   //! times, as a linear value; 0 if not enabled
+   double TruePeak() const { return mTruePeak; }
+
 private:
    void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const;
    void AddBlockToHistogram(size_t validLen);
+   //! Weight len samples of each channel and store the sums of their squares
+   //! in the ring buffer, which must not wrap
+   void WeightBlock(
+      const float *const *channels, size_t offset, size_t len) const;
+   void AddToTruePeak(const float *samples, size_t len, size_t channel) const;
+   //! Called at the end of each hop of mBlockOverlap samples
+   void EndHop();
+   double RecentLoudness(size_t nHops) const;
 
    static constexpr size_t HIST_BIN_COUNT = 65536;
    /// EBU R128 absolute threshold
@@ -50,11 +82,27 @@ private:
    const size_t mBlockSize;
    const size_t mBlockOverlap;
 
-   /// This is be an array of arrays of the type
-   /// mWeightingFilter[CHANNEL][FILTER] with
-   /// CHANNEL = LEFT/RIGHT (0/1) and
-   /// FILTER  = HSF/HPF    (0/1)
-   ArrayOf<ArrayOf<Biquad>> mWeightingFilter;
+   /// The HSF and HPF sections of the weighting filter, for each channel
+   mutable BiquadCascade mWeightingFilter;
+   /// Weighted samples of each channel, for WeightBlock()
+   mutable Floats mWeighted;
+   mutable ArrayOf<float *> mWeightedChannels;
+   mutable ArrayOf<const float *> mInputChannels;
+
+   /// Sums of the squares and counts of samples of the hops that end at
+   /// each mBlockOverlap, for momentary and short-term loudness
+   static constexpr size_t HOP_COUNT = 30;
+   double mHopSums[HOP_COUNT]{};
+   size_t mHopLengths[HOP_COUNT]{};
+   size_t mHopPos{ 0 };
+   double mHopSum{ 0 };
+   size_t mHopLength{ 0 };
+
+   /// For each channel, the last TRUE_PEAK_TAPS samples, oldest first
+   static constexpr size_t TRUE_PEAK_TAPS = 12;
+   bool mTruePeakEnabled{ false };
+   Floats mTruePeakHistory;
+   mutable double mTruePeak{ 0 };
 };
 
 #endif
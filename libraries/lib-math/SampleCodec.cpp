@@ -0,0 +1,346 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleCodec.cpp
+
+**********************************************************************/
+#include "SampleCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/*
+ The layout, all little endian:
+
+   "ASBC", version, representation, exponent, 0, count (4 bytes)
+   then for each frame of 256 samples (the last may be shorter):
+      order of the predictor (1 byte)
+      then for each group of 32 samples (the last padded with zeros):
+         width (1 byte), then 32 residuals of that many bits, least
+         significant first
+   then 8 zero bytes, so that decoding may load 8 bytes at any group
+
+ Residuals are "zigzag" encoded, 0, -1, 1, -2, ... as 0, 1, 2, 3, ...
+ */
+
+namespace {
+constexpr char Magic[]{ 'A', 'S', 'B', 'C' };
+constexpr unsigned char Version = 1;
+using SampleCodec::HeaderSize;
+constexpr size_t FrameSize = 256;
+constexpr size_t GroupSize = 32;
+constexpr size_t Padding = 8;
+constexpr int MaxOrder = 3;
+//! Bound on magnitudes of values, so that residuals take at most 32 bits
+constexpr int32_t Limit = 1 << 27;
+//! Float samples that are exact multiples of 2^-23 are encoded
+constexpr int FloatExponent = 23;
+
+enum Representation : unsigned char {
+   Integers,
+   //! Integers to be multiplied by 2^-exponent
+   ScaledFloats,
+};
+
+//! Prediction of the next value from the previous three, newest first
+inline int64_t Predict(int order, int64_t h1, int64_t h2, int64_t h3)
+{
+   switch (order) {
+   case 0: default:
+      return 0;
+   case 1:
+      return h1;
+   case 2:
+      return 2 * h1 - h2;
+   case 3:
+      return 3 * h1 - 3 * h2 + h3;
+   }
+}
+
+inline uint32_t ZigZag(int64_t residual)
+{
+   return static_cast<uint32_t>(
+      residual < 0 ? -2 * residual - 1 : 2 * residual);
+}
+
+inline int64_t UnZigZag(uint32_t value)
+{
+   return (value & 1) ? -static_cast<int64_t>(value >> 1) - 1 : value >> 1;
+}
+
+inline unsigned char Width(uint32_t bits)
+{
+   unsigned char result = 0;
+   while (bits) {
+      ++result;
+      bits >>= 1;
+   }
+   return result;
+}
+
+//! Convert samples to integers within Limit, or return false
+bool ToIntegers(constSamplePtr src, sampleFormat format, size_t count,
+   std::vector<int32_t> &values, unsigned char &representation,
+   unsigned char &exponent)
+{
+   values.resize(count);
+   representation = Integers;
+   exponent = 0;
+   switch (format) {
+   case int16Sample: {
+      const auto shorts = reinterpret_cast<const short *>(src);
+      std::copy(shorts, shorts + count, values.begin());
+      return true;
+   }
+   case int24Sample: {
+      const auto ints = reinterpret_cast<const int *>(src);
+      for (size_t ii = 0; ii < count; ++ii) {
+         if (ints[ii] <= -Limit || ints[ii] >= Limit)
+            return false;
+         values[ii] = ints[ii];
+      }
+      return true;
+   }
+   case floatSample: {
+      const auto floats = reinterpret_cast<const float *>(src);
+      uint32_t allBits = 0;
+      for (size_t ii = 0; ii < count; ++ii) {
+         const auto f = floats[ii];
+         // Negative zero would come back positive
+         if (f == 0 && std::signbit(f))
+            return false;
+         // Also excludes infinities and NaN
+         const auto scaled = std::ldexp(static_cast<double>(f), FloatExponent);
+         if (!(std::abs(scaled) < Limit) || scaled != std::trunc(scaled))
+            return false;
+         values[ii] = static_cast<int32_t>(scaled);
+         allBits |= static_cast<uint32_t>(std::abs(values[ii]));
+      }
+      // Drop the low bits that are zero in all samples; for instance, eight
+      // of them for samples from 16 bit files
+      int shift = 0;
+      while (shift < FloatExponent && !(allBits & (1u << shift)))
+         ++shift;
+      if (shift > 0)
+         for (auto &value : values)
+            value /= (1 << shift);
+      representation = ScaledFloats;
+      exponent = static_cast<unsigned char>(FloatExponent - shift);
+      return true;
+   }
+   default:
+      return false;
+   }
+}
+
+void EncodeFrame(const int32_t *values, size_t size,
+   int64_t &h1, int64_t &h2, int64_t &h3, std::vector<char> &out)
+{
+   // Choose the predictor with the least sum of residuals
+   int order = 0;
+   uint64_t least = UINT64_MAX;
+   for (int oo = 0; oo <= MaxOrder; ++oo) {
+      uint64_t sum = 0;
+      auto p1 = h1, p2 = h2, p3 = h3;
+      for (size_t ii = 0; ii < size; ++ii) {
+         const int64_t x = values[ii];
+         sum += ZigZag(x - Predict(oo, p1, p2, p3));
+         p3 = p2, p2 = p1, p1 = x;
+      }
+      if (sum < least)
+         least = sum, order = oo;
+   }
+   out.push_back(static_cast<char>(order));
+
+   uint32_t residuals[FrameSize]{};
+   for (size_t ii = 0; ii < size; ++ii) {
+      const int64_t x = values[ii];
+      residuals[ii] = ZigZag(x - Predict(order, h1, h2, h3));
+      h3 = h2, h2 = h1, h1 = x;
+   }
+
+   for (size_t group = 0; group < size; group += GroupSize) {
+      uint32_t allBits = 0;
+      for (size_t ii = 0; ii < GroupSize; ++ii)
+         allBits |= residuals[group + ii];
+      const auto width = Width(allBits);
+      out.push_back(static_cast<char>(width));
+      // Each group fills whole bytes
+      uint64_t accumulator = 0;
+      unsigned bits = 0;
+      for (size_t ii = 0; ii < GroupSize; ++ii) {
+         accumulator |= static_cast<uint64_t>(residuals[group + ii]) << bits;
+         bits += width;
+         for (; bits >= 8; bits -= 8, accumulator >>= 8)
+            out.push_back(static_cast<char>(accumulator & 0xff));
+      }
+   }
+}
+
+template<typename Store>
+bool DecodeFrames(const unsigned char *p, const unsigned char *end,
+   size_t count, const Store &store)
+{
+   int64_t h1 = 0, h2 = 0, h3 = 0;
+   uint32_t residuals[FrameSize];
+   int32_t values[FrameSize];
+   for (size_t start = 0; start < count; start += FrameSize) {
+      const auto size = std::min(FrameSize, count - start);
+      if (p >= end)
+         return false;
+      const int order = *p++;
+      if (order > MaxOrder)
+         return false;
+
+      for (size_t group = 0; group < size; group += GroupSize) {
+         if (p >= end)
+            return false;
+         const unsigned width = *p++;
+         if (width > 32 ||
+             static_cast<size_t>(end - p) < width * GroupSize / 8 + Padding)
+            return false;
+         const auto mask = (uint64_t{ 1 } << width) - 1;
+         const auto residual = residuals + group;
+         for (size_t ii = 0, bit = 0; ii < GroupSize; ++ii, bit += width) {
+            // Sample blocks are little endian, like the machine
+            uint64_t word;
+            memcpy(&word, p + bit / 8, sizeof(word));
+            residual[ii] = static_cast<uint32_t>((word >> (bit % 8)) & mask);
+         }
+         p += width * GroupSize / 8;
+      }
+
+      // Separate loops for each order, so that the compiler can unroll them
+      const auto reconstruct = [&](auto predict) {
+         for (size_t ii = 0; ii < size; ++ii) {
+            const auto x = UnZigZag(residuals[ii]) + predict(h1, h2, h3);
+            if (x <= -Limit || x >= Limit)
+               return false;
+            values[ii] = static_cast<int32_t>(x);
+            h3 = h2, h2 = h1, h1 = x;
+         }
+         return true;
+      };
+      bool good = false;
+      switch (order) {
+      case 0:
+         good = reconstruct([](int64_t, int64_t, int64_t){ return 0; });
+         break;
+      case 1:
+         good = reconstruct([](int64_t h1, int64_t, int64_t){ return h1; });
+         break;
+      case 2:
+         good = reconstruct([](int64_t h1, int64_t h2, int64_t){
+            return 2 * h1 - h2; });
+         break;
+      case 3:
+         good = reconstruct([](int64_t h1, int64_t h2, int64_t h3){
+            return 3 * h1 - 3 * h2 + h3; });
+         break;
+      }
+      if (!good)
+         return false;
+      store(start, values, size);
+   }
+   return static_cast<size_t>(end - p) == Padding;
+}
+}
+
+std::vector<char> SampleCodec::Encode(
+   constSamplePtr src, sampleFormat format, size_t count)
+{
+   std::vector<char> result;
+   if (count == 0 || count > UINT32_MAX)
+      return result;
+
+   std::vector<int32_t> values;
+   unsigned char representation, exponent;
+   if (!ToIntegers(src, format, count, values, representation, exponent))
+      return result;
+
+   const auto rawBytes = count * SAMPLE_SIZE(format);
+   const auto wanted = rawBytes - rawBytes / 8;
+   result.reserve(wanted + FrameSize);
+   result.insert(result.end(), std::begin(Magic), std::end(Magic));
+   result.push_back(static_cast<char>(Version));
+   result.push_back(static_cast<char>(representation));
+   result.push_back(static_cast<char>(exponent));
+   result.push_back(0);
+   for (int ii = 0; ii < 4; ++ii)
+      result.push_back(static_cast<char>((count >> (8 * ii)) & 0xff));
+
+   int64_t h1 = 0, h2 = 0, h3 = 0;
+   for (size_t start = 0; start < count; start += FrameSize) {
+      EncodeFrame(values.data() + start, std::min(FrameSize, count - start),
+         h1, h2, h3, result);
+      // Give up early on incompressible samples
+      if (result.size() > wanted)
+         return {};
+   }
+   result.insert(result.end(), Padding, 0);
+   if (result.size() > wanted)
+      return {};
+   return result;
+}
+
+std::optional<size_t> SampleCodec::DecodedCount(const void *data, size_t size)
+{
+   const auto bytes = static_cast<const unsigned char *>(data);
+   if (size < HeaderSize ||
+       memcmp(bytes, Magic, sizeof(Magic)) != 0 || bytes[4] != Version)
+      return {};
+   size_t count = 0;
+   for (int ii = 0; ii < 4; ++ii)
+      count |= static_cast<size_t>(bytes[8 + ii]) << (8 * ii);
+   return count;
+}
+
+bool SampleCodec::Decode(const void *data, size_t size,
+   samplePtr dest, sampleFormat format, size_t count)
+{
+   if (DecodedCount(data, size) != count)
+      return false;
+   const auto bytes = static_cast<const unsigned char *>(data);
+   const auto representation = bytes[5];
+   const auto exponent = bytes[6];
+   const auto p = bytes + HeaderSize, end = bytes + size;
+
+   switch (format) {
+   case int16Sample: {
+      if (representation != Integers)
+         return false;
+      const auto shorts = reinterpret_cast<short *>(dest);
+      return DecodeFrames(p, end, count,
+         [&](size_t start, const int32_t *values, size_t len){
+            for (size_t ii = 0; ii < len; ++ii)
+               shorts[start + ii] = static_cast<short>(values[ii]);
+         });
+   }
+   case int24Sample: {
+      if (representation != Integers)
+         return false;
+      const auto ints = reinterpret_cast<int *>(dest);
+      return DecodeFrames(p, end, count,
+         [&](size_t start, const int32_t *values, size_t len){
+            std::copy(values, values + len, ints + start);
+         });
+   }
+   case floatSample: {
+      if (representation != ScaledFloats || exponent > FloatExponent)
+         return false;
+      // A power of two, so that the products are exact
+      const auto scale = std::ldexp(1.0f, -exponent);
+      const auto floats = reinterpret_cast<float *>(dest);
+      return DecodeFrames(p, end, count,
+         [&](size_t start, const int32_t *values, size_t len){
+            for (size_t ii = 0; ii < len; ++ii)
+               floats[start + ii] = static_cast<float>(values[ii]) * scale;
+         });
+   }
+   default:
+      return false;
+   }
+}
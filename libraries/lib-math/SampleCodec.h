@@ -0,0 +1,56 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleCodec.h
+  @brief Lossless compression of the samples of a block
+
+**********************************************************************/
+#ifndef __AUDACITY_SAMPLE_CODEC__
+#define __AUDACITY_SAMPLE_CODEC__
+
+#include <optional>
+#include <vector>
+
+#include "SampleFormat.h"
+
+//! Lossless compression of the samples of a block, fast enough to decode
+//! at every read
+/*!
+ Integer samples, and float samples that are exact multiples of 2^-23 (such
+ as those imported from 16 or 24 bit files), are predicted from the previous
+ ones with the best of four fixed polynomials for each 256 samples, and the
+ residuals are packed in groups of 32 with the least width of bits that
+ holds them all.
+
+ Other float samples, such as the results of effects, do not compress, and
+ Encode() declines them.
+ */
+namespace SampleCodec
+{
+   //! Bytes at the start of the data that DecodedCount() examines
+   constexpr size_t HeaderSize = 12;
+
+   //! Compress contiguous samples
+   /*!
+    @return empty if the samples can't be encoded, or would not save at least
+    an eighth of the space
+    */
+   MATH_API std::vector<char>
+   Encode(constSamplePtr src, sampleFormat format, size_t count);
+
+   //! The number of samples that Encode() compressed into the data
+   /*! @return nullopt if the data do not begin as Encode() output does */
+   MATH_API std::optional<size_t> DecodedCount(const void *data, size_t size);
+
+   //! Restore exactly the samples given to Encode()
+   /*!
+    @param format must be the format given to Encode()
+    @param count must be the count given to Encode()
+    @return false if the data are malformed, leaving dest unspecified
+    */
+   MATH_API bool Decode(const void *data, size_t size,
+      samplePtr dest, sampleFormat format, size_t count);
+}
+
+#endif
@@ -0,0 +1,153 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleSummary.cpp
+
+**********************************************************************/
+#include "SampleSummary.h"
+#include "SampleVectors.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+std::atomic<bool> sVectorized{ true };
+
+// The same conversions as in Dither::Apply
+inline float ToFloat(float x) { return x; }
+inline float ToFloat(short x) { return x / 32768.0f; }
+inline float ToFloat(int x) { return x / 8388608.0f; }
+
+template<typename srcType>
+void ScalarAccumulate(SampleSummary &summary, const srcType *src, size_t len)
+{
+   auto min = summary.min, max = summary.max, sumsq = summary.sumsq;
+   for (size_t ii = 0; ii < len; ++ii)
+   {
+      const auto f = ToFloat(src[ii]);
+      if (f < min)
+         min = f;
+      if (f > max)
+         max = f;
+      sumsq += f * f;
+   }
+   summary = { min, max, sumsq };
+}
+
+#ifdef SAMPLE_VECTORS
+using namespace SampleVectors;
+
+// Scaling by powers of two is exact
+inline Vec4f LoadFloats(const float *p) { return Load(p); }
+inline Vec4f LoadFloats(const short *p)
+   { return Mul(ToFloats(Load(p)), Splat(1 / 32768.0f)); }
+inline Vec4f LoadFloats(const int *p)
+   { return Mul(ToFloats(Load(p)), Splat(1 / 8388608.0f)); }
+
+//! Reduce the lanes as the scalar loop would have, or return false when
+//! they hold zeros of differing signs, and only the scalar loop knows
+//! which came first
+template<typename Compare>
+bool ReduceLanes(Vec4f x, Compare compare, float &result)
+{
+   float lanes[4];
+   Store(lanes, x);
+   result = lanes[0];
+   for (size_t ii = 1; ii < 4; ++ii)
+      if (compare(lanes[ii], result))
+         result = lanes[ii];
+   if (result == 0)
+      for (auto lane : lanes)
+         if (lane == 0 && std::signbit(lane) != std::signbit(result))
+            return false;
+   return true;
+}
+
+//! Min and max are computed in four lanes with the same comparisons as the
+//! scalar code, which ignore NaNs; the sum of squares is still accumulated
+//! sequentially, so that rounding agrees with summaries stored before
+template<typename srcType>
+void VectorAccumulate(SampleSummary &summary, const srcType *src, size_t len)
+{
+   constexpr size_t chunk = 64;
+   float buffer[chunk];
+   auto mins = Splat(summary.min), maxs = Splat(summary.max);
+   auto sumsq = summary.sumsq;
+   const auto whole = len - len % 4;
+   for (size_t ii = 0; ii < whole;)
+   {
+      const auto count = std::min(chunk, whole - ii);
+      for (size_t jj = 0; jj < count; jj += 4)
+      {
+         const auto x = LoadFloats(src + ii + jj);
+         mins = SelectLess(x, mins);
+         maxs = SelectGreater(x, maxs);
+         Store(buffer + jj, x);
+      }
+      for (size_t jj = 0; jj < count; ++jj)
+         sumsq += buffer[jj] * buffer[jj];
+      ii += count;
+   }
+
+   float min, max;
+   const bool minOk =
+      ReduceLanes(mins, [](float a, float b){ return a < b; }, min);
+   const bool maxOk =
+      ReduceLanes(maxs, [](float a, float b){ return a > b; }, max);
+   if (!(minOk && maxOk))
+   {
+      // Rare:  revisit to find which zero came first
+      SampleSummary scalar{ summary.min, summary.max, 0 };
+      ScalarAccumulate(scalar, src, whole);
+      if (!minOk)
+         min = scalar.min;
+      if (!maxOk)
+         max = scalar.max;
+   }
+
+   summary = { min, max, sumsq };
+   ScalarAccumulate(summary, src + whole, len - whole);
+}
+#endif
+
+template<typename srcType>
+void Accumulate(SampleSummary &summary, const srcType *src, size_t len)
+{
+#ifdef SAMPLE_VECTORS
+   if (SampleSummary::IsVectorized())
+      return VectorAccumulate(summary, src, len);
+#endif
+   ScalarAccumulate(summary, src, len);
+}
+}
+
+void SampleSummary::Accumulate(
+   constSamplePtr src, sampleFormat format, size_t len)
+{
+   switch (format) {
+   case int16Sample:
+      return ::Accumulate(*this, reinterpret_cast<const short*>(src), len);
+   case int24Sample:
+      return ::Accumulate(*this, reinterpret_cast<const int*>(src), len);
+   case floatSample:
+      return ::Accumulate(*this, reinterpret_cast<const float*>(src), len);
+   default:
+      break;
+   }
+}
+
+bool SampleSummary::IsVectorized()
+{
+#ifdef SAMPLE_VECTORS
+   return sVectorized.load(std::memory_order_relaxed);
+#else
+   return false;
+#endif
+}
+
+void SampleSummary::SetVectorized(bool vectorized)
+{
+   sVectorized.store(vectorized, std::memory_order_relaxed);
+}
@@ -0,0 +1,36 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleSummary.h
+
+**********************************************************************/
+#ifndef __AUDACITY_SAMPLE_SUMMARY__
+#define __AUDACITY_SAMPLE_SUMMARY__
+
+#include "SampleFormat.h"
+
+//! Running minimum, maximum and sum of squares of samples, as stored in the
+//! summaries of sample blocks
+struct MATH_API SampleSummary
+{
+   float min;
+   float max;
+   float sumsq;
+
+   //! Convert contiguous samples to float and update the summary with them
+   /*!
+    Gives the same results as visiting the converted samples in order with
+    `if (x < min) min = x; if (x > max) max = x; sumsq += x * x;`
+    so NaN samples are ignored by min and max
+    */
+   void Accumulate(constSamplePtr src, sampleFormat format, size_t len);
+
+   //! Whether Accumulate() uses vector instructions
+   static bool IsVectorized();
+   //! Choose between vector and scalar code, for testing and benchmarks.
+   //! Has no effect if no vector instructions were compiled.
+   static void SetVectorized(bool vectorized);
+};
+
+#endif
@@ -0,0 +1,132 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleVectors.h
+
+  Split from Dither.cpp
+
+**********************************************************************/
+#ifndef __AUDACITY_SAMPLE_VECTORS__
+#define __AUDACITY_SAMPLE_VECTORS__
+
+//! Thin wrappers of SSE2 or NEON intrinsics, operating on four samples, or
+//! on two doubles
+/*!
+ Defines SAMPLE_VECTORS when either instruction set is available at compile
+ time.  Both are baseline for their 64 bit architectures, so no run-time
+ dispatch is needed.  Only for inclusion in translation units of lib-math.
+ */
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SAMPLE_VECTORS_SSE2
+#define SAMPLE_VECTORS
+#elif defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SAMPLE_VECTORS_NEON
+#define SAMPLE_VECTORS
+#endif
+
+#ifdef SAMPLE_VECTORS
+namespace SampleVectors {
+#if defined(SAMPLE_VECTORS_SSE2)
+using Vec4f = __m128;
+using Vec4i = __m128i;
+
+inline Vec4f Splat(float x) { return _mm_set1_ps(x); }
+inline Vec4f Add(Vec4f a, Vec4f b) { return _mm_add_ps(a, b); }
+inline Vec4f Sub(Vec4f a, Vec4f b) { return _mm_sub_ps(a, b); }
+inline Vec4f Mul(Vec4f a, Vec4f b) { return _mm_mul_ps(a, b); }
+inline Vec4f Min(Vec4f a, Vec4f b) { return _mm_min_ps(a, b); }
+inline Vec4f Max(Vec4f a, Vec4f b) { return _mm_max_ps(a, b); }
+//! x < acc ? x : acc, lane by lane
+inline Vec4f SelectLess(Vec4f x, Vec4f acc)
+{
+   const auto mask = _mm_cmplt_ps(x, acc);
+   return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, acc));
+}
+//! x > acc ? x : acc, lane by lane
+inline Vec4f SelectGreater(Vec4f x, Vec4f acc)
+{
+   const auto mask = _mm_cmpgt_ps(x, acc);
+   return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, acc));
+}
+inline bool AnyNaN(Vec4f x)
+   { return _mm_movemask_ps(_mm_cmpunord_ps(x, x)) != 0; }
+inline Vec4f ToFloats(Vec4i x) { return _mm_cvtepi32_ps(x); }
+inline Vec4i RoundToInts(Vec4f x) { return _mm_cvtps_epi32(x); }
+inline Vec4i ShiftLeft8(Vec4i x) { return _mm_slli_epi32(x, 8); }
+
+inline Vec4f Load(const float *p) { return _mm_loadu_ps(p); }
+inline Vec4i Load(const int *p)
+   { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline Vec4i Load(const short *p)
+{
+   // Sign-extend by unpacking into the high halves
+   const auto x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+   return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+inline void Store(float *p, Vec4f x) { _mm_storeu_ps(p, x); }
+inline void Store(int *p, Vec4i x)
+   { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), x); }
+inline void Store(short *p, Vec4i x)
+   { _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(x, x)); }
+
+using Vec2d = __m128d;
+
+inline Vec2d Splat2d(double x) { return _mm_set1_pd(x); }
+inline Vec2d Make2d(double lane0, double lane1)
+   { return _mm_set_pd(lane1, lane0); }
+inline Vec2d Add(Vec2d a, Vec2d b) { return _mm_add_pd(a, b); }
+inline Vec2d Sub(Vec2d a, Vec2d b) { return _mm_sub_pd(a, b); }
+inline Vec2d Mul(Vec2d a, Vec2d b) { return _mm_mul_pd(a, b); }
+//! Round each lane to float precision, as conversion to float and back does
+inline Vec2d RoundToFloat(Vec2d x) { return _mm_cvtps_pd(_mm_cvtpd_ps(x)); }
+inline double Lane0(Vec2d x) { return _mm_cvtsd_f64(x); }
+inline double Lane1(Vec2d x) { return _mm_cvtsd_f64(_mm_unpackhi_pd(x, x)); }
+#else
+using Vec4f = float32x4_t;
+using Vec4i = int32x4_t;
+
+inline Vec4f Splat(float x) { return vdupq_n_f32(x); }
+inline Vec4f Add(Vec4f a, Vec4f b) { return vaddq_f32(a, b); }
+inline Vec4f Sub(Vec4f a, Vec4f b) { return vsubq_f32(a, b); }
+inline Vec4f Mul(Vec4f a, Vec4f b) { return vmulq_f32(a, b); }
+inline Vec4f Min(Vec4f a, Vec4f b) { return vminq_f32(a, b); }
+inline Vec4f Max(Vec4f a, Vec4f b) { return vmaxq_f32(a, b); }
+inline Vec4f SelectLess(Vec4f x, Vec4f acc)
+   { return vbslq_f32(vcltq_f32(x, acc), x, acc); }
+inline Vec4f SelectGreater(Vec4f x, Vec4f acc)
+   { return vbslq_f32(vcgtq_f32(x, acc), x, acc); }
+inline bool AnyNaN(Vec4f x)
+   { return vminvq_u32(vceqq_f32(x, x)) == 0; }
+inline Vec4f ToFloats(Vec4i x) { return vcvtq_f32_s32(x); }
+inline Vec4i RoundToInts(Vec4f x) { return vcvtnq_s32_f32(x); }
+inline Vec4i ShiftLeft8(Vec4i x) { return vshlq_n_s32(x, 8); }
+
+inline Vec4f Load(const float *p) { return vld1q_f32(p); }
+inline Vec4i Load(const int *p) { return vld1q_s32(p); }
+inline Vec4i Load(const short *p) { return vmovl_s16(vld1_s16(p)); }
+
+inline void Store(float *p, Vec4f x) { vst1q_f32(p, x); }
+inline void Store(int *p, Vec4i x) { vst1q_s32(p, x); }
+inline void Store(short *p, Vec4i x) { vst1_s16(p, vqmovn_s32(x)); }
+
+using Vec2d = float64x2_t;
+
+inline Vec2d Splat2d(double x) { return vdupq_n_f64(x); }
+inline Vec2d Make2d(double lane0, double lane1)
+   { return vcombine_f64(vdup_n_f64(lane0), vdup_n_f64(lane1)); }
+inline Vec2d Add(Vec2d a, Vec2d b) { return vaddq_f64(a, b); }
+inline Vec2d Sub(Vec2d a, Vec2d b) { return vsubq_f64(a, b); }
+inline Vec2d Mul(Vec2d a, Vec2d b) { return vmulq_f64(a, b); }
+inline Vec2d RoundToFloat(Vec2d x) { return vcvt_f64_f32(vcvt_f32_f64(x)); }
+inline double Lane0(Vec2d x) { return vgetq_lane_f64(x, 0); }
+inline double Lane1(Vec2d x) { return vgetq_lane_f64(x, 1); }
+#endif
+
+} // namespace SampleVectors
+#endif
+
+#endif
@@ -0,0 +1,230 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadCascadeTests.cpp
+
+**********************************************************************/
+#include "BiquadCascade.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+//! Restores the default at the end of a test
+struct VectorizedSetter
+{
+   explicit VectorizedSetter(bool vectorized)
+   {
+      BiquadCascade::SetVectorized(vectorized);
+   }
+   ~VectorizedSetter()
+   {
+      BiquadCascade::SetVectorized(true);
+   }
+};
+
+std::vector<float> Noise(size_t length, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> distribution { -0.5f, 0.5f };
+   std::vector<float> result(length);
+   std::generate(result.begin(), result.end(),
+      [&] { return distribution(engine); });
+   return result;
+}
+
+//! As the Classic Filters effect applies its sections
+std::vector<float>
+FilterWithBiquads(ArrayOf<Biquad>& sections, size_t nSections,
+   const std::vector<float>& signal)
+{
+   std::vector<float> result(signal.size());
+   const float* in = signal.data();
+   for (size_t ii = 0; ii < nSections; ++ii)
+   {
+      sections[ii].Reset();
+      sections[ii].Process(in, result.data(), result.size());
+      in = result.data();
+   }
+   return result;
+}
+
+//! Filter all channels, in blocks of random lengths, in place or not
+std::vector<std::vector<float>> FilterWithCascade(BiquadCascade& cascade,
+   const std::vector<std::vector<float>>& signals, bool inPlace,
+   unsigned seed)
+{
+   std::mt19937 engine { seed };
+   const auto nChannels = signals.size();
+   const auto length = signals[0].size();
+   auto result = inPlace ? signals :
+      std::vector<std::vector<float>>(nChannels, std::vector<float>(length));
+   std::vector<const float*> in(nChannels);
+   std::vector<float*> out(nChannels);
+   for (size_t start = 0; start < length;)
+   {
+      const auto len = std::min<size_t>(engine() % 3000, length - start);
+      for (size_t channel = 0; channel < nChannels; ++channel)
+      {
+         in[channel] =
+            (inPlace ? result[channel] : signals[channel]).data() + start;
+         out[channel] = result[channel].data() + start;
+      }
+      cascade.Process(in.data(), out.data(), len);
+      start += len;
+   }
+   return result;
+}
+
+float MaxDifference(const std::vector<float>& a, const std::vector<float>& b)
+{
+   float result = 0;
+   for (size_t ii = 0; ii < a.size(); ++ii)
+      result = std::max(result, std::abs(a[ii] - b[ii]));
+   return result;
+}
+
+ArrayOf<Biquad> MakeFilter(int type, int order, int subtype)
+{
+   // Cutoff at 1 kHz for 44.1 kHz
+   constexpr double nyquist = 22050, cutoff = 1000;
+   switch (type)
+   {
+   case 0:
+      return Biquad::CalcButterworthFilter(order, nyquist, cutoff, subtype);
+   case 1:
+      return Biquad::CalcChebyshevType1Filter(
+         order, nyquist, cutoff, 1.0, subtype);
+   default:
+      return Biquad::CalcChebyshevType2Filter(
+         order, nyquist, cutoff, 30.0, subtype);
+   }
+}
+} // namespace
+
+TEST_CASE("BiquadCascade agrees with Biquad")
+{
+   const bool vectorized = GENERATE(false, true);
+   const VectorizedSetter setter { vectorized };
+   const int type = GENERATE(0, 1, 2);
+   const int order = GENERATE(1, 2, 3, 4, 7, 10);
+   const int subtype = GENERATE(0, 1);
+   const size_t nChannels = GENERATE(1, 2, 3);
+   const bool inPlace = GENERATE(false, true);
+
+   auto sections = MakeFilter(type, order, subtype);
+   const size_t nSections = (order + 1) / 2;
+   constexpr size_t length = 20000;
+   std::vector<std::vector<float>> signals;
+   std::vector<std::vector<float>> expected;
+   for (size_t channel = 0; channel < nChannels; ++channel)
+   {
+      signals.push_back(Noise(length, channel));
+      expected.push_back(
+         FilterWithBiquads(sections, nSections, signals.back()));
+   }
+
+   SECTION("Direct form gives the same results")
+   {
+      BiquadCascade cascade { sections.get(), nSections, nChannels };
+      const auto result = FilterWithCascade(cascade, signals, inPlace, 1);
+      for (size_t channel = 0; channel < nChannels; ++channel)
+         // Identical, but for the possible fusion of multiplications and
+         // additions in the scalar code on some processors
+         REQUIRE(MaxDifference(result[channel], expected[channel]) < 1e-6);
+   }
+
+   SECTION("Transposed form differs only in rounding")
+   {
+      BiquadCascade cascade { sections.get(), nSections, nChannels,
+                              BiquadCascade::Form::TransposedDirectII };
+      const auto result = FilterWithCascade(cascade, signals, inPlace, 2);
+      for (size_t channel = 0; channel < nChannels; ++channel)
+         REQUIRE(MaxDifference(result[channel], expected[channel]) < 1e-5);
+   }
+}
+
+TEST_CASE("BiquadCascade::ProcessOne continues Process")
+{
+   auto sections = MakeFilter(0, 6, Biquad::kHighPass);
+   const auto signal = Noise(1000, 3);
+   auto expected = FilterWithBiquads(sections, 3, signal);
+
+   BiquadCascade cascade { sections.get(), 3, 1 };
+   std::vector<float> result(signal.size());
+   cascade.Process(0, signal.data(), result.data(), 500);
+   for (size_t ii = 500; ii < signal.size(); ++ii)
+      result[ii] = cascade.ProcessOne(0, signal[ii]);
+   REQUIRE(MaxDifference(result, expected) < 1e-6);
+
+   SECTION("Reset clears the state")
+   {
+      cascade.Reset();
+      cascade.Process(0, signal.data(), result.data(), signal.size());
+      REQUIRE(MaxDifference(result, expected) < 1e-6);
+   }
+}
+
+TEST_CASE("BiquadCascade without sections copies")
+{
+   const auto signal = Noise(100, 4);
+   BiquadCascade cascade { nullptr, 0, 1 };
+   std::vector<float> result(signal.size());
+   cascade.Process(0, signal.data(), result.data(), signal.size());
+   REQUIRE(result == signal);
+}
+
+// Run explicitly, with `lib-math-test "[benchmark]"`
+TEST_CASE("BiquadCascade benchmark", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   constexpr size_t length = 1 << 22;
+   const std::vector<std::vector<float>> signals { Noise(length, 5),
+                                                   Noise(length, 6) };
+   std::vector<std::vector<float>> outputs(2, std::vector<float>(length));
+
+   std::cout << "order\tchannels\tBiquad (Msamples/s)\t"
+                "scalar (Msamples/s)\tvector (Msamples/s)\n";
+   for (const int order : { 2, 4, 10 })
+   {
+      auto sections = MakeFilter(1, order, Biquad::kLowPass);
+      const size_t nSections = order / 2;
+      for (const size_t nChannels : { 1, 2 })
+      {
+         const auto rate = [&](auto start) {
+            return length * nChannels /
+                   duration<double, std::micro>(steady_clock::now() - start)
+                      .count();
+         };
+
+         auto start = steady_clock::now();
+         for (size_t channel = 0; channel < nChannels; ++channel)
+            outputs[channel] =
+               FilterWithBiquads(sections, nSections, signals[channel]);
+         const auto biquadRate = rate(start);
+
+         double rates[2] {};
+         for (const bool vectorized : { false, true })
+         {
+            const VectorizedSetter setter { vectorized };
+            BiquadCascade cascade { sections.get(), nSections, nChannels };
+            const float* in[] { signals[0].data(), signals[1].data() };
+            float* out[] { outputs[0].data(), outputs[1].data() };
+            start = steady_clock::now();
+            cascade.Process(in, out, length);
+            rates[vectorized] = rate(start);
+         }
+         std::cout << order << '\t' << nChannels << '\t' << biquadRate << '\t'
+                   << rates[0] << '\t' << rates[1] << '\n';
+      }
+   }
+}
@@ -0,0 +1,187 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DitherTests.cpp
+
+**********************************************************************/
+#include "Dither.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+//! Restores the default at the end of a test
+struct VectorizedSetter
+{
+   explicit VectorizedSetter(bool vectorized)
+   {
+      Dither::SetVectorized(vectorized);
+   }
+   ~VectorizedSetter()
+   {
+      Dither::SetVectorized(true);
+   }
+};
+
+//! Samples of the format, including extremes, and out of range or invalid
+//! values that must be clipped
+std::vector<char> MakeSamples(sampleFormat format, size_t size)
+{
+   std::mt19937 engine { 42 };
+   std::vector<char> result(size * SAMPLE_SIZE(format));
+   if (format == floatSample)
+   {
+      const auto samples = reinterpret_cast<float*>(result.data());
+      std::uniform_real_distribution<float> distribution { -1.2f, 1.2f };
+      const float specials[] = {
+         1.0f, -1.0f, 0.0f, -0.0f, 1.0f / 65536, -1.0f / 65536,
+         std::numeric_limits<float>::quiet_NaN(),
+         std::numeric_limits<float>::infinity(),
+         -std::numeric_limits<float>::infinity(), 1e10f, -1e10f,
+      };
+      for (size_t ii = 0; ii < size; ++ii)
+         samples[ii] = ii % 7 == 3
+            ? specials[(ii / 7) % std::size(specials)]
+            : distribution(engine);
+   }
+   else if (format == int24Sample)
+   {
+      const auto samples = reinterpret_cast<int*>(result.data());
+      std::uniform_int_distribution<int> distribution { -8388608, 8388607 };
+      const int specials[] = { -8388608, 8388607, 0, 1, -1, 1 << 24, -(1 << 24) };
+      for (size_t ii = 0; ii < size; ++ii)
+         samples[ii] = ii % 5 == 2
+            ? specials[(ii / 5) % std::size(specials)]
+            : distribution(engine);
+   }
+   else
+   {
+      const auto samples = reinterpret_cast<short*>(result.data());
+      std::uniform_int_distribution<int> distribution { -32768, 32767 };
+      for (size_t ii = 0; ii < size; ++ii)
+         samples[ii] = ii % 5 == 2
+            ? (ii % 2 ? -32768 : 32767)
+            : distribution(engine);
+   }
+   return result;
+}
+
+//! Convert with a fixed sequence of random numbers, and report the next one
+std::vector<char> Convert(
+   const std::vector<char>& source, sampleFormat sourceFormat,
+   sampleFormat destFormat, DitherType ditherType, size_t len,
+   unsigned sourceStride, unsigned destStride, bool vectorized, int& next)
+{
+   const VectorizedSetter setter { vectorized };
+   Dither dither;
+   std::vector<char> dest(len * destStride * SAMPLE_SIZE(destFormat), 'x');
+   srand(1234);
+   dither.Apply(
+      ditherType, source.data(), sourceFormat, dest.data(), destFormat, len,
+      sourceStride, destStride);
+   next = rand();
+   return dest;
+}
+
+const char* FormatName(sampleFormat format)
+{
+   return format == int16Sample ? "int16" :
+          format == int24Sample ? "int24" :
+                                  "float";
+}
+} // namespace
+
+TEST_CASE("Dither")
+{
+   const auto [sourceFormat, destFormat] = GENERATE(
+      std::pair { int16Sample, int16Sample },
+      std::pair { int16Sample, int24Sample },
+      std::pair { int16Sample, floatSample },
+      std::pair { int24Sample, int16Sample },
+      std::pair { int24Sample, int24Sample },
+      std::pair { int24Sample, floatSample },
+      std::pair { floatSample, int16Sample },
+      std::pair { floatSample, int24Sample },
+      std::pair { floatSample, floatSample });
+   const auto ditherType = GENERATE(
+      DitherType::none, DitherType::rectangle, DitherType::triangle,
+      DitherType::shaped);
+   const auto [sourceStride, destStride] = GENERATE(
+      std::pair { 1u, 1u }, std::pair { 2u, 1u }, std::pair { 1u, 3u });
+
+   SECTION("vectorized and scalar conversions agree exactly")
+   {
+      for (size_t len : { 1, 3, 4, 5, 17, 255, 256, 257, 1000 })
+      {
+         const auto source = MakeSamples(sourceFormat, len * sourceStride);
+         int scalarNext = 0, vectorizedNext = 0;
+         const auto scalar = Convert(
+            source, sourceFormat, destFormat, ditherType, len, sourceStride,
+            destStride, false, scalarNext);
+         const auto vectorized = Convert(
+            source, sourceFormat, destFormat, ditherType, len, sourceStride,
+            destStride, true, vectorizedNext);
+         REQUIRE(scalar == vectorized);
+         // The same random numbers were used
+         REQUIRE(scalarNext == vectorizedNext);
+      }
+   }
+}
+
+// Run explicitly, with `lib-math-test "[benchmark]"`
+TEST_CASE("Dither benchmark", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   constexpr size_t len = 1 << 16;
+   constexpr size_t repetitions = 256;
+   const std::pair<sampleFormat, sampleFormat> pairs[] = {
+      { int16Sample, floatSample }, { int24Sample, floatSample },
+      { int16Sample, int24Sample }, { floatSample, int16Sample },
+      { floatSample, int24Sample }, { int24Sample, int16Sample },
+   };
+   const DitherType ditherTypes[] = { DitherType::none, DitherType::rectangle,
+                                      DitherType::triangle };
+   const char* const ditherNames[] = { "none", "rectangle", "triangle" };
+
+   std::cout << "source\tdest\tdither\tscalar (Msamples/s)\tvectorized "
+                "(Msamples/s)\n";
+   for (const auto& pair : pairs)
+   {
+      const auto sourceFormat = pair.first, destFormat = pair.second;
+      const auto source = MakeSamples(sourceFormat, len);
+      std::vector<char> dest(len * SAMPLE_SIZE(destFormat));
+      for (size_t ii = 0; ii < std::size(ditherTypes); ++ii)
+      {
+         // Widening conversions ignore the dither type
+         if (SAMPLE_SIZE(sourceFormat) < SAMPLE_SIZE(destFormat) && ii > 0)
+            break;
+         const auto measure = [&](bool vectorized) {
+            const VectorizedSetter setter { vectorized };
+            Dither dither;
+            const auto start = steady_clock::now();
+            for (size_t jj = 0; jj < repetitions; ++jj)
+               dither.Apply(
+                  ditherTypes[ii], source.data(), sourceFormat, dest.data(),
+                  destFormat, len);
+            return len * repetitions /
+                   duration<double, std::micro>(steady_clock::now() - start)
+                      .count();
+         };
+         std::cout << FormatName(sourceFormat) << "\t"
+                   << FormatName(destFormat) << "\t"
+                   << ditherNames[ii] << "\t" << measure(false) << "\t"
+                   << measure(true) << "\n";
+      }
+   }
+}
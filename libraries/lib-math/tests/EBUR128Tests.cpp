@@ -0,0 +1,169 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  EBUR128Tests.cpp
+
+**********************************************************************/
+#include "EBUR128.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr auto pi = 3.14159265358979323846;
+
+std::vector<float> Sine(double rate, double frequency, double amplitude,
+   size_t length, double phase = 0)
+{
+   std::vector<float> result(length);
+   for (size_t ii = 0; ii < length; ++ii)
+      result[ii] = static_cast<float>(
+         amplitude * std::sin(2 * pi * frequency * ii / rate + phase));
+   return result;
+}
+
+//! Programme-like material: tones that come and go, and noise
+std::vector<float> Material(double rate, size_t length, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::normal_distribution<double> noise { 0.0, 0.05 };
+   std::vector<float> result(length);
+   for (size_t ii = 0; ii < length; ++ii)
+   {
+      const auto t = ii / rate;
+      const auto envelope = 0.5 + 0.5 * std::sin(2 * pi * 0.3 * t + seed);
+      result[ii] = static_cast<float>(
+         envelope * (0.4 * std::sin(2 * pi * 440 * t) +
+                     0.2 * std::sin(2 * pi * 3000 * t)) +
+         noise(engine));
+   }
+   return result;
+}
+
+void ProcessBySample(
+   EBUR128& analyser, const std::vector<std::vector<float>>& channels)
+{
+   for (size_t ii = 0; ii < channels[0].size(); ++ii)
+   {
+      for (size_t channel = 0; channel < channels.size(); ++channel)
+         analyser.ProcessSampleFromChannel(channels[channel][ii], channel);
+      analyser.NextSample();
+   }
+}
+
+//! In blocks of random lengths
+void ProcessByBlock(EBUR128& analyser,
+   const std::vector<std::vector<float>>& channels, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   const auto length = channels[0].size();
+   std::vector<const float*> pointers(channels.size());
+   for (size_t start = 0; start < length;)
+   {
+      const auto len = std::min<size_t>(1 + engine() % 20000, length - start);
+      for (size_t channel = 0; channel < channels.size(); ++channel)
+         pointers[channel] = channels[channel].data() + start;
+      analyser.ProcessBlock(pointers.data(), channels.size(), len);
+      start += len;
+   }
+}
+} // namespace
+
+TEST_CASE("EBUR128 ProcessBlock agrees with ProcessSampleFromChannel")
+{
+   // 11025 Hz makes blocks that are not whole multiples of hops
+   const double rate = GENERATE(44100.0, 11025.0);
+   const size_t nChannels = GENERATE(1, 2, 3, 5);
+   // Shorter than one block, and several seconds
+   const size_t length = GENERATE(1000, 200000);
+
+   std::vector<std::vector<float>> channels;
+   for (size_t channel = 0; channel < nChannels; ++channel)
+      channels.push_back(Material(rate, length, channel));
+
+   EBUR128 bySample { rate, nChannels };
+   EBUR128 byBlock { rate, nChannels };
+   bySample.EnableTruePeak();
+   byBlock.EnableTruePeak();
+   ProcessBySample(bySample, channels);
+   ProcessByBlock(byBlock, channels, 17);
+
+   // Identical, but for the possible fusion of multiplications and
+   // additions in the scalar code on some processors
+   const auto same = [](double expected) {
+      return Approx(expected).epsilon(1e-12).margin(1e-300);
+   };
+   REQUIRE(byBlock.MomentaryLoudness() == same(bySample.MomentaryLoudness()));
+   REQUIRE(byBlock.ShortTermLoudness() == same(bySample.ShortTermLoudness()));
+   REQUIRE(byBlock.TruePeak() == bySample.TruePeak());
+   REQUIRE(
+      byBlock.IntegrativeLoudness() == same(bySample.IntegrativeLoudness()));
+}
+
+TEST_CASE("EBUR128 measures the loudness of tones")
+{
+   const double rate = 48000;
+   const size_t length = 10 * 48000;
+   // A full scale 1 kHz sine in one channel measures -3.01 LUFS
+   const auto tone = Sine(rate, 1000, 0.1, length);
+
+   SECTION("Mono")
+   {
+      EBUR128 analyser { rate, 1 };
+      const float* const channels[] { tone.data() };
+      analyser.ProcessBlock(channels, 1, length);
+      const auto expected = 20 * std::log10(0.1) - 3.01;
+      REQUIRE(
+         analyser.IntegrativeLoudnessToLUFS(analyser.IntegrativeLoudness()) ==
+         Approx(expected).margin(0.05));
+      REQUIRE(
+         analyser.IntegrativeLoudnessToLUFS(analyser.MomentaryLoudness()) ==
+         Approx(expected).margin(0.05));
+      REQUIRE(
+         analyser.IntegrativeLoudnessToLUFS(analyser.ShortTermLoudness()) ==
+         Approx(expected).margin(0.05));
+   }
+
+   SECTION("Stereo is 3 LU louder")
+   {
+      EBUR128 analyser { rate, 2 };
+      const float* const channels[] { tone.data(), tone.data() };
+      analyser.ProcessBlock(channels, 2, length);
+      REQUIRE(
+         analyser.IntegrativeLoudnessToLUFS(analyser.IntegrativeLoudness()) ==
+         Approx(20 * std::log10(0.1)).margin(0.05));
+   }
+
+   SECTION("Silence")
+   {
+      std::vector<float> silence(length);
+      EBUR128 analyser { rate, 1 };
+      const float* const channels[] { silence.data() };
+      analyser.ProcessBlock(channels, 1, length);
+      REQUIRE(analyser.IntegrativeLoudness() == 0);
+      REQUIRE(analyser.MomentaryLoudness() == 0);
+   }
+}
+
+TEST_CASE("EBUR128 finds true peaks between samples")
+{
+   const double rate = 48000;
+   // A quarter of the sample rate, sampled 45 degrees away from its peaks
+   const auto tone = Sine(rate, rate / 4, 0.5, 48000, pi / 4);
+   const auto samplePeak = std::abs(tone[0]);
+   REQUIRE(samplePeak < 0.36);
+
+   EBUR128 analyser { rate, 1 };
+   REQUIRE(analyser.TruePeak() == 0);
+   analyser.EnableTruePeak();
+   const float* const channels[] { tone.data() };
+   analyser.ProcessBlock(channels, 1, tone.size());
+   REQUIRE(analyser.TruePeak() == Approx(0.5).margin(0.02));
+}
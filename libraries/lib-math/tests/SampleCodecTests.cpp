@@ -0,0 +1,239 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleCodecTests.cpp
+
+**********************************************************************/
+#include "SampleCodec.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+//! A few tones and some noise, quantized as if recorded in the format
+std::vector<char> MakeSamples(sampleFormat format, size_t size, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::normal_distribution<double> noise { 0.0, 0.002 };
+   std::vector<char> result(size * SAMPLE_SIZE(format));
+   constexpr auto pi = 3.14159265358979323846;
+   for (size_t ii = 0; ii < size; ++ii)
+   {
+      const auto t = ii / 44100.0;
+      const auto x = 0.3 * std::sin(2 * pi * 220 * t) +
+                     0.2 * std::sin(2 * pi * 1375 * t + seed) +
+                     noise(engine);
+      if (format == int16Sample)
+         reinterpret_cast<short*>(result.data())[ii] =
+            static_cast<short>(std::lround(x * 32767));
+      else if (format == int24Sample)
+         reinterpret_cast<int*>(result.data())[ii] =
+            static_cast<int>(std::lround(x * 8388607));
+      else
+         // As imported from a 16 bit file
+         reinterpret_cast<float*>(result.data())[ii] =
+            std::lround(x * 32767) / 32768.0f;
+   }
+   return result;
+}
+
+void RequireRoundTrip(const std::vector<char>& samples, sampleFormat format)
+{
+   const auto count = samples.size() / SAMPLE_SIZE(format);
+   const auto encoded = SampleCodec::Encode(samples.data(), format, count);
+   REQUIRE(!encoded.empty());
+   REQUIRE(encoded.size() < samples.size());
+   REQUIRE(
+      SampleCodec::DecodedCount(encoded.data(), encoded.size()) == count);
+   std::vector<char> decoded(samples.size());
+   REQUIRE(SampleCodec::Decode(
+      encoded.data(), encoded.size(), decoded.data(), format, count));
+   // Compare bits, not values, so that floats must be exact
+   REQUIRE(memcmp(decoded.data(), samples.data(), samples.size()) == 0);
+}
+} // namespace
+
+TEST_CASE("SampleCodec restores the samples exactly")
+{
+   const auto format = GENERATE(int16Sample, int24Sample, floatSample);
+   // Lengths exercise partial groups and frames
+   const size_t count = GENERATE(256, 257, 1000, 262144);
+   RequireRoundTrip(MakeSamples(format, count, count), format);
+}
+
+TEST_CASE("SampleCodec declines blocks too short to gain")
+{
+   const auto format = GENERATE(int16Sample, int24Sample, floatSample);
+   const auto samples = MakeSamples(format, 1, 1);
+   REQUIRE(SampleCodec::Encode(samples.data(), format, 1).empty());
+}
+
+TEST_CASE("SampleCodec compresses silence and extreme values")
+{
+   SECTION("Silence")
+   {
+      std::vector<char> zeros(4096 * sizeof(float));
+      RequireRoundTrip(zeros, floatSample);
+      const auto encoded =
+         SampleCodec::Encode(zeros.data(), floatSample, 4096);
+      // Just the header, the widths and the orders
+      REQUIRE(encoded.size() < 200);
+   }
+   SECTION("Full scale square waves")
+   {
+      std::vector<short> shorts(1000);
+      std::vector<float> floats(1000);
+      for (size_t ii = 0; ii < shorts.size(); ++ii)
+      {
+         shorts[ii] = (ii / 50) % 2 ? -32768 : 32767;
+         floats[ii] = (ii / 50) % 2 ? -1.0f : 32767 / 32768.0f;
+      }
+      RequireRoundTrip(
+         { reinterpret_cast<char*>(shorts.data()),
+           reinterpret_cast<char*>(shorts.data() + shorts.size()) },
+         int16Sample);
+      RequireRoundTrip(
+         { reinterpret_cast<char*>(floats.data()),
+           reinterpret_cast<char*>(floats.data() + floats.size()) },
+         floatSample);
+   }
+}
+
+TEST_CASE("SampleCodec declines samples it can't compress")
+{
+   std::vector<float> floats(4096);
+   SECTION("Processed floats")
+   {
+      std::mt19937 engine { 7 };
+      std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+      for (auto& f : floats)
+         f = distribution(engine);
+   }
+   SECTION("Negative zero")
+   {
+      floats[100] = -0.0f;
+   }
+   SECTION("Not finite")
+   {
+      floats[100] = std::numeric_limits<float>::quiet_NaN();
+   }
+   SECTION("Out of range")
+   {
+      floats[100] = 100.0f;
+   }
+   REQUIRE(SampleCodec::Encode(
+              reinterpret_cast<const char*>(floats.data()), floatSample,
+              floats.size())
+              .empty());
+
+   std::mt19937 engine { 11 };
+   std::uniform_int_distribution<int> distribution { -32768, 32767 };
+   std::vector<short> shorts(4096);
+   for (auto& s : shorts)
+      s = static_cast<short>(distribution(engine));
+   REQUIRE(SampleCodec::Encode(
+              reinterpret_cast<const char*>(shorts.data()), int16Sample,
+              shorts.size())
+              .empty());
+}
+
+TEST_CASE("SampleCodec rejects malformed data")
+{
+   const size_t count = 1000;
+   const auto samples = MakeSamples(int16Sample, count, 3);
+   const auto encoded =
+      SampleCodec::Encode(samples.data(), int16Sample, count);
+   REQUIRE(!encoded.empty());
+   std::vector<char> decoded(samples.size());
+
+   REQUIRE(!SampleCodec::DecodedCount(samples.data(), samples.size()));
+   REQUIRE(!SampleCodec::Decode(
+      samples.data(), samples.size(), decoded.data(), int16Sample, count));
+   REQUIRE(!SampleCodec::Decode(
+      encoded.data(), encoded.size() - 1, decoded.data(), int16Sample, count));
+   REQUIRE(!SampleCodec::Decode(
+      encoded.data(), encoded.size(), decoded.data(), int16Sample, count - 1));
+   std::vector<char> floats(count * sizeof(float));
+   REQUIRE(!SampleCodec::Decode(
+      encoded.data(), encoded.size(), floats.data(), floatSample, count));
+
+   // Arbitrary changes of the bytes must not make the decoder misbehave
+   std::mt19937 engine { 5 };
+   for (int ii = 0; ii < 1000; ++ii)
+   {
+      auto damaged = encoded;
+      damaged[12 + engine() % (damaged.size() - 12)] =
+         static_cast<char>(engine());
+      SampleCodec::Decode(
+         damaged.data(), damaged.size(), decoded.data(), int16Sample, count);
+   }
+}
+
+// Run explicitly, with `lib-math-test "[benchmark]"`
+TEST_CASE("SampleCodec benchmark", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   // The usual size of a sample block
+   constexpr size_t len = 1 << 18;
+   constexpr size_t repetitions = 64;
+
+   std::cout << "format\tratio\traw read (MB/s)\tdecode (MB/s)\t"
+                "decode to float (MB/s)\tencode (MB/s)\n";
+   for (auto format : { int16Sample, int24Sample, floatSample })
+   {
+      const auto samples = MakeSamples(format, len, 1);
+      const auto rate = [&](auto start) {
+         return samples.size() * repetitions /
+                duration<double, std::micro>(steady_clock::now() - start)
+                   .count();
+      };
+
+      std::vector<char> encoded;
+      auto start = steady_clock::now();
+      for (size_t ii = 0; ii < repetitions; ++ii)
+         encoded = SampleCodec::Encode(samples.data(), format, len);
+      const auto encodeRate = rate(start);
+      REQUIRE(!encoded.empty());
+
+      // What reading an uncompressed block does after fetching the bytes
+      std::vector<char> decoded(samples.size());
+      std::vector<float> floats(len);
+      start = steady_clock::now();
+      for (size_t ii = 0; ii < repetitions; ++ii)
+         SamplesToFloats(samples.data(), format, floats.data(), len);
+      const auto rawRate = rate(start);
+
+      start = steady_clock::now();
+      for (size_t ii = 0; ii < repetitions; ++ii)
+         SampleCodec::Decode(
+            encoded.data(), encoded.size(), decoded.data(), format, len);
+      const auto decodeRate = rate(start);
+
+      start = steady_clock::now();
+      for (size_t ii = 0; ii < repetitions; ++ii)
+      {
+         SampleCodec::Decode(
+            encoded.data(), encoded.size(), decoded.data(), format, len);
+         SamplesToFloats(decoded.data(), format, floats.data(), len);
+      }
+      const auto floatRate = rate(start);
+      REQUIRE(memcmp(decoded.data(), samples.data(), samples.size()) == 0);
+
+      std::cout << (format == int16Sample   ? "int16" :
+                    format == int24Sample ? "int24" :
+                                            "float")
+                << '\t' << double(encoded.size()) / samples.size() << '\t'
+                << rawRate << '\t' << decodeRate << '\t' << floatRate << '\t'
+                << encodeRate << '\n';
+   }
+}
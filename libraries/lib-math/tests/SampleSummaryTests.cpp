@@ -0,0 +1,196 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleSummaryTests.cpp
+
+**********************************************************************/
+#include "SampleSummary.h"
+
+#include <catch2/catch.hpp>
+
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+//! Restores the default at the end of a test
+struct VectorizedSetter
+{
+   explicit VectorizedSetter(bool vectorized)
+   {
+      SampleSummary::SetVectorized(vectorized);
+   }
+   ~VectorizedSetter()
+   {
+      SampleSummary::SetVectorized(true);
+   }
+};
+
+//! Samples of the format; floats include NaNs, infinities and zeros of
+//! both signs
+std::vector<char> MakeSamples(sampleFormat format, size_t size, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::vector<char> result(size * SAMPLE_SIZE(format));
+   if (format == floatSample)
+   {
+      const auto samples = reinterpret_cast<float*>(result.data());
+      std::uniform_real_distribution<float> distribution { -1.0f, 1.0f };
+      const float specials[] = {
+         0.0f, -0.0f, 1.0f, -1.0f,
+         std::numeric_limits<float>::quiet_NaN(),
+         std::numeric_limits<float>::infinity(),
+         -std::numeric_limits<float>::infinity(),
+      };
+      for (size_t ii = 0; ii < size; ++ii)
+         samples[ii] = ii % 7 == seed % 7
+            ? specials[(ii / 7 + seed) % std::size(specials)]
+            : distribution(engine);
+   }
+   else if (format == int24Sample)
+   {
+      const auto samples = reinterpret_cast<int*>(result.data());
+      std::uniform_int_distribution<int> distribution { -8388608, 8388607 };
+      for (size_t ii = 0; ii < size; ++ii)
+         samples[ii] = distribution(engine);
+   }
+   else
+   {
+      const auto samples = reinterpret_cast<short*>(result.data());
+      std::uniform_int_distribution<int> distribution { -32768, 32767 };
+      for (size_t ii = 0; ii < size; ++ii)
+         samples[ii] = distribution(engine);
+   }
+   return result;
+}
+
+SampleSummary Accumulate(
+   SampleSummary summary, const std::vector<char>& samples,
+   sampleFormat format, size_t len, bool vectorized)
+{
+   const VectorizedSetter setter { vectorized };
+   summary.Accumulate(samples.data(), format, len);
+   return summary;
+}
+
+bool BitwiseEqual(const SampleSummary& a, const SampleSummary& b)
+{
+   return memcmp(&a, &b, sizeof(SampleSummary)) == 0;
+}
+
+const char* FormatName(sampleFormat format)
+{
+   return format == int16Sample ? "int16" :
+          format == int24Sample ? "int24" :
+                                  "float";
+}
+} // namespace
+
+TEST_CASE("SampleSummary")
+{
+   const auto format = GENERATE(int16Sample, int24Sample, floatSample);
+   const auto nan = std::numeric_limits<float>::quiet_NaN();
+   const auto initial = GENERATE_COPY(
+      SampleSummary { FLT_MAX, -FLT_MAX, 0 },
+      SampleSummary { 0.0f, 0.0f, 0 },
+      SampleSummary { -0.0f, -0.0f, 0 },
+      SampleSummary { 0.25f, 0.5f, 1.0f },
+      SampleSummary { nan, nan, nan });
+
+   SECTION("vectorized and scalar summaries agree exactly")
+   {
+      for (unsigned seed = 0; seed < 7; ++seed)
+         for (size_t len : { 0, 1, 3, 4, 5, 63, 64, 65, 255, 1000 })
+         {
+            const auto samples = MakeSamples(format, len, seed);
+            REQUIRE(BitwiseEqual(
+               Accumulate(initial, samples, format, len, false),
+               Accumulate(initial, samples, format, len, true)));
+         }
+   }
+
+   SECTION("zeros of both signs are resolved in order")
+   {
+      std::vector<float> zeros(100, 0.0f);
+      for (size_t ii = 0; ii < zeros.size(); ++ii)
+      {
+         std::vector<float> samples = zeros;
+         samples[ii] = -0.0f;
+         std::vector<char> bytes(samples.size() * sizeof(float));
+         memcpy(bytes.data(), samples.data(), bytes.size());
+         REQUIRE(BitwiseEqual(
+            Accumulate(initial, bytes, floatSample, samples.size(), false),
+            Accumulate(initial, bytes, floatSample, samples.size(), true)));
+      }
+   }
+}
+
+// Run explicitly, with `lib-math-test "[benchmark]"`
+TEST_CASE("SampleSummary benchmark", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   constexpr size_t len = 1 << 16;
+   constexpr size_t blockSize = 256;
+   constexpr size_t repetitions = 256;
+
+   std::cout << "format\tconvert then loop (Msamples/s)\tscalar "
+                "(Msamples/s)\tvectorized (Msamples/s)\n";
+   for (auto format : { int16Sample, int24Sample, floatSample })
+   {
+      const auto samples = MakeSamples(format, len, 1);
+      const auto rate = [&](auto start) {
+         return len * repetitions /
+                duration<double, std::micro>(steady_clock::now() - start)
+                   .count();
+      };
+      // Keep the results so the work is not optimized away
+      std::vector<float> results(len / blockSize);
+      // What sample blocks did before
+      std::vector<float> floats(len);
+      auto start = steady_clock::now();
+      for (size_t ii = 0; ii < repetitions; ++ii)
+      {
+         SamplesToFloats(samples.data(), format, floats.data(), len);
+         for (size_t jj = 0; jj < len; jj += blockSize)
+         {
+            auto min = floats[jj], max = min, sumsq = min * min;
+            for (size_t kk = 1; kk < blockSize; ++kk)
+            {
+               const auto f = floats[jj + kk];
+               sumsq += f * f;
+               if (f < min)
+                  min = f;
+               else if (f > max)
+                  max = f;
+            }
+            results[jj / blockSize] = min + max + sumsq;
+         }
+      }
+      const auto old = rate(start);
+      const auto measure = [&](bool vectorized) {
+         const VectorizedSetter setter { vectorized };
+         const auto start = steady_clock::now();
+         for (size_t ii = 0; ii < repetitions; ++ii)
+            for (size_t jj = 0; jj < len; jj += blockSize)
+            {
+               SampleSummary summary { FLT_MAX, -FLT_MAX, 0 };
+               summary.Accumulate(
+                  samples.data() + jj * SAMPLE_SIZE(format), format,
+                  blockSize);
+               results[jj / blockSize] =
+                  summary.min + summary.max + summary.sumsq;
+            }
+         return rate(start);
+      };
+      std::cout << FormatName(format) << "\t" << old << "\t" << measure(false)
+                << "\t" << measure(true) << "\n";
+   }
+}
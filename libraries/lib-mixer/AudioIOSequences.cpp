@@ -11,6 +11,11 @@
 
 PlayableSequence::~PlayableSequence() = default;
 
+std::shared_ptr<const void> PlayableSequence::Prefetch(double, double) const
+{
+   return nullptr;
+}
+
 RecordableSequence::~RecordableSequence() = default;
 
 OtherPlayableSequence::~OtherPlayableSequence() = default;
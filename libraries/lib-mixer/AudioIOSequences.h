@@ -30,6 +30,14 @@ struct MIXER_API PlayableSequence : WideSampleSequence {
 
    //! May vary asynchronously
    virtual bool GetMute() const = 0;
+
+   //! Read samples between the given times ahead of need
+   /*!
+    May be called in a worker thread, while another thread reads the samples.
+    The default implementation does nothing.
+    @return keeps the fetched data in memory while it exists; may be null
+    */
+   virtual std::shared_ptr<const void> Prefetch(double t0, double t1) const;
 };
 
 using ConstPlayableSequences =
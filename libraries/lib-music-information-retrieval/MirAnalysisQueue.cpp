@@ -0,0 +1,179 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MirAnalysisQueue.cpp
+
+**********************************************************************/
+#include "MirAnalysisQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+#include "concurrency/WorkerPool.h"
+
+namespace MIR
+{
+namespace
+{
+audacity::concurrency::WorkerPool& MirWorkers()
+{
+   static audacity::concurrency::WorkerPool workers;
+   return workers;
+}
+
+//! Thrown from the progress callbacks of analyses to stop them
+struct Cancelled
+{
+};
+
+//! How often Wait() reports progress
+constexpr auto progressInterval = std::chrono::milliseconds { 50 };
+} // namespace
+
+struct AnalysisQueue::Entry
+{
+   explicit Entry(ProjectSyncInfoInput input)
+       : input { std::move(input) }
+   {
+   }
+
+   ProjectSyncInfoInput input;
+   std::atomic<double> progress { 0 };
+
+   // Written by the job before it sets done
+   std::optional<ProjectSyncInfo> result;
+   std::exception_ptr exception;
+
+   // Guarded by State::mutex
+   bool done { false };
+};
+
+struct AnalysisQueue::State
+{
+   //! Return when all entries are done, which needs the lock held
+   void WaitForAll(std::unique_lock<std::mutex>& lock)
+   {
+      doneChanged.wait(lock, [this] { return nDone == entries.size(); });
+   }
+
+   std::mutex mutex;
+   std::condition_variable doneChanged;
+   std::atomic<bool> cancelled { false };
+
+   // Guarded by mutex; the entries have stable addresses for the jobs
+   std::vector<std::unique_ptr<Entry>> entries;
+   size_t nDone { 0 };
+};
+
+AnalysisQueue::AnalysisQueue()
+    : mState { std::make_shared<State>() }
+{
+}
+
+AnalysisQueue::~AnalysisQueue()
+{
+   mState->cancelled = true;
+   std::unique_lock<std::mutex> lock { mState->mutex };
+   mState->WaitForAll(lock);
+}
+
+void AnalysisQueue::Add(ProjectSyncInfoInput input)
+{
+   auto pEntry = std::make_unique<Entry>(std::move(input));
+   auto& entry = *pEntry;
+   {
+      std::lock_guard<std::mutex> lock { mState->mutex };
+      mState->entries.push_back(std::move(pEntry));
+   }
+   MirWorkers().Post([pState = mState, &entry] {
+      if (!pState->cancelled)
+         try
+         {
+            entry.input.progressCallback = [&](double progress) {
+               if (pState->cancelled)
+                  throw Cancelled {};
+               entry.progress.store(progress, std::memory_order_relaxed);
+            };
+            if (auto result = GetProjectSyncInfo(entry.input))
+               entry.result.emplace(std::move(*result));
+         }
+         catch (...)
+         {
+            entry.exception = std::current_exception();
+         }
+      {
+         std::lock_guard<std::mutex> lock { pState->mutex };
+         entry.done = true;
+         ++pState->nDone;
+      }
+      pState->doneChanged.notify_all();
+   });
+}
+
+size_t AnalysisQueue::Size() const
+{
+   std::lock_guard<std::mutex> lock { mState->mutex };
+   return mState->entries.size();
+}
+
+std::vector<std::optional<ProjectSyncInfo>>
+AnalysisQueue::Wait(const std::function<void(double)>& progressCallback)
+{
+   auto& state = *mState;
+   std::unique_lock<std::mutex> lock { state.mutex };
+   const auto clear = [&] {
+      state.entries.clear();
+      state.nDone = 0;
+      state.cancelled = false;
+   };
+
+   const auto total = state.entries.size();
+   while (true)
+   {
+      double sum = 0;
+      for (const auto& pEntry : state.entries)
+         sum += pEntry->done ?
+                   1.0 :
+                   pEntry->progress.load(std::memory_order_relaxed);
+      const auto finished = state.nDone == total;
+      lock.unlock();
+      try
+      {
+         if (progressCallback)
+            progressCallback(total > 0 ? sum / total : 1.0);
+      }
+      catch (...)
+      {
+         state.cancelled = true;
+         lock.lock();
+         state.WaitForAll(lock);
+         clear();
+         throw;
+      }
+      lock.lock();
+      if (finished)
+         break;
+      state.doneChanged.wait_for(
+         lock, progressInterval, [&] { return state.nDone == total; });
+   }
+
+   std::vector<std::optional<ProjectSyncInfo>> results;
+   results.reserve(total);
+   std::exception_ptr exception;
+   for (const auto& pEntry : state.entries)
+   {
+      if (pEntry->exception && !exception)
+         exception = pEntry->exception;
+      results.push_back(std::move(pEntry->result));
+   }
+   clear();
+   if (exception)
+      std::rethrow_exception(exception);
+   return results;
+}
+} // namespace MIR
@@ -0,0 +1,69 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MirAnalysisQueue.h
+
+  @brief Runs GetProjectSyncInfo for several sources concurrently
+
+**********************************************************************/
+#pragma once
+
+#include "MusicInformationRetrieval.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace MIR
+{
+//! Analyses sources on worker threads as soon as they are added, for instance
+//! while the next file is still being imported
+/*!
+ Each analysis only reads its own source, so analyses of different sources
+ share nothing.  They run on a pool shared by all queues, with one thread
+ less than the hardware has.
+ */
+class MUSIC_INFORMATION_RETRIEVAL_API AnalysisQueue final
+{
+public:
+   AnalysisQueue();
+   //! Cancels the analyses that are not done, and waits for those running
+   ~AnalysisQueue();
+
+   AnalysisQueue(const AnalysisQueue&) = delete;
+   AnalysisQueue& operator=(const AnalysisQueue&) = delete;
+
+   //! Start GetProjectSyncInfo(input) as soon as a worker is free
+   /*!
+    @param input its progressCallback is replaced with one that reports to
+    Wait()
+    @pre `input.source` remains valid until Wait() returns or the queue is
+    destroyed
+    */
+   void Add(ProjectSyncInfoInput input);
+
+   //! Number of analyses added since the last Wait()
+   size_t Size() const;
+
+   //! Wait for all analyses added, reporting their mean progress, then empty
+   //! the queue
+   /*!
+    @param progressCallback called on this thread, with values from 0 to 1;
+    if it throws, the analyses are cancelled, and the exception is rethrown
+    when they stop
+    @return the results in the order of Add()
+    @throws the first exception of any analysis, after all of them are done
+    */
+   std::vector<std::optional<ProjectSyncInfo>>
+   Wait(const std::function<void(double)>& progressCallback);
+
+private:
+   struct Entry;
+   struct State;
+   //! Shared with the jobs of the worker threads
+   const std::shared_ptr<State> mState;
+};
+} // namespace MIR
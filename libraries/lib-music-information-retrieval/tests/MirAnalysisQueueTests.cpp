@@ -0,0 +1,153 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MirAnalysisQueueTests.cpp
+
+**********************************************************************/
+#include "MirAnalysisQueue.h"
+#include "MirFakes.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace MIR
+{
+namespace
+{
+//! Clicks on every beat, for a few bars
+class ClickTrackMirAudioReader : public MirAudioReader
+{
+public:
+   explicit ClickTrackMirAudioReader(double bpm)
+       : mSamplesPerBeat { 60 * 44100. / bpm }
+   {
+   }
+
+   double GetSampleRate() const override
+   {
+      return 44100;
+   }
+   long long GetNumSamples() const override
+   {
+      return static_cast<long long>(16 * mSamplesPerBeat);
+   }
+   void
+   ReadFloats(float* buffer, long long where, size_t numFrames) const override
+   {
+      for (size_t i = 0; i < numFrames; ++i)
+      {
+         const auto sinceBeat = std::fmod(where + i, mSamplesPerBeat);
+         buffer[i] = static_cast<float>(
+            std::exp(-sinceBeat / 200) * std::sin(sinceBeat / 3));
+      }
+   }
+
+private:
+   const double mSamplesPerBeat;
+};
+
+class ThrowingMirAudioReader : public ClickTrackMirAudioReader
+{
+public:
+   ThrowingMirAudioReader()
+       : ClickTrackMirAudioReader { 120 }
+   {
+   }
+   void ReadFloats(float*, long long, size_t) const override
+   {
+      throw std::runtime_error { "read error" };
+   }
+};
+
+bool Same(
+   const std::optional<ProjectSyncInfo>& a,
+   const std::optional<ProjectSyncInfo>& b)
+{
+   if (a.has_value() != b.has_value())
+      return false;
+   return !a.has_value() ||
+          (a->rawAudioTempo == b->rawAudioTempo &&
+           a->usedMethod == b->usedMethod &&
+           a->timeSignature == b->timeSignature &&
+           a->stretchMinimizingPowOfTwo == b->stretchMinimizingPowOfTwo &&
+           a->excessDurationInQuarternotes == b->excessDurationInQuarternotes);
+}
+} // namespace
+
+TEST_CASE("AnalysisQueue")
+{
+   const EmptyMirAudioReader emptyReader;
+   const ClickTrackMirAudioReader clicks90 { 90 }, clicks120 { 120 },
+      clicks140 { 140 };
+   std::vector<ProjectSyncInfoInput> inputs {
+      { clicks120, "loop" },
+      { clicks90, "loop 100 BPM" },
+      { emptyReader, "one shot", LibFileFormats::AcidizerTags::OneShot {} },
+      { clicks140, "loop" },
+      { emptyReader, "tagged", LibFileFormats::AcidizerTags::Loop { 128 } },
+   };
+   for (auto& input : inputs)
+      input.viewIsBeatsAndMeasures = true;
+
+   SECTION("gives the results of GetProjectSyncInfo, in order")
+   {
+      AnalysisQueue queue;
+      for (const auto& input : inputs)
+         queue.Add(input);
+      REQUIRE(queue.Size() == inputs.size());
+
+      std::vector<double> progress;
+      const auto results = queue.Wait([&](double p) { progress.push_back(p); });
+      REQUIRE(queue.Size() == 0);
+      REQUIRE(results.size() == inputs.size());
+      for (size_t i = 0; i < inputs.size(); ++i)
+         REQUIRE(Same(results[i], GetProjectSyncInfo(inputs[i])));
+
+      REQUIRE(!progress.empty());
+      REQUIRE(std::is_sorted(progress.begin(), progress.end()));
+      REQUIRE(progress.back() == 1.0);
+   }
+
+   SECTION("rethrows the exception of an analysis")
+   {
+      const ThrowingMirAudioReader throwingReader;
+      AnalysisQueue queue;
+      queue.Add(inputs[0]);
+      queue.Add({ throwingReader, "loop" });
+      REQUIRE_THROWS_AS(queue.Wait({}), std::runtime_error);
+      REQUIRE(queue.Size() == 0);
+   }
+
+   SECTION("cancels when the progress callback throws")
+   {
+      struct Cancelled
+      {
+      };
+      AnalysisQueue queue;
+      for (const auto& input : inputs)
+         queue.Add(input);
+      REQUIRE_THROWS_AS(
+         queue.Wait([](double) { throw Cancelled {}; }), Cancelled);
+      REQUIRE(queue.Size() == 0);
+
+      // The queue is usable again
+      queue.Add(inputs[4]);
+      const auto results = queue.Wait({});
+      REQUIRE(results.size() == 1);
+      REQUIRE(results[0].has_value());
+      REQUIRE(results[0]->rawAudioTempo == 128);
+   }
+
+   SECTION("may be destroyed without waiting")
+   {
+      AnalysisQueue queue;
+      for (const auto& input : inputs)
+         queue.Add(input);
+   }
+}
+} // namespace MIR
@@ -0,0 +1,258 @@
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AutoSaveChain.cpp
+
+**********************************************************************/
+
+#include "AutoSaveChain.h"
+
+#include <algorithm>
+#include <cstring>
+
+// The layout of a base is:
+//
+//    size of the base data      8 bytes
+//    hash of the base data      8 bytes
+//    segment count              4 bytes
+//    segment sizes              8 bytes each
+//
+// A link is:
+//
+//    segment count              4 bytes
+//    then for each segment, either
+//       SameSegment             1 byte
+//       index in previous       4 bytes
+//    or
+//       NewSegment              1 byte
+//       size                    8 bytes
+//       contents
+//
+// Numbers are in native byte order, as in ProjectSerializer, because the
+// chain is only replayed for recovery on the same machine.
+
+namespace {
+enum : uint8_t {
+   SameSegment,
+   NewSegment,
+};
+
+template<typename T> void Append(MemoryStream &stream, T value)
+{
+   stream.AppendData(&value, sizeof(value));
+}
+
+//! Bounds-checked reading of a layout or a link
+struct Reader {
+   const AutoSaveChain::Bytes &bytes;
+   size_t position{ 0 };
+
+   template<typename T> bool Read(T &value)
+   {
+      if (bytes.size() - position < sizeof(value))
+         return false;
+      memcpy(&value, bytes.data() + position, sizeof(value));
+      position += sizeof(value);
+      return true;
+   }
+
+   bool Read(AutoSaveChain::Bytes &value, uint64_t size)
+   {
+      if (bytes.size() - position < size)
+         return false;
+      const auto begin = bytes.begin() + position;
+      value.assign(begin, begin + size);
+      position += size;
+      return true;
+   }
+};
+}
+
+void AutoSaveChain::Reset()
+{
+   mSegments.clear();
+   mIndex.clear();
+   mLinks = 0;
+   mBaseBytes = 0;
+   mChainBytes = 0;
+}
+
+bool AutoSaveChain::IsEmpty() const
+{
+   return mSegments.empty();
+}
+
+size_t AutoSaveChain::GetLinks() const
+{
+   return mLinks;
+}
+
+size_t AutoSaveChain::GetBaseBytes() const
+{
+   return mBaseBytes;
+}
+
+size_t AutoSaveChain::GetChainBytes() const
+{
+   return mChainBytes;
+}
+
+MemoryStream AutoSaveChain::Rebase(
+   const void *data, size_t size, const Boundaries &boundaries)
+{
+   auto segments = Split(data, size, boundaries);
+
+   MemoryStream layout;
+   Append<uint64_t>(layout, size);
+   Append<uint64_t>(layout, Hash(data, size));
+   Append<uint32_t>(layout, segments.size());
+   std::vector<uint64_t> hashes;
+   hashes.reserve(segments.size());
+   for (const auto &segment : segments) {
+      Append<uint64_t>(layout, segment.size());
+      hashes.push_back(Hash(segment.data(), segment.size()));
+   }
+
+   Reset();
+   Adopt(move(segments), hashes);
+   mBaseBytes = size;
+   return layout;
+}
+
+MemoryStream AutoSaveChain::Link(
+   const void *data, size_t size, const Boundaries &boundaries,
+   size_t &changed)
+{
+   auto segments = Split(data, size, boundaries);
+
+   MemoryStream link;
+   changed = 0;
+   Append<uint32_t>(link, segments.size());
+   std::vector<uint64_t> hashes;
+   hashes.reserve(segments.size());
+   for (const auto &segment : segments) {
+      hashes.push_back(Hash(segment.data(), segment.size()));
+      const auto range = mIndex.equal_range(hashes.back());
+      const auto match = std::find_if(range.first, range.second,
+         [&](const auto &pair){ return mSegments[pair.second] == segment; });
+      if (match != range.second) {
+         Append<uint8_t>(link, SameSegment);
+         Append<uint32_t>(link, match->second);
+      }
+      else {
+         ++changed;
+         Append<uint8_t>(link, NewSegment);
+         Append<uint64_t>(link, segment.size());
+         link.AppendData(segment.data(), segment.size());
+      }
+   }
+
+   Adopt(move(segments), hashes);
+   ++mLinks;
+   mChainBytes += link.GetSize();
+   return link;
+}
+
+auto AutoSaveChain::Replay(const Bytes &base,
+   const Bytes &layout, const std::vector<Bytes> &links)
+   -> std::optional<Bytes>
+{
+   // Make segments of the base
+   Reader reader{ layout };
+   uint64_t size, hash;
+   uint32_t count;
+   if (!(reader.Read(size) && reader.Read(hash) && reader.Read(count)))
+      return {};
+   // The base might have been rewritten by another program that does not
+   // know about the chain
+   if (size != base.size() || hash != Hash(base.data(), base.size()))
+      return {};
+
+   Segments segments;
+   segments.reserve(count);
+   size_t position = 0;
+   for (uint32_t ii = 0; ii < count; ++ii) {
+      uint64_t segmentSize;
+      if (!reader.Read(segmentSize) || size - position < segmentSize)
+         return {};
+      const auto begin = base.begin() + position;
+      segments.emplace_back(begin, begin + segmentSize);
+      position += segmentSize;
+   }
+   if (position != size)
+      return {};
+
+   // Apply the links in order
+   for (const auto &bytes : links) {
+      Reader reader{ bytes };
+      if (!reader.Read(count))
+         return {};
+      Segments next;
+      next.reserve(count);
+      for (uint32_t ii = 0; ii < count; ++ii) {
+         uint8_t kind;
+         if (!reader.Read(kind))
+            return {};
+         if (kind == SameSegment) {
+            uint32_t index;
+            if (!reader.Read(index) || index >= segments.size())
+               return {};
+            next.push_back(segments[index]);
+         }
+         else if (kind == NewSegment) {
+            uint64_t segmentSize;
+            Bytes segment;
+            if (!(reader.Read(segmentSize) &&
+                  reader.Read(segment, segmentSize)))
+               return {};
+            next.push_back(move(segment));
+         }
+         else
+            return {};
+      }
+      segments.swap(next);
+   }
+
+   Bytes result;
+   for (const auto &segment : segments)
+      result.insert(result.end(), segment.begin(), segment.end());
+   return result;
+}
+
+auto AutoSaveChain::Split(
+   const void *data, size_t size, const Boundaries &boundaries) -> Segments
+{
+   const auto bytes = static_cast<const uint8_t *>(data);
+   Segments segments;
+   segments.reserve(boundaries.size() + 1);
+   size_t start = 0;
+   for (auto boundary : boundaries) {
+      boundary = std::clamp(boundary, start, size);
+      segments.emplace_back(bytes + start, bytes + boundary);
+      start = boundary;
+   }
+   segments.emplace_back(bytes + start, bytes + size);
+   return segments;
+}
+
+uint64_t AutoSaveChain::Hash(const void *data, size_t size)
+{
+   // FNV-1a, which is stable across builds, unlike std::hash
+   const auto bytes = static_cast<const uint8_t *>(data);
+   uint64_t hash = 14695981039346656037ULL;
+   for (size_t ii = 0; ii < size; ++ii) {
+      hash ^= bytes[ii];
+      hash *= 1099511628211ULL;
+   }
+   return hash;
+}
+
+void AutoSaveChain::Adopt(
+   Segments segments, const std::vector<uint64_t> &hashes)
+{
+   mSegments = move(segments);
+   mIndex.clear();
+   for (size_t ii = 0; ii < mSegments.size(); ++ii)
+      mIndex.emplace(hashes[ii], ii);
+}
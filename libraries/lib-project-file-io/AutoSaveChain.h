@@ -0,0 +1,89 @@
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AutoSaveChain.h
+  @brief Declare AutoSaveChain, which encodes autosave documents as deltas
+
+**********************************************************************/
+
+#ifndef __AUDACITY_AUTO_SAVE_CHAIN__
+#define __AUDACITY_AUTO_SAVE_CHAIN__
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "MemoryStream.h"
+
+//! Remembers the segments of the last written autosave document, so that the
+//! next one can be written as a delta that stores only changed segments
+/*!
+ The encoded document (the data, not the dictionary, of a ProjectSerializer)
+ is cut into segments at boundaries chosen by the writer:  the project
+ prologue, each track, and the epilogue.  A segment is matched by content,
+ so tracks may be reordered, added or removed.
+
+ A chain is a base document, with a layout that records its segment sizes,
+ followed by links that each describe the next document in terms of the
+ segments of the previous one.
+ */
+class PROJECT_FILE_IO_API AutoSaveChain final
+{
+public:
+   using Bytes = std::vector<uint8_t>;
+   using Boundaries = std::vector<size_t>;
+
+   //! Forget the segments; the next document must be written as a base
+   void Reset();
+
+   bool IsEmpty() const;
+
+   //! Number of links written since the base
+   size_t GetLinks() const;
+   size_t GetBaseBytes() const;
+   //! Total size of the links written since the base
+   size_t GetChainBytes() const;
+
+   //! Start a new chain; returns the encoded layout of the base document
+   /*!
+    @param boundaries offsets in increasing order where segments begin,
+    besides 0
+    */
+   MemoryStream Rebase(
+      const void *data, size_t size, const Boundaries &boundaries);
+
+   //! Describe the document relative to the previous one, then adopt it
+   /*!
+    @pre `!IsEmpty()`
+    @param[out] changed how many segments the link stores
+    */
+   MemoryStream Link(
+      const void *data, size_t size, const Boundaries &boundaries,
+      size_t &changed);
+
+   //! Reconstruct the data of the last document of a chain
+   /*!
+    @return nullopt if the layout does not describe this base, or a link is
+    malformed
+    */
+   static std::optional<Bytes> Replay(const Bytes &base,
+      const Bytes &layout, const std::vector<Bytes> &links);
+
+private:
+   using Segments = std::vector<Bytes>;
+   static Segments Split(
+      const void *data, size_t size, const Boundaries &boundaries);
+   static uint64_t Hash(const void *data, size_t size);
+   void Adopt(Segments segments, const std::vector<uint64_t> &hashes);
+
+   Segments mSegments;
+   //! From hash of contents to indices into mSegments
+   std::unordered_multimap<uint64_t, size_t> mIndex;
+   size_t mLinks{ 0 };
+   size_t mBaseBytes{ 0 };
+   size_t mChainBytes{ 0 };
+};
+
+#endif
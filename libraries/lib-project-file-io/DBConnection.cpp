@@ -13,6 +13,7 @@ Paul Licameli -- split from ProjectFileIO.cpp
 
 #include "sqlite3.h"
 
+#include <algorithm>
 #include <wx/string.h>
 
 #include "AudacityLogger.h"
@@ -29,10 +30,16 @@ Paul Licameli -- split from ProjectFileIO.cpp
 #define xstr(a) str(a)
 #define str(a) #a
 
+// Also lets new project files release free pages in place, without copying
 static const char* PageSizeConfig =
    "PRAGMA <schema>.page_size = " xstr(AUDACITY_PROJECT_PAGE_SIZE) ";"
+   "PRAGMA <schema>.auto_vacuum = INCREMENTAL;"
    "VACUUM;";
 
+// Pages released by each statement of the background vacuum, between which
+// other connections may write
+static constexpr int64_t VacuumStepPages = 16;
+
 // Configuration to provide "safe" connections
 static const char* SafeConfig =
    "PRAGMA <schema>.busy_timeout = 5000;"
@@ -48,6 +55,8 @@ static const char *FastConfig =
    "PRAGMA <schema>.synchronous = OFF;"
    "PRAGMA <schema>.journal_mode = OFF;";
 
+IntSetting ProjectMmapSize{ L"/Performance/ProjectMmapSize", 0 };
+
 DBConnection::DBConnection(
    const std::weak_ptr<AudacityProject> &pProject,
    const std::shared_ptr<DBConnectionErrors> &pErrors,
@@ -148,6 +157,7 @@ int DBConnection::Open(const FilePath fileName)
    mCheckpointStop = false;
    mCheckpointPending = false;
    mCheckpointActive = false;
+   mVacuumPages = 0;
    rc = OpenStepByStep( fileName );
    if ( rc != SQLITE_OK)
    {
@@ -202,6 +212,20 @@ int DBConnection::OpenStepByStep(const FilePath fileName)
       return rc;
    }
 
+   // Not fatal; reads then go through the ordinary file I/O
+   SetMmapSize();
+
+   {
+      sqlite3_stmt *stmt = nullptr;
+      auto finalizer = finally([&stmt] { sqlite3_finalize(stmt); });
+      mIncrementalVacuum =
+         sqlite3_prepare_v2(
+            mDB, "PRAGMA main.auto_vacuum;", -1, &stmt, nullptr) == SQLITE_OK &&
+         sqlite3_step(stmt) == SQLITE_ROW &&
+         // 2 means INCREMENTAL
+         sqlite3_column_int(stmt, 0) == 2;
+   }
+
    rc = sqlite3_open(name, &mCheckpointDB);
    if (rc != SQLITE_OK)
    {
@@ -272,9 +296,10 @@ bool DBConnection::Close()
       }
    }
 
-   // Tell the checkpoint thread to shutdown
+   // Tell the checkpoint thread to shutdown, abandoning any vacuuming
    {
       std::lock_guard<std::mutex> guard(mCheckpointMutex);
+      mVacuumPages = 0;
       mCheckpointStop = true;
       mCheckpointCondition.notify_one();
    }
@@ -362,6 +387,70 @@ int DBConnection::FastMode(const char *schema /* = "main" */)
    return ModeConfig(mDB, schema, FastConfig);
 }
 
+int DBConnection::SetMmapSize(const char *schema /* = "main" */)
+{
+   const auto megabytes = std::max(0, ProjectMmapSize.Read());
+   const auto config = wxString::Format(
+      "PRAGMA <schema>.mmap_size = %lld;",
+      static_cast<long long>(megabytes) * 1024 * 1024);
+   int rc = ModeConfig(mDB, schema, config.ToUTF8());
+   if (rc != SQLITE_OK || megabytes == 0)
+      return rc;
+
+   // The library may be compiled with a smaller limit, or without mmap
+   // support at all, so read back what it really does
+   wxString sql = "PRAGMA <schema>.mmap_size;";
+   sql.Replace(wxT("<schema>"), schema);
+   sqlite3_stmt *stmt = nullptr;
+   bool mapped = false;
+   rc = sqlite3_prepare_v2(mDB, sql.ToUTF8(), -1, &stmt, nullptr);
+   if (rc == SQLITE_OK)
+   {
+      auto finalizer = finally([&stmt] { sqlite3_finalize(stmt); });
+      if (sqlite3_step(stmt) == SQLITE_ROW)
+         mapped = sqlite3_column_int64(stmt, 0) > 0;
+   }
+
+   wxLogMessage("Memory-mapped reads %s for %s",
+      mapped ? "enabled" : "unavailable",
+      sqlite3_db_filename(mDB, nullptr));
+
+   return rc;
+}
+
+bool DBConnection::IsIncrementallyVacuumed() const
+{
+   return mIncrementalVacuum;
+}
+
+int64_t DBConnection::GetFreePages()
+{
+   sqlite3_stmt *stmt = nullptr;
+   auto finalizer = finally([&stmt] { sqlite3_finalize(stmt); });
+   if (sqlite3_prepare_v2(
+         mDB, "PRAGMA main.freelist_count;", -1, &stmt, nullptr) == SQLITE_OK &&
+       sqlite3_step(stmt) == SQLITE_ROW)
+      return sqlite3_column_int64(stmt, 0);
+   return 0;
+}
+
+void DBConnection::RequestVacuum(
+   int64_t pages, std::chrono::milliseconds budget)
+{
+   if (!mIncrementalVacuum)
+      return;
+
+   std::lock_guard<std::mutex> guard(mCheckpointMutex);
+   mVacuumBudget = budget;
+   mVacuumPages = std::max<int64_t>(0, pages);
+   mCheckpointCondition.notify_one();
+}
+
+bool DBConnection::IsVacuuming() const
+{
+   return mVacuumPages > 0;
+}
+
 int DBConnection::SetPageSize(const char* schema)
 {
    // First of all - let's check if the database is empty.
@@ -503,7 +592,9 @@ void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
          mCheckpointCondition.wait(lock,
                                    [&]
                                    {
-                                      return mCheckpointPending || mCheckpointStop;
+                                      return mCheckpointPending ||
+                                         mVacuumPages > 0 ||
+                                         mCheckpointStop;
                                    });
 
          // Requested to stop, so bail
@@ -512,6 +603,18 @@ void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
             break;
          }
 
+         // Checkpoints take precedence
+         if (!mCheckpointPending)
+         {
+            const auto budget = mVacuumBudget;
+            lock.unlock();
+            if (!giveUp)
+               Vacuum(db, fileName, budget);
+            else
+               mVacuumPages = 0;
+            continue;
+         }
+
          // Capture the number of pages that need checkpointing and reset
          mCheckpointActive = true;
          mCheckpointPending = false;
@@ -584,6 +687,54 @@ void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
    return;
 }
 
+void DBConnection::Vacuum(sqlite3 *db, const FilePath &fileName,
+   std::chrono::milliseconds budget)
+{
+   using namespace std::chrono;
+   const auto deadline = steady_clock::now() + budget;
+
+   // Release free pages a few at a time, so that writers in the main thread
+   // or the recording thread wait for one short transaction at most
+   int rc = SQLITE_OK;
+   while (mVacuumPages > 0 && !mCheckpointStop && !mCheckpointPending &&
+          steady_clock::now() < deadline)
+   {
+      const auto pages = std::min<int64_t>(mVacuumPages, VacuumStepPages);
+      const auto sql = wxString::Format(
+         "PRAGMA main.incremental_vacuum(%lld);", static_cast<long long>(pages));
+      rc = sqlite3_exec(db, sql.ToUTF8(), nullptr, nullptr, nullptr);
+      if (rc != SQLITE_OK)
+         break;
+
+      // Don't go below zero if cancelled meanwhile
+      auto remaining = mVacuumPages.load();
+      while (remaining > 0 && !mVacuumPages.compare_exchange_weak(
+         remaining, std::max<int64_t>(0, remaining - pages)))
+         ;
+   }
+
+   if (rc != SQLITE_OK && rc != SQLITE_BUSY)
+   {
+      // Not an emergency; the pages stay free within the file
+      wxLogMessage("Failed incremental vacuum of %s\n"
+                   "\tErrCode: %d\n"
+                   "\tErrMsg: %s",
+                   fileName,
+                   sqlite3_errcode(db),
+                   sqlite3_errmsg(db));
+      mVacuumPages = 0;
+   }
+
+   // Vacuuming commits on this connection don't invoke the hook installed on
+   // the primary connection.  The file shrinks when the frames are copied.
+   sqlite3_wal_checkpoint_v2(
+      db, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+
+   // Wait for another request, if the budget ran out
+   if (steady_clock::now() >= deadline)
+      mVacuumPages = 0;
+}
+
 int DBConnection::CheckpointHook(void *data, sqlite3 *db, const char *schema, int pages)
 {
    // Get access to our object
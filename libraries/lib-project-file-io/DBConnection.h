@@ -13,6 +13,7 @@ Paul Licameli -- split from ProjectFileIO.h
 #define __AUDACITY_DB_CONNECTION__
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <map>
@@ -22,12 +23,19 @@ Paul Licameli -- split from ProjectFileIO.h
 
 #include "ClientData.h"
 #include "Identifier.h"
+#include "Prefs.h"
 
 struct sqlite3;
 struct sqlite3_stmt;
 class wxString;
 class AudacityProject;
 
+//! Megabytes of each project file that sqlite may map into memory for
+//! reading; zero, the default, disables
+/*! Opt-in, because an I/O error in mapped memory, as on removable or network
+ storage, raises a signal instead of an error that sqlite can report */
+extern PROJECT_FILE_IO_API IntSetting ProjectMmapSize;
+
 struct DBConnectionErrors
 {
    TranslatableString mLastError;
@@ -62,6 +70,20 @@ public:
    int SafeMode(const char *schema = "main");
    int FastMode(const char* schema = "main");
    int SetPageSize(const char* schema = "main");
+   //! Apply ProjectMmapSize; failure leaves the ordinary reads in use
+   int SetMmapSize(const char *schema = "main");
+
+   //! Whether the file can release free pages without being copied
+   /*! True for files created with auto_vacuum = INCREMENTAL */
+   bool IsIncrementallyVacuumed() const;
+   //! Number of unused pages in the main schema
+   int64_t GetFreePages();
+   //! Ask the background thread to release up to the given number of free
+   //! pages, spending no more than the budget, or until Close()
+   /*! Replaces any previous request.  Does nothing if
+    `!IsIncrementallyVacuumed()` */
+   void RequestVacuum(int64_t pages, std::chrono::milliseconds budget);
+   bool IsVacuuming() const;
 
    bool Assign(sqlite3 *handle);
    sqlite3 *Detach();
@@ -104,6 +126,9 @@ private:
    int ModeConfig(sqlite3 *db, const char *schema, const char *config);
 
    void CheckpointThread(sqlite3 *db, const FilePath &fileName);
+   //! Called in the checkpoint thread
+   void Vacuum(sqlite3 *db, const FilePath &fileName,
+      std::chrono::milliseconds budget);
    static int CheckpointHook(void *data, sqlite3 *db, const char *schema, int pages);
 
 private:
@@ -118,6 +143,12 @@ private:
    std::atomic_bool mCheckpointPending{ false };
    std::atomic_bool mCheckpointActive{ false };
 
+   // Pages that the checkpoint thread should still release
+   std::atomic<int64_t> mVacuumPages{ 0 };
+   // Guarded by mCheckpointMutex
+   std::chrono::milliseconds mVacuumBudget{ 0 };
+   bool mIncrementalVacuum{ false };
+
    std::mutex mStatementMutex;
    using StatementIndex = std::pair<enum StatementID, std::thread::id>;
    std::map<StatementIndex, sqlite3_stmt *> mStatements;
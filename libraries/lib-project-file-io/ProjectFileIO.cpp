@@ -11,9 +11,11 @@ Paul Licameli split from AudacityProject.cpp
 #include "ProjectFileIO.h"
 
 #include <atomic>
+#include <chrono>
 #include <sqlite3.h>
 #include <optional>
 #include <cstring>
+#include <limits>
 
 #include <wx/crt.h>
 #include <wx/log.h>
@@ -31,6 +33,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "ProjectSerializer.h"
 #include "FileNames.h"
 #include "SampleBlock.h"
+#include "SampleBlockCompression.h"
 #include "TempDirectory.h"
 #include "TransactionScope.h"
 #include "WaveTrack.h"
@@ -167,6 +170,33 @@ static const char *ProjectFileSchema =
    "  samples              BLOB"
    ");";
 
+// CREATE SQL autosavedelta
+// Created on demand, so that project files that never autosaved incrementally
+// are unchanged.
+// Row 0 describes the segments of the document in the autosave table.
+// Each following row, in order of id, describes the next document as a delta
+// from the previous one (see AutoSaveChain), and has the names that were
+// added to the dictionary since the previous row.
+static const char *AutoSaveChainSchema =
+   "CREATE TABLE IF NOT EXISTS main.autosavedelta"
+   "("
+   "  id                   INTEGER PRIMARY KEY,"
+   "  dict                 BLOB,"
+   "  doc                  BLOB"
+   ");";
+
+// The chain is compacted into a new base document when it has this many
+// links, or when it becomes larger than the base
+static constexpr size_t MaxAutoSaveLinks = 64;
+
+IntSetting OnlineCompactionBudget{ L"/Performance/OnlineCompactionBudget", 20 };
+
+// Background compaction examines this many block ids per statement
+static constexpr SampleBlockID OrphanScanRange = 1024;
+
+// And begins a new search for orphans no sooner than this after the last
+static constexpr auto OrphanScanInterval = std::chrono::seconds{ 60 };
+
 
 class SQLiteBlobStream final
 {
@@ -372,6 +402,47 @@ protected:
 
 constexpr std::array<const char*, 2> BufferedProjectBlobStream::Columns;
 
+// Reads a document that was assembled in memory
+class BufferedBytesStream final : public BufferedStreamReader
+{
+public:
+   explicit BufferedBytesStream(const AutoSaveChain::Bytes &bytes)
+       : BufferedStreamReader(32 * 1024)
+       , mBytes(bytes)
+   {
+   }
+
+protected:
+   bool HasMoreData() const override
+   {
+      return mPosition < mBytes.size();
+   }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      maxBytes = std::min(maxBytes, mBytes.size() - mPosition);
+      memcpy(buffer, mBytes.data() + mPosition, maxBytes);
+      mPosition += maxBytes;
+      return maxBytes;
+   }
+
+private:
+   const AutoSaveChain::Bytes &mBytes;
+   size_t mPosition{ 0 };
+};
+
+// Whether the table of autosave deltas exists
+static bool HasAutoSaveChain(sqlite3 *db)
+{
+   sqlite3_stmt *stmt = nullptr;
+   auto finalizer = finally([&stmt]{ sqlite3_finalize(stmt); });
+   return sqlite3_prepare_v2(db,
+         "SELECT 1 FROM main.sqlite_master"
+         "  WHERE type = 'table' AND name = 'autosavedelta';",
+         -1, &stmt, nullptr) == SQLITE_OK &&
+      sqlite3_step(stmt) == SQLITE_ROW;
+}
+
 bool ProjectFileIO::InitializeSQL()
 {
    if (audacity::sqlite::Initialize().IsError())
@@ -536,6 +607,7 @@ bool ProjectFileIO::OpenConnection(FilePath fileName /* = {}  */)
    }
 
    mTemporary = isTemp;
+   mAutoSaveChain.Reset();
 
    SetFileName(fileName);
 
@@ -553,6 +625,7 @@ bool ProjectFileIO::CloseConnection()
       return false;
    }
    curConn.reset();
+   mAutoSaveChain.Reset();
 
    SetFileName({});
 
@@ -569,6 +642,7 @@ void ProjectFileIO::SaveConnection()
    mPrevConn = std::move(CurrConn());
    mPrevFileName = mFileName;
    mPrevTemporary = mTemporary;
+   mAutoSaveChain.Reset();
 
    SetFileName({});
 }
@@ -625,6 +699,7 @@ void ProjectFileIO::RestoreConnection()
    curConn = std::move(mPrevConn);
    SetFileName(mPrevFileName);
    mTemporary = mPrevTemporary;
+   mAutoSaveChain.Reset();
 
    mPrevFileName.clear();
 }
@@ -636,6 +711,7 @@ void ProjectFileIO::UseConnection(Connection &&conn, const FilePath &filePath)
 
    curConn = std::move(conn);
    SetFileName(filePath);
+   mAutoSaveChain.Reset();
 }
 
 static int ExecCallback(void *data, int cols, char **vals, char **names)
@@ -837,6 +913,14 @@ void ProjectFileIO::InSet(sqlite3_context *context, int argc, sqlite3_value **ar
 }
 
 bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement)
+{
+   return DeleteBlocks(blockids, complement,
+      std::numeric_limits<SampleBlockID>::min(),
+      std::numeric_limits<SampleBlockID>::max());
+}
+
+bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement,
+   SampleBlockID first, SampleBlockID last)
 {
    auto db = DB();
    int rc;
@@ -865,8 +949,10 @@ bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement)
    // This is the first command that writes to the database, and so we
    // do more informative error reporting than usual, if it fails.
    auto sql = wxString::Format(
-      "DELETE FROM sampleblocks WHERE %sinset(blockid);",
-      complement ? "NOT " : "" );
+      "DELETE FROM sampleblocks WHERE %sinset(blockid)"
+      " AND blockid BETWEEN %lld AND %lld;",
+      complement ? "NOT " : "",
+      static_cast<long long>(first), static_cast<long long>(last) );
    rc = sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
    if (rc != SQLITE_OK)
    {
@@ -1020,6 +1106,11 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
       return false;
    }
 
+   // Let the copy release unused pages without another copying; this must
+   // precede the creation of any table.  Not fatal, if it fails.
+   (void) sqlite3_exec(db, "PRAGMA outbound.auto_vacuum = INCREMENTAL;",
+      nullptr, nullptr, nullptr);
+
    // Ensure attached DB connection gets configured
    //
    // NOTE:  Between the above attach and setting the mode here, a normal DELETE
@@ -1415,6 +1506,21 @@ void ProjectFileIO::Compact(
    // at project close time will still occur.
    mHadUnused = true;
 
+   // A file that can release pages in place needs no copying, unless forced
+   if (!force && !IsTemporary() && !tracks.empty() &&
+       GetConnection().IsIncrementallyVacuumed())
+   {
+      if (CompactInPlace(tracks))
+      {
+         // Like a copying compaction, the file no longer has the blocks that
+         // other sample block objects in memory might try to delete
+         mHadUnused = false;
+         mWasCompacted = true;
+         return;
+      }
+      // Else fall through to the usual compaction
+   }
+
    // If forcing compaction, bypass inspection.
    if (!force)
    {
@@ -1538,6 +1644,107 @@ void ProjectFileIO::Compact(
    return;
 }
 
+bool ProjectFileIO::CompactInPlace(
+   const std::vector<const TrackList *> &tracks)
+{
+   // Commit any blocks still waiting for insertion, before deciding what is
+   // unused
+   (void) WaveTrackFactory::Get(mProject).GetSampleBlockFactory()
+      ->GetActiveBlockIDs();
+
+   BlockIDs used;
+   for (auto pTracks : tracks)
+      if (pTracks)
+         WaveTrackUtilities::InspectBlocks(*pTracks, {}, &used);
+
+   // Deleting blocks that are unused at close is not a recovery
+   const auto recovered = mRecovered;
+   const auto deleted = DeleteBlocks(used, true);
+   mRecovered = recovered;
+   if (!deleted)
+      return false;
+
+   if (IsModified())
+      // As in Compact()
+      (void) AutoSaveDelete();
+
+   // Release all free pages; the checkpoint at close then shrinks the file
+   if (!Query("PRAGMA main.incremental_vacuum;", [](auto...) { return 0; }))
+      return false;
+
+   wxLogDebug(wxT("compacted in place"));
+   return true;
+}
+
+void ProjectFileIO::CompactIncrementally()
+{
+   using namespace std::chrono;
+
+   const auto budget = milliseconds{ OnlineCompactionBudget.Read() };
+   if (budget <= milliseconds::zero() || !HasConnection())
+      return;
+
+   GuardedCall([&]{
+      const auto deadline = steady_clock::now() + budget;
+      auto &conn = GetConnection();
+
+      // Begin a new search for orphans, at most once in an interval
+      const auto now = steady_clock::now();
+      if (mOrphanScanNext > mOrphanScanEnd &&
+          now - mOrphanScanStart >= OrphanScanInterval)
+      {
+         int64_t end = 0;
+         if (!GetValue("SELECT COALESCE(MAX(blockid), 0) FROM sampleblocks;",
+               end, true))
+            end = 0;
+         // Ids are never reused, so any block with an id up to the end and
+         // not in this snapshot is orphaned, even after later edits
+         mOrphanScanActive = WaveTrackFactory::Get(mProject)
+            .GetSampleBlockFactory()->GetActiveBlockIDs();
+         mOrphanScanNext = 1;
+         mOrphanScanEnd = end;
+         mOrphanScanStart = now;
+      }
+
+      // Delete orphans a range at a time in this thread, where block locks
+      // of the extensions may be checked
+      while (mOrphanScanNext <= mOrphanScanEnd &&
+             steady_clock::now() < deadline)
+      {
+         const auto last = std::min(
+            mOrphanScanEnd, mOrphanScanNext + OrphanScanRange - 1);
+         // Orphans found while editing don't make the project recovered
+         const auto recovered = mRecovered;
+         const auto deleted =
+            DeleteBlocks(mOrphanScanActive, true, mOrphanScanNext, last);
+         mRecovered = recovered;
+         if (!deleted)
+         {
+            // Try again at the next interval
+            mOrphanScanNext = mOrphanScanEnd + 1;
+            break;
+         }
+         mOrphanScanNext = last + 1;
+      }
+      if (mOrphanScanNext > mOrphanScanEnd)
+         mOrphanScanActive.clear();
+
+      // Then release free pages in the checkpoint thread, for the rest of
+      // the budget
+      const auto remaining =
+         duration_cast<milliseconds>(deadline - steady_clock::now());
+      if (remaining > milliseconds::zero() && !conn.IsVacuuming())
+      {
+         if (const auto pages = conn.GetFreePages(); pages > 0)
+            conn.RequestVacuum(pages, remaining);
+      }
+   },
+   MakeSimpleGuard(),
+   // Not worth a message; the next step or the compaction at close will
+   // meet any persistent error
+   [](AudacityException *){});
+}
+
 bool ProjectFileIO::WasCompacted()
 {
    return mWasCompacted;
@@ -1618,6 +1825,12 @@ void ProjectFileIO::SetFileName(const FilePath &fileName)
 
    mFileName = fileName;
 
+   // The search for orphans starts over in another database
+   mOrphanScanActive.clear();
+   mOrphanScanNext = 1;
+   mOrphanScanEnd = 0;
+   mOrphanScanStart = {};
+
    if (!mFileName.empty())
    {
       ActiveProjects::Add(mFileName);
@@ -1744,7 +1957,8 @@ void ProjectFileIO::WriteXMLHeader(XMLWriter &xmlFile) const
 
 void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
                              bool recording /* = false */,
-                             const TrackList *tracks /* = nullptr */)
+                             const TrackList *tracks /* = nullptr */,
+                             const std::function<void()> &onSegment /* = {} */)
 // may throw
 {
    auto &proj = mProject;
@@ -1777,9 +1991,13 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
          // when pushing.  Don't auto-save it.
          return;
       }
+      if (onSegment)
+         onSegment();
       useTrack->WriteXML(xmlFile);
    });
 
+   if (onSegment)
+      onSegment();
    xmlFile.EndTag(wxT("project"));
 
    //TIMER_STOP( xml_writer_timer );
@@ -1787,17 +2005,242 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
 
 bool ProjectFileIO::AutoSave(bool recording)
 {
+   using namespace std::chrono;
+   const auto start = steady_clock::now();
+
    ProjectSerializer autosave;
+   AutoSaveChain::Boundaries boundaries;
    WriteXMLHeader(autosave);
-   WriteXML(autosave, recording);
+   WriteXML(autosave, recording, nullptr,
+      [&]{ boundaries.push_back(autosave.GetData().GetSize()); });
+
+   AutoSaveStatistics statistics;
+   statistics.segments = boundaries.size() + 1;
+   statistics.documentBytes =
+      autosave.GetDict().GetSize() + autosave.GetData().GetSize();
+   statistics.serializeSeconds =
+      duration<double>(steady_clock::now() - start).count();
+
+   // Serializing is cheap compared with rewriting the whole document in the
+   // database, so compare all segments, and write only the changed ones
+   const bool compact = mAutoSaveChain.IsEmpty() ||
+      mAutoSaveChain.GetLinks() >= MaxAutoSaveLinks ||
+      mAutoSaveChain.GetChainBytes() > mAutoSaveChain.GetBaseBytes();
+   bool success;
+   if (compact)
+   {
+      success = WriteAutoSaveBase(autosave, boundaries);
+      statistics.bytes = statistics.documentBytes;
+      statistics.written = statistics.segments;
+      statistics.compacted = true;
+   }
+   else
+      success = WriteAutoSaveLink(
+         autosave, boundaries, statistics.bytes, statistics.written);
 
-   if (WriteDoc("autosave", autosave))
+   if (!success)
    {
-      mModified = true;
-      return true;
+      // The database may not have what the chain remembers
+      mAutoSaveChain.Reset();
+      return false;
+   }
+
+   mModified = true;
+
+   statistics.seconds =
+      duration<double>(steady_clock::now() - start).count();
+   mAutoSaveStatistics = statistics;
+   wxLogDebug("AutoSave wrote %llu of %llu bytes, %llu of %llu segments%s, "
+      "in %.1f ms, %.1f ms of it serializing",
+      static_cast<unsigned long long>(statistics.bytes),
+      static_cast<unsigned long long>(statistics.documentBytes),
+      static_cast<unsigned long long>(statistics.written),
+      static_cast<unsigned long long>(statistics.segments),
+      statistics.compacted ? " (compacted)" : "",
+      statistics.seconds * 1000, statistics.serializeSeconds * 1000);
+
+   return true;
+}
+
+auto ProjectFileIO::GetAutoSaveStatistics() const
+   -> const AutoSaveStatistics &
+{
+   return mAutoSaveStatistics;
+}
+
+bool ProjectFileIO::WriteAutoSaveBase(const ProjectSerializer &autosave,
+   const AutoSaveChain::Boundaries &boundaries)
+{
+   TransactionScope transaction(mProject, "AutoSave");
+
+   if (!Query(AutoSaveChainSchema, [](auto...) { return 0; }) ||
+       !Query("DELETE FROM main.autosavedelta;", [](auto...) { return 0; }))
+      return false;
+
+   const auto &dict = autosave.GetDict();
+   const auto &data = autosave.GetData();
+   if (!WriteDoc("autosave", dict, data))
+      return false;
+
+   const auto layout =
+      mAutoSaveChain.Rebase(data.GetData(), data.GetSize(), boundaries);
+   if (!InsertAutoSaveLink(0, nullptr, 0, layout))
+      return false;
+
+   mAutoSaveDictSize = dict.GetSize();
+   return transaction.Commit();
+}
+
+bool ProjectFileIO::WriteAutoSaveLink(const ProjectSerializer &autosave,
+   const AutoSaveChain::Boundaries &boundaries, size_t &bytes,
+   size_t &written)
+{
+   const auto &dict = autosave.GetDict();
+   const auto &data = autosave.GetData();
+   const auto link = mAutoSaveChain.Link(
+      data.GetData(), data.GetSize(), boundaries, written);
+
+   // The dictionary only grows; store only the new names
+   const auto dictSize = dict.GetSize() - mAutoSaveDictSize;
+   const auto dictData =
+      static_cast<const char *>(dict.GetData()) + mAutoSaveDictSize;
+   if (!InsertAutoSaveLink(
+      mAutoSaveChain.GetLinks(), dictData, dictSize, link))
+      return false;
+
+   mAutoSaveDictSize = dict.GetSize();
+   bytes = dictSize + link.GetSize();
+   return true;
+}
+
+bool ProjectFileIO::InsertAutoSaveLink(size_t id,
+   const void *dict, size_t dictSize, const MemoryStream &doc)
+{
+   auto db = DB();
+
+   const char *sql =
+      "INSERT INTO main.autosavedelta(id, dict, doc) VALUES(?1, ?2, ?3);";
+
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&stmt]{ sqlite3_finalize(stmt); });
+
+   int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT(
+         "sqlite3.context", "ProjectFileIO::InsertAutoSaveLink::prepare");
+
+      SetDBError(
+         XO("Unable to prepare project file command:\n\n%s").Format(sql)
+      );
+      return false;
    }
 
-   return false;
+   // A zero-length, not null, blob when there are no new names
+   if (sqlite3_bind_int64(stmt, 1, id) ||
+       sqlite3_bind_blob64(stmt, 2, dictSize ? dict : "", dictSize,
+          SQLITE_STATIC) ||
+       sqlite3_bind_blob64(stmt, 3, doc.GetData(), doc.GetSize(),
+          SQLITE_STATIC))
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT(
+         "sqlite3.context", "ProjectFileIO::InsertAutoSaveLink::bind");
+
+      SetDBError(XO("Unable to bind to blob"));
+      return false;
+   }
+
+   rc = sqlite3_step(stmt);
+   if (rc != SQLITE_DONE)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT(
+         "sqlite3.context", "ProjectFileIO::InsertAutoSaveLink::step");
+
+      SetDBError(
+         XO("Failed to update the project file.\nThe following command failed:\n\n%s")
+            .Format(sql));
+      return false;
+   }
+
+   return true;
+}
+
+std::optional<AutoSaveChain::Bytes> ProjectFileIO::ReplayAutoSave()
+{
+   auto db = DB();
+   if (!HasAutoSaveChain(db))
+      return {};
+
+   // Read all of one row of blobs, in order
+   const auto readRows = [db](const char *sql, size_t columns,
+      const std::function<void(std::vector<AutoSaveChain::Bytes>)> &consume)
+   {
+      sqlite3_stmt *stmt = nullptr;
+      auto cleanup = finally([&stmt]{ sqlite3_finalize(stmt); });
+      if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+         return false;
+      int rc;
+      while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+      {
+         std::vector<AutoSaveChain::Bytes> row;
+         for (size_t column = 0; column < columns; ++column)
+         {
+            const auto data = static_cast<const uint8_t *>(
+               sqlite3_column_blob(stmt, column));
+            const auto size = sqlite3_column_bytes(stmt, column);
+            row.emplace_back(data, data + (data ? size : 0));
+         }
+         consume(move(row));
+      }
+      return rc == SQLITE_DONE;
+   };
+
+   std::optional<AutoSaveChain::Bytes> layout;
+   AutoSaveChain::Bytes dictTail;
+   std::vector<AutoSaveChain::Bytes> links;
+   if (!readRows("SELECT dict, doc FROM main.autosavedelta ORDER BY id;", 2,
+      [&](std::vector<AutoSaveChain::Bytes> row){
+         if (!layout)
+            layout = move(row[1]);
+         else
+         {
+            dictTail.insert(dictTail.end(), row[0].begin(), row[0].end());
+            links.push_back(move(row[1]));
+         }
+      }))
+      return {};
+
+   // Without links, the base can be read directly
+   if (!layout || links.empty())
+      return {};
+
+   AutoSaveChain::Bytes dict, base;
+   if (!readRows("SELECT dict, doc FROM main.autosave WHERE id = 1;", 2,
+      [&](std::vector<AutoSaveChain::Bytes> row){
+         dict = move(row[0]);
+         base = move(row[1]);
+      }))
+      return {};
+
+   auto data = AutoSaveChain::Replay(base, *layout, links);
+   if (!data)
+   {
+      wxLogMessage("Ignoring autosave delta chain that does not match");
+      return {};
+   }
+
+   wxLogInfo("Replayed %llu autosave deltas",
+      static_cast<unsigned long long>(links.size()));
+
+   // Decoding reads the dictionary and document as one stream
+   dict.insert(dict.end(), dictTail.begin(), dictTail.end());
+   dict.insert(dict.end(), data->begin(), data->end());
+   return dict;
 }
 
 bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
@@ -1809,7 +2252,11 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
       db = DB();
    }
 
-   rc = sqlite3_exec(db, "DELETE FROM autosave;", nullptr, nullptr, nullptr);
+   rc = sqlite3_exec(db,
+      HasAutoSaveChain(db)
+         ? "DELETE FROM autosave; DELETE FROM autosavedelta;"
+         : "DELETE FROM autosave;",
+      nullptr, nullptr, nullptr);
    if (rc != SQLITE_OK)
    {
       ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
@@ -1822,6 +2269,8 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
    }
 
    mModified = false;
+   if (db == DB())
+      mAutoSaveChain.Reset();
 
    return true;
 }
@@ -1829,6 +2278,14 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
 bool ProjectFileIO::WriteDoc(const char *table,
                              const ProjectSerializer &autosave,
                              const char *schema /* = "main" */)
+{
+   return WriteDoc(table, autosave.GetDict(), autosave.GetData(), schema);
+}
+
+bool ProjectFileIO::WriteDoc(const char *table,
+                             const MemoryStream &dict,
+                             const MemoryStream &data,
+                             const char *schema /* = "main" */)
 {
    auto db = DB();
 
@@ -1867,9 +2324,6 @@ bool ProjectFileIO::WriteDoc(const char *table,
       return false;
    }
 
-   const MemoryStream& dict = autosave.GetDict();
-   const MemoryStream& data = autosave.GetData();
-
    // Bind statement parameters
    // Might return SQL_MISUSE which means it's our mistake that we violated
    // preconditions; should return SQL_OK which is 0
@@ -1973,8 +2427,16 @@ bool ProjectFileIO::WriteDoc(const char *table,
    if (!writeStream("doc", data))
       return false;
 
-   const wxString setVersionSql =
-      wxString::Format("PRAGMA user_version = %u", BaseProjectFormatVersion.GetPacked());
+   // Versions of Audacity without the codec must refuse a project that may
+   // have compressed sample blocks
+   const auto &compression = SampleBlockCompression::Get(mProject);
+   const auto version =
+      compression.IsEnabled() || compression.HasCompressedBlocks()
+         ? std::max(BaseProjectFormatVersion,
+            CompressedSampleBlocksProjectFormatVersion)
+         : BaseProjectFormatVersion;
+   const wxString setVersionSql = wxString::Format(
+      "PRAGMA %s.user_version = %u", schema, version.GetPacked());
 
    if (!Query(setVersionSql.c_str(), [](auto...) { return 0; }))
    {
@@ -2037,6 +2499,16 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
    if (!OpenConnection(fileName))
       return {};
 
+   // Saving must keep the version that can read compressed blocks, even if
+   // compression is no longer enabled
+   int64_t hasCompressed = 0;
+   const auto hasCompressedSql = wxString::Format(
+      "SELECT EXISTS(SELECT 1 FROM main.sampleblocks"
+      "  WHERE sampleformat & %d);", CompressedSampleFormatFlag);
+   if (GetValue(hasCompressedSql.c_str(), hasCompressed, true) &&
+       hasCompressed != 0)
+      SampleBlockCompression::Get(mProject).SetHasCompressedBlocks();
+
    int64_t rowId = -1;
 
    bool useAutosave =
@@ -2063,10 +2535,18 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
    else
    {
       // Load 'er up
-      BufferedProjectBlobStream stream(
-         DB(), "main", useAutosave ? "autosave" : "project", rowId);
-
-      success = ProjectSerializer::Decode(stream, this);
+      if (auto replayed = useAutosave
+         ? ReplayAutoSave() : std::optional<AutoSaveChain::Bytes>{})
+      {
+         BufferedBytesStream stream(*replayed);
+         success = ProjectSerializer::Decode(stream, this);
+      }
+      else
+      {
+         BufferedProjectBlobStream stream(
+            DB(), "main", useAutosave ? "autosave" : "project", rowId);
+         success = ProjectSerializer::Decode(stream, this);
+      }
 
       if (!success)
       {
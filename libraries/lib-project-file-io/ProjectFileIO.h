@@ -11,12 +11,15 @@ Paul Licameli split from AudacityProject.h
 #ifndef __AUDACITY_PROJECT_FILE_IO__
 #define __AUDACITY_PROJECT_FILE_IO__
 
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <unordered_set>
 
 #include <wx/event.h>
 
+#include "AutoSaveChain.h" // member variable
 #include "ClientData.h" // to inherit
 #include "Observer.h"
 #include "Prefs.h" // to inherit
@@ -46,6 +49,9 @@ using Connection = std::unique_ptr<DBConnection>;
 
 using BlockIDs = std::unordered_set<SampleBlockID>;
 
+//! Milliseconds of each step of background compaction; zero disables it
+extern PROJECT_FILE_IO_API IntSetting OnlineCompactionBudget;
+
 //! Subscribe to ProjectFileIO to receive messages; always in idle time
 enum class ProjectFileIOMessage : int {
    CheckpointFailure,   //!< Failure happened in a worker thread
@@ -110,9 +116,36 @@ public:
 
    void MarkTemporary();
 
+   //! Write the document of the project, as a delta from the last if it can
+   /*!
+    Only the changed segments are written, but the whole project is still
+    serialized on each call, to find them.  That remaining cost is
+    `serializeSeconds` of the statistics, in proportion to `documentBytes`.
+    The document holds the attributes of tracks and clips and one element
+    for each sample block, tens of bytes each, and no samples; so it grows
+    with the count of clips and blocks, not with the length of the audio.
+    */
    bool AutoSave(bool recording = false);
    bool AutoSaveDelete(sqlite3 *db = nullptr);
 
+   //! Measurements of the last successful AutoSave()
+   struct AutoSaveStatistics {
+      //! Bytes of dictionary and document written
+      size_t bytes{ 0 };
+      //! Bytes of dictionary and document serialized, written or not
+      size_t documentBytes{ 0 };
+      //! Segments of the document: the prologue, each track, the epilogue
+      size_t segments{ 0 };
+      //! Segments that were written, because they changed
+      size_t written{ 0 };
+      //! Whether the whole document was written, restarting the delta chain
+      bool compacted{ false };
+      //! Time to serialize the project, which is part of seconds
+      double serializeSeconds{ 0 };
+      double seconds{ 0 };
+   };
+   const AutoSaveStatistics &GetAutoSaveStatistics() const;
+
    bool OpenProject();
    void CloseProject();
    bool ReopenProject();
@@ -205,6 +238,14 @@ public:
    void Compact(
       const std::vector<const TrackList *> &tracks, bool force = false);
 
+   //! Release some unused space in the project file, within a time budget
+   /*!
+    Called periodically in the main thread when not recording.  Deletes a
+    range of orphan sample blocks, then lets the checkpoint thread release
+    free pages to the file system, if the file uses incremental vacuum.
+    */
+   void CompactIncrementally();
+
    // The last compact check did actually compact the project file if true
    bool WasCompacted();
 
@@ -215,6 +256,10 @@ public:
    // (when complement is true), with ids not in the given set.
    bool DeleteBlocks(const BlockIDs &blockids, bool complement);
 
+   //! Like the above, but only examine ids from first to last inclusive
+   bool DeleteBlocks(const BlockIDs &blockids, bool complement,
+      SampleBlockID first, SampleBlockID last);
+
    // Type of function that is given the fields of one row and returns
    // 0 for success or non-zero to stop the query
    using ExecCB = std::function<int(int cols, char **vals, char **names)>;
@@ -233,7 +278,9 @@ private:
 
    void WriteXMLHeader(XMLWriter &xmlFile) const;
    void WriteXML(XMLWriter &xmlFile, bool recording = false,
-      const TrackList *tracks = nullptr) /* not override */;
+      const TrackList *tracks = nullptr,
+      //! Called before each track and before the end of the project
+      const std::function<void()> &onSegment = {}) /* not override */;
 
    // XMLTagHandler callback methods
    bool HandleXMLTag(const std::string_view& tag, const AttributesList &attrs) override;
@@ -274,6 +321,22 @@ private:
 
    // Write project or autosave XML (binary) documents
    bool WriteDoc(const char *table, const ProjectSerializer &autosave, const char *schema = "main");
+   bool WriteDoc(const char *table,
+      const MemoryStream &dict, const MemoryStream &data,
+      const char *schema = "main");
+
+   // Write the whole autosave document, and restart the delta chain
+   bool WriteAutoSaveBase(const ProjectSerializer &autosave,
+      const AutoSaveChain::Boundaries &boundaries);
+   // Append a delta to the chain
+   bool WriteAutoSaveLink(const ProjectSerializer &autosave,
+      const AutoSaveChain::Boundaries &boundaries, size_t &bytes,
+      size_t &written);
+   bool InsertAutoSaveLink(size_t id,
+      const void *dict, size_t dictSize, const MemoryStream &doc);
+   // Dictionary and document of the autosave with the delta chain applied,
+   // or nullopt if there is no chain to apply
+   std::optional<AutoSaveChain::Bytes> ReplayAutoSave();
 
    // Application defined function to verify blockid exists is in set of blockids
    static void InSet(sqlite3_context *context, int argc, sqlite3_value **argv);
@@ -301,6 +364,10 @@ private:
 
    bool ShouldCompact(const std::vector<const TrackList *> &tracks);
 
+   //! Delete unused blocks and free pages without copying the file
+   /*! @pre the connection uses incremental vacuum */
+   bool CompactInPlace(const std::vector<const TrackList *> &tracks);
+
 private:
    Connection &CurrConn();
 
@@ -332,6 +399,18 @@ private:
    Connection mPrevConn;
    FilePath mPrevFileName;
    bool mPrevTemporary;
+
+   // Segments of the last autosave in the current connection
+   AutoSaveChain mAutoSaveChain;
+   // How much of ProjectSerializer's dictionary the chain has written
+   size_t mAutoSaveDictSize{ 0 };
+   AutoSaveStatistics mAutoSaveStatistics;
+
+   // State of the search for orphan blocks by CompactIncrementally()
+   BlockIDs mOrphanScanActive;
+   SampleBlockID mOrphanScanNext{ 1 };
+   SampleBlockID mOrphanScanEnd{ 0 };
+   std::chrono::steady_clock::time_point mOrphanScanStart{};
 };
 
 //! Makes a temporary project that doesn't display on the screen
@@ -0,0 +1,155 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SampleBlockCache.cpp
+
+**********************************************************************/
+
+#include "SampleBlockCache.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "Project.h"
+
+IntSetting SampleBlockCacheSize{ L"/Performance/SampleBlockCacheSize", 256 };
+
+static const AudacityProject::AttachedObjects::RegisteredFactory
+sSampleBlockCacheKey{
+   []( AudacityProject & ){
+      const auto megabytes = std::max(0, SampleBlockCacheSize.Read());
+      return std::make_shared< SampleBlockCache >(
+         static_cast<size_t>(megabytes) * 1024 * 1024);
+   }
+};
+
+SampleBlockCache &SampleBlockCache::Get( AudacityProject &project )
+{
+   return project.AttachedObjects::Get< SampleBlockCache >(
+      sSampleBlockCacheKey );
+}
+
+const SampleBlockCache &SampleBlockCache::Get( const AudacityProject &project )
+{
+   return Get( const_cast< AudacityProject & >( project ) );
+}
+
+size_t SampleBlockCache::KeyHash::operator ()(const Key &key) const
+{
+   return std::hash<SampleBlockID>{}(key.id) * 3 +
+      static_cast<size_t>(key.kind);
+}
+
+SampleBlockCache::SampleBlockCache(size_t budgetBytes)
+   : mBudget{ budgetBytes }
+{
+}
+
+SampleBlockCache::~SampleBlockCache() = default;
+
+auto SampleBlockCache::Find(SampleBlockID id, Kind kind) -> Data
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   const auto iter = mIndex.find({ id, kind });
+   if (iter == mIndex.end()) {
+      ++mStatistics.misses;
+      return {};
+   }
+   ++mStatistics.hits;
+   // Move to the front
+   mEntries.splice(mEntries.begin(), mEntries, iter->second);
+   return iter->second->data;
+}
+
+void SampleBlockCache::Insert(SampleBlockID id, Kind kind, Data data)
+{
+   if (!data)
+      return;
+
+   const auto bytes = SizeOf(data);
+   std::lock_guard<std::mutex> lock{ mMutex };
+   // Don't let one entry flush all the others
+   if (bytes > mBudget / 2)
+      return;
+
+   const Key key{ id, kind };
+   if (const auto iter = mIndex.find(key); iter != mIndex.end())
+      EraseEntry(iter->second);
+
+   mEntries.push_front({ key, std::move(data), bytes });
+   mIndex.emplace(key, mEntries.begin());
+   ++mStatistics.entries;
+   mStatistics.bytes += bytes;
+   Trim();
+}
+
+void SampleBlockCache::Erase(SampleBlockID id)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   for (auto kind : { Kind::Samples, Kind::Summary256, Kind::Summary64k })
+      if (const auto iter = mIndex.find({ id, kind }); iter != mIndex.end())
+         EraseEntry(iter->second);
+}
+
+void SampleBlockCache::Clear()
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mIndex.clear();
+   mEntries.clear();
+   mStatistics.entries = 0;
+   mStatistics.bytes = 0;
+}
+
+void SampleBlockCache::SetBudget(size_t budgetBytes)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mBudget = budgetBytes;
+   Trim();
+}
+
+size_t SampleBlockCache::GetBudget() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mBudget;
+}
+
+bool SampleBlockCache::IsEnabled() const
+{
+   return GetBudget() > 0;
+}
+
+auto SampleBlockCache::GetStatistics() const -> Statistics
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mStatistics;
+}
+
+void SampleBlockCache::ResetStatistics()
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mStatistics.hits = 0;
+   mStatistics.misses = 0;
+   mStatistics.evictions = 0;
+}
+
+size_t SampleBlockCache::SizeOf(const Data &data)
+{
+   return sizeof(Entry) + data->size() * sizeof(float);
+}
+
+void SampleBlockCache::EraseEntry(List::iterator iter)
+{
+   --mStatistics.entries;
+   mStatistics.bytes -= iter->bytes;
+   mIndex.erase(iter->key);
+   mEntries.erase(iter);
+}
+
+void SampleBlockCache::Trim()
+{
+   while (mStatistics.bytes > mBudget && !mEntries.empty()) {
+      EraseEntry(std::prev(mEntries.end()));
+      ++mStatistics.evictions;
+   }
+}
@@ -0,0 +1,116 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SampleBlockCache.h
+@brief Declare SampleBlockCache, a project-wide LRU cache of decoded sample
+block contents
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_BLOCK_CACHE__
+#define __AUDACITY_SAMPLE_BLOCK_CACHE__
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ClientData.h"
+#include "Prefs.h"
+
+class AudacityProject;
+
+using SampleBlockID = long long;
+
+//! Budget for decoded sample data of each project, in megabytes; zero disables
+extern PROJECT_FILE_IO_API IntSetting SampleBlockCacheSize;
+
+//! Least-recently-used cache of sample block contents converted to float
+/*!
+ Blocks with the same SampleBlockID may be shared by many tracks and undo
+ states, and their stored contents never change, so the decoded floats and
+ the summaries can be kept, up to a memory budget, after the last reader
+ drops them.
+
+ All member functions are thread-safe.
+ */
+class PROJECT_FILE_IO_API SampleBlockCache final : public ClientData::Base
+{
+public:
+   static SampleBlockCache &Get(AudacityProject &project);
+   static const SampleBlockCache &Get(const AudacityProject &project);
+
+   enum class Kind : unsigned char {
+      Samples,
+      Summary256,
+      Summary64k,
+   };
+
+   using Data = std::shared_ptr<std::vector<float>>;
+
+   struct Statistics {
+      uint64_t hits{ 0 };
+      uint64_t misses{ 0 };
+      uint64_t evictions{ 0 };
+      size_t entries{ 0 };
+      size_t bytes{ 0 };
+   };
+
+   explicit SampleBlockCache(size_t budgetBytes);
+   ~SampleBlockCache() override;
+
+   //! Returns null if not cached; counts a hit or a miss
+   Data Find(SampleBlockID id, Kind kind);
+
+   //! Replaces any previous contents for the same key and evicts as needed
+   void Insert(SampleBlockID id, Kind kind, Data data);
+
+   //! Forget everything cached for the block
+   void Erase(SampleBlockID id);
+
+   void Clear();
+
+   //! Evicts immediately if the new budget is smaller
+   void SetBudget(size_t budgetBytes);
+   size_t GetBudget() const;
+
+   //! Whether the budget is nonzero
+   bool IsEnabled() const;
+
+   Statistics GetStatistics() const;
+   void ResetStatistics();
+
+private:
+   struct Key {
+      SampleBlockID id;
+      Kind kind;
+      bool operator ==(const Key &other) const
+      { return id == other.id && kind == other.kind; }
+   };
+   struct KeyHash {
+      size_t operator ()(const Key &key) const;
+   };
+   struct Entry {
+      Key key;
+      Data data;
+      //! Remembered, in case a reader resizes the vector
+      size_t bytes;
+   };
+   using List = std::list<Entry>;
+
+   static size_t SizeOf(const Data &data);
+   void EraseEntry(List::iterator iter);
+   void Trim();
+
+   mutable std::mutex mMutex;
+   //! Most recently used at the front
+   List mEntries;
+   std::unordered_map<Key, List::iterator, KeyHash> mIndex;
+   size_t mBudget;
+   Statistics mStatistics;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SampleBlockCompression.cpp
+
+**********************************************************************/
+
+#include "SampleBlockCompression.h"
+
+#include "Project.h"
+#include "XMLAttributeValueView.h"
+#include "XMLWriter.h"
+
+BoolSetting CompressSampleBlocks{ L"/Performance/CompressSampleBlocks", false };
+
+static const AudacityProject::AttachedObjects::RegisteredFactory
+sSampleBlockCompressionKey{
+   []( AudacityProject & ){
+      return std::make_shared< SampleBlockCompression >(
+         CompressSampleBlocks.Read());
+   }
+};
+
+SampleBlockCompression &SampleBlockCompression::Get( AudacityProject &project )
+{
+   return project.AttachedObjects::Get< SampleBlockCompression >(
+      sSampleBlockCompressionKey );
+}
+
+const SampleBlockCompression &
+SampleBlockCompression::Get( const AudacityProject &project )
+{
+   return Get( const_cast< AudacityProject & >( project ) );
+}
+
+SampleBlockCompression::SampleBlockCompression(bool enabled)
+   : mEnabled{ enabled }
+{
+}
+
+SampleBlockCompression::~SampleBlockCompression() = default;
+
+bool SampleBlockCompression::IsEnabled() const
+{
+   return mEnabled.load(std::memory_order_relaxed);
+}
+
+void SampleBlockCompression::SetEnabled(bool enabled)
+{
+   mEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool SampleBlockCompression::HasCompressedBlocks() const
+{
+   return mHasCompressedBlocks.load(std::memory_order_relaxed);
+}
+
+void SampleBlockCompression::SetHasCompressedBlocks()
+{
+   mHasCompressedBlocks.store(true, std::memory_order_relaxed);
+}
+
+static ProjectFileIORegistry::AttributeWriterEntry entry {
+[](const AudacityProject &project, XMLWriter &xmlFile){
+   xmlFile.WriteAttr(wxT("compressblocks"),
+      SampleBlockCompression::Get(project).IsEnabled());
+}
+};
+
+static ProjectFileIORegistry::AttributeReaderEntries entries {
+// Just a pointer to function, but needing overload resolution as non-const:
+(SampleBlockCompression& (*)(AudacityProject &)) &SampleBlockCompression::Get, {
+   { "compressblocks", [](auto &settings, auto value){
+      settings.SetEnabled(value.Get(settings.IsEnabled()));
+   } },
+} };
@@ -0,0 +1,62 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SampleBlockCompression.h
+@brief Whether a project stores new sample blocks compressed
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_BLOCK_COMPRESSION__
+#define __AUDACITY_SAMPLE_BLOCK_COMPRESSION__
+
+#include <atomic>
+
+#include "ClientData.h"
+#include "Prefs.h"
+
+class AudacityProject;
+
+//! Whether new projects compress their sample blocks
+extern PROJECT_FILE_IO_API BoolSetting CompressSampleBlocks;
+
+//! Added to the sampleformat column of rows with compressed samples, so
+//! that no guessing from the contents is needed.  It is outside the range
+//! of sampleFormat values.
+constexpr int CompressedSampleFormatFlag = 0x01000000;
+
+//! Whether a project stores the samples of new blocks with a lossless codec
+/*!
+ Blocks already stored keep their form; summaries are never compressed.
+ The choice is saved with the project, and new projects take it from the
+ CompressSampleBlocks preference.
+
+ Reading a project with compressed blocks needs a version of the program
+ that has the codec, so such a project records
+ CompressedSampleBlocksProjectFormatVersion.
+ */
+class PROJECT_FILE_IO_API SampleBlockCompression final
+   : public ClientData::Base
+{
+public:
+   static SampleBlockCompression &Get(AudacityProject &project);
+   static const SampleBlockCompression &Get(const AudacityProject &project);
+
+   explicit SampleBlockCompression(bool enabled);
+   ~SampleBlockCompression() override;
+
+   //! May be called from any thread
+   bool IsEnabled() const;
+   void SetEnabled(bool enabled);
+
+   //! Whether the project has stored any block compressed, since it was
+   //! loaded or made; may be called from any thread
+   bool HasCompressedBlocks() const;
+   void SetHasCompressedBlocks();
+
+private:
+   std::atomic<bool> mEnabled;
+   std::atomic<bool> mHasCompressedBlocks{ false };
+};
+
+#endif
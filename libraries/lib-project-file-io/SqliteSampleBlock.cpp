@@ -14,7 +14,11 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 #include "BasicUI.h"
 #include "DBConnection.h"
 #include "ProjectFileIO.h"
+#include "SampleBlockCache.h"
+#include "SampleBlockCompression.h"
+#include "SampleCodec.h"
 #include "SampleFormat.h"
+#include "SampleSummary.h"
 #include "AudioSegmentSampleView.h"
 #include "XMLTagHandler.h"
 
@@ -25,8 +29,14 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 #include "WaveTrackUtilities.h"
 
 #include "SentryHelper.h"
+#include "TransactionScope.h"
 #include <wx/log.h>
 
+#include "concurrency/WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <mutex>
 
 class SqliteSampleBlockFactory;
@@ -38,6 +48,11 @@ public:
    BlockSampleView GetFloatSampleView(bool mayThrow) override;
 
 private:
+   //! Decoded contents of the whole block, possibly shared with the
+   //! project's SampleBlockCache
+   /*! @pre `!IsSilent()` */
+   std::shared_ptr<std::vector<float>> GetDecodedSamples();
+
    std::weak_ptr<std::vector<float>> mCache;
    std::mutex mCacheMutex;
 
@@ -53,7 +68,12 @@ public:
 
    //! Numbers of bytes needed for 256 and for 64k summaries
    using Sizes = std::pair< size_t, size_t >;
-   void Commit(Sizes sizes);
+
+   //! Insert the row, assigning mBlockID, but keep the data in memory
+   /*! @pre summaries are calculated */
+   void Insert(Sizes sizes);
+   //! Release the data that Insert() saved
+   void FinishCommit();
 
    void Delete();
 
@@ -82,11 +102,31 @@ public:
    void SaveXML(XMLWriter &xmlFile) override;
 
 private:
-   bool IsSilent() const { return mBlockID <= 0; }
+   //! Silent blocks have no rows, and nonpositive ids that encode their
+   //! lengths.  Blocks awaiting insertion have no rows yet, but have samples.
+   bool IsSilent() const
+   {
+      return mBlockID <= 0 && !mPending.load(std::memory_order_acquire);
+   }
+   //! Insert this, and any other blocks awaiting insertion, if not yet done
+   /*! This must be done before use of mBlockID or of the database row */
+   void EnsureCommitted() const;
+   void WaitForSummary();
    void Load(SampleBlockID sbid);
+   //! Read from the database, bypassing the caches
+   size_t ReadSamples(samplePtr dest,
+                      sampleFormat destformat,
+                      size_t sampleoffset,
+                      size_t numsamples);
+   //! Fetch and decode all the samples, then copy the requested ones
+   size_t ReadCompressedSamples(samplePtr dest,
+                                sampleFormat destformat,
+                                size_t sampleoffset,
+                                size_t numsamples);
    bool GetSummary(float *dest,
                    size_t frameoffset,
                    size_t numframes,
+                   SampleBlockCache::Kind kind,
                    DBConnection::StatementID id,
                    const char *sql);
    size_t GetBlob(void *dest,
@@ -101,12 +141,34 @@ private:
       bytesPerFrame = fields * sizeof(float),
    };
    Sizes SetSizes( size_t numsamples, sampleFormat srcformat );
-   void CalcSummary(Sizes sizes);
+   static Sizes SummarySizes( size_t numsamples );
+
+   //! The samples of a new block, and what the worker calculates from them
+   /*! Shared with the job, so that it needs nothing else of the block, which
+    may be destroyed before the job runs */
+   struct NewData
+   {
+      void CalcSummary(Sizes sizes);
+
+      ArrayOf<char> mSamples;
+      sampleFormat mSampleFormat;
+      size_t mSampleCount;
+
+      ArrayOf<char> mSummary256;
+      ArrayOf<char> mSummary64k;
+      double mSumMin;
+      double mSumMax;
+      double mSumRms;
+      //! Not empty only if compression was enabled
+      std::vector<char> mEncoded;
+   };
 
 private:
    //! This must never be called for silent blocks
    /*! @post return value is not null */
    DBConnection *Conn() const;
+   //! Null for silent blocks, or if caching is disabled
+   SampleBlockCache *Cache() const;
    sqlite3 *DB() const
    {
       return Conn()->DB();
@@ -119,8 +181,18 @@ private:
    bool mLocked = false;
 
    SampleBlockID mBlockID{ 0 };
+   //! Whether SetSamples() queued this for insertion, which is not yet done
+   std::atomic<bool> mPending{ false };
+   //! Summaries are calculated on a worker thread, into mNewData
+   std::future<void> mSummaryReady;
+   std::shared_ptr<NewData> mNewData;
+   Sizes mSizes;
 
    ArrayOf<char> mSamples;
+   //! What Insert() stores instead of mSamples, if not empty
+   std::vector<char> mEncoded;
+   //! Whether the row holds samples encoded by SampleCodec
+   bool mCompressed{ false };
    size_t mSampleBytes;
    size_t mSampleCount;
    sampleFormat mSampleFormat;
@@ -175,6 +247,15 @@ public:
          mSampleBlockDeletionCallback();
    }
 
+   //! Queue a new block for insertion of its row, done later in a batch
+   void Enqueue(const std::shared_ptr<SqliteSampleBlock> &sb);
+   //! Insert rows of all queued blocks
+   /*!
+    @param wait if false, and another thread is inserting, return at once,
+    leaving the queue for a later flush
+    */
+   void FlushPending(bool wait = true);
+
 private:
    void OnBeginPurge(size_t begin, size_t end);
    void OnEndPurge();
@@ -182,6 +263,7 @@ private:
    friend SqliteSampleBlock;
 
    AudacityProject &mProject;
+   SampleBlockCache &mCache;
    Observer::Subscription mUndoSubscription;
    std::function<void()> mSampleBlockDeletionCallback;
    const std::shared_ptr<ConnectionPtr> mppConnection;
@@ -192,11 +274,35 @@ private:
    // to the factory and we can't have a leaky cycle of shared pointers)
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
+   //! Guarded by mFlushMutex
    AllBlocksMap mAllBlocks;
+
+   //! Held while inserting a batch; threads that demand the ids of blocks in
+   //! the batch wait for it
+   std::mutex mFlushMutex;
+
+   //! Blocks made by DoCreate but not yet inserted, in order of creation
+   /*! They are not in mAllBlocks until insertion gives them ids */
+   std::vector< std::weak_ptr< SqliteSampleBlock > > mPendingBlocks;
+   //! Guards only mPendingBlocks, never held during database access
+   std::mutex mPendingMutex;
 };
 
+namespace {
+//! Number of queued blocks that causes insertion without demand
+constexpr size_t PendingBlocksLimit = 32;
+
+//! Shared by all projects, to calculate the summaries of new blocks
+audacity::concurrency::WorkerPool &SummaryWorkers()
+{
+   static audacity::concurrency::WorkerPool workers;
+   return workers;
+}
+}
+
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
    : mProject{ project }
+   , mCache{ SampleBlockCache::Get(project) }
    , mppConnection{ ConnectionPtr::Get(project).shared_from_this() }
 {
    mUndoSubscription = UndoManager::Get(project)
@@ -219,13 +325,105 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
 {
    auto sb = std::make_shared<SqliteSampleBlock>(shared_from_this());
    sb->SetSamples(src, numsamples, srcformat);
-   // block id has now been assigned
-   mAllBlocks[ sb->GetBlockID() ] = sb;
+   // block id will be assigned later, when first needed
+   Enqueue(sb);
    return sb;
 }
 
+void SqliteSampleBlockFactory::Enqueue(
+   const std::shared_ptr<SqliteSampleBlock> &sb)
+{
+   size_t nPending;
+   {
+      std::lock_guard<std::mutex> lock{ mPendingMutex };
+      sb->mPending = true;
+      mPendingBlocks.push_back(sb);
+      nPending = mPendingBlocks.size();
+   }
+   // The creating thread, which may be recording, does not wait for
+   // another thread's insertions
+   if (nPending >= PendingBlocksLimit)
+      FlushPending(false);
+}
+
+void SqliteSampleBlockFactory::FlushPending(bool wait)
+{
+   // Other threads demanding the ids of the same blocks wait here
+   std::unique_lock<std::mutex> flushLock{ mFlushMutex, std::defer_lock };
+   if (wait)
+      flushLock.lock();
+   else if (!flushLock.try_lock())
+      return;
+
+   // Take the queue, so that blocks can be queued and the queue examined
+   // during the insertions
+   std::vector<std::shared_ptr<SqliteSampleBlock>> blocks;
+   {
+      std::lock_guard<std::mutex> lock{ mPendingMutex };
+      blocks.reserve(mPendingBlocks.size());
+      for (const auto &wb : mPendingBlocks)
+         if (auto sb = wb.lock())
+            blocks.push_back(move(sb));
+      // Others were destroyed before insertion, and leave no trace
+      mPendingBlocks.clear();
+   }
+   if (blocks.empty())
+      return;
+
+   size_t nInserted = 0;
+   auto requeue = finally([&]{
+      if (nInserted == blocks.size())
+         return;
+      // If there was an exception, retry remaining blocks at next demand,
+      // ahead of blocks queued since
+      std::lock_guard<std::mutex> lock{ mPendingMutex };
+      mPendingBlocks.insert(mPendingBlocks.begin(),
+         blocks.begin() + nInserted, blocks.end());
+   });
+
+   for (const auto &sb : blocks)
+      sb->WaitForSummary();
+
+   // Group the insertions into one transaction when it is safe:  savepoints
+   // belong to the connection, not the thread, and others are opened only in
+   // the main thread
+   if (blocks.size() > 1 && BasicUI::IsUiThread()) {
+      TransactionScope transaction{ mProject, "InsertSampleBlocks" };
+      try {
+         for (; nInserted < blocks.size(); ++nInserted)
+            blocks[nInserted]->Insert(blocks[nInserted]->mSizes);
+      }
+      catch (...) {
+         // The rows are rolled back
+         for (size_t ii = 0; ii < nInserted; ++ii)
+            blocks[ii]->mBlockID = 0;
+         nInserted = 0;
+         throw;
+      }
+      if (!transaction.Commit()) {
+         for (auto &sb : blocks)
+            sb->mBlockID = 0;
+         nInserted = 0;
+         mppConnection->mpConnection->ThrowException(true);
+      }
+      for (auto &sb : blocks) {
+         sb->FinishCommit();
+         mAllBlocks[ sb->mBlockID ] = sb;
+      }
+   }
+   else
+      for (; nInserted < blocks.size(); ++nInserted) {
+         auto &sb = blocks[nInserted];
+         sb->Insert(sb->mSizes);
+         sb->FinishCommit();
+         mAllBlocks[ sb->mBlockID ] = sb;
+      }
+}
+
 auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
 {
+   FlushPending();
+   std::lock_guard<std::mutex> lock{ mFlushMutex };
    SampleBlockIDs result;
    for (auto end = mAllBlocks.end(), it = mAllBlocks.begin(); it != end;) {
       if (it->second.expired())
@@ -282,6 +480,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromId(
       return DoCreateSilent(-id, floatSample);
 
    // First see if this block id was previously loaded
+   std::lock_guard<std::mutex> lock{ mFlushMutex };
    auto& wb = mAllBlocks[id];
 
    if (auto block = wb.lock())
@@ -302,6 +501,23 @@ BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
 {
    assert(mSampleCount > 0);
 
+   try {
+      EnsureCommitted();
+      return GetDecodedSamples();
+   }
+   catch (...)
+   {
+      if (mayThrow)
+         std::rethrow_exception(std::current_exception());
+   }
+
+   // Not remembered in mCache, so that other reads may retry and report
+   // the error
+   return std::make_shared<std::vector<float>>(mSampleCount, 0.f);
+}
+
+std::shared_ptr<std::vector<float>> SqliteSampleBlock::GetDecodedSamples()
+{
    // Double-checked locking.
    // `weak_ptr::lock()` guarantees atomicity, which is important to make this
    // work without races.
@@ -313,22 +529,26 @@ BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
    if (cache)
       return cache;
 
-   const auto newCache =
-      std::make_shared<std::vector<float>>(mSampleCount);
-   try {
-      const auto cachedSize = DoGetSamples(
-         reinterpret_cast<samplePtr>(newCache->data()), floatSample, 0,
+   // Maybe another reader decoded it earlier and let it go since
+   const auto pCache = Cache();
+   if (pCache)
+      cache = pCache->Find(mBlockID, SampleBlockCache::Kind::Samples);
+
+   if (!cache) {
+      if (!mValid)
+         Load(mBlockID);
+      cache = std::make_shared<std::vector<float>>(mSampleCount);
+      // This may throw
+      const auto cachedSize = ReadSamples(
+         reinterpret_cast<samplePtr>(cache->data()), floatSample, 0,
          mSampleCount);
       assert(cachedSize == mSampleCount);
+      if (pCache)
+         pCache->Insert(mBlockID, SampleBlockCache::Kind::Samples, cache);
    }
-   catch (...)
-   {
-      if (mayThrow)
-         std::rethrow_exception(std::current_exception());
-      std::fill(newCache->begin(), newCache->end(), 0.f);
-   }
-   mCache = newCache;
-   return newCache;
+
+   mCache = cache;
+   return cache;
 }
 
 SqliteSampleBlock::SqliteSampleBlock(
@@ -350,8 +570,9 @@ SqliteSampleBlock::~SqliteSampleBlock()
       mpFactory->OnSampleBlockDtor(*this);
    }
 
-   if (IsSilent()) {
+   if (mBlockID <= 0) {
       // The block object was constructed but failed to Load() or Commit().
+      // Or it was destroyed while still awaiting insertion.
       // Or it's a silent block with no row in the database.
       // Just let the stack unwind.  Don't violate the assertion in
       // Delete(), which may do odd recursive things in debug builds when it
@@ -397,8 +618,42 @@ void SqliteSampleBlock::CloseLock() noexcept
    mLocked = true;
 }
 
+SampleBlockCache *SqliteSampleBlock::Cache() const
+{
+   if (!mpFactory || mBlockID <= 0 || !mpFactory->mCache.IsEnabled())
+      return nullptr;
+   return &mpFactory->mCache;
+}
+
+void SqliteSampleBlock::EnsureCommitted() const
+{
+   if (mPending.load(std::memory_order_acquire) && mpFactory)
+      mpFactory->FlushPending();
+}
+
+void SqliteSampleBlock::WaitForSummary()
+{
+   // Rethrows any exception from CalcSummary
+   if (mSummaryReady.valid())
+      mSummaryReady.get();
+   if (!mNewData)
+      return;
+
+   // The job is done with the data
+   auto &data = *mNewData;
+   mSamples = std::move(data.mSamples);
+   mSummary256 = std::move(data.mSummary256);
+   mSummary64k = std::move(data.mSummary64k);
+   mSumMin = data.mSumMin;
+   mSumMax = data.mSumMax;
+   mSumRms = data.mSumRms;
+   mEncoded = std::move(data.mEncoded);
+   mNewData.reset();
+}
+
 SampleBlockID SqliteSampleBlock::GetBlockID() const
 {
+   EnsureCommitted();
    return mBlockID;
 }
 
@@ -417,12 +672,41 @@ size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
                                      size_t sampleoffset,
                                      size_t numsamples)
 {
+   EnsureCommitted();
    if (IsSilent()) {
       auto size = SAMPLE_SIZE(destformat);
       memset(dest, 0, numsamples * size);
       return numsamples;
    }
 
+   // Reads as float, which are most of them, are served from the decoded
+   // contents of the whole block, which may be shared with other readers,
+   // or at least held by a prefetching reader
+   if (destformat == floatSample) {
+      const auto data = Cache() ? GetDecodedSamples() : mCache.lock();
+      if (!data)
+         return ReadSamples(dest, destformat, sampleoffset, numsamples);
+      const auto offset = std::min(sampleoffset, data->size());
+      const auto count = std::min(numsamples, data->size() - offset);
+      const auto floats = reinterpret_cast<float *>(dest);
+      std::copy_n(data->data() + offset, count, floats);
+      std::fill_n(floats + count, numsamples - count, 0.f);
+      return numsamples;
+   }
+
+   return ReadSamples(dest, destformat, sampleoffset, numsamples);
+}
+
+size_t SqliteSampleBlock::ReadSamples(samplePtr dest,
+                                      sampleFormat destformat,
+                                      size_t sampleoffset,
+                                      size_t numsamples)
+{
+   if (!mValid)
+      Load(mBlockID);
+   if (mCompressed)
+      return ReadCompressedSamples(dest, destformat, sampleoffset, numsamples);
+
    // Prepare and cache statement...automatically finalized at DB close
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::GetSamples,
       "SELECT samples FROM sampleblocks WHERE blockid = ?1;");
@@ -435,24 +719,104 @@ size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
                   numsamples * SAMPLE_SIZE(mSampleFormat)) / SAMPLE_SIZE(mSampleFormat);
 }
 
+size_t SqliteSampleBlock::ReadCompressedSamples(samplePtr dest,
+                                                sampleFormat destformat,
+                                                size_t sampleoffset,
+                                                size_t numsamples)
+{
+   auto db = DB();
+
+   // Prepare and cache statement...automatically finalized at DB close
+   sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::GetSamples,
+      "SELECT samples FROM sampleblocks WHERE blockid = ?1;");
+
+   // Bind statement parameters
+   // Might return SQLITE_MISUSE which means it's our mistake that we violated
+   // preconditions; should return SQL_OK which is 0
+   if (sqlite3_bind_int64(stmt, 1, mBlockID))
+   {
+      ADD_EXCEPTION_CONTEXT(
+         "sqlite3.rc", std::to_string(sqlite3_errcode(Conn()->DB())));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context",
+         "SqliteSampleBlock::ReadCompressedSamples::bind");
+
+      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+   }
+
+   // Execute the statement, and decode all of the blob, which is the only
+   // way to find any of the samples
+   SampleBuffer decoded(mSampleCount, mSampleFormat);
+   const auto rc = sqlite3_step(stmt);
+   const bool good = rc == SQLITE_ROW &&
+      SampleCodec::Decode(sqlite3_column_blob(stmt, 0),
+         static_cast<size_t>(sqlite3_column_bytes(stmt, 0)),
+         decoded.ptr(), mSampleFormat, mSampleCount);
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+
+   if (!good)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context",
+         "SqliteSampleBlock::ReadCompressedSamples::step");
+
+      wxLogDebug(
+         wxT("SqliteSampleBlock::ReadCompressedSamples - SQLITE error %s"),
+         sqlite3_errmsg(db));
+
+      // Just showing the user a simple message, not the library error too
+      // which isn't internationalized
+      Conn()->ThrowException( false );
+   }
+
+   // No dithering, as explained in GetBlob()
+   wxASSERT(destformat == floatSample || destformat == mSampleFormat);
+   const auto offset = std::min(sampleoffset, mSampleCount);
+   const auto count = std::min(numsamples, mSampleCount - offset);
+   CopySamples(decoded.ptr() + offset * SAMPLE_SIZE(mSampleFormat),
+      mSampleFormat, dest, destformat, count);
+   if (numsamples > count)
+      memset(dest + count * SAMPLE_SIZE(destformat), 0,
+         (numsamples - count) * SAMPLE_SIZE(destformat));
+
+   return numsamples;
+}
+
 void SqliteSampleBlock::SetSamples(constSamplePtr src,
                                    size_t numsamples,
                                    sampleFormat srcformat)
 {
-   auto sizes = SetSizes(numsamples, srcformat);
-   mSamples.reinit(mSampleBytes);
-   memcpy(mSamples.get(), src, mSampleBytes);
-
-   CalcSummary( sizes );
-
-   Commit( sizes );
+   mSizes = SetSizes(numsamples, srcformat);
+   auto pData = std::make_shared<NewData>();
+   pData->mSamples.reinit(mSampleBytes);
+   memcpy(pData->mSamples.get(), src, mSampleBytes);
+   pData->mSampleFormat = mSampleFormat;
+   pData->mSampleCount = mSampleCount;
+
+   // The factory inserts the row later, together with other new blocks
+   const bool compress = mpFactory &&
+      SampleBlockCompression::Get(mpFactory->mProject).IsEnabled();
+   auto task = std::make_shared<std::packaged_task<void()>>(
+      [pData, sizes = mSizes, compress]{
+         pData->CalcSummary(sizes);
+         // Summaries stay uncompressed, for drawing without decoding
+         if (compress)
+            pData->mEncoded = SampleCodec::Encode(pData->mSamples.get(),
+               pData->mSampleFormat, pData->mSampleCount);
+      });
+   mNewData = move(pData);
+   mSummaryReady = task->get_future();
+   SummaryWorkers().Post([task]{ (*task)(); });
 }
 
 bool SqliteSampleBlock::GetSummary256(float *dest,
                                       size_t frameoffset,
                                       size_t numframes)
 {
-   return GetSummary(dest, frameoffset, numframes, DBConnection::GetSummary256,
+   return GetSummary(dest, frameoffset, numframes,
+      SampleBlockCache::Kind::Summary256, DBConnection::GetSummary256,
       "SELECT summary256 FROM sampleblocks WHERE blockid = ?1;");
 }
 
@@ -460,28 +824,59 @@ bool SqliteSampleBlock::GetSummary64k(float *dest,
                                       size_t frameoffset,
                                       size_t numframes)
 {
-   return GetSummary(dest, frameoffset, numframes, DBConnection::GetSummary64k,
+   return GetSummary(dest, frameoffset, numframes,
+      SampleBlockCache::Kind::Summary64k, DBConnection::GetSummary64k,
       "SELECT summary64k FROM sampleblocks WHERE blockid = ?1;");
 }
 
 bool SqliteSampleBlock::GetSummary(float *dest,
                                    size_t frameoffset,
                                    size_t numframes,
+                                   SampleBlockCache::Kind kind,
                                    DBConnection::StatementID id,
                                    const char *sql)
 {
    // Non-throwing, it returns true for success
+   try {
+      EnsureCommitted();
+   }
+   catch ( const AudacityException & ) {
+      memset(dest, 0, 3 * numframes * sizeof( float ));
+      return false;
+   }
    bool silent = IsSilent();
    if (!silent) {
       // Not a silent block
       try {
          // Prepare and cache statement...automatically finalized at DB close
-         auto stmt = Conn()->Prepare(id, sql);
+         const auto prepare = [&]{ return Conn()->Prepare(id, sql); };
+         if (const auto pCache = Cache()) {
+            auto data = pCache->Find(mBlockID, kind);
+            if (!data) {
+               // Fetch the whole summary, to share with other readers
+               if (!mValid)
+                  Load(mBlockID);
+               const auto sizes = SummarySizes(mSampleCount);
+               const auto bytes = kind == SampleBlockCache::Kind::Summary256
+                  ? sizes.first : sizes.second;
+               data = std::make_shared<std::vector<float>>(
+                  bytes / sizeof(float));
+               GetBlob(data->data(), floatSample, prepare(),
+                  floatSample, 0, bytes);
+               pCache->Insert(mBlockID, kind, data);
+            }
+            const auto offset = std::min(frameoffset * fields, data->size());
+            const auto count =
+               std::min(numframes * fields, data->size() - offset);
+            std::copy_n(data->data() + offset, count, dest);
+            std::fill_n(dest + count, numframes * fields - count, 0.f);
+            return true;
+         }
          // Note GetBlob returns a size_t, not a bool
          // REVIEW: An error in GetBlob() will throw an exception.
          GetBlob(dest,
                      floatSample,
-                     stmt,
+                     prepare(),
                      floatSample,
                      frameoffset * fields * SAMPLE_SIZE(floatSample),
                      numframes * fields * SAMPLE_SIZE(floatSample));
@@ -497,16 +892,19 @@ bool SqliteSampleBlock::GetSummary(float *dest,
 
 double SqliteSampleBlock::GetSumMin() const
 {
+   EnsureCommitted();
    return mSumMin;
 }
 
 double SqliteSampleBlock::GetSumMax() const
 {
+   EnsureCommitted();
    return mSumMax;
 }
 
 double SqliteSampleBlock::GetSumRms() const
 {
+   EnsureCommitted();
    return mSumRms;
 }
 
@@ -517,6 +915,7 @@ double SqliteSampleBlock::GetSumRms() const
 /// @param len   The number of samples to include in the region
 MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
 {
+   EnsureCommitted();
    if (IsSilent())
       return {};
 
@@ -538,22 +937,11 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
       float *samples = (float *) blockData.ptr();
 
       size_t copied = DoGetSamples((samplePtr) samples, floatSample, start, len);
-      for (size_t i = 0; i < copied; ++i, ++samples)
-      {
-         float sample = *samples;
-
-         if (sample > max)
-         {
-            max = sample;
-         }
-
-         if (sample < min)
-         {
-            min = sample;
-         }
-
-         sumsq += (sample * sample);
-      }
+      SampleSummary summary{ min, max, sumsq };
+      summary.Accumulate((constSamplePtr) samples, floatSample, copied);
+      min = summary.min;
+      max = summary.max;
+      sumsq = summary.sumsq;
    }
 
    return { min, max, (float) sqrt(sumsq / len) };
@@ -564,11 +952,13 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
 /// these values are already computed.
 MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS() const
 {
+   EnsureCommitted();
    return { (float) mSumMin, (float) mSumMax, (float) mSumRms };
 }
 
 size_t SqliteSampleBlock::GetSpaceUsage() const
 {
+   EnsureCommitted();
    if (IsSilent())
       return 0;
    else
@@ -671,9 +1061,9 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
     There is only one use of that function not always fetching float, in
     WaveTrack::Get().
 
-    It can be shown that the only paths to WaveTrack::Get() not specifying
-    floatSample are in Benchmark, which is only a diagnostic test, and there
-    the sample format is the same as what the track was constructed with.
+    Paths to WaveTrack::Get() not specifying floatSample must ask for the
+    format that the track was constructed with, as the assertion below
+    checks.
 
     Therefore, no dithering even there!
     */
@@ -713,11 +1103,18 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
    mSumMax = -FLT_MAX;
    mSumMin = 0.0;
 
+   // The header of compressed samples tells their count.  Fetch nothing
+   // from uncompressed samples, which may lie beyond the overflow pages of
+   // the summaries.  (16777216 is CompressedSampleFormatFlag)
    // Prepare and cache statement...automatically finalized at DB close
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::LoadSampleBlock,
       "SELECT sampleformat, summin, summax, sumrms,"
-      "       length(samples)"
+      "       length(samples),"
+      "       CASE WHEN sampleformat & 16777216"
+      "          THEN substr(samples, 1, 12) END"
       "  FROM sampleblocks WHERE blockid = ?1;");
+   static_assert(CompressedSampleFormatFlag == 16777216);
+   static_assert(SampleCodec::HeaderSize == 12);
 
    // Bind statement parameters
    // Might return SQLITE_MISUSE which means it's our mistake that we violated
@@ -753,12 +1150,32 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
 
    // Retrieve returned data
    mBlockID = sbid;
-   mSampleFormat = (sampleFormat) sqlite3_column_int(stmt, 0);
+   const auto format = sqlite3_column_int(stmt, 0);
+   mCompressed = (format & CompressedSampleFormatFlag) != 0;
+   mSampleFormat = (sampleFormat) (format & ~CompressedSampleFormatFlag);
    mSumMin = sqlite3_column_double(stmt, 1);
    mSumMax = sqlite3_column_double(stmt, 2);
    mSumRms = sqlite3_column_double(stmt, 3);
    mSampleBytes = sqlite3_column_int(stmt, 4);
    mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   if (mCompressed)
+   {
+      const auto count = SampleCodec::DecodedCount(
+         sqlite3_column_blob(stmt, 5),
+         static_cast<size_t>(sqlite3_column_bytes(stmt, 5)));
+      if (!count)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.context",
+            "SqliteSampleBlock::Load::header");
+
+         sqlite3_clear_bindings(stmt);
+         sqlite3_reset(stmt);
+         Conn()->ThrowException( false );
+      }
+      // Report the size of the decoded samples, like other blocks
+      mSampleCount = *count;
+      mSampleBytes = mSampleCount * SAMPLE_SIZE(mSampleFormat);
+   }
 
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
@@ -767,7 +1184,7 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
    mValid = true;
 }
 
-void SqliteSampleBlock::Commit(Sizes sizes)
+void SqliteSampleBlock::Insert(Sizes sizes)
 {
    const auto mSummary256Bytes = sizes.first;
    const auto mSummary64kBytes = sizes.second;
@@ -784,13 +1201,19 @@ void SqliteSampleBlock::Commit(Sizes sizes)
    // Bind statement parameters
    // Might return SQLITE_MISUSE which means it's our mistake that we violated
    // preconditions; should return SQL_OK which is 0
-   if (sqlite3_bind_int(stmt, 1, static_cast<int>(mSampleFormat)) ||
+   const bool compressed = !mEncoded.empty();
+   const auto format = static_cast<int>(mSampleFormat) |
+      (compressed ? CompressedSampleFormatFlag : 0);
+   const void *samples = compressed
+      ? static_cast<const void *>(mEncoded.data()) : mSamples.get();
+   const auto sampleBytes = compressed ? mEncoded.size() : mSampleBytes;
+   if (sqlite3_bind_int(stmt, 1, format) ||
        sqlite3_bind_double(stmt, 2, mSumMin) ||
        sqlite3_bind_double(stmt, 3, mSumMax) ||
        sqlite3_bind_double(stmt, 4, mSumRms) ||
        sqlite3_bind_blob(stmt, 5, mSummary256.get(), mSummary256Bytes, SQLITE_STATIC) ||
        sqlite3_bind_blob(stmt, 6, mSummary64k.get(), mSummary64kBytes, SQLITE_STATIC) ||
-       sqlite3_bind_blob(stmt, 7, mSamples.get(), mSampleBytes, SQLITE_STATIC))
+       sqlite3_bind_blob(stmt, 7, samples, sampleBytes, SQLITE_STATIC))
    {
 
       ADD_EXCEPTION_CONTEXT(
@@ -821,9 +1244,25 @@ void SqliteSampleBlock::Commit(Sizes sizes)
 
    // Retrieve returned data
    mBlockID = sqlite3_last_insert_rowid(db);
+   mCompressed = compressed;
+   if (compressed)
+      // The project must now record a version that can read this block
+      SampleBlockCompression::Get(mpFactory->mProject).SetHasCompressedBlocks();
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+}
+
+void SqliteSampleBlock::FinishCommit()
+{
+   // The row id might be reused after deletion of another block
+   if (const auto pCache = Cache())
+      pCache->Erase(mBlockID);
 
    // Reset local arrays
    mSamples.reset();
+   mEncoded = {};
    mSummary256.reset();
    mSummary64k.reset();
    {
@@ -831,11 +1270,8 @@ void SqliteSampleBlock::Commit(Sizes sizes)
       mCache.reset();
    }
 
-   // Clear statement bindings and rewind statement
-   sqlite3_clear_bindings(stmt);
-   sqlite3_reset(stmt);
-
    mValid = true;
+   mPending.store(false, std::memory_order_release);
 }
 
 void SqliteSampleBlock::Delete()
@@ -845,6 +1281,9 @@ void SqliteSampleBlock::Delete()
 
    wxASSERT(!IsSilent());
 
+   if (const auto pCache = Cache())
+      pCache->Erase(mBlockID);
+
    // Prepare and cache statement...automatically finalized at DB close
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::DeleteSampleBlock,
       "DELETE FROM sampleblocks WHERE blockid = ?1;");
@@ -886,7 +1325,7 @@ void SqliteSampleBlock::Delete()
 
 void SqliteSampleBlock::SaveXML(XMLWriter &xmlFile)
 {
-   xmlFile.WriteAttr(wxT("blockid"), mBlockID);
+   xmlFile.WriteAttr(wxT("blockid"), GetBlockID());
 }
 
 auto SqliteSampleBlock::SetSizes(
@@ -896,7 +1335,12 @@ auto SqliteSampleBlock::SetSizes(
    mSampleCount = numsamples;
    mSampleBytes = mSampleCount * SAMPLE_SIZE(mSampleFormat);
 
-   int frames64k = (mSampleCount + 65535) / 65536;
+   return SummarySizes(mSampleCount);
+}
+
+auto SqliteSampleBlock::SummarySizes(size_t numsamples) -> Sizes
+{
+   int frames64k = (numsamples + 65535) / 65536;
    int frames256 = frames64k * 256;
    return { frames256 * bytesPerFrame, frames64k * bytesPerFrame };
 }
@@ -904,27 +1348,16 @@ auto SqliteSampleBlock::SetSizes(
 /// Calculates summary block data describing this sample data.
 ///
 /// This method also has the side effect of setting the mSumMin,
-/// mSumMax, and mSumRms members of this class.
+/// mSumMax, and mSumRms members.
 ///
-void SqliteSampleBlock::CalcSummary(Sizes sizes)
+void SqliteSampleBlock::NewData::CalcSummary(Sizes sizes)
 {
    const auto mSummary256Bytes = sizes.first;
    const auto mSummary64kBytes = sizes.second;
 
-   Floats samplebuffer;
-   float *samples;
-
-   if (mSampleFormat == floatSample)
-   {
-      samples = (float *) mSamples.get();
-   }
-   else
-   {
-      samplebuffer.reinit((unsigned) mSampleCount);
-      SamplesToFloats(mSamples.get(), mSampleFormat,
-         samplebuffer.get(), mSampleCount);
-      samples = samplebuffer.get();
-   }
+   // Samples are converted to float while summarizing, without a buffer
+   const auto samples = mSamples.get();
+   const auto sampleSize = SAMPLE_SIZE(mSampleFormat);
 
    mSummary256.reinit(mSummary256Bytes);
    mSummary64k.reinit(mSummary64kBytes);
@@ -944,9 +1377,9 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
 
    for (int i = 0; i < sumLen; ++i)
    {
-      min = samples[i * 256];
-      max = samples[i * 256];
-      sumsq = min * min;
+      const auto frame = samples + i * 256 * sampleSize;
+      float first;
+      SamplesToFloats(frame, mSampleFormat, &first, 1);
 
       int jcount = 256;
       if (jcount > mSampleCount - i * 256)
@@ -955,20 +1388,11 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
          fraction = 1.0 - (jcount / 256.0);
       }
 
-      for (int j = 1; j < jcount; ++j)
-      {
-         float f1 = samples[i * 256 + j];
-         sumsq += f1 * f1;
-
-         if (f1 < min)
-         {
-            min = f1;
-         }
-         else if (f1 > max)
-         {
-            max = f1;
-         }
-      }
+      SampleSummary summary{ first, first, first * first };
+      summary.Accumulate(frame + sampleSize, mSampleFormat, jcount - 1);
+      min = summary.min;
+      max = summary.max;
+      sumsq = summary.sumsq;
 
       totalSquares += sumsq;
 
@@ -0,0 +1,320 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AutoSaveChainTests.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "AutoSaveChain.h"
+
+namespace
+{
+using Bytes = AutoSaveChain::Bytes;
+
+//! A document cut into segments, as AutoSave cuts the prologue, each track
+//! and the epilogue
+struct Document final
+{
+   explicit Document(const std::vector<std::string>& segments)
+   {
+      for (const auto& segment : segments)
+      {
+         if (!data.empty())
+            boundaries.push_back(data.size());
+         data.insert(data.end(), segment.begin(), segment.end());
+      }
+   }
+
+   Bytes data;
+   AutoSaveChain::Boundaries boundaries;
+};
+
+Bytes ToBytes(const MemoryStream& stream)
+{
+   const auto data = static_cast<const uint8_t*>(stream.GetData());
+   return { data, data + stream.GetSize() };
+}
+
+Bytes Rebase(AutoSaveChain& chain, const Document& document)
+{
+   return ToBytes(chain.Rebase(
+      document.data.data(), document.data.size(), document.boundaries));
+}
+
+Bytes Link(AutoSaveChain& chain, const Document& document, size_t& changed)
+{
+   return ToBytes(chain.Link(document.data.data(), document.data.size(),
+      document.boundaries, changed));
+}
+
+const std::string Prologue = "<project rate=44100>";
+const std::string TrackA = "<wavetrack name=A><waveclip offset=0/></wavetrack>";
+const std::string TrackB = "<wavetrack name=B><waveclip offset=1/></wavetrack>";
+const std::string TrackC = "<wavetrack name=C><waveclip offset=2/></wavetrack>";
+const std::string Epilogue = "</project>";
+} // namespace
+
+TEST_CASE("AutoSaveChain round trips")
+{
+   AutoSaveChain chain;
+   REQUIRE(chain.IsEmpty());
+
+   const Document base { { Prologue, TrackA, TrackB, Epilogue } };
+   const auto layout = Rebase(chain, base);
+   REQUIRE(!chain.IsEmpty());
+   REQUIRE(chain.GetLinks() == 0);
+   REQUIRE(chain.GetBaseBytes() == base.data.size());
+   REQUIRE(chain.GetChainBytes() == 0);
+
+   SECTION("A base alone replays as itself")
+   {
+      REQUIRE(AutoSaveChain::Replay(base.data, layout, {}) == base.data);
+   }
+
+   SECTION("A link stores only the changed segment")
+   {
+      const Document next {
+         { Prologue, TrackA, TrackB + "<envelope/>", Epilogue } };
+      size_t changed = 0;
+      const auto link = Link(chain, next, changed);
+      REQUIRE(changed == 1);
+      REQUIRE(chain.GetLinks() == 1);
+      REQUIRE(chain.GetChainBytes() == link.size());
+      REQUIRE(link.size() < next.data.size());
+      REQUIRE(AutoSaveChain::Replay(base.data, layout, { link }) == next.data);
+   }
+
+   SECTION("An unchanged document stores no segments")
+   {
+      size_t changed = 1;
+      const auto link = Link(chain, base, changed);
+      REQUIRE(changed == 0);
+      REQUIRE(AutoSaveChain::Replay(base.data, layout, { link }) == base.data);
+   }
+
+   SECTION("Each prefix of the links replays the document it ends with")
+   {
+      std::vector<Document> documents;
+      std::vector<Bytes> links;
+      for (int ii = 1; ii <= 5; ++ii)
+      {
+         documents.push_back(Document { { Prologue,
+            TrackA + std::string(ii, '+'), TrackB, Epilogue } });
+         size_t changed = 0;
+         links.push_back(Link(chain, documents.back(), changed));
+         REQUIRE(changed == 1);
+      }
+      size_t chainBytes = 0;
+      for (size_t ii = 0; ii < links.size(); ++ii)
+      {
+         chainBytes += links[ii].size();
+         const std::vector<Bytes> prefix(
+            links.begin(), links.begin() + ii + 1);
+         REQUIRE(AutoSaveChain::Replay(base.data, layout, prefix) ==
+            documents[ii].data);
+      }
+      REQUIRE(chain.GetLinks() == links.size());
+      REQUIRE(chain.GetChainBytes() == chainBytes);
+   }
+
+   SECTION("Compaction starts a new chain from the last document")
+   {
+      const Document next { { Prologue, TrackA, TrackC, Epilogue } };
+      size_t changed = 0;
+      Link(chain, next, changed);
+
+      const auto newLayout = Rebase(chain, next);
+      REQUIRE(chain.GetLinks() == 0);
+      REQUIRE(chain.GetChainBytes() == 0);
+      REQUIRE(chain.GetBaseBytes() == next.data.size());
+      REQUIRE(AutoSaveChain::Replay(next.data, newLayout, {}) == next.data);
+
+      // Links now refer to the segments of the new base
+      const Document last { { Prologue, TrackC, Epilogue } };
+      const auto link = Link(chain, last, changed);
+      REQUIRE(changed == 0);
+      REQUIRE(
+         AutoSaveChain::Replay(next.data, newLayout, { link }) == last.data);
+      // The old base does not match the new layout
+      REQUIRE(!AutoSaveChain::Replay(base.data, newLayout, { link }));
+   }
+
+   SECTION("Reset forgets the segments")
+   {
+      chain.Reset();
+      REQUIRE(chain.IsEmpty());
+      REQUIRE(chain.GetLinks() == 0);
+      REQUIRE(chain.GetBaseBytes() == 0);
+   }
+}
+
+TEST_CASE("AutoSaveChain matches tracks by content")
+{
+   AutoSaveChain chain;
+   const Document base { { Prologue, TrackA, TrackB, Epilogue } };
+   const auto layout = Rebase(chain, base);
+   std::vector<Bytes> links;
+   size_t changed = 0;
+
+   const auto check = [&](const Document& document, size_t expectedChanged)
+   {
+      links.push_back(Link(chain, document, changed));
+      REQUIRE(changed == expectedChanged);
+      REQUIRE(
+         AutoSaveChain::Replay(base.data, layout, links) == document.data);
+   };
+
+   SECTION("Reordered tracks")
+   {
+      check(Document { { Prologue, TrackB, TrackA, Epilogue } }, 0);
+   }
+
+   SECTION("Added tracks")
+   {
+      check(Document { { Prologue, TrackA, TrackC, TrackB, Epilogue } }, 1);
+      // A copy of a track needs no new segment
+      check(Document {
+         { Prologue, TrackA, TrackC, TrackB, TrackC, Epilogue } }, 0);
+   }
+
+   SECTION("Removed tracks")
+   {
+      check(Document { { Prologue, TrackB, Epilogue } }, 0);
+      check(Document { { Prologue, Epilogue } }, 0);
+      // A track removed earlier is new again
+      check(Document { { Prologue, TrackA, Epilogue } }, 1);
+   }
+
+   SECTION("Reordered, added and removed at once")
+   {
+      check(Document { { Prologue, TrackC, TrackB, Epilogue } }, 1);
+      check(Document { { "<project rate=48000>", TrackB, TrackC, Epilogue } },
+         1);
+   }
+}
+
+TEST_CASE("AutoSaveChain rejects a base that the layout does not describe")
+{
+   AutoSaveChain chain;
+   const Document base { { Prologue, TrackA, TrackB, Epilogue } };
+   const auto layout = Rebase(chain, base);
+   size_t changed = 0;
+   const auto link = Link(chain,
+      Document { { Prologue, TrackB, TrackC, Epilogue } }, changed);
+
+   SECTION("A base of another size")
+   {
+      auto stale = base.data;
+      stale.push_back(' ');
+      REQUIRE(!AutoSaveChain::Replay(stale, layout, { link }));
+   }
+
+   SECTION("A base of the same size but other contents")
+   {
+      auto stale = base.data;
+      stale[Prologue.size() + 1] ^= 1;
+      REQUIRE(!AutoSaveChain::Replay(stale, layout, { link }));
+   }
+
+   SECTION("The layout of another base")
+   {
+      AutoSaveChain other;
+      const Document otherBase { { Prologue, TrackC, TrackA, Epilogue } };
+      const auto otherLayout = Rebase(other, otherBase);
+      REQUIRE(otherBase.data.size() == base.data.size());
+      REQUIRE(!AutoSaveChain::Replay(base.data, otherLayout, { link }));
+   }
+
+   SECTION("Segment sizes that do not add up to the base")
+   {
+      // The first size follows the base size, hash and segment count
+      auto bad = layout;
+      const auto offset = 2 * sizeof(uint64_t) + sizeof(uint32_t);
+      uint64_t size;
+      memcpy(&size, bad.data() + offset, sizeof(size));
+      ++size;
+      memcpy(bad.data() + offset, &size, sizeof(size));
+      REQUIRE(!AutoSaveChain::Replay(base.data, bad, { link }));
+   }
+
+   SECTION("A truncated layout")
+   {
+      for (size_t size = 0; size < layout.size(); ++size)
+      {
+         const Bytes truncated(layout.begin(), layout.begin() + size);
+         REQUIRE(!AutoSaveChain::Replay(base.data, truncated, { link }));
+      }
+   }
+}
+
+TEST_CASE("AutoSaveChain rejects malformed links")
+{
+   AutoSaveChain chain;
+   const Document base { { Prologue, TrackA, TrackB, Epilogue } };
+   const auto layout = Rebase(chain, base);
+   size_t changed = 0;
+   const Document next { { Prologue, TrackB, TrackC, Epilogue } };
+   const auto first = Link(chain, next, changed);
+   const auto second =
+      Link(chain, Document { { Prologue, TrackC, Epilogue } }, changed);
+   REQUIRE(AutoSaveChain::Replay(base.data, layout, { first }) == next.data);
+
+   // The first segment of a link follows the segment count
+   const auto kindOffset = sizeof(uint32_t);
+   const auto indexOffset = kindOffset + sizeof(uint8_t);
+
+   SECTION("Truncated at any length")
+   {
+      for (size_t size = 0; size < first.size(); ++size)
+      {
+         const Bytes truncated(first.begin(), first.begin() + size);
+         REQUIRE(!AutoSaveChain::Replay(base.data, layout, { truncated }));
+         REQUIRE(!AutoSaveChain::Replay(
+            base.data, layout, { truncated, second }));
+      }
+   }
+
+   SECTION("A later link truncated")
+   {
+      const Bytes truncated(second.begin(), second.end() - 1);
+      REQUIRE(!AutoSaveChain::Replay(base.data, layout, { first, truncated }));
+   }
+
+   SECTION("An unknown kind of segment")
+   {
+      auto bad = first;
+      bad[kindOffset] = 7;
+      REQUIRE(!AutoSaveChain::Replay(base.data, layout, { bad }));
+   }
+
+   SECTION("An index beyond the previous segments")
+   {
+      // The prologue is unchanged, so the link refers to it by index
+      auto bad = first;
+      REQUIRE(bad[kindOffset] == 0);
+      const uint32_t index = 4;
+      memcpy(bad.data() + indexOffset, &index, sizeof(index));
+      REQUIRE(!AutoSaveChain::Replay(base.data, layout, { bad }));
+   }
+
+   SECTION("A segment size beyond the link")
+   {
+      // The first segment of this link is new
+      const auto link = Link(chain, Document { { TrackA } }, changed);
+      auto bad = link;
+      REQUIRE(bad[kindOffset] == 1);
+      const uint64_t size = ~uint64_t{};
+      memcpy(bad.data() + indexOffset, &size, sizeof(size));
+      REQUIRE(!AutoSaveChain::Replay(
+         base.data, layout, { first, second, bad }));
+      REQUIRE(AutoSaveChain::Replay(base.data, layout, { first, second, link })
+         == Document { { TrackA } }.data);
+   }
+}
@@ -0,0 +1,163 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectFormatVersionTests.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+#include "MockedPrefs.h"
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "ProjectFormatVersion.h"
+#include "SampleBlockCompression.h"
+#include "TempDirectory.h"
+#include "Track.h"
+#include "WaveTrack.h"
+#include "sqlite/Connection.h"
+
+namespace
+{
+//! Keeps the project databases apart from those of any running instance,
+//! and removes them at the end
+struct Session final
+{
+   Session()
+   {
+      wxFileName dir { wxFileName::GetTempDir(), wxEmptyString };
+      dir.AppendDir(wxString::Format("audacity-project-file-io-test-%lu",
+         static_cast<unsigned long>(wxGetProcessId())));
+      path = dir.GetPath();
+      REQUIRE(wxFileName::Mkdir(path, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL));
+      TempDirectory::SetSessionTempDir(path);
+      REQUIRE(ProjectFileIO::InitializeSQL());
+   }
+
+   ~Session()
+   {
+      wxFileName::Rmdir(path, wxPATH_RMDIR_RECURSIVE);
+   }
+
+   wxString path;
+};
+
+MockedPrefs prefs;
+
+const Session& GetSession()
+{
+   static Session session;
+   return session;
+}
+
+//! Run a query of one integer on the saved project
+int64_t QueryValue(const wxString& path, const char* sql)
+{
+   auto connection = audacity::sqlite::Connection::Open(
+      path.ToStdString(), audacity::sqlite::OpenMode::ReadOnly);
+   REQUIRE(connection);
+   auto statement = connection->CreateStatement(sql);
+   REQUIRE(statement);
+   auto run = statement->Prepare().Run();
+   REQUIRE(run.IsOk());
+   int64_t value = 0;
+   for (auto row : run)
+   {
+      REQUIRE(row.Get(0, value));
+      break;
+   }
+   return value;
+}
+
+//! Saves a project with one track of samples that compress well
+/*!
+ @param compressAppended whether compression is enabled while appending
+ @param compressSaved whether it is enabled when saving
+ @return the path of the saved project
+ */
+wxString MakeSavedProject(bool compressAppended, bool compressSaved)
+{
+   const auto& session = GetSession();
+   const auto pProject = AudacityProject::Create();
+   auto& projectFileIO = ProjectFileIO::Get(*pProject);
+   REQUIRE(projectFileIO.OpenProject());
+   auto& compression = SampleBlockCompression::Get(*pProject);
+
+   compression.SetEnabled(compressAppended);
+   // A ramp of 16 bit values
+   constexpr size_t length = 44100;
+   std::vector<float> samples(length);
+   for (size_t ii = 0; ii < length; ++ii)
+      samples[ii] = static_cast<int>(ii % 1000) / 32768.0f;
+   const auto track =
+      WaveTrackFactory::Get(*pProject).Create(1, floatSample, 44100);
+   track->Append(0, reinterpret_cast<constSamplePtr>(samples.data()),
+      floatSample, length, 1, int16Sample);
+   track->Flush();
+   TrackList::Get(*pProject).Add(track);
+   compression.SetEnabled(compressSaved);
+
+   // Save outside the temporary directory, or the project stays temporary
+   wxFileName file { session.path, wxString::Format("saved-%d-%d.aup3",
+      int(compressAppended), int(compressSaved)) };
+   file.AppendDir(wxT("saved"));
+   REQUIRE(file.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL));
+   const auto path = file.GetFullPath();
+   REQUIRE(projectFileIO.SaveProject(path, nullptr));
+
+   // As when closing a window:  destroy the sample blocks while the database
+   // is still open, without deleting the rows of a saved project
+   projectFileIO.SetBypass();
+   TrackList::Get(*pProject).Clear();
+   projectFileIO.CloseProject();
+   return path;
+}
+
+const char* const VersionSql = "PRAGMA user_version;";
+const auto CompressedVersion = std::max(
+   BaseProjectFormatVersion, CompressedSampleBlocksProjectFormatVersion);
+const char* const CompressedCountSql =
+   "SELECT COUNT(1) FROM sampleblocks WHERE sampleformat & 16777216;";
+} // namespace
+
+TEST_CASE("Projects with compressed sample blocks record a newer version")
+{
+   static_assert(CompressedSampleFormatFlag == 16777216);
+   // Above every release of 3.7, none of which has the codec
+   REQUIRE(ProjectFormatVersion { 3, 7, 255, 255 } <
+      CompressedSampleBlocksProjectFormatVersion);
+   REQUIRE(!(SupportedProjectFormatVersion <
+      CompressedSampleBlocksProjectFormatVersion));
+
+   SECTION("Without compression, the base version")
+   {
+      const auto path = MakeSavedProject(false, false);
+      REQUIRE(QueryValue(path, CompressedCountSql) == 0);
+      REQUIRE(QueryValue(path, VersionSql) ==
+         BaseProjectFormatVersion.GetPacked());
+   }
+
+   SECTION("With compression enabled")
+   {
+      const auto path = MakeSavedProject(true, true);
+      REQUIRE(QueryValue(path, CompressedCountSql) > 0);
+      REQUIRE(QueryValue(path, VersionSql) ==
+         CompressedVersion.GetPacked());
+   }
+
+   SECTION("With compressed blocks, after compression is disabled")
+   {
+      const auto path = MakeSavedProject(true, false);
+      REQUIRE(QueryValue(path, CompressedCountSql) > 0);
+      REQUIRE(QueryValue(path, VersionSql) ==
+         CompressedVersion.GetPacked());
+   }
+}
@@ -10,6 +10,7 @@
 
 #include "ProjectFormatVersion.h"
 
+#include <algorithm>
 #include <tuple>
 
 bool operator == (ProjectFormatVersion lhs, ProjectFormatVersion rhs) noexcept
@@ -49,8 +50,14 @@ bool ProjectFormatVersion::IsValid() const noexcept
    return Major != 0;
 }
 
-const ProjectFormatVersion SupportedProjectFormatVersion = {
-   AUDACITY_VERSION, AUDACITY_RELEASE, AUDACITY_REVISION, AUDACITY_MODLEVEL
+const ProjectFormatVersion CompressedSampleBlocksProjectFormatVersion = {
+   3, 8, 0, 0
 };
 
+const ProjectFormatVersion SupportedProjectFormatVersion = std::max(
+   ProjectFormatVersion {
+      AUDACITY_VERSION, AUDACITY_RELEASE, AUDACITY_REVISION, AUDACITY_MODLEVEL
+   },
+   CompressedSampleBlocksProjectFormatVersion);
+
 const ProjectFormatVersion BaseProjectFormatVersion = { AUDACITY_VERSION, AUDACITY_RELEASE, 0, 0 };
@@ -38,7 +38,15 @@ PROJECT_API bool operator==(ProjectFormatVersion lhs, ProjectFormatVersion rhs)
 PROJECT_API bool operator!=(ProjectFormatVersion lhs, ProjectFormatVersion rhs) noexcept;
 PROJECT_API bool operator<(ProjectFormatVersion lhs, ProjectFormatVersion rhs) noexcept;
 
-//! This constant represents the current version of Audacity
+//! The least version of projects that may store sample blocks compressed
+/*!
+ Versions of Audacity before it can't decode them, and must refuse such
+ projects.  This is a bump of the format to that of the next minor release,
+ 3.8.0, so that no 3.7.x release, which lacks the codec, opens them.
+ */
+PROJECT_API extern const ProjectFormatVersion CompressedSampleBlocksProjectFormatVersion;
+//! This constant represents the current version of Audacity, or the greatest
+//! project version above that it can read
 PROJECT_API extern const ProjectFormatVersion SupportedProjectFormatVersion;
 //! This is a helper constant for the "most compatible" project version which is the current MAJ.MIN.0.0
 PROJECT_API extern const ProjectFormatVersion BaseProjectFormatVersion;
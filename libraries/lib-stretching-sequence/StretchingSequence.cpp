@@ -118,6 +118,12 @@ bool StretchingSequence::GetMute() const
    return mSequence.GetMute();
 }
 
+std::shared_ptr<const void>
+StretchingSequence::Prefetch(double t0, double t1) const
+{
+   return mSequence.Prefetch(t0, t1);
+}
+
 double StretchingSequence::GetStartTime() const
 {
    return mSequence.GetStartTime();
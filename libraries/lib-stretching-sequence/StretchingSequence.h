@@ -55,6 +55,7 @@ public:
    const ChannelGroup *FindChannelGroup() const override;
    bool GetSolo() const override;
    bool GetMute() const override;
+   std::shared_ptr<const void> Prefetch(double t0, double t1) const override;
 
    // AudioGraph::Channel
    AudioGraph::ChannelType GetChannelType() const override;
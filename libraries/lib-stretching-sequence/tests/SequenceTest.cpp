@@ -0,0 +1,288 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SequenceTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "Sequence.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+//! Small blocks, so that tests make many of them; restores the default at
+//! the end of a test
+struct BlockSizeSetter
+{
+   // 128 to 256 float samples per block
+   static constexpr size_t bytes = 1024;
+   BlockSizeSetter()
+       : previous { Sequence::GetMaxDiskBlockSize() }
+   {
+      Sequence::SetMaxDiskBlockSize(bytes);
+   }
+   ~BlockSizeSetter()
+   {
+      Sequence::SetMaxDiskBlockSize(previous);
+   }
+   const size_t previous;
+};
+
+std::unique_ptr<Sequence> MakeSequence()
+{
+   return std::make_unique<Sequence>(
+      std::make_shared<MockSampleBlockFactory>(),
+      SampleFormats { floatSample, floatSample });
+}
+
+void Append(Sequence& sequence, const std::vector<float>& samples)
+{
+   sequence.Append(
+      reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+      samples.size(), 1, floatSample);
+   sequence.Flush();
+}
+
+std::vector<float> Contents(const Sequence& sequence)
+{
+   std::vector<float> result(sequence.GetNumSamples().as_size_t());
+   sequence.Get(
+      reinterpret_cast<samplePtr>(result.data()), floatSample, 0,
+      result.size(), true);
+   return result;
+}
+
+//! Starts of blocks are contiguous, and lengths are within limits
+void CheckBlocks(const Sequence& sequence)
+{
+   const auto& blocks = sequence.GetBlockArray();
+   sampleCount pos = 0;
+   size_t count = 0;
+   for (const auto& block : blocks)
+   {
+      REQUIRE(block.sb);
+      REQUIRE(block.start == pos);
+      const auto length = block.sb->GetSampleCount();
+      REQUIRE(length > 0);
+      REQUIRE(length <= sequence.GetMaxBlockSize());
+      pos += length;
+      ++count;
+   }
+   REQUIRE(count == blocks.size());
+   REQUIRE(pos == sequence.GetNumSamples());
+   REQUIRE(blocks.GetNumSamples() == pos);
+}
+
+//! Blocks found by sample agree with the starts of blocks
+void CheckFindBlock(const Sequence& sequence, size_t step)
+{
+   const auto& blocks = sequence.GetBlockArray();
+   for (size_t ii = 0; ii < blocks.size(); ii += step)
+   {
+      const auto block = blocks[ii];
+      REQUIRE(size_t(sequence.FindBlock(block.start)) == ii);
+      REQUIRE(
+         size_t(sequence.FindBlock(
+            block.start + block.sb->GetSampleCount() - 1)) ==
+         ii);
+   }
+}
+
+std::vector<float> Ramp(size_t length, float first)
+{
+   std::vector<float> result(length);
+   for (size_t ii = 0; ii < length; ++ii)
+      result[ii] = first + ii;
+   return result;
+}
+} // namespace
+
+TEST_CASE("Sequence edits agree with a vector of samples")
+{
+   const BlockSizeSetter setter;
+   const auto sequence = MakeSequence();
+   // Integer values that a float represents exactly
+   std::vector<float> expected = Ramp(300000, 1);
+   Append(*sequence, expected);
+   CheckBlocks(*sequence);
+   REQUIRE(Contents(*sequence) == expected);
+
+   std::mt19937 engine { 7 };
+   const auto randomIn = [&](size_t lo, size_t hi) {
+      return std::uniform_int_distribution<size_t> { lo, hi }(engine);
+   };
+   for (int ii = 0; ii < 200; ++ii)
+   {
+      const size_t numSamples = expected.size();
+      // Short edits as well as edits spanning several blocks
+      const size_t maxLen = randomIn(0, 1) ? 100 : 5000;
+      const auto start = randomIn(0, numSamples - 1);
+      const auto len = randomIn(1, std::min(maxLen, numSamples - start));
+      switch (randomIn(0, 4))
+      {
+      case 0:
+      {
+         sequence->Delete(start, len);
+         expected.erase(
+            expected.begin() + start, expected.begin() + start + len);
+         break;
+      }
+      case 1:
+      {
+         const auto copy =
+            sequence->Copy(sequence->GetFactory(), start, start + len);
+         const auto dest = randomIn(0, numSamples);
+         sequence->Paste(dest, copy.get());
+         std::vector<float> pasted(
+            expected.begin() + start, expected.begin() + start + len);
+         expected.insert(expected.begin() + dest, pasted.begin(), pasted.end());
+         break;
+      }
+      case 2:
+      {
+         sequence->InsertSilence(start, len);
+         expected.insert(expected.begin() + start, len, 0.f);
+         break;
+      }
+      case 3:
+      {
+         const auto samples = Ramp(len, -float(ii) * 10000);
+         sequence->SetSamples(
+            reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+            start, len, floatSample);
+         std::copy(samples.begin(), samples.end(), expected.begin() + start);
+         break;
+      }
+      default:
+      {
+         // Paste a sequence of many blocks
+         const auto other = MakeSequence();
+         const auto samples = Ramp(len * 4, float(ii) * 100000);
+         Append(*other, samples);
+         sequence->Paste(start, other.get());
+         expected.insert(
+            expected.begin() + start, samples.begin(), samples.end());
+         break;
+      }
+      }
+      REQUIRE(sequence->GetNumSamples() == expected.size());
+      CheckBlocks(*sequence);
+      CheckFindBlock(*sequence, 17);
+      REQUIRE(Contents(*sequence) == expected);
+   }
+}
+
+TEST_CASE("Sequence with many blocks")
+{
+   const BlockSizeSetter setter;
+   const auto sequence = MakeSequence();
+   const auto factory = sequence->GetFactory();
+   const auto blockSize = sequence->GetMaxBlockSize();
+   // Share a few distinct blocks many times, to save memory
+   std::vector<SampleBlockPtr> distinct;
+   for (size_t ii = 0; ii < 8; ++ii)
+   {
+      const auto samples = Ramp(blockSize, ii * blockSize);
+      distinct.push_back(factory->Create(
+         reinterpret_cast<constSamplePtr>(samples.data()), blockSize,
+         floatSample));
+   }
+   constexpr size_t nBlocks = 200000;
+   for (size_t ii = 0; ii < nBlocks; ++ii)
+      sequence->AppendSharedBlock(distinct[ii % distinct.size()]);
+   REQUIRE(sequence->GetBlockArray().size() == nBlocks);
+   REQUIRE(sequence->GetNumSamples() == nBlocks * blockSize);
+
+   // Value of a sample of the original contents
+   const auto valueAt = [&](sampleCount pos) {
+      return float((pos % (distinct.size() * blockSize)).as_long_long());
+   };
+   const auto sampleAt = [&](sampleCount pos) {
+      float value {};
+      sequence->Get(
+         reinterpret_cast<samplePtr>(&value), floatSample, pos, 1, true);
+      return value;
+   };
+
+   // Edit near the start; later contents shift
+   sequence->Delete(100, 3 * blockSize);
+   sampleCount shift = -sampleCount(3 * blockSize);
+   CheckBlocks(*sequence);
+   REQUIRE(sampleAt(99) == valueAt(99));
+   REQUIRE(sampleAt(100) == valueAt(100 + 3 * blockSize));
+
+   sequence->InsertSilence(10, 5);
+   shift += 5;
+   CheckBlocks(*sequence);
+   REQUIRE(sampleAt(9) == valueAt(9));
+   REQUIRE(sampleAt(12) == 0);
+   REQUIRE(sampleAt(15) == valueAt(10));
+
+   const auto copy = sequence->Copy(factory, 1000, 1000 + 10 * blockSize);
+   sequence->Paste(50, copy.get());
+   shift += 10 * blockSize;
+   CheckBlocks(*sequence);
+   REQUIRE(sampleAt(49) == valueAt(44));
+   REQUIRE(sampleAt(50) == valueAt(995 + 3 * blockSize));
+   REQUIRE(sampleAt(50 + 10 * blockSize) == valueAt(45));
+
+   const float values[] = { -1, -2, -3 };
+   sequence->SetSamples(
+      reinterpret_cast<constSamplePtr>(values), floatSample, 20, 3,
+      floatSample);
+   CheckBlocks(*sequence);
+   REQUIRE(sampleAt(21) == -2);
+
+   // Contents at the end moved only by the edits
+   const auto end = sequence->GetNumSamples();
+   REQUIRE(end == nBlocks * blockSize + shift);
+   for (const sampleCount pos : { end - 1, end - blockSize - 7, end / 2 })
+      REQUIRE(sampleAt(pos) == valueAt(pos - shift));
+   CheckFindBlock(*sequence, 997);
+}
+
+// Run explicitly, with `lib-stretching-sequence-test "[benchmark]"`
+TEST_CASE("Sequence edit benchmark", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   const BlockSizeSetter setter;
+   std::cout << "blocks\tedit near start (us)\tedit near end (us)\n";
+   for (size_t nBlocks = 1000; nBlocks <= 1000000; nBlocks *= 10)
+   {
+      const auto sequence = MakeSequence();
+      const auto factory = sequence->GetFactory();
+      const auto blockSize = sequence->GetMaxBlockSize();
+      const auto samples = Ramp(blockSize, 0);
+      const auto block = factory->Create(
+         reinterpret_cast<constSamplePtr>(samples.data()), blockSize,
+         floatSample);
+      for (size_t ii = 0; ii < nBlocks; ++ii)
+         sequence->AppendSharedBlock(block);
+      constexpr size_t nEdits = 100;
+      const auto measure = [&](sampleCount pos) {
+         const auto start = steady_clock::now();
+         for (size_t ii = 0; ii < nEdits; ++ii)
+         {
+            // Each makes new blocks and changes the starts of later ones
+            sequence->InsertSilence(pos, blockSize / 2);
+            sequence->Delete(pos, blockSize / 2);
+         }
+         return duration<double, std::micro>(steady_clock::now() - start)
+                   .count() /
+                (2 * nEdits);
+      };
+      const auto nearStart = measure(blockSize + 10);
+      const auto nearEnd = measure(sequence->GetNumSamples() - blockSize - 10);
+      REQUIRE(sequence->GetNumSamples() == nBlocks * blockSize);
+      std::cout << nBlocks << "\t" << nearStart << "\t" << nearEnd << "\n";
+   }
+}
@@ -0,0 +1,180 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveTrackClipLookupTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "TestWaveClipMaker.h"
+#include "TestWaveTrackMaker.h"
+#include "WaveChannelUtilities.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+constexpr auto sampleRate = 100;
+
+const auto sampleBlockFactory = std::make_shared<MockSampleBlockFactory>();
+TestWaveClipMaker clipMaker { sampleRate, sampleBlockFactory };
+TestWaveTrackMaker trackMaker { sampleRate, sampleBlockFactory };
+
+//! Clips of half a second, starting every second
+WaveClipHolders MakeClips(size_t nClips)
+{
+   WaveClipHolders clips;
+   for (size_t ii = 0; ii < nClips; ++ii)
+      clips.push_back(clipMaker.ClipFilledWith(
+         0.f, sampleRate / 2, 1,
+         [ii](auto& clip) { clip.SetPlayStartTime(ii); }));
+   return clips;
+}
+
+//! What WaveChannelUtilities::GetClipAtTime computed by sorting every time
+WaveChannelUtilities::ClipPointer
+SortedLookup(WaveChannel& channel, double time)
+{
+   const auto clips = WaveChannelUtilities::SortedClipArray(channel);
+   auto p = std::find_if(
+      clips.rbegin(), clips.rend(),
+      [&](const auto& clip) { return clip->WithinPlayRegion(time); });
+   return p != clips.rend() ? *p : nullptr;
+}
+
+//! What WaveChannelUtilities::GetIntervalAtTime computed by linear search
+WaveChannelUtilities::ClipPointer
+LinearLookup(WaveChannel& channel, double time)
+{
+   for (const auto& interval : channel.Intervals())
+      if (interval->WithinPlayRegion(time))
+         return interval;
+   return nullptr;
+}
+
+bool SameClip(
+   const WaveChannelUtilities::ClipPointer& a,
+   const WaveChannelUtilities::ClipPointer& b)
+{
+   return a && b ? &a->GetClip() == &b->GetClip() : !a && !b;
+}
+
+void CheckLookups(WaveChannel& channel, double endTime)
+{
+   for (double time = -1; time < endTime; time += 0.125)
+   {
+      REQUIRE(SameClip(
+         WaveChannelUtilities::GetClipAtTime(channel, time),
+         SortedLookup(channel, time)));
+      REQUIRE(SameClip(
+         WaveChannelUtilities::GetIntervalAtTime(channel, time),
+         LinearLookup(channel, time)));
+   }
+}
+} // namespace
+
+TEST_CASE("WaveTrack clip lookup by time")
+{
+   const auto clips = MakeClips(20);
+   const auto track = trackMaker.Track(clips);
+   auto& channel = **track->Channels().begin();
+
+   SECTION("agrees with searches of all clips")
+   {
+      CheckLookups(channel, 21);
+      // Ends are open and starts are closed
+      REQUIRE(SameClip(
+         WaveChannelUtilities::GetClipAtTime(channel, 3.0),
+         channel.GetInterval(3)));
+      REQUIRE(!WaveChannelUtilities::GetClipAtTime(channel, 3.5));
+   }
+
+   SECTION("follows changes of clips")
+   {
+      CheckLookups(channel, 21);
+      clips[4]->ShiftBy(0.25);
+      CheckLookups(channel, 21);
+      // Overlap the next clip
+      clips[7]->SetPlayStartTime(7.75);
+      CheckLookups(channel, 21);
+      clips[10]->TrimLeft(0.125);
+      clips[11]->TrimRight(0.25);
+      CheckLookups(channel, 21);
+      clips[12]->StretchRightTo(14.5);
+      CheckLookups(channel, 21);
+      clips[15]->InsertSilence(clips[15]->GetPlayStartTime() + 0.25, 2.0);
+      CheckLookups(channel, 21);
+      track->RemoveInterval(clips[2]);
+      CheckLookups(channel, 21);
+      track->InsertInterval(
+         clipMaker.ClipFilledWith(
+            0.f, sampleRate, 1,
+            [](auto& clip) { clip.SetPlayStartTime(1.75); }),
+         false);
+      CheckLookups(channel, 21);
+      // Grow the clip that starts last, as recording does
+      clips[19]->AppendSilence(1.0, 1.0);
+      CheckLookups(channel, 22);
+   }
+
+   SECTION("follows clips moved to other tracks")
+   {
+      const auto otherTrack = trackMaker.Track(MakeClips(5));
+      auto& otherChannel = **otherTrack->Channels().begin();
+      track->RemoveInterval(clips[6]);
+      otherTrack->InsertInterval(clips[6], false);
+      CheckLookups(channel, 21);
+      CheckLookups(otherChannel, 21);
+      // Only the track now holding the clip follows it
+      clips[6]->ShiftBy(10.25);
+      CheckLookups(channel, 21);
+      CheckLookups(otherChannel, 21);
+      REQUIRE(SameClip(
+         WaveChannelUtilities::GetClipAtTime(otherChannel, 16.5),
+         otherChannel.GetInterval(5)));
+   }
+}
+
+// Run explicitly, with `lib-stretching-sequence-test "[benchmark]"`
+TEST_CASE("WaveTrack clip lookup benchmark", "[.][benchmark]")
+{
+   using namespace std::chrono;
+   std::cout
+      << "clips\tsorting (us)\tindexed (us)\tediting other track (us)\n";
+   for (size_t nClips = 10; nClips <= 10000; nClips *= 10)
+   {
+      const auto track = trackMaker.Track(MakeClips(nClips));
+      auto& channel = **track->Channels().begin();
+      constexpr size_t nLookups = 1000;
+      const auto measure = [&](auto lookup) {
+         size_t found = 0;
+         const auto start = steady_clock::now();
+         for (size_t ii = 0; ii < nLookups; ++ii)
+            found += lookup(channel, ii * double(nClips) / nLookups) != nullptr;
+         const auto elapsed =
+            duration<double, std::micro>(steady_clock::now() - start).count();
+         REQUIRE(found > 0);
+         return elapsed / nLookups;
+      };
+      const auto sorting = measure(SortedLookup);
+      const auto indexed = measure(
+         [](WaveChannel& channel, double time)
+         { return WaveChannelUtilities::GetClipAtTime(channel, time); });
+      // Edits of clips of another track formerly invalidated the index
+      const auto otherClips = MakeClips(1);
+      const auto otherTrack = trackMaker.Track(otherClips);
+      const auto editing = measure(
+         [&](WaveChannel& channel, double time)
+         {
+            otherClips[0]->ShiftBy(0.0);
+            return WaveChannelUtilities::GetClipAtTime(channel, time);
+         });
+      std::cout << nClips << "\t" << sorting << "\t" << indexed << "\t"
+                << editing << "\n";
+   }
+}
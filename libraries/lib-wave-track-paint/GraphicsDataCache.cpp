@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <type_traits>
 
 #include "ZoomInfo.h"
@@ -71,6 +72,10 @@ auto GetPPSMatchRange(
 }
 } // namespace
 
+void GraphicsDataCacheBase::OnEvicted(const GraphicsDataCacheKey&)
+{
+}
+
 void GraphicsDataCacheBase::Invalidate()
 {
    for (auto& item : mLookup)
@@ -295,6 +300,45 @@ GraphicsDataCacheBase::PerformBaseLookup(GraphicsDataCacheKey key)
    return newElement.Data;
 }
 
+void GraphicsDataCacheBase::FindSubstitutes(
+   GraphicsDataCacheKey key, Lookup& substitutes) const
+{
+   substitutes.clear();
+
+   if (key.PixelsPerSecond <= 0.0)
+      return;
+
+   const auto elementSamples = [this](double pixelsPerSecond)
+   { return CacheElementWidth * mScaledSampleRate / pixelsPerSecond; };
+
+   const double first = key.FirstSample;
+   const double last  = first + elementSamples(key.PixelsPerSecond);
+
+   for (const auto& item : mLookup)
+   {
+      if (
+         !item.Data->IsComplete || item.Data->AwaitsEviction ||
+         IsSamePPS(
+            mScaledSampleRate, item.Key.PixelsPerSecond, key.PixelsPerSecond))
+         continue;
+
+      const double itemFirst = item.Key.FirstSample;
+      const double itemLast =
+         itemFirst + elementSamples(item.Key.PixelsPerSecond);
+
+      if (itemFirst < last && first < itemLast)
+         substitutes.push_back(item);
+   }
+
+   const auto zoomDistance = [key](const LookupElement& item)
+   { return std::abs(std::log(item.Key.PixelsPerSecond / key.PixelsPerSecond)); };
+
+   std::stable_sort(
+      substitutes.begin(), substitutes.end(),
+      [&](const auto& lhs, const auto& rhs)
+      { return zoomDistance(lhs) < zoomDistance(rhs); });
+}
+
 bool GraphicsDataCacheBase::CreateNewItems()
 {
    for (auto& item : mNewLookupItems)
@@ -351,6 +395,7 @@ void GraphicsDataCacheBase::PerformCleanup()
 
       if (it->Data->LastCacheAccess < mCacheAccessIndex)
       {
+         OnEvicted(it->Key);
          DisposeElement(it->Data);
          mLookup.erase(it);
       }
@@ -389,6 +434,7 @@ void GraphicsDataCacheBase::PerformFullCleanup(
       if (data->LastCacheAccess >= mCacheAccessIndex)
          break;
 
+      OnEvicted(mLookup[index].Key);
       DisposeElement(data);
       data->AwaitsEviction = true;
    }
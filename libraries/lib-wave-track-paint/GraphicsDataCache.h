@@ -60,7 +60,7 @@ public:
    virtual ~GraphicsDataCacheBase() = default;
 
    //! Invalidate the cache content
-   void Invalidate();
+   virtual void Invalidate();
 
    //! Returns the sample rate associated with cache
    double GetScaledSampleRate() const noexcept;
@@ -98,6 +98,8 @@ protected:
    virtual GraphicsDataCacheElementBase* CreateElement(const GraphicsDataCacheKey& key) = 0;
    //! This method is called, when the cache element should be evicted. Implementation may not deallocate the object.
    virtual void DisposeElement(GraphicsDataCacheElementBase* element) = 0;
+   //! This method is called when the element of the key is evicted by the LRU policy, before it is disposed. Default implementation is empty
+   virtual void OnEvicted(const GraphicsDataCacheKey& key);
 
    //! This method is called on all elements matching the request that are not complete (i. e. IsComplete if false).
    virtual bool UpdateElement(
@@ -109,6 +111,13 @@ protected:
    //! Perform a lookup for the given key. This method modifies mLookup and invalidates any previous result.
    const GraphicsDataCacheElementBase* PerformBaseLookup(GraphicsDataCacheKey key);
 
+   //! Find the complete elements of other zoom levels, that overlap the samples of the key, the nearest zoom level first.
+   /*!
+    Lets an element be drawn approximately, from coarser or finer data, while its own data is not ready.
+    Elements are not valid after the next lookup.
+    */
+   void FindSubstitutes(GraphicsDataCacheKey key, Lookup& substitutes) const;
+
 private:
    // Called internally to create a list of items in the mNewLookupItems
    bool CreateNewItems();
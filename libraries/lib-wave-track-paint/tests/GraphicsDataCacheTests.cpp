@@ -83,6 +83,38 @@ void CheckCacheElementLookup(GraphicsDataCache<CacheElement>& cache, const ZoomI
       REQUIRE(it->LastCacheAccess == age);
    }
 }
+
+struct SubstitutesCache : GraphicsDataCache<CacheElement>
+{
+   SubstitutesCache()
+       : GraphicsDataCache<CacheElement>(
+            44100, []() { return std::make_unique<CacheElement>(); })
+   {
+   }
+
+   Lookup FindSubstitutes(GraphicsDataCacheKey key)
+   {
+      Lookup substitutes;
+      GraphicsDataCacheBase::FindSubstitutes(key, substitutes);
+      return substitutes;
+   }
+};
+
+struct EvictionCache : GraphicsDataCache<CacheElement>
+{
+   EvictionCache()
+       : GraphicsDataCache<CacheElement>(
+            44100, []() { return std::make_unique<CacheElement>(); })
+   {
+   }
+
+   void OnEvicted(const GraphicsDataCacheKey& key) override
+   {
+      Evicted.push_back(key);
+   }
+
+   std::vector<GraphicsDataCacheKey> Evicted;
+};
 } // namespace
 
 TEST_CASE("graphics-data-cache", "")
@@ -117,3 +149,79 @@ TEST_CASE("graphics-data-cache", "")
       CheckCacheElementLookup(cache, info, t0, t1, itemsCount);
    }
 }
+
+TEST_CASE("graphics-data-cache-substitutes", "")
+{
+   const auto zoom = ZoomInfo::GetDefaultZoom();
+
+   SubstitutesCache cache;
+   bool complete = true;
+   cache.setInitializer(
+      [&](const GraphicsDataCacheKey& key, CacheElement& element)
+      {
+         element = key;
+         element.IsComplete = complete;
+         return true;
+      });
+
+   // Two elements at the default zoom
+   cache.PerformLookup(ZoomInfo(0.0, zoom), 0, 5);
+
+   SECTION("Only other zoom levels overlapping the key are substitutes")
+   {
+      REQUIRE(cache.FindSubstitutes({ zoom, 0 }).empty());
+
+      auto substitutes = cache.FindSubstitutes({ 2 * zoom, 0 });
+      REQUIRE(substitutes.size() == 1);
+      REQUIRE(substitutes[0].Key.FirstSample == 0);
+
+      substitutes = cache.FindSubstitutes({ zoom / 2, 0 });
+      REQUIRE(substitutes.size() == 2);
+   }
+
+   SECTION("The nearest zoom level comes first")
+   {
+      cache.PerformLookup(ZoomInfo(0.0, 3 * zoom), 0, 0.5);
+
+      const auto substitutes = cache.FindSubstitutes({ 2 * zoom, 0 });
+      REQUIRE(substitutes.size() == 2);
+      REQUIRE(substitutes[0].Key.PixelsPerSecond == Approx(3 * zoom));
+      REQUIRE(substitutes[1].Key.PixelsPerSecond == Approx(zoom));
+   }
+
+   SECTION("Incomplete elements are not substitutes")
+   {
+      complete = false;
+      cache.PerformLookup(ZoomInfo(0.0, 3 * zoom), 0, 0.5);
+
+      const auto substitutes = cache.FindSubstitutes({ 2 * zoom, 0 });
+      REQUIRE(substitutes.size() == 1);
+      REQUIRE(substitutes[0].Key.PixelsPerSecond == Approx(zoom));
+   }
+}
+
+TEST_CASE("graphics-data-cache-eviction", "")
+{
+   ZoomInfo info(0.0, ZoomInfo::GetDefaultZoom());
+
+   EvictionCache cache;
+
+   cache.PerformLookup(info, 0, 1);
+   REQUIRE(cache.Evicted.empty());
+
+   for (int i = 0; i < 128; ++i)
+      cache.PerformLookup(info, i, i + 2);
+
+   // The least recently used elements are reported once each
+   REQUIRE(!cache.Evicted.empty());
+   REQUIRE(cache.Evicted.front().FirstSample == 0);
+
+   for (size_t i = 1; i < cache.Evicted.size(); ++i)
+      REQUIRE(
+         cache.Evicted[i - 1].FirstSample < cache.Evicted[i].FirstSample);
+
+   // Elements still in use are not evicted
+   auto lastLookup = cache.PerformLookup(info, 127, 129);
+   for (const auto& key : cache.Evicted)
+      REQUIRE(key.FirstSample < lastLookup.first->Key.FirstSample);
+}
@@ -400,12 +400,17 @@ bool WaveBitmapCache::InitializeElement(
    if (mPaintParamters.Height == 0)
       return false;
 
-   if (!mLookupHelper->PerformLookup(this, key))
+   // The data may yet be computed in the background, look again next time
+   if (
+      !mLookupHelper->PerformLookup(this, key) ||
+      mLookupHelper->AvailableColumns == 0)
    {
       const auto width = 1;
       const auto height = mPaintParamters.Height;
       const auto bytes = element.Allocate(width, height);
       std::memset(bytes, 0, width * height * 3);
+      element.AvailableColumns = 0;
+      element.IsComplete = false;
       return true;
    }
 
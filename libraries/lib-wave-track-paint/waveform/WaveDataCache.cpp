@@ -14,17 +14,116 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <condition_variable>
 #include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
+#include "BasicUI.h"
 #include "SampleBlock.h"
 #include "SampleFormat.h"
 #include "Sequence.h"
 #include "WaveClip.h"
 
+#include "concurrency/WorkerPool.h"
+
 #include "RoundUpUnsafe.h"
 
+BoolSetting WaveformCacheInBackground{ L"/GUI/WaveformCacheInBackground", true };
+
 namespace
 {
+audacity::concurrency::WorkerPool& WaveformWorkers()
+{
+   static audacity::concurrency::WorkerPool workers;
+   return workers;
+}
+
+//! Reads the data of the requested type from a sequence block
+bool ReadBlock(
+   const SeqBlock& inputBlock, WaveCacheSampleBlock::Type dataType,
+   WaveCacheSampleBlock& outBlock)
+{
+   outBlock.FirstSample = inputBlock.start.as_long_long();
+   outBlock.NumSamples  = inputBlock.sb->GetSampleCount();
+
+   switch (dataType)
+   {
+   case WaveCacheSampleBlock::Type::Samples:
+   {
+      samplePtr ptr = static_cast<samplePtr>(
+         static_cast<void*>(outBlock.GetWritePointer(outBlock.NumSamples)));
+
+      inputBlock.sb->GetSamples(
+         ptr, floatSample, 0, outBlock.NumSamples, false);
+   }
+   break;
+   case WaveCacheSampleBlock::Type::MinMaxRMS256:
+   {
+      size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 256);
+
+      float* ptr =
+         static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+
+      inputBlock.sb->GetSummary256(ptr, 0, framesCount);
+   }
+   break;
+   case WaveCacheSampleBlock::Type::MinMaxRMS64k:
+   {
+      size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 64 * 1024);
+
+      float* ptr =
+         static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+
+      inputBlock.sb->GetSummary64k(ptr, 0, framesCount);
+   }
+   break;
+   default:
+      return false;
+   }
+
+   outBlock.DataType = dataType;
+
+   return true;
+}
+
+//! Reads from a copy of the blocks holding samples [first, first + count),
+//! which later edits of the sequence do not change, so that a worker thread
+//! can use it
+/*!
+ The blocks are inserted into the database first, on this thread, so that
+ the worker does not insert them while the main thread holds a savepoint.
+ @pre `0 <= first && count > 0 && first + count <= blocks.GetNumSamples()`
+ */
+WaveDataCache::DataProvider MakeSnapshotDataProvider(
+   BlockArray blocks, int64_t first, int64_t count)
+{
+   const auto firstBlock = blocks.FindBlock(first);
+   auto slice =
+      blocks.Slice(firstBlock, blocks.FindBlock(first + count - 1) + 1);
+   const auto offset = blocks[firstBlock].start.as_long_long();
+
+   for (const auto& block : slice)
+      block.sb->GetBlockID();
+
+   return [blocks = std::move(slice), offset](
+             int64_t requiredSample, WaveCacheSampleBlock::Type dataType,
+             WaveCacheSampleBlock& outBlock)
+   {
+      requiredSample -= offset;
+      if (requiredSample < 0 || requiredSample >= blocks.GetNumSamples())
+         return false;
+
+      if (!ReadBlock(
+             blocks[blocks.FindBlock(requiredSample)], dataType, outBlock))
+         return false;
+
+      outBlock.FirstSample += offset;
+      return true;
+   };
+}
 //
 // Getting high-level data from the track for screen display and
 // clipping calculations
@@ -222,61 +321,60 @@ MakeDefaultDataProvider(const WaveClip& clip, int channelIndex)
          // then continue with the rest of the function
       }
 
-      const auto blockIndex  = sequence->FindBlock(requiredSample);
-      const auto& inputBlock = sequence->GetBlockArray()[blockIndex];
-
-      outBlock.FirstSample = inputBlock.start.as_long_long();
-      outBlock.NumSamples  = inputBlock.sb->GetSampleCount();
-
-      switch (dataType)
-      {
-      case WaveCacheSampleBlock::Type::Samples:
-      {
-         samplePtr ptr = static_cast<samplePtr>(
-            static_cast<void*>(outBlock.GetWritePointer(outBlock.NumSamples)));
-
-         inputBlock.sb->GetSamples(
-            ptr, floatSample, 0, outBlock.NumSamples, false);
-      }
-      break;
-      case WaveCacheSampleBlock::Type::MinMaxRMS256:
-      {
-         size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 256);
-
-         float* ptr =
-            static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
-
-         inputBlock.sb->GetSummary256(ptr, 0, framesCount);
-      }
-      break;
-      case WaveCacheSampleBlock::Type::MinMaxRMS64k:
-      {
-         size_t framesCount = RoundUpUnsafe(outBlock.NumSamples, 64 * 1024);
-
-         float* ptr =
-            static_cast<float*>(outBlock.GetWritePointer(framesCount * 3));
+      const auto blockIndex = sequence->FindBlock(requiredSample);
 
-         inputBlock.sb->GetSummary64k(ptr, 0, framesCount);
-      }
-      break;
-      default:
-         return false;
-      }
-
-      outBlock.DataType = dataType;
-
-      return true;
+      return ReadBlock(
+         sequence->GetBlockArray()[blockIndex], dataType, outBlock);
    };
 }
 
 } // namespace
 
-WaveDataCache::WaveDataCache(const WaveClip& waveClip, int channelIndex)
+struct WaveDataCache::BackgroundState final
+{
+   struct Result final
+   {
+      WaveCacheElement::Columns Columns;
+      size_t AvailableColumns { 0 };
+      bool IsComplete { false };
+      FrameStatistics::Duration FillDuration {};
+   };
+
+   // Keys of an element are always the same doubles, those of its lookup
+   using Key = std::pair<double, int64_t>;
+
+   std::mutex Mutex;
+   //! Incremented by Invalidate(), so that results of older work are dropped
+   uint64_t Generation { 0 };
+   //! Cached elements awaiting results; work for other keys is skipped or
+   //! dropped
+   /*! The data provider, which holds sample blocks, stays here until a
+    worker takes it, so that cancelled work releases the blocks at once */
+   std::map<Key, DataProvider> Pending;
+   //! Incomplete results stay, so that the main thread computes those keys
+   std::map<Key, Result> Ready;
+   //! Providers that workers are done with, released on the main thread
+   std::vector<DataProvider> Finished;
+   //! Number of workers holding providers
+   size_t Running { 0 };
+   std::condition_variable Idle;
+   //! Whether a call on the main thread is scheduled
+   bool NotificationPending { false };
+
+   //! Used and cleared on the main thread only
+   WaveDataCache* Owner { nullptr };
+};
+
+WaveDataCache::WaveDataCache(
+   const WaveClip& waveClip, int channelIndex, bool inBackground)
     : GraphicsDataCache<WaveCacheElement>(
          waveClip.GetRate() / waveClip.GetStretchRatio(),
          [] { return std::make_unique<WaveCacheElement>(); })
     , mProvider { MakeDefaultDataProvider(waveClip, channelIndex) }
+    , mBackground { inBackground ? std::make_shared<BackgroundState>() :
+                                   nullptr }
     , mWaveClip { waveClip }
+    , mChannelIndex { channelIndex }
     , mStretchChangedSubscription {
        const_cast<WaveClip&>(waveClip)
           .Observer::Publisher<StretchRatioChange>::Subscribe(
@@ -286,6 +384,69 @@ WaveDataCache::WaveDataCache(const WaveClip& waveClip, int channelIndex)
              })
     }
 {
+   if (mBackground)
+      mBackground->Owner = this;
+}
+
+WaveDataCache::~WaveDataCache()
+{
+   if (mBackground)
+   {
+      // Release the blocks after unlocking
+      std::map<BackgroundState::Key, DataProvider> pending;
+      std::vector<DataProvider> finished;
+
+      std::unique_lock<std::mutex> lock { mBackground->Mutex };
+      mBackground->Owner = nullptr;
+
+      // Cancel the work not yet started
+      ++mBackground->Generation;
+      pending.swap(mBackground->Pending);
+      mBackground->Ready.clear();
+
+      // Work in progress still reads the blocks of the clip
+      mBackground->Idle.wait(
+         lock, [this] { return mBackground->Running == 0; });
+      finished.swap(mBackground->Finished);
+   }
+}
+
+void WaveDataCache::Invalidate()
+{
+   if (mBackground)
+   {
+      // Release the blocks after unlocking
+      std::map<BackgroundState::Key, DataProvider> pending;
+      std::vector<DataProvider> finished;
+
+      std::lock_guard<std::mutex> lock { mBackground->Mutex };
+      ++mBackground->Generation;
+      pending.swap(mBackground->Pending);
+      finished.swap(mBackground->Finished);
+      mBackground->Ready.clear();
+   }
+
+   GraphicsDataCache<WaveCacheElement>::Invalidate();
+}
+
+void WaveDataCache::OnEvicted(const GraphicsDataCacheKey& key)
+{
+   if (!mBackground)
+      return;
+
+   const BackgroundState::Key stateKey { key.PixelsPerSecond,
+                                         key.FirstSample };
+   DataProvider provider;
+
+   std::lock_guard<std::mutex> lock { mBackground->Mutex };
+   if (
+      auto it = mBackground->Pending.find(stateKey);
+      it != mBackground->Pending.end())
+   {
+      provider = std::move(it->second);
+      mBackground->Pending.erase(it);
+   }
+   mBackground->Ready.erase(stateKey);
 }
 
 bool WaveDataCache::InitializeElement(
@@ -294,15 +455,252 @@ bool WaveDataCache::InitializeElement(
    auto sw = FrameStatistics::CreateStopwatch(
       FrameStatistics::SectionID::WaveDataCache);
 
+   if (mBackground && InitializeInBackground(key, element))
+      return true;
+
+   return FillElement(
+             key, GetScaledSampleRate(), mProvider, mCachedBlock, element) != 0;
+}
+
+bool WaveDataCache::InitializeInBackground(
+   const GraphicsDataCacheKey& key, WaveCacheElement& element)
+{
+   const auto scaledSampleRate = GetScaledSampleRate();
+   const auto samplesPerColumn =
+      std::max(0.0, scaledSampleRate / key.PixelsPerSecond);
+   const auto elementSamplesCount = static_cast<int64_t>(
+      std::round(samplesPerColumn * WaveDataCache::CacheElementWidth));
+
+   // The append buffer changes while recording, read it on this thread
+   const auto sequence = mWaveClip.GetSequence(mChannelIndex);
+   if (
+      elementSamplesCount == 0 || key.FirstSample < 0 ||
+      key.FirstSample + elementSamplesCount > sequence->GetNumSamples())
+      return false;
+
+   auto& state = *mBackground;
+   const BackgroundState::Key stateKey { key.PixelsPerSecond,
+                                         key.FirstSample };
+
+   std::unique_lock<std::mutex> lock { state.Mutex };
+
+   if (auto it = state.Ready.find(stateKey); it != state.Ready.end())
+   {
+      auto& result = it->second;
+
+      // The data could not be read, let the main thread try as before
+      if (!result.IsComplete)
+         return false;
+
+      element.Data             = result.Columns;
+      element.AvailableColumns = result.AvailableColumns;
+      element.IsComplete       = true;
+
+      const auto fillDuration = result.FillDuration;
+      state.Ready.erase(it);
+      lock.unlock();
+
+      FrameStatistics::AddMeasurement(
+         FrameStatistics::SectionID::WaveDataCacheFill, fillDuration);
+
+      return true;
+   }
+
+   if (state.Pending.count(stateKey) == 0)
+   {
+      lock.unlock();
+
+      DataProvider provider;
+      try
+      {
+         provider = MakeSnapshotDataProvider(
+            sequence->GetBlockArray(), key.FirstSample, elementSamplesCount);
+      }
+      catch (...)
+      {
+         // The blocks could not be inserted, let the main thread try as before
+         return false;
+      }
+
+      lock.lock();
+      state.Pending.emplace(stateKey, std::move(provider));
+      const auto generation = state.Generation;
+      lock.unlock();
+
+      WaveformWorkers().Post(
+         [pState = mBackground, stateKey, key, generation, scaledSampleRate]
+         {
+            auto& state = *pState;
+            DataProvider provider;
+            {
+               std::lock_guard<std::mutex> lock { state.Mutex };
+               const auto it = state.Pending.find(stateKey);
+               // Invalidated or evicted before the work started
+               if (
+                  generation != state.Generation || it == state.Pending.end() ||
+                  !it->second)
+                  return;
+
+               provider = std::move(it->second);
+               it->second = nullptr;
+               ++state.Running;
+            }
+
+            const auto start = FrameStatistics::Clock::now();
+
+            WaveCacheSampleBlock cachedBlock;
+            WaveCacheElement element;
+            try
+            {
+               FillElement(
+                  key, scaledSampleRate, provider, cachedBlock, element);
+            }
+            catch (...)
+            {
+               element.AvailableColumns = 0;
+               element.IsComplete       = false;
+            }
+
+            BackgroundState::Result result;
+            result.Columns          = element.Data;
+            result.AvailableColumns = element.AvailableColumns;
+            result.IsComplete       = element.IsComplete;
+            result.FillDuration     = FrameStatistics::Clock::now() - start;
+
+            {
+               std::lock_guard<std::mutex> lock { state.Mutex };
+
+               // The last references to the blocks may not be released here
+               state.Finished.push_back(std::move(provider));
+               if (--state.Running == 0)
+                  state.Idle.notify_all();
+
+               if (
+                  generation == state.Generation &&
+                  state.Pending.erase(stateKey) != 0)
+                  state.Ready.insert_or_assign(stateKey, std::move(result));
+
+               // Coalesce the notifications of many elements
+               if (std::exchange(state.NotificationPending, true))
+                  return;
+            }
+
+            BasicUI::CallAfter(
+               [wState = std::weak_ptr<BackgroundState> { pState }]
+               {
+                  const auto pState = wState.lock();
+                  if (!pState)
+                     return;
+
+                  std::vector<DataProvider> finished;
+                  WaveDataCache* owner = nullptr;
+                  {
+                     std::lock_guard<std::mutex> lock { pState->Mutex };
+                     pState->NotificationPending = false;
+                     finished.swap(pState->Finished);
+                     if (!pState->Ready.empty())
+                        owner = pState->Owner;
+                  }
+
+                  finished.clear();
+
+                  if (owner != nullptr)
+                     owner->Publish({});
+               });
+         });
+   }
+   else
+      lock.unlock();
+
+   FillFromSubstitutes(key, element);
+
+   return true;
+}
+
+void WaveDataCache::FillFromSubstitutes(
+   const GraphicsDataCacheKey& key, WaveCacheElement& element)
+{
+   FindSubstitutes(key, mSubstitutes);
+
+   const auto scaledSampleRate = GetScaledSampleRate();
+   const double samplesPerColumn = scaledSampleRate / key.PixelsPerSecond;
+
+   element.AvailableColumns = 0;
+   element.IsComplete       = false;
+
+   for (size_t columnIndex = 0; columnIndex < WaveDataCache::CacheElementWidth;
+        ++columnIndex)
+   {
+      const double first = key.FirstSample + samplesPerColumn * columnIndex;
+      const double last  = first + samplesPerColumn;
+
+      bool found = false;
+
+      // Take the columns of the nearest zoom level that has any
+      for (const auto& substitute : mSubstitutes)
+      {
+         const auto& data =
+            static_cast<const WaveCacheElement&>(*substitute.Data);
+         const double substituteSamplesPerColumn =
+            scaledSampleRate / substitute.Key.PixelsPerSecond;
+
+         const auto from = std::max<int64_t>(
+            0, static_cast<int64_t>(std::floor(
+                  (first - substitute.Key.FirstSample) /
+                  substituteSamplesPerColumn)));
+         const auto to = std::min<int64_t>(
+            data.AvailableColumns,
+            static_cast<int64_t>(std::ceil(
+               (last - substitute.Key.FirstSample) /
+               substituteSamplesPerColumn)));
+
+         if (from >= to)
+            continue;
+
+         auto& column = element.Data[columnIndex];
+         column = data.Data[from];
+
+         double squaresSum = double(column.rms) * column.rms;
+
+         for (auto index = from + 1; index < to; ++index)
+         {
+            const auto substituteColumn = data.Data[index];
+
+            column.min = std::min(column.min, substituteColumn.min);
+            column.max = std::max(column.max, substituteColumn.max);
+
+            squaresSum += double(substituteColumn.rms) * substituteColumn.rms;
+         }
+
+         column.rms = std::sqrt(squaresSum / (to - from));
+
+         found = true;
+         break;
+      }
+
+      // Columns are drawn from the left, up to the first one missing
+      if (!found)
+         break;
+
+      element.AvailableColumns = columnIndex + 1;
+   }
+}
+
+size_t WaveDataCache::FillElement(
+   const GraphicsDataCacheKey& key, double scaledSampleRate,
+   DataProvider& provider, WaveCacheSampleBlock& cachedBlock,
+   WaveCacheElement& element)
+{
    element.AvailableColumns = 0;
 
    int64_t firstSample = key.FirstSample;
 
    const auto samplesPerColumn =
-      std::max(0.0, GetScaledSampleRate() / key.PixelsPerSecond);
+      std::max(0.0, scaledSampleRate / key.PixelsPerSecond);
 
-   const size_t elementSamplesCount =
-      samplesPerColumn * WaveDataCache::CacheElementWidth;
+   // The columns below round their bounds to samples
+   const size_t elementSamplesCount = static_cast<size_t>(
+      std::round(samplesPerColumn * WaveDataCache::CacheElementWidth));
    size_t processedSamples = 0;
 
    const WaveCacheSampleBlock::Type blockType =
@@ -311,8 +709,8 @@ bool WaveDataCache::InitializeElement(
          (samplesPerColumn >= 256 ? WaveCacheSampleBlock::Type::MinMaxRMS256 :
                                     WaveCacheSampleBlock::Type::Samples);
 
-   if (blockType != mCachedBlock.DataType)
-      mCachedBlock.Reset();
+   if (blockType != cachedBlock.DataType)
+      cachedBlock.Reset();
 
    size_t columnIndex = 0;
 
@@ -325,11 +723,11 @@ bool WaveDataCache::InitializeElement(
 
       while (samplesLeft != 0)
       {
-         if (!mCachedBlock.ContainsSample(firstSample))
-            if (!mProvider(firstSample, blockType, mCachedBlock))
+         if (!cachedBlock.ContainsSample(firstSample))
+            if (!provider(firstSample, blockType, cachedBlock))
                break;
 
-         summary = mCachedBlock.GetSummary(firstSample, samplesLeft, summary);
+         summary = cachedBlock.GetSummary(firstSample, samplesLeft, summary);
          if(summary.SamplesCount == 0)
             break;
 
@@ -381,7 +779,7 @@ bool WaveDataCache::InitializeElement(
    element.AvailableColumns = columnIndex;
    element.IsComplete       = processedSamples == elementSamplesCount;
 
-   return processedSamples != 0;
+   return processedSamples;
 }
 
 bool WaveCacheSampleBlock::ContainsSample(int64_t sampleIndex) const noexcept
@@ -19,9 +19,18 @@
 #include "GraphicsDataCache.h"
 #include "WaveData.h"
 #include "Observer.h"
+#include "Prefs.h"
 
 class WaveClip;
 
+//! Whether waveform data missing from the cache are computed on worker
+//! threads, while coarser data already cached are drawn in their place
+extern WAVE_TRACK_PAINT_API BoolSetting WaveformCacheInBackground;
+
+//! Published by WaveDataCache on the main thread, when elements computed in
+//! the background are ready, and the waveform should be drawn again
+struct WaveDataCacheReady final {};
+
 //! Helper structure used to transfer the data between the data and graphics layers
 struct WAVE_TRACK_PAINT_API WaveCacheSampleBlock final
 {
@@ -89,22 +98,64 @@ struct WAVE_TRACK_PAINT_API WaveCacheElement final : GraphicsDataCacheElementBas
 };
 
 //! Cache that contains the waveform data
+/*!
+ In the background mode, an element stored in the sequence is computed on a
+ worker thread; until then, lookups return it filled from the cached elements
+ of other zoom levels, if any, and incomplete, so that the next lookup after
+ WaveDataCacheReady is published takes the result. Elements that reach the
+ append buffer are always computed on the main thread.
+
+ Workers read only blocks that the main thread inserted into the database
+ before posting the work. The main thread also takes every reference to
+ the blocks back from the workers, and destruction of the cache waits for
+ the work in progress, so no block outlives the clip because of the cache.
+ */
 class WAVE_TRACK_PAINT_API WaveDataCache final :
-    public GraphicsDataCache<WaveCacheElement>
+    public GraphicsDataCache<WaveCacheElement>,
+    public Observer::Publisher<WaveDataCacheReady>
 {
 public:
    using DataProvider = std::function<bool (int64_t requiredSample, WaveCacheSampleBlock::Type dataType, WaveCacheSampleBlock& block)>;
 
-   WaveDataCache(const WaveClip& waveClip, int channelIndex);
+   WaveDataCache(
+      const WaveClip& waveClip, int channelIndex, bool inBackground = false);
+   //! Cancels the background work not yet started, and waits for the rest
+   ~WaveDataCache() override;
+
+   //! Also discards the results of the background work not yet taken
+   void Invalidate() override;
 
 private:
+   struct BackgroundState;
+
+   //! Drops the background work for the key, so that neither it nor its
+   //! result is kept for an element no longer cached
+   void OnEvicted(const GraphicsDataCacheKey& key) override;
+
    bool InitializeElement(
       const GraphicsDataCacheKey& key, WaveCacheElement& element) override;
 
+   //! Returns false if the element must be computed on the main thread
+   bool InitializeInBackground(
+      const GraphicsDataCacheKey& key, WaveCacheElement& element);
+   void FillFromSubstitutes(
+      const GraphicsDataCacheKey& key, WaveCacheElement& element);
+
+   //! Fills the columns of element and returns the number of samples used
+   static size_t FillElement(
+      const GraphicsDataCacheKey& key, double scaledSampleRate,
+      DataProvider& provider, WaveCacheSampleBlock& cachedBlock,
+      WaveCacheElement& element);
+
    DataProvider mProvider;
 
    WaveCacheSampleBlock mCachedBlock;
 
+   //! Null unless in the background mode
+   std::shared_ptr<BackgroundState> mBackground;
+   Lookup mSubstitutes;
+
    const WaveClip& mWaveClip;
+   const int mChannelIndex;
    Observer::Subscription mStretchChangedSubscription;
 };
@@ -0,0 +1,315 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BlockArray.cpp
+
+**********************************************************************/
+#include "BlockArray.h"
+#include "SampleBlock.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+struct BlockArray::Node
+{
+   SeqBlock::SampleBlockPtr sb;
+   size_t length;
+   //! Heap order of priorities keeps the tree balanced, expecting
+   //! logarithmic depth
+   uint32_t priority;
+   NodePtr left, right;
+
+   // Totals for this node's subtree
+   size_type count;
+   sampleCount samples;
+};
+
+namespace {
+uint32_t NewPriority()
+{
+   // Pseudo-random but reproducible, and safe for any thread
+   static std::atomic<uint32_t> counter{ 0 };
+   auto x = counter.fetch_add(0x9E3779B9u, std::memory_order_relaxed);
+   x ^= x >> 16;
+   x *= 0x85EBCA6Bu;
+   x ^= x >> 13;
+   x *= 0xC2B2AE35u;
+   x ^= x >> 16;
+   return x;
+}
+
+using NodePtr = BlockArray::NodePtr;
+
+inline BlockArray::size_type Count(const NodePtr &node)
+{
+   return node ? node->count : 0;
+}
+
+inline sampleCount Samples(const NodePtr &node)
+{
+   return node ? node->samples : 0;
+}
+
+NodePtr MakeNode(SeqBlock::SampleBlockPtr sb, size_t length,
+   uint32_t priority, NodePtr left, NodePtr right)
+{
+   const auto count = Count(left) + 1 + Count(right);
+   const auto samples = Samples(left) + length + Samples(right);
+   return std::make_shared<const BlockArray::Node>(BlockArray::Node{
+      std::move(sb), length, priority, std::move(left), std::move(right),
+      count, samples });
+}
+
+//! Copy of the node with other children
+inline NodePtr WithChildren(const NodePtr &node, NodePtr left, NodePtr right)
+{
+   return MakeNode(
+      node->sb, node->length, node->priority, std::move(left), std::move(right));
+}
+
+NodePtr Merge(const NodePtr &left, const NodePtr &right)
+{
+   if (!left)
+      return right;
+   if (!right)
+      return left;
+   if (left->priority > right->priority)
+      return WithChildren(left, left->left, Merge(left->right, right));
+   else
+      return WithChildren(right, Merge(left, right->left), right->right);
+}
+
+//! @return the first `count` nodes, and the rest
+std::pair<NodePtr, NodePtr> Split(const NodePtr &node, size_t count)
+{
+   if (!node)
+      return {};
+   if (count == 0)
+      return { nullptr, node };
+   if (count >= node->count)
+      return { node, nullptr };
+   const auto leftCount = Count(node->left);
+   if (count <= leftCount) {
+      auto [first, rest] = Split(node->left, count);
+      return {
+         std::move(first), WithChildren(node, std::move(rest), node->right) };
+   }
+   else {
+      auto [first, rest] = Split(node->right, count - leftCount - 1);
+      return {
+         WithChildren(node, node->left, std::move(first)), std::move(rest) };
+   }
+}
+
+NodePtr Replace(const NodePtr &node, size_t index,
+   const SeqBlock::SampleBlockPtr &sb, size_t length)
+{
+   const auto leftCount = Count(node->left);
+   if (index < leftCount)
+      return WithChildren(
+         node, Replace(node->left, index, sb, length), node->right);
+   else if (index > leftCount)
+      return WithChildren(node, node->left,
+         Replace(node->right, index - leftCount - 1, sb, length));
+   else
+      return MakeNode(sb, length, node->priority, node->left, node->right);
+}
+
+SeqBlock At(const BlockArray::Node *node, size_t index)
+{
+   sampleCount start = 0;
+   while (true) {
+      assert(node);
+      const auto leftCount = Count(node->left);
+      if (index < leftCount)
+         node = node->left.get();
+      else {
+         start += Samples(node->left);
+         if (index == leftCount)
+            return { node->sb, start };
+         start += node->length;
+         index -= leftCount + 1;
+         node = node->right.get();
+      }
+   }
+}
+}
+
+SeqBlock BlockArray::const_iterator::operator *() const
+{
+   return At(mRoot.get(), mIndex);
+}
+
+bool BlockArray::const_iterator::operator ==(const const_iterator &other) const
+{
+   const bool atEnd = mIndex >= Count(mRoot),
+      otherAtEnd = other.mIndex >= Count(other.mRoot);
+   if (atEnd || otherAtEnd)
+      return atEnd && otherAtEnd;
+   return mRoot == other.mRoot && mIndex == other.mIndex;
+}
+
+auto BlockArray::const_iterator::operator ++() -> const_iterator &
+{
+   ++mIndex;
+   return *this;
+}
+
+auto BlockArray::const_iterator::operator ++(int) -> const_iterator
+{
+   auto result = *this;
+   ++mIndex;
+   return result;
+}
+
+BlockArray::BlockArray() = default;
+
+BlockArray::BlockArray(NodePtr root)
+   : mRoot{ std::move(root) }
+{
+}
+
+BlockArray::BlockArray(const BlockArray &other)
+   : mRoot{ other.Load() }
+{
+}
+
+BlockArray &BlockArray::operator =(const BlockArray &other)
+{
+   Store(other.Load());
+   return *this;
+}
+
+BlockArray::BlockArray(BlockArray &&other) noexcept
+   : mRoot{ other.Load() }
+{
+   other.Store(nullptr);
+}
+
+BlockArray &BlockArray::operator =(BlockArray &&other) noexcept
+{
+   auto root = other.Load();
+   other.Store(nullptr);
+   Store(std::move(root));
+   return *this;
+}
+
+BlockArray::~BlockArray() = default;
+
+auto BlockArray::Load() const -> NodePtr
+{
+   return std::atomic_load(&mRoot);
+}
+
+void BlockArray::Store(NodePtr root)
+{
+   std::atomic_store(&mRoot, std::move(root));
+}
+
+auto BlockArray::size() const -> size_type
+{
+   return Count(Load());
+}
+
+bool BlockArray::empty() const
+{
+   return !Load();
+}
+
+SeqBlock BlockArray::operator [](size_type index) const
+{
+   const auto root = Load();
+   assert(index < Count(root));
+   return At(root.get(), index);
+}
+
+SeqBlock BlockArray::back() const
+{
+   const auto root = Load();
+   assert(root);
+   return At(root.get(), root->count - 1);
+}
+
+auto BlockArray::begin() const -> const_iterator
+{
+   return { Load(), 0 };
+}
+
+auto BlockArray::end() const -> const_iterator
+{
+   // Not taking another snapshot, which might differ from that of begin()
+   return {};
+}
+
+void BlockArray::push_back(const SeqBlock &block)
+{
+   const auto length = block.sb ? block.sb->GetSampleCount() : 0;
+   Store(Merge(Load(),
+      MakeNode(block.sb, length, NewPriority(), nullptr, nullptr)));
+}
+
+void BlockArray::pop_back()
+{
+   const auto root = Load();
+   assert(root);
+   Store(Split(root, root->count - 1).first);
+}
+
+void BlockArray::swap(BlockArray &other) noexcept
+{
+   auto root = Load();
+   Store(other.Load());
+   other.Store(std::move(root));
+}
+
+sampleCount BlockArray::GetNumSamples() const
+{
+   return Samples(Load());
+}
+
+auto BlockArray::FindBlock(sampleCount pos) const -> size_type
+{
+   const auto root = Load();
+   assert(pos >= 0 && pos < Samples(root));
+   size_type result = 0;
+   auto node = root.get();
+   while (node) {
+      const auto leftSamples = Samples(node->left);
+      if (pos < leftSamples)
+         node = node->left.get();
+      else {
+         result += Count(node->left);
+         pos -= leftSamples;
+         if (pos < node->length)
+            break;
+         ++result;
+         pos -= node->length;
+         node = node->right.get();
+      }
+   }
+   return result;
+}
+
+void BlockArray::Replace(size_type index, const SeqBlock::SampleBlockPtr &sb)
+{
+   const auto root = Load();
+   assert(index < Count(root));
+   const auto length = sb ? sb->GetSampleCount() : 0;
+   Store(::Replace(root, index, sb, length));
+}
+
+BlockArray BlockArray::Slice(size_type first, size_type last) const
+{
+   assert(first <= last && last <= size());
+   auto rest = Split(Load(), first).second;
+   return BlockArray{ Split(rest, last - first).first };
+}
+
+void BlockArray::Append(const BlockArray &blocks)
+{
+   Store(Merge(Load(), blocks.Load()));
+}
@@ -0,0 +1,169 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BlockArray.h
+
+  Split from Sequence.h
+
+  @brief Index of the sample blocks of a Sequence, by position and by
+  cumulative sample count
+
+**********************************************************************/
+#ifndef __AUDACITY_BLOCK_ARRAY__
+#define __AUDACITY_BLOCK_ARRAY__
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+
+#include "SampleCount.h"
+
+class SampleBlock;
+
+// This is an internal data structure!  For advanced use only.
+class SeqBlock {
+ public:
+   using SampleBlockPtr = std::shared_ptr<SampleBlock>;
+   SampleBlockPtr sb;
+   ///the sample in the global wavetrack that this block starts at.
+   sampleCount start;
+
+   SeqBlock()
+      : sb{}, start(0)
+   {}
+
+   SeqBlock(const SampleBlockPtr &sb_, sampleCount start_)
+      : sb(sb_), start(start_)
+   {}
+
+   // Construct a SeqBlock with changed start, same file
+   SeqBlock Plus(sampleCount delta) const
+   {
+      return SeqBlock(sb, start + delta);
+   }
+};
+
+//! Sequence of SeqBlock, indexed by position and by sample
+/*!
+ The blocks are held in a balanced tree (a treap) in which each node caches
+ the count of blocks and of samples beneath it.  So the start of a block is
+ not stored but follows from the lengths of the blocks before it, and
+ subscripting, FindBlock(), Replace(), Slice() and Append() all cost
+ logarithmic time in the number of blocks.  An edit near the start of a very
+ long sequence therefore need not copy or re-offset all the later blocks.
+
+ Nodes are immutable once made and are shared among copies, so copying a
+ BlockArray takes constant time, and modifications build a new tree that
+ shares the unchanged nodes.  Each modification gives the strong guarantee.
+
+ The root is loaded and stored atomically, so that one thread may read
+ while another thread replaces the contents with a modified copy, as
+ happens when recording appends blocks while the display reads them.
+
+ Starts of SeqBlock values passed to push_back() are ignored; starts of
+ values returned are computed.
+ */
+class WAVE_TRACK_API BlockArray
+{
+public:
+   //! Opaque outside of the implementation
+   struct Node;
+   using NodePtr = std::shared_ptr<const Node>;
+
+   using size_type = size_t;
+   using value_type = SeqBlock;
+
+   //! Iterates over a snapshot of the contents when begin() was called
+   class WAVE_TRACK_API const_iterator
+   {
+   public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = SeqBlock;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = SeqBlock;
+
+      const_iterator() = default;
+
+      SeqBlock operator *() const;
+      const_iterator &operator ++();
+      const_iterator operator ++(int);
+
+      //! All iterators past the end of their snapshots compare equal
+      bool operator ==(const const_iterator &other) const;
+      bool operator !=(const const_iterator &other) const
+      {
+         return !(*this == other);
+      }
+
+   private:
+      friend BlockArray;
+      const_iterator(NodePtr root, size_type index)
+         : mRoot{ std::move(root) }, mIndex{ index }
+      {}
+
+      NodePtr mRoot;
+      size_type mIndex{};
+   };
+
+   BlockArray();
+   BlockArray(const BlockArray &other);
+   BlockArray &operator =(const BlockArray &other);
+   BlockArray(BlockArray &&other) noexcept;
+   BlockArray &operator =(BlockArray &&other) noexcept;
+   ~BlockArray();
+
+   size_type size() const;
+   bool empty() const;
+
+   //! @pre `index < size()`
+   SeqBlock operator [](size_type index) const;
+   //! @pre `!empty()`
+   SeqBlock back() const;
+
+   const_iterator begin() const;
+   const_iterator end() const;
+
+   //! @excsafety{Strong}
+   void push_back(const SeqBlock &block);
+   //! @excsafety{Strong}
+   /*! @pre `!empty()` */
+   void pop_back();
+
+   void swap(BlockArray &other) noexcept;
+
+   //! Sum of lengths of all the blocks
+   sampleCount GetNumSamples() const;
+
+   //! Index of the block containing a sample
+   /*! @pre `0 <= pos && pos < GetNumSamples()` */
+   size_type FindBlock(sampleCount pos) const;
+
+   //! Substitute another sample block at an index, shifting later starts
+   //! if the length differs
+   /*!
+    @pre `index < size()`
+    @excsafety{Strong}
+    */
+   void Replace(size_type index, const SeqBlock::SampleBlockPtr &sb);
+
+   //! Blocks in the half-open range of indices, sharing this array's nodes
+   /*! @pre `first <= last && last <= size()` */
+   BlockArray Slice(size_type first, size_type last) const;
+
+   //! Add all of the blocks of another array at the end
+   /*! @excsafety{Strong} */
+   void Append(const BlockArray &blocks);
+
+private:
+   explicit BlockArray(NodePtr root);
+
+   NodePtr Load() const;
+   void Store(NodePtr root);
+
+   NodePtr mRoot;
+};
+
+#endif
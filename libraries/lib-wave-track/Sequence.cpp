@@ -176,7 +176,7 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
 
       for (size_t i = 0; i < blockCount; i++)
       {
-         SeqBlock &oldSeqBlock = mBlock[i];
+         const SeqBlock &oldSeqBlock = mBlock[i];
          const auto &oldBlockFile = oldSeqBlock.sb;
          const auto len = oldBlockFile->GetSampleCount();
          ensureSampleBufferSize(bufferOld, oldFormats.Stored(), oldSize, len);
@@ -218,8 +218,8 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
    // Aliased files will be converted at save, per comment above.
 
    // Commit the changes to block file array
-   CommitChangesIfConsistent
-      (newBlockArray, mNumSamples, wxT("Sequence::ConvertToSampleFormat()"));
+   CommitChangesIfConsistent(newBlockArray, 0, newBlockArray.size(),
+      mNumSamples, wxT("Sequence::ConvertToSampleFormat()"));
 
    // Commit the other changes
    bSuccess = true;
@@ -431,10 +431,16 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
       --b0;
 
    // If there are blocks in the middle, use the blocks whole
-   for (int bb = b0 + 1; bb < b1; ++bb)
-      AppendBlock(pUseFactory, format,
-         dest->mBlock, dest->mNumSamples, mBlock[bb]);
-      // Increase ref count or duplicate file
+   if (!pUseFactory && b0 + 1 < b1) {
+      // Share the part of the index too
+      dest->mBlock.Append(mBlock.Slice(b0 + 1, b1));
+      dest->mNumSamples = dest->mBlock.GetNumSamples();
+   }
+   else
+      for (int bb = b0 + 1; bb < b1; ++bb)
+         AppendBlock(pUseFactory, format,
+            dest->mBlock, dest->mNumSamples, mBlock[bb]);
+         // Increase ref count or duplicate file
 
    // Do the last block
    if (b1 > b0) {
@@ -458,6 +464,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
          // Increase ref count or duplicate file
    }
 
+   dest->mBlockCount.store(dest->mBlock.size(), std::memory_order_release);
    dest->ConsistencyCheck(wxT("Sequence::Copy()"));
 
    return dest;
@@ -544,22 +551,28 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // Build and swap a copy so there is a strong exception safety guarantee
       BlockArray newBlock{ mBlock };
       sampleCount samples = mNumSamples;
-      for (unsigned int i = 0; i < srcNumBlocks; i++)
-         // AppendBlock may throw for limited disk space, if pasting from
-         // one project into another.
-         AppendBlock(pUseFactory, format,
-            newBlock, samples, srcBlock[i]);
-
-      CommitChangesIfConsistent
-         (newBlock, samples, wxT("Paste branch one"));
+      if (!pUseFactory) {
+         // Share the whole index of the source
+         newBlock.Append(srcBlock);
+         samples += srcBlock.GetNumSamples();
+      }
+      else
+         for (unsigned int i = 0; i < srcNumBlocks; i++)
+            // AppendBlock may throw for limited disk space, if pasting from
+            // one project into another.
+            AppendBlock(pUseFactory, format,
+               newBlock, samples, srcBlock[i]);
+
+      CommitChangesIfConsistent(newBlock, numBlocks, newBlock.size(),
+         samples, wxT("Paste branch one"));
       mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
       return;
    }
 
    const int b = (s == mNumSamples) ? numBlocks - 1 : FindBlock(s);
    wxASSERT((b >= 0) && (b < (int)numBlocks));
-   SeqBlock *const pBlock = &mBlock[b];
-   const auto length = pBlock->sb->GetSampleCount();
+   const SeqBlock splitBlock = mBlock[b];
+   const auto length = splitBlock.sb->GetSampleCount();
    const auto largerBlockLen = addedLen + length;
    // PRL: when insertion point is the first sample of a block,
    // and the following test fails, perhaps we could test
@@ -568,7 +581,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // Special case: we can fit all of the NEW samples inside of
       // one block!
 
-      SeqBlock &block = *pBlock;
+      const SeqBlock &block = splitBlock;
       // largerBlockLen is not more than mMaxSamples...
       SampleBuffer buffer(largerBlockLen.as_size_t(), format);
 
@@ -584,23 +597,23 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
            splitPoint, length - splitPoint, true);
 
       // largerBlockLen is not more than mMaxSamples...
-      block.sb = mpFactory->Create(
+      auto sb = mpFactory->Create(
          buffer.ptr(),
          largerBlockLen.as_size_t(),
          format);
 
       // Don't make a duplicate array.  We can still give Strong-guarantee
-      // if we modify only one block in place.
+      // if we modify only one block in place; the starts of later blocks
+      // follow.
+      mBlock.Replace(b, sb);
 
       // use No-fail-guarantee in remaining steps
-      for (unsigned int i = b + 1; i < numBlocks; i++)
-         mBlock[i].start += addedLen;
-
       mNumSamples += addedLen;
 
       // This consistency check won't throw, it asserts.
       // Proof that we kept consistency is not hard.
-      ConsistencyCheck(wxT("Paste branch two"), false);
+      ConsistencyCheck(mBlock, mMaxSamples, b, b + 1, mNumSamples,
+         wxT("Paste branch two"), false);
       mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
       return;
    }
@@ -609,11 +622,8 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    // it's simplest to just lump all the data together
    // into one big block along with the split block,
    // then resplit it all
-   BlockArray newBlock;
+   BlockArray newBlock = mBlock.Slice(0, b);
 
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b);
-
-   SeqBlock &splitBlock = mBlock[b];
    auto splitLen = splitBlock.sb->GetSampleCount();
    // s lies within splitBlock
    auto splitPoint = ( s - splitBlock.start ).as_size_t();
@@ -681,13 +691,13 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
                newBlock, s + lastStart, sampleBuffer.ptr(), rightLen);
    }
 
-   // Copy remaining blocks to NEW block array and
+   // Share remaining blocks in the NEW block array and
    // swap the NEW block array in for the old
-   for (i = b + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(addedLen));
+   const auto newBlocksEnd = newBlock.size();
+   newBlock.Append(mBlock.Slice(b + 1, numBlocks));
 
-   CommitChangesIfConsistent
-      (newBlock, mNumSamples + addedLen, wxT("Paste branch three"));
+   CommitChangesIfConsistent(newBlock, b, newBlocksEnd,
+      mNumSamples + addedLen, wxT("Paste branch three"));
 
    mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
 }
@@ -847,6 +857,22 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
          }
       }
 
+      // Make sure that start times and lengths are consistent
+      const auto numSamples = mBlock.GetNumSamples();
+      if (wb.start != numSamples)
+      {
+         wxLogWarning(
+            wxT("Gap detected in project file.\n")
+            wxT("   Start (%s) for block file %lld is not one sample past end of previous block (%s).\n")
+            wxT("   Moving start so blocks are contiguous."),
+            // PRL:  Why bother with Internat when the above is just wxT?
+            Internat::ToString(wb.start.as_double(), 0),
+            wb.sb->GetBlockID(),
+            Internat::ToString(numSamples.as_double(), 0));
+         mErrorOpening = true;
+      }
+
+      // The start of the block follows from the previous lengths
       mBlock.push_back(wb);
       return true;
    }
@@ -946,28 +972,8 @@ void Sequence::HandleXMLEndTag(const std::string_view& tag)
 
    // Make sure that the sequence is valid.
 
-   // Make sure that start times and lengths are consistent
-   sampleCount numSamples = 0;
-   const size_t blockCount = mBlock.size();
-
-   for (unsigned b = 0; b < blockCount;  b++)
-   {
-      SeqBlock &block = mBlock[b];
-      if (block.start != numSamples)
-      {
-         wxLogWarning(
-            wxT("Gap detected in project file.\n")
-            wxT("   Start (%s) for block file %lld is not one sample past end of previous block (%s).\n")
-            wxT("   Moving start so blocks are contiguous."),
-            // PRL:  Why bother with Internat when the above is just wxT?
-            Internat::ToString(block.start.as_double(), 0),
-            block.sb->GetBlockID(),
-            Internat::ToString(numSamples.as_double(), 0));
-         block.start = numSamples;
-         mErrorOpening = true;
-      }
-      numSamples += block.sb->GetSampleCount();
-   }
+   // Starts of blocks were checked in HandleXMLTag
+   const auto numSamples = mBlock.GetNumSamples();
 
    mBlockCount.store(mBlock.size(), std::memory_order_release);
 
@@ -1054,42 +1060,9 @@ int Sequence::FindBlock(sampleCount pos) const
    if (pos == 0)
       return 0;
 
-   const size_t numBlocks = mBlockCount.load(std::memory_order_relaxed);
-
-   size_t lo = 0, hi = numBlocks, guess;
-   sampleCount loSamples = 0, hiSamples = mNumSamples;
-
-   while (true) {
-      //this is not a binary search, but a
-      //dictionary search where we guess something smarter than the binary division
-      //of the unsearched area, since samples are usually proportional to block file number.
-      const double frac = (pos - loSamples).as_double() /
-         (hiSamples - loSamples).as_double();
-      guess = std::min(hi - 1, lo + size_t(frac * (hi - lo)));
-      const SeqBlock &block = mBlock[guess];
-
-      wxASSERT(block.sb->GetSampleCount() > 0);
-      wxASSERT(lo <= guess && guess < hi && lo < hi);
-
-      if (pos < block.start) {
-         wxASSERT(lo != guess);
-         hi = guess;
-         hiSamples = block.start;
-      }
-      else {
-         const sampleCount nextStart = block.start + block.sb->GetSampleCount();
-         if (pos < nextStart)
-            break;
-         else {
-            wxASSERT(guess < hi - 1);
-            lo = guess + 1;
-            loSamples = nextStart;
-         }
-      }
-   }
-
-   const int rval = guess;
-   wxASSERT(rval >= 0 && rval < numBlocks &&
+   // Logarithmic search, by the sample counts cached in the block index
+   const int rval = mBlock.FindBlock(pos);
+   wxASSERT(rval >= 0 && rval < mBlock.size() &&
             pos >= mBlock[rval].start &&
             pos < mBlock[rval].start + mBlock[rval].sb->GetSampleCount());
 
@@ -1223,8 +1196,8 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
    }
 
    int b = FindBlock(start);
-   BlockArray newBlock;
-   std::copy( mBlock.begin(), mBlock.begin() + b, std::back_inserter(newBlock) );
+   const auto firstChanged = b;
+   BlockArray newBlock = mBlock.Slice(0, b);
 
    while (len > 0
       // Redundant termination condition,
@@ -1233,8 +1206,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       // that cause the loop to make no progress because blen == 0
       && b < (int)size
    ) {
-      newBlock.push_back( mBlock[b] );
-      SeqBlock &block = newBlock.back();
+      SeqBlock block = mBlock[b];
       // start is within block
       const auto bstart = ( start - block.start ).as_size_t();
       const auto fileLength = block.sb->GetSampleCount();
@@ -1299,6 +1271,8 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
             block.sb = factory.CreateSilent(fileLength, dstFormat);
       }
 
+      newBlock.push_back( block );
+
       // blen might be zero for inconsistent Sequence...
       if( buffer )
          buffer += (blen * SAMPLE_SIZE(format));
@@ -1310,9 +1284,11 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       b++;
    }
 
-   std::copy( mBlock.begin() + b, mBlock.end(), std::back_inserter(newBlock) );
+   const auto lastChanged = b;
+   newBlock.Append( mBlock.Slice(b, size) );
 
-   CommitChangesIfConsistent( newBlock, mNumSamples, wxT("SetSamples") );
+   CommitChangesIfConsistent( newBlock, firstChanged, lastChanged,
+      mNumSamples, wxT("SetSamples") );
 
    mSampleFormats.UpdateEffective(effectiveFormat);
 }
@@ -1354,7 +1330,7 @@ void Sequence::AppendSharedBlock(const SeqBlock::SampleBlockPtr &pBlock)
       THROW_INCONSISTENCY_EXCEPTION;
 
    BlockArray newBlock;
-   newBlock.emplace_back( pBlock, mNumSamples );
+   newBlock.push_back( SeqBlock( pBlock, mNumSamples ) );
    auto newNumSamples = mNumSamples + len;
 
    AppendBlocksIfConsistent(newBlock, false,
@@ -1443,8 +1419,8 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
 
    // If the last block is not full, we need to add samples to it
    int numBlocks = mBlock.size();
-   SeqBlock *pLastBlock;
-   decltype(pLastBlock->sb->GetSampleCount()) length;
+   SeqBlock lastBlock;
+   decltype(lastBlock.sb->GetSampleCount()) length;
    size_t bufferSize = mMaxSamples;
    const auto dstFormat = mSampleFormats.Stored();
    SampleBuffer buffer2(bufferSize, dstFormat);
@@ -1452,9 +1428,8 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
    if (coalesce &&
        numBlocks > 0 &&
        (length =
-        (pLastBlock = &mBlock.back())->sb->GetSampleCount()) < mMinSamples) {
+        (lastBlock = mBlock.back()).sb->GetSampleCount()) < mMinSamples) {
       // Enlarge a sub-minimum block at the end
-      const SeqBlock &lastBlock = *pLastBlock;
       const auto addLen = std::min(mMaxSamples - length, len);
 
       // Reading same format as was saved before causes no dithering
@@ -1589,8 +1564,8 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    const auto format = mSampleFormats.Stored();
    auto sampleSize = SAMPLE_SIZE(format);
 
-   SeqBlock *pBlock;
-   decltype(pBlock->sb->GetSampleCount()) length;
+   SeqBlock b;
+   decltype(b.sb->GetSampleCount()) length;
 
    // One buffer for reuse in various branches here
    SampleBuffer scratch;
@@ -1601,8 +1576,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // block and the resulting length is not too small, perform the
    // deletion within this block:
    if (b0 == b1 &&
-       (length = (pBlock = &mBlock[b0])->sb->GetSampleCount()) - len >= mMinSamples) {
-      SeqBlock &b = *pBlock;
+       (length = (b = mBlock[b0]).sb->GetSampleCount()) - len >= mMinSamples) {
       // start is within block
       auto pos = ( start - b.start ).as_size_t();
 
@@ -1623,38 +1597,34 @@ void Sequence::Delete(sampleCount start, sampleCount len)
            // is not more than the length of the block
            ( pos + len ).as_size_t(), newLen - pos, true);
 
-      b.sb = factory.Create(scratch.ptr(), newLen, format);
+      auto sb = factory.Create(scratch.ptr(), newLen, format);
 
       // Don't make a duplicate array.  We can still give Strong-guarantee
-      // if we modify only one block in place.
+      // if we modify only one block in place; the starts of later blocks
+      // follow.
+      mBlock.Replace(b0, sb);
 
       // use No-fail-guarantee in remaining steps
 
-      for (unsigned int j = b0 + 1; j < numBlocks; j++)
-         mBlock[j].start -= len;
-
       mNumSamples -= len;
 
       // This consistency check won't throw, it asserts.
       // Proof that we kept consistency is not hard.
-      ConsistencyCheck(wxT("Delete - branch one"), false);
+      ConsistencyCheck(mBlock, mMaxSamples, b0, b0 + 1, mNumSamples,
+         wxT("Delete - branch one"), false);
       return;
    }
 
-   // Create a NEW array of blocks
-   BlockArray newBlock;
-
-   // Copy the blocks before the deletion point over to
-   // the NEW array
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b0);
-   unsigned int i;
+   // Create a NEW array of blocks, sharing the blocks before the
+   // deletion point
+   BlockArray newBlock = mBlock.Slice(0, b0);
 
    // First grab the samples in block b0 before the deletion point
    // into preBuffer.  If this is enough samples for its own block,
    // or if this would be the first block in the array, write it out.
    // Otherwise combine it with the previous block (splitting them
    // 50/50 if necessary).
-   const SeqBlock &preBlock = mBlock[b0];
+   const SeqBlock preBlock = mBlock[b0];
    // start is within preBlock
    auto preBufferLen = ( start - preBlock.start ).as_size_t();
    if (preBufferLen) {
@@ -1668,7 +1638,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.push_back(SeqBlock(pFile, preBlock.start));
       } else {
-         const SeqBlock &prepreBlock = mBlock[b0 - 1];
+         const SeqBlock prepreBlock = mBlock[b0 - 1];
          const auto prepreLen = prepreBlock.sb->GetSampleCount();
          const auto sum = prepreLen + preBufferLen;
 
@@ -1696,7 +1666,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // for its own block, or if this would be the last block in
    // the array, write it out.  Otherwise combine it with the
    // subsequent block (splitting them 50/50 if necessary).
-   const SeqBlock &postBlock = mBlock[b1];
+   const SeqBlock postBlock = mBlock[b1];
    // start + len - 1 lies within postBlock
    const auto postBufferLen = (
        (postBlock.start + postBlock.sb->GetSampleCount()) - (start + len)
@@ -1714,7 +1684,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.push_back(SeqBlock(file, start));
       } else {
-         SeqBlock &postpostBlock = mBlock[b1 + 1];
+         const SeqBlock postpostBlock = mBlock[b1 + 1];
          const auto postpostLen = postpostBlock.sb->GetSampleCount();
          const auto sum = postpostLen + postBufferLen;
 
@@ -1737,21 +1707,23 @@ void Sequence::Delete(sampleCount start, sampleCount len)
       // right on the end of a block.
    }
 
-   // Copy the remaining blocks over from the old array
-   for (i = b1 + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(-len));
+   // Share the remaining blocks of the old array
+   const auto newBlocksEnd = newBlock.size();
+   newBlock.Append(mBlock.Slice(b1 + 1, numBlocks));
 
-   CommitChangesIfConsistent
-      (newBlock, mNumSamples - len, wxT("Delete - branch two"));
+   // The new blocks may begin at b0 - 1, after combination with prepreBlock
+   CommitChangesIfConsistent(newBlock, b0 > 0 ? b0 - 1 : 0, newBlocksEnd,
+      mNumSamples - len, wxT("Delete - branch two"));
 }
 
 void Sequence::ConsistencyCheck(const wxChar *whereStr, bool mayThrow) const
 {
-   ConsistencyCheck(mBlock, mMaxSamples, 0, mNumSamples, whereStr, mayThrow);
+   ConsistencyCheck(mBlock, mMaxSamples, 0, mBlock.size(), mNumSamples,
+      whereStr, mayThrow);
 }
 
 void Sequence::ConsistencyCheck
-   (const BlockArray &mBlock, size_t maxSamples, size_t from,
+   (const BlockArray &mBlock, size_t maxSamples, size_t from, size_t to,
     sampleCount mNumSamples, const wxChar *whereStr,
     bool WXUNUSED(mayThrow))
 {
@@ -1759,28 +1731,22 @@ void Sequence::ConsistencyCheck
    // gives a little more discrimination
    std::optional<InconsistencyException> ex;
 
-   unsigned int numBlocks = mBlock.size();
-
-   unsigned int i;
-   sampleCount pos = from < numBlocks ? mBlock[from].start : mNumSamples;
-   if ( from == 0 && pos != 0 )
-      ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-
-   for (i = from; !ex && i < numBlocks; i++) {
-      const SeqBlock &seqBlock = mBlock[i];
-      if (pos != seqBlock.start)
-         ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
+   // Starts of blocks are computed from the lengths by BlockArray, so they
+   // are contiguous; the total is kept there too, and need not be summed
+   const auto numBlocks = mBlock.size();
+   to = std::min(to, numBlocks);
 
+   for (auto i = from; !ex && i < to; i++) {
+      const SeqBlock seqBlock = mBlock[i];
       if ( seqBlock.sb ) {
          const auto length = seqBlock.sb->GetSampleCount();
          if (length > maxSamples)
             ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-         pos += length;
       }
       else
          ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
    }
-   if ( !ex && pos != mNumSamples )
+   if ( !ex && mBlock.GetNumSamples() != mNumSamples )
       ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
 
    if ( ex )
@@ -1802,9 +1768,10 @@ void Sequence::ConsistencyCheck
 }
 
 void Sequence::CommitChangesIfConsistent
-   (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr)
+   (BlockArray &newBlock, size_t from, size_t to,
+    sampleCount numSamples, const wxChar *whereStr)
 {
-   ConsistencyCheck( newBlock, mMaxSamples, 0, numSamples, whereStr ); // may throw
+   ConsistencyCheck( newBlock, mMaxSamples, from, to, numSamples, whereStr ); // may throw
 
    // now commit
    // use No-fail-guarantee
@@ -1824,39 +1791,25 @@ void Sequence::AppendBlocksIfConsistent
    if (additionalBlocks.empty())
       return;
 
-   bool tmpValid = false;
-   SeqBlock tmp;
-
-   if ( replaceLast && ! mBlock.empty() ) {
-      tmp = mBlock.back(), tmpValid = true;
-      mBlockCount.store(mBlock.size() - 1, std::memory_order_release);
-      mBlock.pop_back();
-   }
-   auto prevSize = mBlock.size();
-
-   bool consistent = false;
-   auto cleanup = finally( [&] {
-      if ( !consistent ) {
-         mBlock.resize( prevSize );
-
-         if ( tmpValid )
-            mBlock.push_back( tmp );
-      }
-      mBlockCount.store(mBlock.size(), std::memory_order_release);
-   } );
-
-   std::copy( additionalBlocks.begin(), additionalBlocks.end(),
-              std::back_inserter( mBlock ) );
+   // Copying the index is cheap, and a reader in another thread sees either
+   // the old or the new contents, when the copy is swapped in
+   BlockArray newBlock{ mBlock };
+   if ( replaceLast && ! newBlock.empty() )
+      newBlock.pop_back();
+   const auto prevSize = newBlock.size();
+   newBlock.Append( additionalBlocks );
 
    // Check consistency only of the blocks that were added,
    // avoiding quadratic time for repeated checking of repeating appends
-   ConsistencyCheck( mBlock, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
+   ConsistencyCheck( newBlock, mMaxSamples, prevSize, newBlock.size(),
+      numSamples, whereStr ); // may throw
 
    // now commit
    // use No-fail-guarantee
 
+   mBlock.swap(newBlock);
+   mBlockCount.store(mBlock.size(), std::memory_order_release);
    mNumSamples = numSamples;
-   consistent = true;
 }
 
 void Sequence::DebugPrintf
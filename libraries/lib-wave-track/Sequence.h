@@ -15,6 +15,7 @@
 #include <deque>
 #include <functional>
 
+#include "BlockArray.h"
 #include "SampleFormat.h"
 #include "XMLTagHandler.h"
 
@@ -25,29 +26,6 @@ class SampleBlock;
 class SampleBlockFactory;
 using SampleBlockFactoryPtr = std::shared_ptr<SampleBlockFactory>;
 
-// This is an internal data structure!  For advanced use only.
-class SeqBlock {
- public:
-   using SampleBlockPtr = std::shared_ptr<SampleBlock>;
-   SampleBlockPtr sb;
-   ///the sample in the global wavetrack that this block starts at.
-   sampleCount start;
-
-   SeqBlock()
-      : sb{}, start(0)
-   {}
-
-   SeqBlock(const SampleBlockPtr &sb_, sampleCount start_)
-      : sb(sb_), start(start_)
-   {}
-
-   // Construct a SeqBlock with changed start, same file
-   SeqBlock Plus(sampleCount delta) const
-   {
-      return SeqBlock(sb, start + delta);
-   }
-};
-class BlockArray : public std::deque<SeqBlock> {};
 using BlockPtrArray = std::deque<SeqBlock*>; // non-owning pointers
 
 class WAVE_TRACK_API Sequence final : public XMLTagHandler{
@@ -319,8 +297,10 @@ public:
       (const BlockArray &block, sampleCount numSamples, wxString *dest);
 
 private:
+   // Checks only the blocks in [from, to), besides the total length;
+   // the starts of blocks are consistent by construction of BlockArray
    static void ConsistencyCheck
-      (const BlockArray &block, size_t maxSamples, size_t from,
+      (const BlockArray &block, size_t maxSamples, size_t from, size_t to,
        sampleCount numSamples, const wxChar *whereStr,
        bool mayThrow = true);
 
@@ -328,8 +308,11 @@ private:
    // They either throw because final consistency check fails, or swap the
    // changed contents into place.
 
+   // Blocks of newBlock outside of [from, to) are assumed to be shared
+   // with the old contents, which were checked already
    void CommitChangesIfConsistent
-      (BlockArray &newBlock, sampleCount numSamples, const wxChar *whereStr);
+      (BlockArray &newBlock, size_t from, size_t to,
+       sampleCount numSamples, const wxChar *whereStr);
 
    void AppendBlocksIfConsistent
       (BlockArray &additionalBlocks, bool replaceLast,
@@ -412,12 +412,10 @@ auto WaveChannelUtilities::SortedClipArray(const WaveChannel &channel)
 auto WaveChannelUtilities::GetClipAtTime(
    WaveChannel &channel, double time) -> ClipPointer
 {
-   const auto clips = SortedClipArray(channel);
-   auto p = std::find_if(
-      clips.rbegin(), clips.rend(), [&](const auto& clip) {
-         return clip->WithinPlayRegion(time);
-      });
-   return p != clips.rend() ? *p : nullptr;
+   // Use the lookup by time cached in the track
+   if (const auto pClip = channel.GetTrack().GetLatestIntervalAtTime(time))
+      return pClip->GetChannel<Clip>(channel.GetChannelIndex());
+   return nullptr;
 }
 
 
@@ -430,9 +428,7 @@ auto WaveChannelUtilities::GetClipAtTime(
 auto WaveChannelUtilities::GetIntervalAtTime(WaveChannel &channel, double t)
    -> ClipPointer
 {
-   ClipPointer result;
-   for (const auto &interval : channel.Intervals())
-      if (interval->WithinPlayRegion(t))
-         return interval;
+   if (const auto pClip = channel.GetTrack().GetIntervalAtTime(t))
+      return pClip->GetChannel<Clip>(channel.GetChannelIndex());
    return nullptr;
 }
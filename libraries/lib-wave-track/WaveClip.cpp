@@ -455,6 +455,7 @@ void WaveClip::TransferSequence(WaveClip &origClip, WaveClip &newClip)
    // Move right channel into result
    newClip.mSequences.resize(1);
    newClip.mSequences[0] = move(origClip.mSequences[1]);
+   newClip.PlayRegionChanged();
    // Delayed satisfaction of the class invariants after the empty construction
    newClip.CheckInvariants();
 }
@@ -520,6 +521,7 @@ void WaveClip::MakeStereo(WaveClip &&other, bool mustAlign)
    mCutLines.clear();
    mSequences.resize(2);
    mSequences[1] = move(other.mSequences[0]);
+   PlayRegionChanged();
 
    this->Attachments::ForCorresponding(other,
    [mustAlign](WaveClipListener *pLeft, WaveClipListener *pRight){
@@ -562,6 +564,7 @@ void WaveClip::OnProjectTempoChange(
       mEnvelope->RescaleTimesBy(ratioChange);
    }
    mProjectTempo = newTempo;
+   PlayRegionChanged();
    Observer::Publisher<StretchRatioChange>::Publish(
       StretchRatioChange { GetStretchRatio() });
 }
@@ -581,6 +584,7 @@ void WaveClip::StretchLeftTo(double to)
    mEnvelope->SetOffset(mSequenceOffset);
    mEnvelope->RescaleTimesBy(ratioChange);
    StretchCutLines(ratioChange);
+   PlayRegionChanged();
    Observer::Publisher<StretchRatioChange>::Publish(
       StretchRatioChange { GetStretchRatio() });
 }
@@ -606,6 +610,7 @@ void WaveClip::StretchBy(double ratio)
    mEnvelope->SetOffset(mSequenceOffset);
    mEnvelope->RescaleTimesBy(ratio);
    StretchCutLines(ratio);
+   PlayRegionChanged();
    Observer::Publisher<StretchRatioChange>::Publish(
       StretchRatioChange { GetStretchRatio() });
 }
@@ -734,9 +739,29 @@ constSamplePtr WaveClip::GetAppendBuffer(size_t ii) const
 
 void WaveClip::MarkChanged() noexcept // NOFAIL-GUARANTEE
 {
+   PlayRegionChanged();
    Attachments::ForEach(std::mem_fn(&WaveClipListener::MarkChanged));
 }
 
+WaveClipPlayRegionObserver::~WaveClipPlayRegionObserver() = default;
+
+void WaveClip::SetPlayRegionObserver(
+   WaveClipPlayRegionObserver *pObserver) noexcept
+{
+   mpPlayRegionObserver.store(pObserver, std::memory_order_release);
+}
+
+WaveClipPlayRegionObserver *WaveClip::GetPlayRegionObserver() const noexcept
+{
+   return mpPlayRegionObserver.load(std::memory_order_acquire);
+}
+
+void WaveClip::PlayRegionChanged() noexcept
+{
+   if (const auto pObserver = GetPlayRegionObserver())
+      pObserver->OnPlayRegionChange(*this);
+}
+
 std::pair<float, float> WaveClip::GetMinMax(size_t ii,
    double t0, double t1, bool mayThrow) const
 {
@@ -818,7 +843,9 @@ WaveClip::AppendToChannel(size_t iChannel,
    constSamplePtr buffer, sampleFormat format, size_t len)
 {
    assert(iChannel < NChannels());
-   return mSequences[iChannel]->AppendNewBlock(buffer, format, len);
+   auto result = mSequences[iChannel]->AppendNewBlock(buffer, format, len);
+   PlayRegionChanged();
+   return result;
 }
 
 /*! @excsafety{Strong} */
@@ -839,6 +866,7 @@ void WaveClip::AppendLegacySharedBlock(
    // does not need to be relaxed.  The clip is in a still unzipped track.
    assert(NChannels() == 1);
    mSequences[0]->AppendSharedBlock( pBlock );
+   PlayRegionChanged();
 }
 
 bool WaveClip::Append(size_t iChannel, const size_t nChannels,
@@ -1025,6 +1053,7 @@ void WaveClip::HandleXMLEndTag(const std::string_view& tag)
    mSequences.shrink_to_fit();
    if (tag == WaveClip_tag)
       UpdateEnvelopeTrackLen();
+   PlayRegionChanged();
    // A proof of this assertion assumes that nothing has happened since
    // construction of this, besides calls to the other deserialization
    // functions
@@ -1810,6 +1839,7 @@ sampleCount WaveClip::GetVisibleSampleCount() const
 void WaveClip::SetTrimLeft(double trim)
 {
     mTrimLeft = std::max(.0, trim);
+    PlayRegionChanged();
 }
 
 double WaveClip::GetTrimLeft() const noexcept
@@ -1820,6 +1850,7 @@ double WaveClip::GetTrimLeft() const noexcept
 void WaveClip::SetTrimRight(double trim)
 {
     mTrimRight = std::max(.0, trim);
+    PlayRegionChanged();
 }
 
 double WaveClip::GetTrimRight() const noexcept
@@ -1861,12 +1892,14 @@ void WaveClip::TrimLeftTo(double to)
    mTrimLeft =
       std::clamp(to, SnapToTrackSample(mSequenceOffset), GetPlayEndTime()) -
       mSequenceOffset;
+   PlayRegionChanged();
 }
 
 void WaveClip::TrimRightTo(double to)
 {
    const auto endTime = SnapToTrackSample(GetSequenceEndTime());
    mTrimRight = endTime - std::clamp(to, GetPlayStartTime(), endTime);
+   PlayRegionChanged();
 }
 
 double WaveClip::GetSequenceStartTime() const noexcept
@@ -1880,6 +1913,7 @@ void WaveClip::SetSequenceStartTime(double startTime)
 {
     mSequenceOffset = startTime;
     mEnvelope->SetOffset(startTime);
+    PlayRegionChanged();
 }
 
 double WaveClip::GetSequenceEndTime() const
@@ -2032,6 +2066,7 @@ void WaveClip::AssertOrRepairStrongInvariant()
    if (!StrongInvariant()) {
       assert(false);
       RepairChannels();
+      PlayRegionChanged();
       assert(StrongInvariant());
    }
 }
@@ -2066,5 +2101,6 @@ WaveClip::Transaction::~Transaction()
       clip.mSequences.swap(sequences);
       clip.mTrimLeft = mTrimLeft;
       clip.mTrimRight = mTrimRight;
+      clip.PlayRegionChanged();
    }
 }
@@ -22,6 +22,7 @@
 
 #include <wx/longlong.h>
 
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <optional>
@@ -82,6 +83,17 @@ struct WaveClipListener : WaveClipListenerBase {
    virtual void Erase(size_t index);
 };
 
+//! Notified by a clip when its play region may have changed
+/*! The clip may notify from a thread other than the main thread, as when
+ recording appends to it */
+class WAVE_TRACK_API WaveClipPlayRegionObserver /* not final */
+{
+public:
+   virtual ~WaveClipPlayRegionObserver();
+   /*! @excsafety{No-fail} */
+   virtual void OnPlayRegionChange(const WaveClip &clip) noexcept = 0;
+};
+
 class WAVE_TRACK_API WaveClipChannel
    : public ChannelInterval
    , public ClipTimes
@@ -862,6 +874,11 @@ public:
             const SampleBlockFactoryPtr &factory,
             bool copyCutlines, CreateToken token);
 
+   //! Set by the track that holds the clip; copies of the clip have none
+   void SetPlayRegionObserver(WaveClipPlayRegionObserver *pObserver) noexcept;
+   //! May be null
+   WaveClipPlayRegionObserver *GetPlayRegionObserver() const noexcept;
+
 private:
    static void TransferSequence(WaveClip &origClip, WaveClip &newClip);
    static void FixSplitCutlines(
@@ -873,6 +890,11 @@ private:
    /*! @excsafety{No-fail} */
    void MarkChanged() noexcept;
 
+   //! Called by operations that may change GetPlayStartTime() or
+   //! GetPlayEndTime(); notifies the observer
+   /*! @excsafety{No-fail} */
+   void PlayRegionChanged() noexcept;
+
    // Always gives non-negative answer, not more than sample sequence length
    // even if t0 really falls outside that range
    sampleCount TimeToSequenceSamples(double t) const;
@@ -976,6 +998,8 @@ private:
    bool mIsPlaceholder { false };
 
    wxString mName;
+
+   std::atomic<WaveClipPlayRegionObserver*> mpPlayRegionObserver{ nullptr };
 };
 
 #endif
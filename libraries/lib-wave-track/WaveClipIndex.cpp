@@ -0,0 +1,145 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveClipIndex.cpp
+
+**********************************************************************/
+#include "WaveClipIndex.h"
+
+#include <algorithm>
+
+WaveClipIndex::WaveClipIndex() = default;
+
+WaveClipIndex::~WaveClipIndex()
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   for (const auto &entry : mEntries)
+      if (entry.pClip->GetPlayRegionObserver() == this)
+         entry.pClip->SetPlayRegionObserver(nullptr);
+}
+
+void WaveClipIndex::Insert(const WaveClipHolder &pClip)
+{
+   assert(pClip);
+   std::lock_guard<std::mutex> lock{ mMutex };
+
+   const Key key{ pClip->GetPlayStartTime(), mNextSerial };
+   const auto inserted = mKeys.emplace(pClip.get(), key);
+   assert(inserted.second); // pre
+   try {
+      const auto iter = mEntries.insert(Locate(key),
+         Entry{ key.first, pClip->GetPlayEndTime(), 0, key.second, pClip });
+      const size_t position = iter - mEntries.begin();
+      UpdateMaxEnds(position, position);
+   }
+   catch (...) {
+      mKeys.erase(inserted.first);
+      throw;
+   }
+   ++mNextSerial;
+   pClip->SetPlayRegionObserver(this);
+}
+
+void WaveClipIndex::Remove(const WaveClip &clip) noexcept
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   const auto found = mKeys.find(&clip);
+   if (found == mKeys.end())
+      return;
+
+   const auto iter = Locate(found->second);
+   assert(iter != mEntries.end() && iter->pClip.get() == &clip);
+   // Another track may have taken the clip already
+   if (iter->pClip->GetPlayRegionObserver() == this)
+      iter->pClip->SetPlayRegionObserver(nullptr);
+
+   const size_t position = iter - mEntries.begin();
+   mEntries.erase(iter);
+   mKeys.erase(found);
+   UpdateMaxEnds(position, position);
+}
+
+size_t WaveClipIndex::size() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mEntries.size();
+}
+
+WaveClipHolder WaveClipIndex::Find(double time, bool latest) const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+
+   // Clips that start after the time can't contain it; search back from the
+   // last that does not, until no earlier clip ends after the time
+   const auto begin = mEntries.begin();
+   auto iter = std::upper_bound(begin, mEntries.end(), time,
+      [](double t, const Entry &entry){ return t < entry.start; });
+   const Entry *pResult = nullptr;
+   while (iter != begin && (--iter)->maxEnd > time) {
+      if (iter->pClip->WithinPlayRegion(time)) {
+         if (latest)
+            return iter->pClip;
+         if (!pResult || iter->serial < pResult->serial)
+            pResult = &*iter;
+      }
+   }
+   return pResult ? pResult->pClip : nullptr;
+}
+
+void WaveClipIndex::OnPlayRegionChange(const WaveClip &clip) noexcept
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   const auto found = mKeys.find(&clip);
+   if (found == mKeys.end())
+      return;
+
+   const auto first = mEntries.begin(), last = mEntries.end();
+   const auto iter = Locate(found->second);
+   assert(iter != last && iter->pClip.get() == &clip);
+   iter->end = clip.GetPlayEndTime();
+
+   const size_t from = iter - first;
+   size_t to = from;
+   if (const auto start = clip.GetPlayStartTime(); start != iter->start) {
+      iter->start = start;
+      const Key key{ start, iter->serial };
+      found->second = key;
+      const auto less = [](const Entry &entry, const Key &other){
+         return Key{ entry.start, entry.serial } < other; };
+      // Rotate the entry into place, which allocates nothing
+      if (iter != first && !less(*(iter - 1), key)) {
+         const auto dest = std::lower_bound(first, iter, key, less);
+         std::rotate(dest, iter, iter + 1);
+         to = dest - first;
+      }
+      else {
+         const auto dest = std::lower_bound(iter + 1, last, key, less);
+         std::rotate(iter, iter + 1, dest);
+         to = (dest - first) - 1;
+      }
+   }
+
+   UpdateMaxEnds(std::min(from, to), std::max(from, to));
+}
+
+auto WaveClipIndex::Locate(const Key &key) -> std::vector<Entry>::iterator
+{
+   return std::lower_bound(mEntries.begin(), mEntries.end(), key,
+      [](const Entry &entry, const Key &other){
+         return Key{ entry.start, entry.serial } < other; });
+}
+
+void WaveClipIndex::UpdateMaxEnds(size_t first, size_t last) noexcept
+{
+   for (auto ii = first, size = mEntries.size(); ii < size; ++ii) {
+      auto &entry = mEntries[ii];
+      const auto maxEnd =
+         ii > 0 ? std::max(mEntries[ii - 1].maxEnd, entry.end) : entry.end;
+      // Later values depend only on this one and their own ends
+      if (ii > last && maxEnd == entry.maxEnd)
+         break;
+      entry.maxEnd = maxEnd;
+   }
+}
@@ -0,0 +1,87 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveClipIndex.h
+
+**********************************************************************/
+#ifndef __AUDACITY_WAVE_CLIP_INDEX__
+#define __AUDACITY_WAVE_CLIP_INDEX__
+
+#include "WaveClip.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//! Play regions of the clips of one track, sorted by start time, for lookup
+//! of clips by time
+/*!
+ The index observes its clips and updates itself in place when the play
+ region of one of them changes, so changes of the clips of other tracks cost
+ it nothing.  An update moves the entry of the clip, if its start changed,
+ and revises the running maxima of end times after it only as far as they
+ change.  So appending to the clip that starts last, as recording does, costs
+ logarithmic time in the number of clips.
+
+ Insertions go after all indexed clips in storage order, as WaveTrack pushes
+ clips onto its array, and removals keep the order of the others.
+ */
+class WAVE_TRACK_API WaveClipIndex final : public WaveClipPlayRegionObserver
+{
+public:
+   WaveClipIndex();
+   WaveClipIndex(const WaveClipIndex&) = delete;
+   WaveClipIndex& operator=(const WaveClipIndex&) = delete;
+   //! Stops observing the clips
+   ~WaveClipIndex() override;
+
+   //! Index a clip after all others in storage order, and observe it
+   /*!
+    @pre `pClip != nullptr`
+    @pre the clip is not indexed
+    */
+   void Insert(const WaveClipHolder& pClip);
+   //! Stop indexing and observing the clip, if it is indexed
+   void Remove(const WaveClip& clip) noexcept;
+
+   size_t size() const;
+
+   //! Of the clips whose play regions contain the time, the one that starts
+   //! latest, if `latest`, or else the first in storage order; or null
+   /*!
+    When the time is both the end of a clip and the start of the next clip,
+    the latter clip is found
+    */
+   WaveClipHolder Find(double time, bool latest) const;
+
+private:
+   void OnPlayRegionChange(const WaveClip& clip) noexcept override;
+
+   struct Entry
+   {
+      double start;
+      double end;
+      //! Greatest end of this and all earlier entries
+      double maxEnd;
+      //! Increases with the storage order of the clips
+      size_t serial;
+      WaveClipHolder pClip;
+   };
+   //! Entries are sorted by start, then by serial
+   using Key = std::pair<double, size_t>;
+
+   std::vector<Entry>::iterator Locate(const Key& key);
+   //! Recompute maxEnd from the entry at first, stopping at the first
+   //! unchanged value after the entry at last
+   void UpdateMaxEnds(size_t first, size_t last) noexcept;
+
+   mutable std::mutex mMutex;
+   std::vector<Entry> mEntries;
+   std::unordered_map<const WaveClip*, Key> mKeys;
+   size_t mNextSerial{ 0 };
+};
+
+#endif
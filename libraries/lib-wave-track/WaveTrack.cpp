@@ -200,11 +200,14 @@ WaveTrack::IntervalHolder WaveTrack::GetNextInterval(
 
 WaveTrack::IntervalHolder WaveTrack::GetIntervalAtTime(double t)
 {
-   IntervalHolder result;
-   for (const auto &interval : Intervals())
-      if (interval->WithinPlayRegion(t))
-         return interval;
-   return nullptr;
+   assert(mClipIndex.size() == mClips.size());
+   return mClipIndex.Find(t, false);
+}
+
+WaveTrack::IntervalHolder WaveTrack::GetLatestIntervalAtTime(double t)
+{
+   assert(mClipIndex.size() == mClips.size());
+   return mClipIndex.Find(t, true);
 }
 
 namespace {
@@ -598,12 +601,15 @@ bool WaveTrack::LinkConsistencyFix(const bool doFix)
    // This implies satisfaction of the precondition of SetRate()
    assert(!doFix || IsLeader());
 
-   const auto removeZeroClips = [](WaveClipHolders& clips) {
+   const auto removeZeroClips = [](WaveTrack& track) {
       // Check for zero-length clips and remove them
+      auto &clips = track.NarrowClips();
       for (auto it = clips.begin(); it != clips.end();)
       {
-         if ((*it)->IsEmpty())
+         if ((*it)->IsEmpty()) {
+            track.mClipIndex.Remove(**it);
             it = clips.erase(it);
+         }
          else
             ++it;
       }
@@ -638,8 +644,8 @@ bool WaveTrack::LinkConsistencyFix(const bool doFix)
             //this can't break alignment as there should be a "twin"
             //in the right channel which will also be removed, otherwise
             //track will be unlinked because AreAligned returned false
-            removeZeroClips(NarrowClips());
-            removeZeroClips(next->NarrowClips());
+            removeZeroClips(*this);
+            removeZeroClips(*next);
          }
       }
    }
@@ -665,7 +671,7 @@ bool WaveTrack::LinkConsistencyFix(const bool doFix)
       }
       if (linkType == LinkType::None)
          // Did not visit the other call to removeZeroClips, do it now
-         removeZeroClips(NarrowClips());
+         removeZeroClips(*this);
       else
          // Make a real wide wave track from two deserialized narrow tracks
          ZipClips();
@@ -1068,8 +1074,10 @@ auto WaveTrack::SplitChannels() -> std::vector<Holder>
       auto pOwner = GetOwner();
       assert(pOwner); // pre
       auto pNewTrack = result.emplace_back(EmptyCopy(1));
-      for (auto &pClip : mClips)
+      for (auto &pClip : mClips) {
          pNewTrack->mClips.emplace_back(pClip->SplitChannels());
+         pNewTrack->mClipIndex.Insert(pNewTrack->mClips.back());
+      }
       this->mRightChannel.reset();
       TrackList::AssignUniqueId(pNewTrack);
       auto iter = pOwner->Find(this);
@@ -1542,8 +1550,10 @@ std::ptrdiff_t WaveTrack::FindClip(const Interval &clip)
 void WaveTrack::RemoveClip(std::ptrdiff_t distance)
 {
    auto &clips = NarrowClips();
-   if (distance < clips.size())
+   if (distance < clips.size()) {
+      mClipIndex.Remove(*clips[distance]);
       clips.erase(clips.begin() + distance);
+   }
 }
 
 /*! @excsafety{Strong} */
@@ -1935,7 +1945,15 @@ bool WaveTrack::InsertClip(WaveClipHolders &clips, WaveClipHolder clip,
    const auto& tempo = GetProjectTempo(*this);
    if (tempo.has_value())
       clip->OnProjectTempoChange(std::nullopt, *tempo);
+   assert(&clips == &mClips);
    clips.push_back(std::move(clip));
+   try {
+      mClipIndex.Insert(clips.back());
+   }
+   catch (...) {
+      clips.pop_back();
+      throw;
+   }
    Publish({ clips.back(),
       newClip ? WaveTrackMessage::New : WaveTrackMessage::Inserted });
 
@@ -2346,6 +2364,13 @@ bool WaveTrack::GetSolo() const
    return PlayableTrack::GetSolo();
 }
 
+std::shared_ptr<const void> WaveTrack::Prefetch(double t0, double t1) const
+{
+   // Don't throw for read errors; the reader will find them again
+   return std::make_shared<const ChannelGroupSampleView>(
+      GetSampleView(t0, t1, false));
+}
+
 const char *WaveTrack::WaveTrack_tag = "wavetrack";
 
 static constexpr auto Offset_attr = "offset";
@@ -2465,6 +2490,7 @@ XMLTagHandler *WaveTrack::HandleXMLChild(const std::string_view& tag)
       const auto xmlHandler = clip.get();
       auto &clips = NarrowClips();
       clips.push_back(std::move(clip));
+      mClipIndex.Insert(clips.back());
       Publish({ clips.back(), WaveTrackMessage::Deserialized });
       return xmlHandler;
    }
@@ -2950,12 +2976,8 @@ void WaveTrack::GetEnvelopeValues(
 // latter clip is returned.
 auto WaveTrack::GetClipAtTime(double time) const -> IntervalConstHolder
 {
-   const auto clips = SortedClipArray();
-   auto p = std::find_if(
-      clips.rbegin(), clips.rend(), [&](const auto &pClip) {
-         return pClip->WithinPlayRegion(time);
-      });
-   return p != clips.rend() ? *p : nullptr;
+   assert(mClipIndex.size() == mClips.size());
+   return mClipIndex.Find(time, true);
 }
 
 auto WaveTrack::CreateClip(double offset, const wxString& name,
@@ -3247,8 +3269,10 @@ void WaveTrack::RemoveInterval(const IntervalHolder& interval)
 {
    const auto end = mClips.end(),
       iter = find(mClips.begin(), end, interval);
-   if (iter != end)
+   if (iter != end) {
+      mClipIndex.Remove(**iter);
       mClips.erase(iter);
+   }
 }
 
 void WaveTrack::ReplaceInterval(
@@ -3354,7 +3378,9 @@ void WaveTrack::ZipClips(bool mustAlign)
 
    while (iterRight != endRight) {
       // Leftover misaligned mono clips
+      pRight->mClipIndex.Remove(**iterRight);
       mClips.emplace_back(move(*iterRight));
+      mClipIndex.Insert(mClips.back());
       ++iterRight;
    }
 
@@ -17,6 +17,7 @@
 #include "SampleCount.h"
 #include "SampleFormat.h"
 #include "SampleTrack.h"
+#include "WaveClipIndex.h"
 #include "WideSampleSequence.h"
 
 #include <functional>
@@ -463,6 +464,8 @@ public:
    const ChannelGroup *FindChannelGroup() const override;
    bool GetMute() const override;
    bool GetSolo() const override;
+   //! Holds the sample views of all channels in the range
+   std::shared_ptr<const void> Prefetch(double t0, double t1) const override;
    //! @}
 
    ///
@@ -666,7 +669,16 @@ public:
    IntervalHolder
    GetNextInterval(const Interval& interval, PlaybackDirection searchDirection);
 
+   //! Of the intervals whose play regions contain the time, the first in
+   //! storage order, or null
    IntervalHolder GetIntervalAtTime(double t);
+   //! Of the intervals whose play regions contain the time, the one that
+   //! starts latest, or null
+   /*!
+    When the time is both the end of a clip and the start of the next clip,
+    the latter clip is returned
+    */
+   IntervalHolder GetLatestIntervalAtTime(double t);
 
    auto Intervals() { return ChannelGroup::Intervals<Interval>(); }
    auto Intervals() const { return ChannelGroup::Intervals<const Interval>(); }
@@ -833,6 +845,10 @@ private:
    wxCriticalSection mAppendCriticalSection;
    double mLegacyProjectFileOffset{ 0 };
 
+   //! Indexes exactly the clips of mClips, in the same storage order, for
+   //! GetIntervalAtTime() and GetClipAtTime()
+   WaveClipIndex mClipIndex;
+
    friend WaveChannel; // so it can Publish
 };
 
@@ -26,6 +26,7 @@
 #include <wx/defs.h>
 
 #include "Import.h"
+#include "ImportPipeline.h"
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 
@@ -48,6 +49,8 @@ static const auto exts = {
 #include "WaveTrack.h"
 #include "ImportUtils.h"
 
+#include <algorithm>
+
 #ifdef USE_LIBID3TAG
 extern "C" {
 #include <id3tag.h>
@@ -80,13 +83,20 @@ class MyFLACFile final : public FLAC::Decoder::File
       return mWasError;
    }
 
-   ImportProgressListener *mImportProgressListener {nullptr};
+   //! Decodes the file in the reader thread of the pipeline
+   void Read(ImportPipeline &pipeline, size_t chunkFrames);
 
  private:
    friend class FLACImportFileHandle;
    FLACImportFileHandle *mFile;
    bool                  mWasError;
    wxArrayString         mComments;
+
+   // Used only in the reader thread
+   ImportPipeline        *mPipeline{};
+   ImportPipeline::Chunk *mChunk{};
+   //! Capacity of each channel of the chunk
+   size_t                mChunkFrames{};
  protected:
    FLAC__StreamDecoderWriteStatus write_callback(const FLAC__Frame *frame,
                                                          const FLAC__int32 * const buffer[]) override;
@@ -216,51 +226,64 @@ void MyFLACFile::error_callback(FLAC__StreamDecoderErrorStatus WXUNUSED(status))
    }*/
 }
 
+void MyFLACFile::Read(ImportPipeline &pipeline, size_t chunkFrames)
+{
+   mPipeline = &pipeline;
+   mChunkFrames = chunkFrames;
+   auto cleanup = finally([&]{
+      if (mChunk)
+         mPipeline->Submit(*mChunk);
+      mChunk = nullptr;
+      mPipeline = nullptr;
+   });
+
+   // TODO: Vigilant Sentry: Variable res unused after assignment (error code DA1)
+   //    Should check the result.
+   #ifdef LEGACY_FLAC
+      bool res = (process_until_end_of_file() != 0);
+   #else
+      bool res = (process_until_end_of_stream() != 0);
+   #endif
+}
+
 FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *frame,
                                                           const FLAC__int32 * const buffer[])
 {
    // Don't let C++ exceptions propagate through libflac
    return GuardedCall< FLAC__StreamDecoderWriteStatus > ( [&] {
-      auto tmp = ArrayOf< short >{ frame->header.blocksize };
+      const auto blocksize = frame->header.blocksize;
+      const auto format =
+         frame->header.bits_per_sample <= 16 ? int16Sample : int24Sample;
 
-      unsigned chn = 0;
-      ImportUtils::ForEachChannel(*mFile->mTrack, [&](auto& channel)
+      // Gather frames into chunks of the pipeline, each channel contiguous
+      if (mChunk &&
+          (mChunk->format != format || mChunk->frames + blocksize > mChunkFrames))
       {
-         if (frame->header.bits_per_sample <= 16) {
-            if (frame->header.bits_per_sample == 8) {
-               for (unsigned int s = 0; s < frame->header.blocksize; s++) {
-                  tmp[s] = buffer[chn][s] << 8;
-               }
-            } else /* if (frame->header.bits_per_sample == 16) */ {
-               for (unsigned int s = 0; s < frame->header.blocksize; s++) {
-                  tmp[s] = buffer[chn][s];
-               }
-            }
+         mPipeline->Submit(*mChunk);
+         mChunk = nullptr;
+      }
+      if (!mChunk) {
+         // Null when the import is cancelled or stopped
+         mChunk = mPipeline->Acquire();
+         if (!mChunk)
+            return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+         mChunk->nChannels = mFile->mNumChannels;
+         mChunk->format = format;
+      }
 
-            channel.AppendBuffer((samplePtr)tmp.get(),
-                     int16Sample,
-                     frame->header.blocksize, 1,
-                     int16Sample);
-         }
-         else {
-            channel.AppendBuffer((samplePtr)buffer[chn],
-                     int24Sample,
-                     frame->header.blocksize, 1,
-                     int24Sample);
+      const auto raw = reinterpret_cast<FLAC__int32 *>(mChunk->Raw(
+         mChunk->nChannels * mChunkFrames * sizeof(FLAC__int32)));
+      for (size_t chn = 0; chn < mChunk->nChannels; ++chn) {
+         const auto dst = raw + chn * mChunkFrames + mChunk->frames;
+         if (frame->header.bits_per_sample == 8) {
+            for (unsigned int s = 0; s < blocksize; s++) {
+               dst[s] = buffer[chn][s] << 8;
+            }
          }
-         ++chn;
-      });
-
-      mFile->mSamplesDone += frame->header.blocksize;
-
-      if(mFile->mNumSamples > 0)
-         mImportProgressListener->OnImportProgress(static_cast<double>(mFile->mSamplesDone) /
-                                                   static_cast<double>(mFile->mNumSamples));
-
-      if (mFile->IsCancelled() || mFile->IsStopped())
-      {
-         return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+         else
+            std::copy(buffer[chn], buffer[chn] + blocksize, dst);
       }
+      mChunk->frames += blocksize;
 
       return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
    }, MakeSimpleGuard(FLAC__STREAM_DECODER_WRITE_STATUS_ABORT) );
@@ -401,21 +424,48 @@ void FLACImportFileHandle::Import(
 
    outTracks.clear();
 
-   auto cleanup = finally([&]{ mFile->mImportProgressListener = nullptr; });
-
    wxASSERT(mStreamInfoDone);
 
    mTrack = ImportUtils::NewWaveTrack(*trackFactory, mNumChannels, mFormat, mSampleRate);
 
-   mFile->mImportProgressListener = &progressListener;
-
-   // TODO: Vigilant Sentry: Variable res unused after assignment (error code DA1)
-   //    Should check the result.
-   #ifdef LEGACY_FLAC
-      bool res = (mFile->process_until_end_of_file() != 0);
-   #else
-      bool res = (mFile->process_until_end_of_stream() != 0);
-   #endif
+   // Chunks hold at least one frame of the largest size
+   const auto chunkFrames = std::max<size_t>(
+      mTrack->GetMaxBlockSize(), FLAC__MAX_BLOCK_SIZE);
+
+   // The reader thread decodes, workers convert to the sample formats of the
+   // track, and this thread appends
+   ImportPipeline pipeline{ [chunkFrames](ImportPipeline::Chunk &chunk) {
+      const auto raw = reinterpret_cast<const FLAC__int32 *>(chunk.Raw());
+      for (size_t chn = 0; chn < chunk.nChannels; ++chn) {
+         const auto src = raw + chn * chunkFrames;
+         if (chunk.format == int16Sample)
+            std::copy(src, src + chunk.frames,
+               reinterpret_cast<short *>(chunk.Channel(chn)));
+         else
+            std::copy(src, src + chunk.frames,
+               reinterpret_cast<FLAC__int32 *>(chunk.Channel(chn)));
+      }
+   } };
+   pipeline.Run(
+      [&](ImportPipeline &pipeline) { mFile->Read(pipeline, chunkFrames); },
+      [&](const ImportPipeline::Chunk &chunk) {
+         unsigned chn = 0;
+         ImportUtils::ForEachChannel(*mTrack, [&](auto& channel)
+         {
+            channel.AppendBuffer(chunk.Channel(chn), chunk.format,
+                     chunk.frames, 1,
+                     chunk.format);
+            ++chn;
+         });
+
+         mSamplesDone += chunk.frames;
+
+         if(mNumSamples > 0)
+            progressListener.OnImportProgress(static_cast<double>(mSamplesDone) /
+                                              static_cast<double>(mNumSamples));
+
+         return !IsCancelled() && !IsStopped();
+      });
 
    if(IsCancelled())
    {
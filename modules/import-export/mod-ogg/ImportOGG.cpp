@@ -48,7 +48,10 @@ static const auto exts = {
 
 #include <vorbis/vorbisfile.h>
 
+#include <algorithm>
+
 #include "WaveTrack.h"
+#include "ImportPipeline.h"
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "ImportUtils.h"
@@ -245,8 +248,6 @@ void OggImportFileHandle::Import(
 
    long bytesRead = 0;
    {
-      ArrayOf<short> mainBuffer{ CODEC_TRANSFER_SIZE };
-
       /* determine endianness (clever trick courtesy of Nicholas Devillard,
        * (http://www.eso.org/~ndevilla/endian/) */
       int testvar = 1, endian;
@@ -255,11 +256,6 @@ void OggImportFileHandle::Import(
       else
          endian = 1;  // big endian
 
-      /* number of samples currently in each channel's buffer */
-      long samplesRead = 0;
-      int bitstream = 0;
-      int samplesSinceLastCallback = 0;
-
       // You would think that the stream would already be seeked to 0, and
       // indeed it is if the file is legit.  But I had several ogg files on
       // my hard drive that have malformed headers, and this added call
@@ -267,60 +263,101 @@ void OggImportFileHandle::Import(
       // zeros inserted at the beginning
       ov_pcm_seek(mVorbisFile.get(), 0);
 
-      do {
-         /* get data from the decoder */
-         bytesRead = ov_read(mVorbisFile.get(), (char *)mainBuffer.get(),
-            CODEC_TRANSFER_SIZE,
-            endian,
-            2,    // word length (2 for 16 bit samples)
-            1,    // signed
-            &bitstream);
-
-         if (bytesRead == OV_HOLE) {
-            wxFileName ff(GetFilename());
-            wxLogError(wxT("Ogg Vorbis importer: file %s is malformed, ov_read() reported a hole"),
-               ff.GetFullName());
-            /* http://lists.xiph.org/pipermail/vorbis-dev/2001-February/003223.html
-             * is the justification for doing this - best effort for malformed file,
-             * hence the message.
-             */
-            continue;
-         }
-         else if (bytesRead < 0) {
-            /* Malformed Ogg Vorbis file. */
-            /* TODO: Return some sort of meaningful error. */
-            wxLogError(wxT("Ogg Vorbis importer: ov_read() returned error %i"),
-               bytesRead);
-            break;
-         }
-
-         samplesRead = bytesRead / mVorbisFile->vi[bitstream].channels / sizeof(short);
-
-         if (mStreamUsage[bitstream] != 0)
-         {
+      // The reader thread decodes into chunks, each of one bitstream, workers
+      // deinterleave them, and this thread gives them to the wavetracks
+      ImportPipeline pipeline;
+      pipeline.Run(
+         [&](ImportPipeline &pipeline) {
+            ArrayOf<short> mainBuffer{ CODEC_TRANSFER_SIZE };
+            ImportPipeline::Chunk *chunk{};
+            const auto submit = [&]{
+               const auto timeTotal =
+                  ov_time_total(mVorbisFile.get(), chunk->stream);
+               if(timeTotal > 0)
+                  chunk->progress = ov_time_tell(mVorbisFile.get()) / timeTotal;
+               pipeline.Submit(*chunk);
+               chunk = nullptr;
+            };
+
+            int bitstream = 0;
+            do {
+               /* get data from the decoder */
+               bytesRead = ov_read(mVorbisFile.get(), (char *)mainBuffer.get(),
+                  CODEC_TRANSFER_SIZE,
+                  endian,
+                  2,    // word length (2 for 16 bit samples)
+                  1,    // signed
+                  &bitstream);
+
+               if (bytesRead == OV_HOLE) {
+                  wxFileName ff(GetFilename());
+                  wxLogError(wxT("Ogg Vorbis importer: file %s is malformed, ov_read() reported a hole"),
+                     ff.GetFullName());
+                  /* http://lists.xiph.org/pipermail/vorbis-dev/2001-February/003223.html
+                   * is the justification for doing this - best effort for malformed file,
+                   * hence the message.
+                   */
+                  continue;
+               }
+               else if (bytesRead < 0) {
+                  /* Malformed Ogg Vorbis file. */
+                  /* TODO: Return some sort of meaningful error. */
+                  wxLogError(wxT("Ogg Vorbis importer: ov_read() returned error %i"),
+                     bytesRead);
+                  break;
+               }
+
+               if (mStreamUsage[bitstream] == 0)
+                  continue;
+
+               const size_t channels = mVorbisFile->vi[bitstream].channels;
+               /* number of samples read into each channel */
+               const size_t samplesRead = bytesRead / channels / sizeof(short);
+
+               if (chunk && (chunk->stream != static_cast<size_t>(bitstream) ||
+                  chunk->frames + samplesRead > SAMPLES_PER_CALLBACK))
+                  submit();
+               if (!chunk) {
+                  // Null when the import is cancelled or stopped
+                  chunk = pipeline.Acquire();
+                  if (!chunk)
+                     break;
+                  chunk->stream = bitstream;
+                  chunk->nChannels = channels;
+                  chunk->format = int16Sample;
+               }
+
+               const auto buffer = reinterpret_cast<short *>(chunk->Raw(
+                  SAMPLES_PER_CALLBACK * channels * sizeof(short)));
+               std::copy(mainBuffer.get(),
+                  mainBuffer.get() + samplesRead * channels,
+                  buffer + chunk->frames * channels);
+               chunk->frames += samplesRead;
+            } while (bytesRead != 0);
+
+            if (chunk)
+               submit();
+         },
+         [&](const ImportPipeline::Chunk &chunk) {
             /* give the data to the wavetracks */
             unsigned chn = 0;
-            ImportUtils::ForEachChannel(**std::next(mStreams.begin(), bitstream), [&](auto& channel)
+            ImportUtils::ForEachChannel(**std::next(mStreams.begin(), chunk.stream), [&](auto& channel)
             {
                channel.AppendBuffer(
-                  (char *)(mainBuffer.get() + chn),
+                  chunk.Channel(chn),
                   int16Sample,
-                  samplesRead,
-                  mVorbisFile->vi[bitstream].channels,
+                  chunk.frames,
+                  1,
                   int16Sample
                );
                ++chn;
             });
-         }
 
-         samplesSinceLastCallback += samplesRead;
-         if (samplesSinceLastCallback > SAMPLES_PER_CALLBACK) {
-            const auto timeTotal = ov_time_total(mVorbisFile.get(), bitstream);
-            if(timeTotal > 0)
-               progressListener.OnImportProgress(ov_time_tell(mVorbisFile.get()) / timeTotal);
-            samplesSinceLastCallback -= SAMPLES_PER_CALLBACK;
-         }
-      } while (!IsCancelled() && !IsStopped() && bytesRead != 0);
+            if (chunk.progress >= 0)
+               progressListener.OnImportProgress(chunk.progress);
+
+            return !IsCancelled() && !IsStopped();
+         });
    }
 
    if (bytesRead < 0)
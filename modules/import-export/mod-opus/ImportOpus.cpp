@@ -24,6 +24,7 @@
 #include "Tags.h"
 #include "WaveTrack.h"
 #include "CodeConversions.h"
+#include "ImportPipeline.h"
 #include "ImportUtils.h"
 #include "ImportProgressListener.h"
 #include "CodeConversions.h"
@@ -186,50 +187,90 @@ void OpusImportFileHandle::Import(
       mFormat,
       mSampleRate);
 
-   /* The number of samples to read in each loop */
+   /* The number of samples to read into each chunk */
    const size_t SAMPLES_TO_READ = track->GetMaxBlockSize();
    uint64_t totalSamplesRead = 0;
 
    const auto bufferSize = mNumChannels * SAMPLES_TO_READ;
 
-   ArrayOf<float> floatBuffer { bufferSize };
+   // Set by the reader thread
+   int readError = 0;
+   bool channelsChanged = false;
 
-   uint64_t samplesRead = 0;
+   // The reader thread decodes, workers deinterleave, and this thread appends
+   ImportPipeline pipeline;
+   pipeline.Run(
+      [&](ImportPipeline &pipeline) {
+         // Null when the import is cancelled or stopped
+         while (const auto chunk = pipeline.Acquire())
+         {
+            chunk->nChannels = mNumChannels;
+            chunk->format = mFormat;
+            const auto floatBuffer =
+               reinterpret_cast<float*>(chunk->Raw(bufferSize * sizeof(float)));
+
+            // Each read gives at most one packet, so read until the chunk is
+            // full or the file ends
+            bool done = false;
+            while (!done && chunk->frames < SAMPLES_TO_READ)
+            {
+               int linkIndex { -1 };
+               auto samplesPerChannelRead = op_read_float(mOpusFile,
+                  floatBuffer + chunk->frames * mNumChannels,
+                  (SAMPLES_TO_READ - chunk->frames) * mNumChannels, &linkIndex);
 
-   do
-   {
-      int linkIndex { -1 };
-      auto samplesPerChannelRead = op_read_float(mOpusFile, floatBuffer.get(), SAMPLES_TO_READ, &linkIndex);
-
-      if (samplesPerChannelRead < 0 && samplesPerChannelRead != OP_HOLE)
-      {
-         NotifyImportFailed(progressListener, samplesPerChannelRead);
-         return;
-      }
-
-      auto linkChannels = op_head(mOpusFile, linkIndex)->channel_count;
-
-      if (linkChannels != mNumChannels)
-      {
-         NotifyImportFailed(progressListener, XO("File has changed the number of channels in the middle."));
-         return;
-      }
-
-      unsigned chn = 0;
-      ImportUtils::ForEachChannel(*track, [&](auto& channel)
-      {
-         channel.AppendBuffer(
-            reinterpret_cast<constSamplePtr>(floatBuffer.get() +
-            chn), mFormat, samplesRead, mNumChannels, mFormat
-         );
-         ++chn;
+               if (samplesPerChannelRead == OP_HOLE)
+                  continue;
+
+               if (samplesPerChannelRead < 0)
+               {
+                  readError = samplesPerChannelRead;
+                  done = true;
+               }
+               else if (samplesPerChannelRead == 0)
+                  done = true;
+               else if (op_head(mOpusFile, linkIndex)->channel_count != mNumChannels)
+               {
+                  channelsChanged = true;
+                  done = true;
+               }
+               else
+                  chunk->frames += samplesPerChannelRead;
+            }
+
+            pipeline.Submit(*chunk);
+            if (done)
+               break;
+         }
+      },
+      [&](const ImportPipeline::Chunk &chunk) {
+         unsigned chn = 0;
+         ImportUtils::ForEachChannel(*track, [&](auto& channel)
+         {
+            channel.AppendBuffer(
+               chunk.Channel(chn), mFormat, chunk.frames, 1, mFormat
+            );
+            ++chn;
+         });
+
+         totalSamplesRead += chunk.frames;
+
+         progressListener.OnImportProgress(double(totalSamplesRead) / mNumSamples);
+
+         return !IsCancelled() && !IsStopped();
       });
 
-      samplesRead = samplesPerChannelRead;
-      totalSamplesRead += samplesRead;
+   if (readError < 0)
+   {
+      NotifyImportFailed(progressListener, readError);
+      return;
+   }
 
-      progressListener.OnImportProgress(double(totalSamplesRead) / mNumSamples);
-   } while (!IsCancelled() && !IsStopped() && samplesRead != 0);
+   if (channelsChanged)
+   {
+      NotifyImportFailed(progressListener, XO("File has changed the number of channels in the middle."));
+      return;
+   }
 
    if (IsCancelled())
    {
@@ -35,6 +35,7 @@
 
 #include "FileFormats.h"
 #include "GetAcidizerTags.h"
+#include "ImportPipeline.h"
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "ImportUtils.h"
@@ -318,63 +319,59 @@ void PCMImportFileHandle::Import(
          return;
       }
 
-      SampleBuffer srcbuffer, buffer;
-      wxASSERT(mInfo.channels >= 0);
-      while (NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, mFormat).ptr() ||
-             NULL == buffer.Allocate(maxBlock, mFormat).ptr())
-      {
-         maxBlock /= 2;
-         if (maxBlock < 1)
-         {
-            progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
-            return;
-         }
-      }
-
       decltype(fileTotalFrames) framescompleted = 0;
 
-      long block;
-      do {
-         block = maxBlock;
-
-         if (mFormat == int16Sample)
-            block = SFCall<sf_count_t>(sf_readf_short, mFile.get(), (short *)srcbuffer.ptr(), block);
-         //import 24 bit int as float and have the append function convert it.  This is how PCMAliasBlockFile worked too.
-         else
-            block = SFCall<sf_count_t>(sf_readf_float, mFile.get(), (float *)srcbuffer.ptr(), block);
-
-         if(block < 0 || block > (long)maxBlock) {
-            wxASSERT(false);
-            block = maxBlock;
-         }
+      // Read 16 bit int as such, and all else as float.  Import 24 bit int as
+      // float and have the append function convert it.  This is how
+      // PCMAliasBlockFile worked too.
+      const auto readFormat =
+         (mFormat == int16Sample) ? int16Sample : floatSample;
+      const auto nChannels = static_cast<size_t>(mInfo.channels);
+
+      // The reader thread reads interleaved samples, workers deinterleave
+      // them, and this thread appends them
+      ImportPipeline pipeline;
+      pipeline.Run(
+         [&](ImportPipeline &pipeline) {
+            while (const auto pChunk = pipeline.Acquire()) {
+               auto &chunk = *pChunk;
+               const auto buffer =
+                  chunk.Raw(maxBlock * nChannels * SAMPLE_SIZE(readFormat));
+
+               sf_count_t block;
+               if (readFormat == int16Sample)
+                  block = SFCall<sf_count_t>(sf_readf_short, mFile.get(), (short *)buffer, maxBlock);
+               else
+                  block = SFCall<sf_count_t>(sf_readf_float, mFile.get(), (float *)buffer, maxBlock);
+
+               if(block < 0 || block > (sf_count_t)maxBlock) {
+                  wxASSERT(false);
+                  block = maxBlock;
+               }
 
-         if (block) {
+               chunk.nChannels = nChannels;
+               chunk.frames = block;
+               chunk.format = readFormat;
+               pipeline.Submit(chunk);
+               if (block == 0)
+                  break;
+            }
+         },
+         [&](const ImportPipeline::Chunk &chunk) {
             unsigned c = 0;
             ImportUtils::ForEachChannel(*trackList, [&](auto& channel)
             {
-               if (mFormat==int16Sample) {
-                  for(int j=0; j<block; j++)
-                     ((short *)buffer.ptr())[j] =
-                        ((short *)srcbuffer.ptr())[mInfo.channels*j+c];
-               }
-               else {
-                  for(int j=0; j<block; j++)
-                     ((float *)buffer.ptr())[j] =
-                        ((float *)srcbuffer.ptr())[mInfo.channels*j+c];
-               }
-
                channel.AppendBuffer(
-                  buffer.ptr(),
-                  (mFormat == int16Sample) ? int16Sample : floatSample,
-                  block, 1, mEffectiveFormat
+                  chunk.Channel(c), chunk.format, chunk.frames, 1,
+                  mEffectiveFormat
                );
                ++c;
             });
-            framescompleted += block;
-         }
-         if(fileTotalFrames > 0)
-            progressListener.OnImportProgress(framescompleted.as_double() / fileTotalFrames.as_double());
-      } while (block > 0 && !IsCancelled() && !IsStopped());
+            framescompleted += chunk.frames;
+            if(fileTotalFrames > 0)
+               progressListener.OnImportProgress(framescompleted.as_double() / fileTotalFrames.as_double());
+            return !IsCancelled() && !IsStopped();
+         });
    }
 
    if(IsCancelled())
@@ -31,6 +31,7 @@
 #include "Tags.h"
 #include "WaveTrack.h"
 #include "CodeConversions.h"
+#include "ImportPipeline.h"
 #include "ImportUtils.h"
 #include "ImportProgressListener.h"
 
@@ -171,81 +172,80 @@ void WavPackImportFileHandle::Import(
    auto tracks = trackFactory->CreateMany(mNumChannels, mFormat, mSampleRate);
 
 
-   /* The number of samples to read in each loop */
+   /* The number of samples to read into each chunk */
    const size_t SAMPLES_TO_READ = (*tracks->Any<WaveTrack>().begin())->GetMaxBlockSize();
    uint32_t totalSamplesRead = 0;
 
    {
       const uint32_t bufferSize = mNumChannels * SAMPLES_TO_READ;
-      ArrayOf<int32_t> wavpackBuffer{ bufferSize };
-      ArrayOf<int16_t> int16Buffer;
-      ArrayOf<float> floatBuffer;
-      uint32_t samplesRead = 0;
-
-      if (mFormat == int16Sample) {
-         int16Buffer.reinit(bufferSize);
-      } else if (mFormat == floatSample && (wavpackMode & MODE_FLOAT) != MODE_FLOAT) {
-         floatBuffer.reinit(bufferSize);
-      }
-
-      do {
-         samplesRead = WavpackUnpackSamples(mWavPackContext, wavpackBuffer.get(), SAMPLES_TO_READ);
 
-         if (mFormat == int16Sample) {
-            if (mBytesPerSample == 1)
-               for (int64_t c = 0; c < samplesRead * mNumChannels; c++)
-                  int16Buffer[c] = static_cast<int16_t>(wavpackBuffer[c] * 256);
-            else
-               for (int64_t c = 0; c < samplesRead * mNumChannels; c++)
-                  int16Buffer[c] = static_cast<int16_t>(wavpackBuffer[c]);
-
-            unsigned chn = 0;
-            ImportUtils::ForEachChannel(*tracks, [&](auto& channel)
-            {
-               channel.AppendBuffer(
-                  reinterpret_cast<constSamplePtr>(int16Buffer.get() + chn),
-                  mFormat,
-                  samplesRead,
-                  mNumChannels,
-                  mFormat
-               );
-               ++chn;
-            });
-         } else if (mFormat == int24Sample || (wavpackMode & MODE_FLOAT) == MODE_FLOAT) {
+      // The reader thread unpacks, workers convert to the format of the
+      // tracks and deinterleave, and this thread appends
+      ImportPipeline pipeline{ [&](ImportPipeline::Chunk &chunk) {
+         const auto wavpackBuffer =
+            reinterpret_cast<const int32_t *>(chunk.Raw());
+         const auto frames = chunk.frames;
+         for (size_t chn = 0; chn < chunk.nChannels; ++chn) {
+            const auto src = wavpackBuffer + chn;
+            if (mFormat == int16Sample) {
+               const auto int16Buffer =
+                  reinterpret_cast<int16_t *>(chunk.Channel(chn));
+               if (mBytesPerSample == 1)
+                  for (size_t c = 0; c < frames; c++)
+                     int16Buffer[c] = static_cast<int16_t>(src[c * chunk.nChannels] * 256);
+               else
+                  for (size_t c = 0; c < frames; c++)
+                     int16Buffer[c] = static_cast<int16_t>(src[c * chunk.nChannels]);
+            } else if (mFormat == int24Sample || (wavpackMode & MODE_FLOAT) == MODE_FLOAT) {
+               const auto buffer = reinterpret_cast<int32_t *>(chunk.Channel(chn));
+               for (size_t c = 0; c < frames; c++)
+                  buffer[c] = src[c * chunk.nChannels];
+            } else {
+               const auto floatBuffer =
+                  reinterpret_cast<float *>(chunk.Channel(chn));
+               for (size_t c = 0; c < frames; c++)
+                  floatBuffer[c] = static_cast<float>(src[c * chunk.nChannels] / static_cast<double>(std::numeric_limits<int32_t>::max()));
+            }
+         }
+      } };
+
+      pipeline.Run(
+         [&](ImportPipeline &pipeline) {
+            // Null when the import is cancelled or stopped
+            while (const auto chunk = pipeline.Acquire()) {
+               const auto wavpackBuffer = reinterpret_cast<int32_t *>(
+                  chunk->Raw(bufferSize * sizeof(int32_t)));
+               const auto samplesRead = WavpackUnpackSamples(mWavPackContext, wavpackBuffer, SAMPLES_TO_READ);
+
+               chunk->nChannels = mNumChannels;
+               chunk->frames = samplesRead;
+               chunk->format = mFormat;
+               chunk->progress = WavpackGetProgress(mWavPackContext);
+               pipeline.Submit(*chunk);
+               if (samplesRead == 0)
+                  break;
+            }
+         },
+         [&](const ImportPipeline::Chunk &chunk) {
             unsigned chn = 0;
             ImportUtils::ForEachChannel(*tracks, [&](auto& channel)
             {
                channel.AppendBuffer(
-                  reinterpret_cast<constSamplePtr>(wavpackBuffer.get() + chn),
+                  chunk.Channel(chn),
                   mFormat,
-                  samplesRead,
-                  mNumChannels,
+                  chunk.frames,
+                  1,
                   mFormat
                );
                ++chn;
             });
-         } else {
-            for (int64_t c = 0; c < samplesRead * mNumChannels; c++)
-               floatBuffer[c] = static_cast<float>(wavpackBuffer[c] / static_cast<double>(std::numeric_limits<int32_t>::max()));
 
-            unsigned chn = 0;
-            ImportUtils::ForEachChannel(*tracks, [&](auto& channel)
-            {
-               channel.AppendBuffer(
-                  reinterpret_cast<constSamplePtr>(floatBuffer.get() + chn),
-                  mFormat,
-                  samplesRead,
-                  mNumChannels,
-                  mFormat
-               );
-               ++chn;
-            });
-         }
+            totalSamplesRead += chunk.frames;
 
-         totalSamplesRead += samplesRead;
+            progressListener.OnImportProgress(chunk.progress);
 
-         progressListener.OnImportProgress(WavpackGetProgress(mWavPackContext));
-      } while (!IsCancelled() && !IsStopped() && samplesRead != 0);
+            return !IsCancelled() && !IsStopped();
+         });
    }
 
    if (WavpackGetNumErrors(mWavPackContext))
@@ -0,0 +1,122 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CommandPipeline.cpp
+
+**********************************************************************/
+#include "CommandPipeline.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <wx/string.h>
+
+#include "commands/ScriptCommandRelay.h"
+
+CommandPipeline::CommandPipeline(Writer writer, Flusher flusher)
+   : mWriter{ std::move(writer) }
+   , mFlusher{ std::move(flusher) }
+{
+   mThread = std::thread{ [this]{ Run(); } };
+}
+
+CommandPipeline::~CommandPipeline()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mDone = true;
+   }
+   mReceived.notify_one();
+   mThread.join();
+}
+
+void CommandPipeline::Receive(std::string line)
+{
+   // Ignore line endings, and the terminating null that some clients send
+   line.erase(std::remove_if(line.begin(), line.end(), [](char c){
+      return c == '\r' || c == '\n' || c == '\0';
+   }), line.end());
+   if (line.empty())
+      return;
+
+   Entry entry;
+   const auto space = line.find(' ');
+   if (line[0] == '@' && space != std::string::npos && space > 1) {
+      entry.id = line.substr(1, space - 1);
+      entry.command = line.substr(space + 1);
+   }
+   else
+      entry.command = std::move(line);
+
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mEntries.push_back(std::move(entry));
+   }
+   mReceived.notify_one();
+}
+
+void CommandPipeline::Run()
+{
+   while (true) {
+      std::deque<Entry> batch;
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mReceived.wait(lock, [this]{ return mDone || !mEntries.empty(); });
+         if (mEntries.empty())
+            return;
+         batch.swap(mEntries);
+      }
+
+      // Scripts must send UTF-8, if going beyond 7-bit ASCII.
+      // Important for filenames in commands.
+      std::vector<wxString> commands;
+      // Only frames can carry binary data
+      std::vector<bool> binary;
+      for (const auto &entry : batch) {
+         commands.push_back(wxString::FromUTF8(entry.command));
+         binary.push_back(!entry.id.empty());
+      }
+
+      ScriptCommandRelay::ExecBatch(commands, binary,
+         [&](size_t index, const wxString &response,
+            const ScriptCommandRelay::BinaryResponse *pBinary
+         ) {
+            if (pBinary)
+               Respond(batch[index], pBinary->type,
+                  { pBinary->data.data(), pBinary->data.size() });
+            else {
+               const auto utf8 = response.ToUTF8();
+               Respond(batch[index], {}, { utf8.data(), utf8.length() });
+            }
+         });
+   }
+}
+
+void CommandPipeline::Respond(const Entry &entry, const std::string &type,
+   std::string_view response)
+{
+   // After the client goes away, still run the commands it sent
+   if (mFailed)
+      return;
+   try {
+      if (entry.id.empty()) {
+         // An empty line ends the response
+         mWriter(response.data(), response.size());
+         mWriter("\n", 1);
+      }
+      else {
+         auto header = "@" + entry.id + " " + std::to_string(response.size());
+         if (!type.empty())
+            header += " " + type;
+         header += "\n";
+         mWriter(header.data(), header.size());
+         mWriter(response.data(), response.size());
+      }
+      mFlusher();
+   }
+   catch (...) {
+      mFailed = true;
+   }
+}
@@ -0,0 +1,96 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CommandPipeline.h
+
+  @brief Runs the commands received from a pipe in batches, while more
+  are read
+
+**********************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+//! Runs the commands received from a pipe in batches, while more are read
+/*!
+ A line of the plain protocol is one command, and its response follows as
+ lines of text ending with an empty line.  A client must read the whole
+ response before it sends another command.
+
+ A line of the pipelined protocol is a correlation id (of any characters
+ but space) after '@', then a space, then the command:
+
+     @17 Select: Start=0 End=10
+
+ A client need not wait for responses before sending more such commands.
+ Each response is one frame: '@', the id, a space, and the count of bytes
+ of the response, in decimal, ending with a newline; then exactly that many
+ bytes of the response text, in UTF-8:
+
+     @17 26\n
+     BatchCommand finished: OK\n
+
+ A command may instead respond with binary data, but only in a frame.  Then
+ the header has a third field naming the encoding of the data; text frames
+ have no third field.  GetSamples responds so with 32-bit floats, in the
+ byte order of the machine, type "f32":
+
+     @18 GetSamples: Track=0 Channel=0 Start=0 End=1
+     @18 176400 f32\n
+     (176400 bytes)
+
+ If the command fails, the frame is text with the error.  In the plain
+ protocol, GetSamples responds with the numbers as text.
+
+ Responses are in the order of the commands.  All the commands received
+ while others run go to the main thread together, as one batch.
+ */
+class CommandPipeline final
+{
+public:
+   //! Writes all the bytes to the pipe, or throws
+   using Writer = std::function<void(const char *data, size_t size)>;
+   //! Makes written bytes available to the client
+   using Flusher = std::function<void()>;
+
+   //! Starts a thread that runs the commands and writes the responses
+   CommandPipeline(Writer writer, Flusher flusher);
+   //! Finishes the commands received, then stops the thread
+   ~CommandPipeline();
+
+   //! Called from the reading thread with each line, line ending removed
+   void Receive(std::string line);
+
+private:
+   struct Entry
+   {
+      //! Empty for the plain protocol
+      std::string id;
+      std::string command;
+   };
+
+   void Run();
+   //! Writes a response; type is empty for text, else names the binary
+   //! encoding
+   void Respond(const Entry &entry, const std::string &type,
+      std::string_view response);
+
+   const Writer mWriter;
+   const Flusher mFlusher;
+
+   std::mutex mMutex;
+   std::condition_variable mReceived;
+   std::deque<Entry> mEntries;
+   bool mDone{ false };
+   bool mFailed{ false };
+
+   std::thread mThread;
+};
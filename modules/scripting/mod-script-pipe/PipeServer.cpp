@@ -5,10 +5,13 @@
 #include <stdio.h>
 #include <tchar.h>
 
-const int nBuff = 1024;
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "CommandPipeline.h"
 
-extern "C" int DoSrv( char * pIn );
-extern "C" int DoSrvMore( char * pOut, size_t nMax );
+const int nBuff = 1024;
 
 void PipeServer()
 {
@@ -46,11 +49,7 @@ void PipeServer()
    BOOL bConnected;
    BOOL bSuccess;
    DWORD cbBytesRead;
-   DWORD cbBytesWritten;
    CHAR chRequest[ nBuff ];
-   CHAR chResponse[ nBuff ];
-
-   int jj=0;
 
    for(;;)
    {
@@ -67,28 +66,47 @@ void PipeServer()
 
       if( bConnected )
       {
+         // Responses are written while more commands are read
+         CommandPipeline pipeline{
+            [&]( const char *data, size_t size ){
+               // Write messages no bigger than the buffer of the pipe
+               while( size > 0 )
+               {
+                  DWORD cbBytesWritten;
+                  const auto count =
+                     static_cast<DWORD>( std::min<size_t>( size, nBuff ) );
+                  if( !WriteFile( hPipeFromSrv, data, count, &cbBytesWritten, NULL) )
+                     throw std::runtime_error{ "Write failed on pipe" };
+                  data += cbBytesWritten;
+                  size -= cbBytesWritten;
+               }
+            },
+            []{}
+         };
+
+         std::string message;
          for(;;)
          {
-            printf( "About to read\n" );
             bSuccess = ReadFile( hPipeToSrv, chRequest, nBuff, &cbBytesRead, NULL);
+            const bool more = !bSuccess && GetLastError() == ERROR_MORE_DATA;
 
-            chRequest[ cbBytesRead] = '\0'; 
-
-            if( !bSuccess || cbBytesRead==0 )
+            if( (!bSuccess && !more) || cbBytesRead==0 )
                break;
 
-            printf( "Rxd %s\n", chRequest );
-
-            DoSrv( chRequest );
-            jj++;
-            while( true )
-            {
-               int nWritten = DoSrvMore( chResponse, nBuff );
-               if( nWritten <= 1 )
-                  break;
-               WriteFile( hPipeFromSrv, chResponse, nWritten-1, &cbBytesWritten, NULL);
-            }
-            //FlushFileBuffers( hPipeFromSrv );
+            message.append( chRequest, cbBytesRead );
+            if( more )
+               // The rest of the message follows
+               continue;
+
+            printf( "Rxd %s\n", message.c_str() );
+
+            // A message may hold several commands, one on each line; the
+            // last need not end with a newline
+            size_t start = 0;
+            for( size_t end; (end = message.find( '\n', start )) != std::string::npos; start = end + 1 )
+               pipeline.Receive( message.substr( start, end - start ) );
+            pipeline.Receive( message.substr( start ) );
+            message.clear();
          }
          FlushFileBuffers( hPipeToSrv );
          DisconnectNamedPipe( hPipeToSrv );
@@ -114,13 +132,15 @@ void PipeServer()
 #include <unistd.h>
 #include <string.h>
 
+#include <stdexcept>
+#include <string>
+
+#include "CommandPipeline.h"
+
 const char fifotmpl[] = "/tmp/audacity_script_pipe.%s.%d";
 
 const int nBuff = 1024;
 
-extern "C" int DoSrv( char * pIn );
-extern "C" int DoSrvMore( char * pOut, size_t nMax );
-
 void PipeServer()
 {
    FILE *fromFifo = NULL;
@@ -164,32 +184,33 @@ void PipeServer()
       return;
    }
 
-   while (fgets(buf, sizeof(buf), toFifo) != NULL)
    {
-      int len = strlen(buf);
-      if (len <= 1)
-      {
-         continue;
-      }
-
-      buf[len - 1] = '\0';
-
-      printf("Server received %s\n", buf);
-      DoSrv(buf);
-
-      while (true)
+      // Responses are written while more commands are read
+      CommandPipeline pipeline{
+         [&](const char *data, size_t size) {
+            if (fwrite(data, 1, size, fromFifo) != size)
+               throw std::runtime_error{ "Write failed on fifo" };
+         },
+         [&]{ fflush(fromFifo); }
+      };
+
+      std::string line;
+      while (fgets(buf, sizeof(buf), toFifo) != NULL)
       {
-         len = DoSrvMore(buf, nBuff);
-         if (len <= 1)
+         // A line longer than the buffer takes more than one read
+         line += buf;
+         if (line.back() != '\n')
          {
-            break;
+            continue;
          }
-         printf("Server sending %s",buf);
 
-         // len - 1 because we do not send the null character
-         fwrite(buf, 1, len - 1, fromFifo);
+         printf("Server received %s", line.c_str());
+         pipeline.Receive(std::move(line));
+         line.clear();
       }
-      fflush(fromFifo);
+      pipeline.Receive(std::move(line));
+
+      // Leaving this scope waits for the responses to all commands received
    }
 
    printf("Read failed on fifo, quitting\n");
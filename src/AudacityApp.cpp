@@ -39,6 +39,7 @@ It handles initialization and termination by subclassing wxApp.
 
 #include <wx/fs_zip.h>
 
+#include <wx/cmdline.h>
 #include <wx/dir.h>
 #include <wx/file.h>
 #include <wx/filename.h>
@@ -68,7 +69,6 @@ It handles initialization and termination by subclassing wxApp.
 #include "AColor.h"
 #include "AudacityFileConfig.h"
 #include "AudioIO.h"
-#include "Benchmark.h"
 #include "Clipboard.h"
 #include "CommandLineArgs.h"
 #include "CrashReport.h" // for HAS_CRASH_REPORT
@@ -109,6 +109,8 @@ It handles initialization and termination by subclassing wxApp.
 #include "widgets/FileHistory.h"
 #include "wxWidgetsBasicUI.h"
 #include "LogWindow.h"
+#include "MacroFileProcessor.h"
+#include "BatchCommands.h"
 #include "FrameStatisticsDialog.h"
 #include "PluginStartupRegistration.h"
 #include "IncompatiblePluginsDialog.h"
@@ -1472,6 +1474,15 @@ bool AudacityApp::OnInit()
    }
 #endif
 
+   // An instance applying a macro for another uses its own copies of the
+   // settings files; see InitPart2()
+   for (int ii = 1; ii + 1 < argc; ++ii) {
+      if (argv[ii] == wxT("--macro-worker")) {
+         MacroFileProcessor::UseWorkerSettings(argv[ii + 1]);
+         break;
+      }
+   }
+
    // Initialize preferences and language
    {
       InitPreferences(audacity::ApplicationSettings::Call());
@@ -1521,13 +1532,70 @@ bool AudacityApp::OnInit()
 #endif
 }
 
+//! Applies the macro to the files named on the command line, in other
+//! instances of the program, printing a result for each file
+/*! @return the exit code; nonzero if any file failed */
+static int ApplyMacroToFiles(
+   const wxCmdLineParser &parser, const wxString &macro)
+{
+   if (MacroCommands::GetNames().Index(macro) == wxNOT_FOUND) {
+      wxPrintf(_("There is no macro named \"%s\"\n"), macro);
+      return 1;
+   }
+
+   long jobs = MacroFileProcessor::DefaultJobs();
+   if (parser.Found(wxT("jobs"), &jobs) && jobs < 1) {
+      wxPrintf(_("The number of jobs must be at least 1\n"));
+      return 1;
+   }
+
+   // The other instances need not have the same working directory
+   FilePaths files;
+   for (size_t i = 0, cnt = parser.GetParamCount(); i < cnt; i++) {
+      wxFileName name{ parser.GetParam(i) };
+      name.MakeAbsolute();
+      files.push_back(name.GetFullPath());
+   }
+
+   const auto results =
+      MacroFileProcessor::ApplyInProcesses(macro, files, jobs);
+   const auto failed = std::count_if(results.begin(), results.end(),
+      [](const auto &result){ return !result.success; });
+   return failed == 0 ? 0 : 1;
+}
+
 bool AudacityApp::InitPart2()
 {
 #if defined(__WXMAC__)
    SetExitOnFrameDelete(false);
 #endif
 
+   // Parse command line and handle options that might require
+   // immediate exit...no need to initialize all of the audio
+   // stuff to display the version string.
+   std::shared_ptr< wxCmdLineParser > parser{ ParseCommandLine() };
+   if (!parser)
+   {
+      // Either user requested help or a parsing error occurred
+      exit(1);
+   }
+
+   // Applying a macro to files from the command line starts other instances
+   // that do the work, each with its own directory for temporary files, so
+   // that none of them conflicts with an instance the user is running
+   wxString macro, macroWorkerDir;
+   if (parser->Found(wxT("macro"), &macro)) {
+      if (!parser->Found(wxT("macro-worker"), &macroWorkerDir)) {
+         const auto exitCode = ApplyMacroToFiles(*parser, macro);
+         FinishPreferences();
+         exit(exitCode);
+      }
+      TempDirectory::SetSessionTempDir(macroWorkerDir);
+   }
+   const bool macroWorker = !macroWorkerDir.empty();
+
    // Make sure the temp dir isn't locked by another process.
+   if (!macroWorker)
    {
       auto key =
          PreferenceKey(FileNames::Operation::Temp, FileNames::PathType::_None);
@@ -1556,16 +1624,6 @@ bool AudacityApp::InitPart2()
       );
    });
 
-   // Parse command line and handle options that might require
-   // immediate exit...no need to initialize all of the audio
-   // stuff to display the version string.
-   std::shared_ptr< wxCmdLineParser > parser{ ParseCommandLine() };
-   if (!parser)
-   {
-      // Either user requested help or a parsing error occurred
-      exit(1);
-   }
-
    wxString journalFileName;
    const bool playingJournal = parser->Found("j", &journalFileName);
 
@@ -1597,7 +1655,8 @@ bool AudacityApp::InitPart2()
 
    AudacityProject *project;
 
-   ShowSplashScreen();
+   if (!macroWorker)
+      ShowSplashScreen();
 
    {
       // ANSWER-ME: Why is YieldFor needed at all?
@@ -1642,7 +1701,7 @@ bool AudacityApp::InitPart2()
 
    //Search for the new plugins
    std::vector<wxString> failedPlugins;
-   if(!playingJournal && !SkipEffectsScanAtStartup.Read())
+   if(!playingJournal && !macroWorker && !SkipEffectsScanAtStartup.Read())
    {
       auto newPlugins = PluginManager::Get().CheckPluginUpdates();
       if(!newPlugins.empty())
@@ -1670,7 +1729,8 @@ bool AudacityApp::InitPart2()
       project = ProjectManager::New();
    }
 
-   if (!playingJournal && ProjectSettings::Get(*project).GetShowSplashScreen())
+   if (!playingJournal && !macroWorker &&
+       ProjectSettings::Get(*project).GetShowSplashScreen())
    {
       // This may do a check-for-updates at every start up.
       // Mainly this is to tell users of ALPHAS who don't know that they have an ALPHA.
@@ -1686,7 +1746,8 @@ bool AudacityApp::InitPart2()
    HideSplashScreen(splashFadeOut);
 
 #if defined(HAVE_UPDATES_CHECK)
-   UpdateManager::Start(playingJournal);
+   if (!macroWorker)
+      UpdateManager::Start(playingJournal);
 #endif
 
    Importer::Get().Initialize();
@@ -1694,6 +1755,14 @@ bool AudacityApp::InitPart2()
 
    // Bug1561: delay the recovery dialog, to avoid crashes.
    CallAfter( [=] () mutable {
+      if (macroWorker) {
+         // The instance that started this one reports the results
+         GetProjectFrame(*project).Hide();
+         MacroFileProcessor::RunWorker(*project, macro, macroWorkerDir);
+         QuitAudacity(true);
+         return;
+      }
+
       // Remove duplicate shortcuts when there's a change of version
       int vMajorInit, vMinorInit, vMicroInit;
       GetPreferencesVersion(vMajorInit, vMinorInit, vMicroInit);
@@ -1719,12 +1788,6 @@ bool AudacityApp::InitPart2()
       //
       if (project && !didRecoverAnything)
       {
-         if (parser->Found(wxT("t")))
-         {
-            RunBenchmark( nullptr, *project);
-            QuitAudacity(true);
-         }
-
          for (size_t i = 0, cnt = parser->GetParamCount(); i < cnt; i++)
          {
             // PRL: Catch any exceptions, don't try this file again, continue to
@@ -2446,12 +2509,24 @@ std::unique_ptr<wxCmdLineParser> AudacityApp::ParseCommandLine()
    parser->AddSwitch(wxT("h"), wxT("help"), _("this help message"),
                      wxCMD_LINE_OPTION_HELP);
 
-   /*i18n-hint: This runs a set of automatic tests on Audacity itself */
-   parser->AddSwitch(wxT("t"), wxT("test"), _("run self diagnostics"));
-
    /*i18n-hint: This displays the Audacity version */
    parser->AddSwitch(wxT("v"), wxT("version"), _("display Audacity version"));
 
+   /*i18n-hint: This applies a macro to the files named on the command line,
+    *           then exits */
+   parser->AddLongOption(wxT("macro"),
+      _("apply the named macro to each file, then quit"));
+
+   /*i18n-hint: This sets how many files are processed at once by the
+    *           macro option */
+   parser->AddLongOption(wxT("jobs"),
+      _("number of files to apply the macro to at once"),
+      wxCMD_LINE_VAL_NUMBER);
+
+   // Used by the instances that the macro option starts
+   parser->AddLongOption(wxT("macro-worker"), {}, wxCMD_LINE_VAL_STRING,
+      wxCMD_LINE_HIDDEN);
+
    /*i18n-hint: This is a list of one or more files that Audacity
     *           should open upon startup */
    parser->AddParam(_("audio or project file name"),
@@ -36,6 +36,7 @@
 #include <wx/settings.h>
 
 #include "Clipboard.h"
+#include "MacroFileProcessor.h"
 #include "PluginManager.h"
 #include "ShuttleGui.h"
 #include "MenuCreator.h"
@@ -456,6 +457,7 @@ void ApplyMacroDialog::OnApplyToFiles(wxCommandEvent & WXUNUSED(event))
       Clipboard::Scope scope;
 
       wxWindowDisabler wd(&activityWin);
+      MacroFileProcessor processor{ *project, mMacroCommands, mCatalog };
       for (i = 0; i < (int)files.size(); i++) {
          if (i > 0) {
             //Clear the arrow in previous item.
@@ -464,27 +466,9 @@ void ApplyMacroDialog::OnApplyToFiles(wxCommandEvent & WXUNUSED(event))
          fileList->SetItemImage(i, 1, 1);
          fileList->EnsureVisible(i);
 
-         auto success = GuardedCall<bool>([&] {
-            ProjectFileManager::Get(*project).Import(files[i]);
-            Viewport::Get(*project).ZoomFitHorizontallyAndShowTrack(nullptr);
-            SelectUtilities::DoSelectAll(*project);
-            if (!mMacroCommands.ApplyMacro(mCatalog))
-               return false;
-
-            if (!activityWin.IsShown() || mAbort)
-               return false;
-
-            return true;
-         });
-
-         // Ensure project is completely reset
-         ProjectManager::Get(*project).ResetProjectToEmpty();
-         // Bug2567:
-         // Must also destroy the clipboard, to be sure sample blocks are
-         // all freed and their ids can be reused safely in the next pass
-         globalClipboard.Clear();
-
-         if (!success)
+         // This also resets the project completely
+         const auto result = processor.ApplyToFile(files[i]);
+         if (!result.success || !activityWin.IsShown() || mAbort)
             break;
       }
    }
@@ -45,6 +45,10 @@ public:
             AddSection(S, FrameStatistics::SectionID::WaveBitmapCachePreprocess);
             S.AddFixedText(Verbatim("WaveBitmapCache Lookups"));
             AddSection(S, FrameStatistics::SectionID::WaveBitmapCache);
+            S.AddFixedText(Verbatim("WaveBitmapCache Drawing"));
+            AddSection(S, FrameStatistics::SectionID::WaveBitmapDraw);
+            S.AddFixedText(Verbatim("WaveDataCache Background Fill (per element)"));
+            AddSection(S, FrameStatistics::SectionID::WaveDataCacheFill);
          }
          S.EndVerticalLay();
       }
@@ -0,0 +1,319 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MacroFileProcessor.cpp
+
+**********************************************************************/
+#include "MacroFileProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <wx/app.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/process.h>
+#include <wx/stdpaths.h>
+#include <wx/textfile.h>
+#include <wx/utils.h>
+
+#include "AudacityException.h"
+#include "BatchCommands.h"
+#include "Clipboard.h"
+#include "FileNames.h"
+#include "Project.h"
+#include "ProjectFileManager.h"
+#include "ProjectManager.h"
+#include "SelectUtilities.h"
+#include "TempDirectory.h"
+#include "Viewport.h"
+
+namespace {
+const auto FileListName = wxT("files.txt");
+const auto SettingsDirName = wxT("settings");
+
+//! Copy the user's settings files for one instance
+bool CopySettings(const FilePath &dir)
+{
+   const auto settingsDir = wxFileName{ dir, SettingsDirName }.GetFullPath();
+   if (!wxFileName::Mkdir(settingsDir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL))
+      return false;
+   for (const auto &path : { FileNames::Configuration(),
+      FileNames::PluginRegistry(), FileNames::PluginSettings() }) {
+      // A missing file gets its defaults in the instance too
+      if (!wxFileExists(path))
+         continue;
+      const wxFileName name{ path };
+      if (!wxCopyFile(path,
+         wxFileName{ settingsDir, name.GetFullName() }.GetFullPath()))
+         return false;
+   }
+   return true;
+}
+
+//! Write a line to the standard output at once, so that another process
+//! reading it sees whole lines
+void PrintLine(const wxString &line)
+{
+   const auto utf8 = (line + wxT("\n")).ToUTF8();
+   fwrite(utf8.data(), 1, utf8.length(), stdout);
+   fflush(stdout);
+}
+
+//! Another instance of the program, applying the macro to some of the files
+class Worker final : public wxProcess
+{
+public:
+   Worker() : wxProcess{ wxPROCESS_REDIRECT } {}
+
+   void OnTerminate(int, int) override { mRunning = false; }
+   bool IsRunning() const { return mRunning; }
+
+   //! Appends the complete lines of output so far
+   void ReadLines(std::vector<wxString> &lines)
+   {
+      // Read a character at a time, because reading more may block
+      if (const auto pStream = GetInputStream()) {
+         while (IsInputAvailable()) {
+            const auto c = pStream->GetC();
+            if (pStream->LastRead() == 0)
+               break;
+            if (c == '\n') {
+               lines.push_back(wxString::FromUTF8(mLine).Trim());
+               mLine.clear();
+            }
+            else
+               mLine.push_back(c);
+         }
+      }
+      // Pass on the error output, so that the pipe does not fill and block
+      // the other process
+      if (const auto pStream = GetErrorStream()) {
+         while (IsErrorAvailable()) {
+            const auto c = pStream->GetC();
+            if (pStream->LastRead() == 0)
+               break;
+            fputc(c, stderr);
+         }
+      }
+   }
+
+   FilePath dir;
+   //! Indices of the files given to this instance, in the order it reports
+   std::vector<size_t> indices;
+   size_t reported{ 0 };
+
+private:
+   std::string mLine;
+   bool mRunning{ true };
+};
+}
+
+MacroFileProcessor::MacroFileProcessor(AudacityProject &project,
+   MacroCommands &commands, const MacroCommandsCatalog &catalog,
+   bool reportErrors)
+   : mProject{ project }
+   , mCommands{ commands }
+   , mCatalog{ catalog }
+   , mReportErrors{ reportErrors }
+{
+}
+
+auto MacroFileProcessor::ApplyToFile(const FilePath &path) -> Result
+{
+   using namespace std::chrono;
+   const auto start = steady_clock::now();
+   auto &project = mProject;
+   Result result{ path };
+
+   const auto body = [&]{
+      if (!ProjectFileManager::Get(project).Import(path)) {
+         result.message = XO("The file could not be imported");
+         return false;
+      }
+      Viewport::Get(project).ZoomFitHorizontallyAndShowTrack(nullptr);
+      SelectUtilities::DoSelectAll(project);
+      if (!mCommands.ApplyMacro(mCatalog)) {
+         result.message = XO("The macro failed or was cancelled");
+         return false;
+      }
+      return true;
+   };
+   const auto handler = [&](AudacityException *) {
+      result.message = XO("An error occurred while applying the macro");
+      return false;
+   };
+   if (mReportErrors)
+      result.success = GuardedCall<bool>(body, handler);
+   else
+      result.success =
+         GuardedCall<bool>(body, handler, [](AudacityException *){});
+
+   // Ensure project is completely reset
+   ProjectManager::Get(project).ResetProjectToEmpty();
+   // Bug2567:
+   // Must also destroy the clipboard, to be sure sample blocks are
+   // all freed and their ids can be reused safely in the next pass
+   Clipboard::Get().Clear();
+
+   result.seconds = duration<double>(steady_clock::now() - start).count();
+   return result;
+}
+
+size_t MacroFileProcessor::DefaultJobs()
+{
+   return std::max(1u, std::thread::hardware_concurrency());
+}
+
+auto MacroFileProcessor::ApplyInProcesses(
+   const wxString &macro, const FilePaths &files, size_t jobs) -> Results
+{
+   Results results;
+   for (const auto &path : files)
+      results.push_back(
+         { path, false, XO("The process applying the macro ended early") });
+   if (files.empty())
+      return results;
+   jobs = std::clamp<size_t>(jobs, 1, files.size());
+
+   const auto executable = wxStandardPaths::Get().GetExecutablePath();
+   std::vector<std::unique_ptr<Worker>> workers;
+   for (size_t jj = 0; jj < jobs; ++jj) {
+      auto pWorker = std::make_unique<Worker>();
+      auto &worker = *pWorker;
+
+      // Each instance has its own directory for temporary files, so that it
+      // neither finds the projects of the others nor waits for them
+      worker.dir = wxFileName{ TempDirectory::TempDir(),
+         wxString::Format(wxT("macro-%lu-%lu"),
+            wxGetProcessId(), static_cast<unsigned long>(jj))
+      }.GetFullPath();
+      if (!wxFileName::Mkdir(worker.dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)
+          || !CopySettings(worker.dir))
+         continue;
+
+      // Interleave the files, so that each instance gets a similar mix of
+      // short and long ones
+      wxTextFile list{ wxFileName{ worker.dir, FileListName }.GetFullPath() };
+      if (!list.Create())
+         continue;
+      for (auto ii = jj; ii < files.size(); ii += jobs) {
+         worker.indices.push_back(ii);
+         list.AddLine(files[ii]);
+      }
+      if (!list.Write(wxTextFileType_None, wxConvUTF8))
+         continue;
+
+      const wxString args[]{
+         executable, wxT("--macro"), macro, wxT("--macro-worker"), worker.dir
+      };
+      std::vector<wxWCharBuffer> buffers;
+      std::vector<const wchar_t *> argv;
+      for (const auto &arg : args)
+         buffers.emplace_back(arg.wc_str());
+      for (const auto &buffer : buffers)
+         argv.push_back(buffer.data());
+      argv.push_back(nullptr);
+      if (wxExecute(argv.data(), wxEXEC_ASYNC | wxEXEC_HIDE_CONSOLE, &worker)
+          == 0)
+         continue;
+
+      workers.push_back(std::move(pWorker));
+   }
+
+   const auto report = [&](Worker &worker) {
+      std::vector<wxString> lines;
+      worker.ReadLines(lines);
+      for (const auto &line : lines) {
+         auto result = ParseResult(line);
+         // Skip any other output of the program
+         if (!result || worker.reported >= worker.indices.size())
+            continue;
+         PrintLine(line);
+         results[worker.indices[worker.reported++]] = std::move(*result);
+      }
+   };
+
+   const auto running = [&]{
+      return std::any_of(workers.begin(), workers.end(),
+         [](const auto &pWorker){ return pWorker->IsRunning(); });
+   };
+   while (running()) {
+      for (const auto &pWorker : workers)
+         report(*pWorker);
+      // Let the event loop notice the ends of the processes
+      wxYield();
+      wxMilliSleep(50);
+   }
+   for (const auto &pWorker : workers) {
+      report(*pWorker);
+      wxFileName::Rmdir(pWorker->dir, wxPATH_RMDIR_RECURSIVE);
+   }
+
+   return results;
+}
+
+void MacroFileProcessor::UseWorkerSettings(const FilePath &dir)
+{
+   FileNames::SetSessionConfigDir(
+      wxFileName{ dir, SettingsDirName }.GetFullPath());
+}
+
+void MacroFileProcessor::RunWorker(AudacityProject &project,
+   const wxString &macro, const FilePath &dir)
+{
+   FilePaths files;
+   wxTextFile list{ wxFileName{ dir, FileListName }.GetFullPath() };
+   if (list.Open(wxConvUTF8))
+      for (size_t ii = 0, count = list.GetLineCount(); ii < count; ++ii)
+         files.push_back(list[ii]);
+
+   MacroCommands commands{ project };
+   MacroCommandsCatalog catalog{ &project };
+   commands.ReadMacro(macro);
+
+   // Move global clipboard contents aside temporarily
+   Clipboard::Scope scope;
+
+   // Nobody is at the computer to see messages about errors
+   MacroFileProcessor processor{ project, commands, catalog, false };
+   for (const auto &path : files)
+      PrintLine(FormatResult(processor.ApplyToFile(path)));
+}
+
+wxString MacroFileProcessor::FormatResult(const Result &result)
+{
+   auto message = result.message.Translation();
+   message.Replace(wxT("\t"), wxT(" "));
+   message.Replace(wxT("\n"), wxT(" "));
+   return wxString::Format(wxT("%s\t%s\t%s\t%s"),
+      result.success ? wxT("OK") : wxT("FAILED"),
+      wxString::FromCDouble(result.seconds, 3), result.path, message);
+}
+
+auto MacroFileProcessor::ParseResult(const wxString &line)
+   -> std::optional<Result>
+{
+   // No escape character, because of backslashes in paths
+   const auto fields = wxSplit(line, wxT('\t'), wxT('\0'));
+   if (fields.size() < 3)
+      return {};
+
+   Result result;
+   if (fields[0] == wxT("OK"))
+      result.success = true;
+   else if (fields[0] != wxT("FAILED"))
+      return {};
+   if (!fields[1].ToCDouble(&result.seconds))
+      return {};
+   result.path = fields[2];
+   if (fields.size() > 3)
+      result.message = Verbatim(fields[3]);
+   return result;
+}
@@ -0,0 +1,94 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MacroFileProcessor.h
+
+  @brief Applies a macro to a list of files, with a result for each
+
+**********************************************************************/
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "Identifier.h"
+#include "TranslatableString.h"
+
+class AudacityProject;
+class MacroCommands;
+class MacroCommandsCatalog;
+
+//! Applies a macro to files one at a time, each imported into the emptied
+//! project, so that each file has a new temporary database
+/*!
+ Macro commands and effects run in the main thread, in a project that has a
+ window.  So the way to process many files at once is to run more instances
+ of the program, see ApplyInProcesses(); each applies the macro to its share
+ of the files in its own temporary directory.
+ */
+class MacroFileProcessor final
+{
+public:
+   struct Result
+   {
+      FilePath path;
+      bool success{ false };
+      //! Why it failed; empty for success
+      TranslatableString message;
+      double seconds{ 0 };
+   };
+   using Results = std::vector<Result>;
+
+   /*!
+    @param reportErrors whether exceptions are reported to the user; if not,
+    the processing of files may go on without anyone at the computer
+    */
+   MacroFileProcessor(AudacityProject &project,
+      MacroCommands &commands, const MacroCommandsCatalog &catalog,
+      bool reportErrors = true);
+
+   //! Imports the file, selects all, applies the macro, then empties the
+   //! project
+   Result ApplyToFile(const FilePath &path);
+
+   //! The number of processes that ApplyInProcesses() uses by default
+   static size_t DefaultJobs();
+
+   //! Applies the macro to the files in up to `jobs` other instances of this
+   //! program at once
+   /*!
+    Prints each result to the standard output as it arrives, in the format
+    of FormatResult().
+    @return the results in the order of the files; a file has a failed
+    result if its process ended before reporting it
+    */
+   static Results ApplyInProcesses(
+      const wxString &macro, const FilePaths &files, size_t jobs);
+
+   //! In an instance started by ApplyInProcesses(), use the copies of the
+   //! settings files in the directory; call before preferences are loaded
+   /*!
+    The instances don't take the lock that keeps other instances from
+    starting, so they must neither write the user's settings nor conflict
+    with each other.  Changes to the copies are lost with the directory.
+    */
+   static void UseWorkerSettings(const FilePath &dir);
+
+   //! In an instance started by ApplyInProcesses(), apply the macro to the
+   //! files listed in the directory, printing the results
+   static void RunWorker(AudacityProject &project,
+      const wxString &macro, const FilePath &dir);
+
+   //! One line, fields separated by tabs: "OK" or "FAILED", seconds, path,
+   //! and message
+   static wxString FormatResult(const Result &result);
+   static std::optional<Result> ParseResult(const wxString &line);
+
+private:
+   AudacityProject &mProject;
+   MacroCommands &mCommands;
+   const MacroCommandsCatalog &mCatalog;
+   const bool mReportErrors;
+};
@@ -10,6 +10,8 @@
 
 #include "PluginStartupRegistration.h"
 
+#include <algorithm>
+#include <optional>
 #include <thread>
 
 #include <wx/log.h>
@@ -127,58 +129,164 @@ namespace
    };
 }
 
-PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
-{
-   for(auto& p : pluginsToProcess)
-      mPluginsToProcess.push_back(p);
-}
+IntSetting PluginValidationProcesses{ L"/Plugins/ValidationProcesses", 0 };
 
-void PluginStartupRegistration::OnInternalError(const wxString& error)
+///Validates plugins one module at a time, in its own host process,
+///trying each provider associated with the module in turn
+class PluginStartupRegistration::Worker final :
+   public AsyncPluginValidator::Delegate
 {
-   StopWithError(error);
-}
+   PluginStartupRegistration& mOwner;
+   std::unique_ptr<AsyncPluginValidator> mValidator;
+   std::optional<size_t> mPluginIndex;
+   size_t mProviderIndex{0};
+   bool mValidProviderFound{false};
+   std::vector<PluginDescriptor> mFailedPluginsCache;
+   std::chrono::system_clock::time_point mRequestStartTime{};
+
+   const std::vector<wxString>& GetProviders() const
+   {
+      return mOwner.mPluginsToProcess[*mPluginIndex].second;
+   }
 
-void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
-{
-   if(!mValidProviderFound)
+   const wxString& GetPath() const
+   {
+      return mOwner.mPluginsToProcess[*mPluginIndex].first;
+   }
+
+   void ValidateCurrent()
+   {
+      try
+      {
+         if(!mValidator)
+            mValidator = std::make_unique<AsyncPluginValidator>(*this);
+
+         mValidator->Validate(GetProviders()[mProviderIndex], GetPath());
+         mRequestStartTime = std::chrono::system_clock::now();
+      }
+      catch(std::exception& e)
+      {
+         mOwner.StopWithError(e.what());
+      }
+      catch(...)
+      {
+         mOwner.StopWithError("unknown error");
+      }
+   }
+
+public:
+   explicit Worker(PluginStartupRegistration& owner) : mOwner(owner) { }
+
+   bool IsBusy() const noexcept { return mPluginIndex.has_value(); }
+
+   std::optional<size_t> GetPluginIndex() const noexcept { return mPluginIndex; }
+
+   std::chrono::system_clock::time_point GetRequestStartTime() const noexcept
+   {
+      return mRequestStartTime;
+   }
+
+   ///True if the host did not respond since the current request was sent
+   bool IsSilent() const noexcept
+   {
+      return mValidator && mValidator->InactiveSince() < mRequestStartTime;
+   }
+
+   void Start(size_t pluginIndex)
+   {
+      mPluginIndex = pluginIndex;
+      mProviderIndex = 0;
+      mValidProviderFound = false;
       mFailedPluginsCache.clear();
+      ValidateCurrent();
+   }
 
-   mValidProviderFound = true;
-   if(!desc.IsValid())
-      mFailedPluginsCache.push_back(desc);
-   PluginManager::Get().RegisterPlugin(PluginDescriptor { desc });
-}
+   ///Stops the host process, if any
+   void Release()
+   {
+      mPluginIndex.reset();
+      mValidator.reset();
+   }
 
-void PluginStartupRegistration::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
-{
-   PluginID ID = providerId + wxT("_") + path;
-   PluginDescriptor pluginDescriptor;
-   pluginDescriptor.SetPluginType(PluginTypeStub);
-   pluginDescriptor.SetID(ID);
-   pluginDescriptor.SetProviderID(providerId);
-   pluginDescriptor.SetPath(path);
-   pluginDescriptor.SetEnabled(false);
-   pluginDescriptor.SetValid(false);
-
-   //Multiple providers can report same module paths
-   //do not register until all associated providers have tried to load the module
-   mFailedPluginsCache.push_back(std::move(pluginDescriptor));
-}
+   void Skip()
+   {
+      if(!mValidator)
+         return;
+      //Drop current validator, no more callbacks will be received from now
+      mValidator->SetDelegate(nullptr);
+      //While on Linux and MacOS socket `shutdown()` wakes up `select()` almost
+      //immediately, on Windows it sometimes get delayed on unspecified amount
+      //of time. As we do not expect any data we can safely move remaining
+      //operations to another thread.
+      std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(mValidator))]{ }).detach();
+
+      if(!mValidProviderFound)
+      {
+         // Validator didn't report anything yet or it tried
+         // one or more providers that didn't recognize the plugin.
+         // In that case we assume that none of the remaining providers
+         // can recognize that plugin.
+         // Note: create stub `PluginDescriptors` for each associated provider
+         for(;mProviderIndex < GetProviders().size(); ++mProviderIndex)
+            OnPluginValidationFailed(GetProviders()[mProviderIndex], GetPath());
+         mProviderIndex = GetProviders().size() - 1;
+      }
+      //else
+      //    Don't assume that `OnValidationFinished()` and `OnPluginFound()`
+      //    aren't deferred within run loop
 
+      OnValidationFinished();
+   }
 
-void PluginStartupRegistration::OnValidationFinished()
-{
-   ++mCurrentPluginProviderIndex;
-   if(mValidProviderFound ||
-      mPluginsToProcess[mCurrentPluginIndex].second.size() == mCurrentPluginProviderIndex)
+   void OnInternalError(const wxString& error) override
+   {
+      mOwner.StopWithError(error);
+   }
+
+   void OnPluginFound(const PluginDescriptor& desc) override
+   {
+      if(!mValidProviderFound)
+         mFailedPluginsCache.clear();
+
+      mValidProviderFound = true;
+      if(!desc.IsValid())
+         mFailedPluginsCache.push_back(desc);
+      PluginManager::Get().RegisterPlugin(PluginDescriptor { desc });
+   }
+
+   void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override
    {
+      PluginID ID = providerId + wxT("_") + path;
+      PluginDescriptor pluginDescriptor;
+      pluginDescriptor.SetPluginType(PluginTypeStub);
+      pluginDescriptor.SetID(ID);
+      pluginDescriptor.SetProviderID(providerId);
+      pluginDescriptor.SetPath(path);
+      pluginDescriptor.SetEnabled(false);
+      pluginDescriptor.SetValid(false);
+
+      //Multiple providers can report same module paths
+      //do not register until all associated providers have tried to load the module
+      mFailedPluginsCache.push_back(std::move(pluginDescriptor));
+   }
+
+   void OnValidationFinished() override
+   {
+      ++mProviderIndex;
+      if(!mValidProviderFound && GetProviders().size() != mProviderIndex)
+      {
+         ValidateCurrent();
+         return;
+      }
+
+      std::vector<wxString> failedPaths;
       if(!mFailedPluginsCache.empty())
       {
          //we've tried all providers associated with same module path...
          if(!mValidProviderFound)
          {
             //...but none of them succeeded
-            mFailedPluginsPaths.push_back(mFailedPluginsCache[0].GetPath());
+            failedPaths.push_back(mFailedPluginsCache[0].GetPath());
 
             //Same plugin path, but different providers, we need to register all of them
             for(auto& desc : mFailedPluginsCache)
@@ -190,95 +298,100 @@ void PluginStartupRegistration::OnValidationFinished()
             for(auto& desc : mFailedPluginsCache)
             {
                if(desc.GetPluginType() != PluginTypeStub)
-                  mFailedPluginsPaths.push_back(desc.GetPath());
+                  failedPaths.push_back(desc.GetPath());
             }
          }
       }
-      ++mCurrentPluginIndex;
-      mCurrentPluginProviderIndex = 0;
-      mValidProviderFound = false;
       mFailedPluginsCache.clear();
+
+      const auto pluginIndex = *mPluginIndex;
+      mPluginIndex.reset();
+      mOwner.OnPluginProcessed(pluginIndex, std::move(failedPaths));
+      mOwner.ProcessNext(*this);
    }
-   ProcessNext();
+};
+
+PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
+{
+   for(auto& p : pluginsToProcess)
+      mPluginsToProcess.push_back(p);
+   mFailedPaths.resize(mPluginsToProcess.size());
 }
 
+PluginStartupRegistration::~PluginStartupRegistration() = default;
+
 const std::vector<wxString>& PluginStartupRegistration::GetFailedPluginsPaths() const noexcept
 {
    return mFailedPluginsPaths;
 }
 
-void PluginStartupRegistration::Run(std::chrono::seconds timeout)
+void PluginStartupRegistration::Run(std::chrono::seconds timeout, size_t processes)
 {
+   if(processes == 0)
+   {
+      const auto setting = PluginValidationProcesses.Read();
+      processes = setting > 0
+         ? static_cast<size_t>(setting)
+         //Plugins may take much memory and time to load, leave some
+         //processors to the rest of the system
+         : std::max(1u, std::thread::hardware_concurrency() / 2);
+   }
+   processes = std::max<size_t>(1, std::min(processes, mPluginsToProcess.size()));
+
    PluginScanDialog dialog(nullptr, wxID_ANY, XO("Searching for plugins"));
    wxTimer timeoutTimer(&dialog, OnPluginScanTimeout);
    mScanDialog = &dialog;
-   mTimeoutTimer = &timeoutTimer;
    mTimeout = timeout;
 
    dialog.Bind(wxEVT_BUTTON, [this](wxCommandEvent& evt) {
       evt.Skip();
       if(evt.GetId() == wxID_IGNORE)
-         Skip();
+         SkipOldest();
    });
    dialog.Bind(wxEVT_TIMER, [this](wxTimerEvent& evt) {
       if(evt.GetId() == OnPluginScanTimeout)
-      {
-         if(mValidator && mValidator->InactiveSince() < mRequestStartTime)
-            Skip();
-         //else
-         //   wxMessageBox("Please check for plugin popups!");
-      }
+         CheckTimeouts();
       else
          evt.Skip();
    });
    dialog.Bind(wxEVT_CLOSE_WINDOW, [this](wxCloseEvent& evt) {
       evt.Skip();
-      mValidator.reset();
+      mStopped = true;
+      //Workers may still be on the call stack, only stop their hosts
+      for(auto& worker : mWorkers)
+         worker->Release();
       PluginManager::Get().Save();
       PluginManager::Get().NotifyPluginsChanged();
    });
 
    dialog.CenterOnScreen();
-   ProcessNext();
+   if(mTimeout.count() > 0)
+      timeoutTimer.Start(1000);
+   for(size_t i = 0; i < processes; ++i)
+      mWorkers.push_back(std::make_unique<Worker>(*this));
+   for(size_t i = 0; i < mWorkers.size() && !mStopped; ++i)
+      ProcessNext(*mWorkers[i]);
    dialog.ShowModal();
+
+   mStopped = true;
+   for(auto& worker : mWorkers)
+      worker->Release();
+
+   //Report failures in the order of plugins, whichever process finished first
+   mFailedPluginsPaths.clear();
+   for(auto& paths : mFailedPaths)
+      for(auto& path : paths)
+         mFailedPluginsPaths.push_back(std::move(path));
 }
 
 void PluginStartupRegistration::Stop()
 {
+   if(mStopped)
+      return;
    if(auto dialog = mScanDialog.get())
       dialog->Close();
 }
 
-void PluginStartupRegistration::Skip()
-{
-   //Drop current validator, no more callbacks will be received from now
-   mValidator->SetDelegate(nullptr);
-   //While on Linux and MacOS socket `shutdown()` wakes up `select()` almost
-   //immediately, on Windows it sometimes get delayed on unspecified amount
-   //of time. As we do not expect any data we can safely move remaining
-   //operations to another thread.
-   std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(mValidator))]{ }).detach();
-
-   if(!mValidProviderFound)
-   {
-      // Validator didn't report anything yet or it tried
-      // one or more providers that didn't recognize the plugin.
-      // In that case we assume that none of the remaining providers
-      // can recognize that plugin.
-      // Note: create stub `PluginDescriptors` for each associated provider
-      for(;mCurrentPluginProviderIndex < mPluginsToProcess[mCurrentPluginIndex].second.size(); ++mCurrentPluginProviderIndex)
-         OnPluginValidationFailed(
-            mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-            mPluginsToProcess[mCurrentPluginIndex].first);
-      mCurrentPluginProviderIndex = mPluginsToProcess[mCurrentPluginIndex].second.size() - 1;
-   }
-   //else
-   //    Don't assume that `OnValidationFinished()` and `OnPluginFound()`
-   //    aren't deferred within run loop
-
-   OnValidationFinished();
-}
-
 void PluginStartupRegistration::StopWithError(const wxString& msg)
 {
    //TODO: show error dialog?
@@ -286,41 +399,75 @@ void PluginStartupRegistration::StopWithError(const wxString& msg)
    Stop();
 }
 
-void PluginStartupRegistration::ProcessNext()
+void PluginStartupRegistration::ProcessNext(Worker& worker)
 {
-   if(mCurrentPluginIndex == mPluginsToProcess.size())
-   {
-      Stop();
+   if(mStopped)
       return;
-   }
 
-   try
+   if(mNextPluginIndex == mPluginsToProcess.size())
    {
-      if(auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get()))
-      {
-         const auto progress = static_cast<float>(mCurrentPluginIndex) / static_cast<float>(mPluginsToProcess.size());
-         dialog->UpdateProgress(
-            mPluginsToProcess[mCurrentPluginIndex].first,
-            progress);
-      }
-      if(!mValidator)
-         mValidator = std::make_unique<AsyncPluginValidator>(*this);
-
-      mValidator->Validate(
-         mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-         mPluginsToProcess[mCurrentPluginIndex].first
-      );
-      mRequestStartTime = std::chrono::system_clock::now();
-      if(auto timer = mTimeoutTimer.get())
-         timer->StartOnce(std::chrono::duration_cast<std::chrono::milliseconds>(mTimeout).count());
+      //Nothing left for this one, stop its host early
+      worker.Release();
+      if(std::none_of(mWorkers.begin(), mWorkers.end(),
+         [](auto& other) { return other->IsBusy(); }))
+         Stop();
+      return;
    }
-   catch(std::exception& e)
+
+   worker.Start(mNextPluginIndex++);
+   UpdateProgress();
+}
+
+void PluginStartupRegistration::OnPluginProcessed(size_t pluginIndex, std::vector<wxString> failedPaths)
+{
+   mFailedPaths[pluginIndex] = std::move(failedPaths);
+   ++mPluginsProcessed;
+   UpdateProgress();
+}
+
+PluginStartupRegistration::Worker* PluginStartupRegistration::GetOldestBusyWorker() const
+{
+   Worker* oldest = nullptr;
+   for(auto& worker : mWorkers)
    {
-      StopWithError(e.what());
+      if(worker->IsBusy() &&
+         (oldest == nullptr || worker->GetRequestStartTime() < oldest->GetRequestStartTime()))
+         oldest = worker.get();
    }
-   catch(...)
+   return oldest;
+}
+
+void PluginStartupRegistration::SkipOldest()
+{
+   if(auto worker = GetOldestBusyWorker())
+      worker->Skip();
+}
+
+void PluginStartupRegistration::CheckTimeouts()
+{
+   const auto now = std::chrono::system_clock::now();
+   for(auto& worker : mWorkers)
    {
-      StopWithError("unknown error");
+      //Skip() may stop the registration
+      if(mStopped)
+         return;
+      if(worker->IsBusy() && worker->IsSilent() &&
+         now - worker->GetRequestStartTime() >= mTimeout)
+         worker->Skip();
    }
 }
 
+void PluginStartupRegistration::UpdateProgress()
+{
+   auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get());
+   if(dialog == nullptr)
+      return;
+   //Show the plugin that Skip would drop
+   const auto worker = GetOldestBusyWorker();
+   if(worker == nullptr)
+      return;
+   const auto progress = static_cast<float>(mPluginsProcessed) / static_cast<float>(mPluginsToProcess.size());
+   dialog->UpdateProgress(
+      mPluginsToProcess[*worker->GetPluginIndex()].first,
+      progress);
+}
@@ -17,47 +17,60 @@
 #include <wx/string.h>
 #include <wx/timer.h>
 #include "AsyncPluginValidator.h"
+#include "Prefs.h"
 #include "wxPanelWrapper.h"
 
+///Number of plugin host processes that validate plugins at the same time;
+///zero or less chooses from the number of processors
+extern IntSetting PluginValidationProcesses;
+
 ///Helper class that passes plugins provided in constructor
-///to plugin validator, then "good" plugins are registered in
-///PluginManager. 
-class PluginStartupRegistration final :
-   public AsyncPluginValidator::Delegate
+///to plugin validators, then "good" plugins are registered in
+///PluginManager. Each validator runs its own host process, so
+///several plugins are validated at once, and a plugin that crashes
+///or hangs its host affects no other.
+class PluginStartupRegistration final
 {
-   std::unique_ptr<AsyncPluginValidator> mValidator;
+   class Worker;
+
+   std::vector<std::unique_ptr<Worker>> mWorkers;
    std::vector<std::pair<wxString, std::vector<wxString>>> mPluginsToProcess;
-   size_t mCurrentPluginIndex{0};
-   size_t mCurrentPluginProviderIndex{0};
-   bool mValidProviderFound{false};
+   size_t mNextPluginIndex{0};
+   size_t mPluginsProcessed{0};
+   ///For each plugin, paths that didn't pass validation
+   std::vector<std::vector<wxString>> mFailedPaths;
    std::vector<wxString> mFailedPluginsPaths;
-   std::vector<PluginDescriptor> mFailedPluginsCache;
    wxWeakRef<wxDialogWrapper> mScanDialog;
-   wxWeakRef<wxTimer> mTimeoutTimer;
    std::chrono::system_clock::duration mTimeout{};
-   std::chrono::system_clock::time_point mRequestStartTime{};
+   ///Set when the dialog closes; no more plugins are started then
+   bool mStopped{false};
 public:
 
    PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess);
+   ~PluginStartupRegistration();
 
    ///Starts validation, showing dialog that blocks execution until
    ///process is complete or canceled
    ///@param timeout Time allowed to spend on a single plugin validation.
    ///Pass 0 to disable timeout.
-   void Run(std::chrono::seconds timeout = std::chrono::seconds(30));
+   ///@param processes Number of plugins validated at once, in separate
+   ///processes. Pass 0 to use PluginValidationProcesses.
+   void Run(std::chrono::seconds timeout = std::chrono::seconds(30),
+      size_t processes = 0);
 
    ///Returns list of paths of plugins that didn't pass validation for some reason
    const std::vector<wxString>& GetFailedPluginsPaths() const noexcept;
 
-   void OnInternalError(const wxString& error) override;
-   void OnPluginFound(const PluginDescriptor& desc) override;
-   void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
-   void OnValidationFinished() override;
-
 private:
-   
+
    void Stop();
-   void Skip();
    void StopWithError(const wxString& msg);
-   void ProcessNext();
+   ///Gives the worker the next plugin, if any is left
+   void ProcessNext(Worker& worker);
+   void OnPluginProcessed(size_t pluginIndex, std::vector<wxString> failedPaths);
+   void CheckTimeouts();
+   ///Skips the plugin that has been validated for the longest time
+   void SkipOldest();
+   void UpdateProgress();
+   Worker* GetOldestBusyWorker() const;
 };
@@ -28,6 +28,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "Legacy.h"
+#include "MirAnalysisQueue.h"
 #include "MusicInformationRetrieval.h"
 #include "PlatformCompatibility.h"
 #include "Project.h"
@@ -1368,38 +1369,27 @@ bool ProjectFileManager::Import(wxArrayString fileNames, bool addToHistory)
 
 namespace
 {
+//! Wait for the analyses of the readers, which the queue began as each
+//! file was imported
 std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> RunTempoDetection(
    const std::vector<std::shared_ptr<ClipMirAudioReader>>& readers,
-   const MIR::ProjectInterface& project, bool projectWasEmpty)
+   MIR::AnalysisQueue& queue)
 {
-   const auto isBeatsAndMeasures = project.ViewIsBeatsAndMeasures();
-   const auto projectTempo = project.GetTempo();
-
    using namespace BasicUI;
    auto progress = MakeProgress(
       XO("Music Information Retrieval"), XO("Analyzing imported audio"),
       ProgressShowCancel);
-   auto count = 0;
-   const auto reportProgress = [&](double progressFraction) {
-      const auto result = progress->Poll(
-         (count + progressFraction) / readers.size() * 1000, 1000);
+   const auto syncInfos = queue.Wait([&](double progressFraction) {
+      const auto result = progress->Poll(progressFraction * 1000, 1000);
       if (result != ProgressResult::Success)
          throw UserException {};
-   };
+   });
 
    std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> analyzedClips;
    analyzedClips.reserve(readers.size());
-   std::transform(
-      readers.begin(), readers.end(), std::back_inserter(analyzedClips),
-      [&](const std::shared_ptr<ClipMirAudioReader>& reader) {
-         const MIR::ProjectSyncInfoInput input {
-            *reader,      reader->filename, reader->tags,       reportProgress,
-            projectTempo, projectWasEmpty,  isBeatsAndMeasures,
-         };
-         auto syncInfo = MIR::GetProjectSyncInfo(input);
-         ++count;
-         return std::make_shared<AnalyzedWaveClip>(reader, syncInfo);
-      });
+   for (size_t i = 0; i < readers.size(); ++i)
+      analyzedClips.push_back(
+         std::make_shared<AnalyzedWaveClip>(readers[i], syncInfos[i]));
    return analyzedClips;
 }
 } // namespace
@@ -1409,13 +1399,29 @@ bool ProjectFileManager::ImportAndRunTempoDetection(
 {
    const auto projectWasEmpty =
       TrackList::Get(mProject).Any<WaveTrack>().empty();
+   const auto pProj = mProject.shared_from_this();
+   bool isBeatsAndMeasures;
+   double projectTempo;
+   {
+      const AudacityMirProject mirInterface { *pProj };
+      isBeatsAndMeasures = mirInterface.ViewIsBeatsAndMeasures();
+      projectTempo = mirInterface.GetTempo();
+   }
+
+   // Analyze each file on a worker thread while the next ones import
+   const auto queue = std::make_shared<MIR::AnalysisQueue>();
    std::vector<std::shared_ptr<ClipMirAudioReader>> resultingReaders;
    const auto success = std::all_of(
       fileNames.begin(), fileNames.end(), [&](const FilePath& fileName) {
          std::shared_ptr<ClipMirAudioReader> resultingReader;
          const auto success = DoImport(fileName, addToHistory, resultingReader);
          if (success && resultingReader)
+         {
+            queue->Add({ *resultingReader, resultingReader->filename,
+                         resultingReader->tags, {}, projectTempo,
+                         projectWasEmpty, isBeatsAndMeasures });
             resultingReaders.push_back(std::move(resultingReader));
+         }
          return success;
       });
    // At the moment, one failing import doesn't revert the project state, hence
@@ -1423,11 +1429,9 @@ bool ProjectFileManager::ImportAndRunTempoDetection(
    // TODO implement reverting of the project state on failure.
    if (!resultingReaders.empty())
    {
-      const auto pProj = mProject.shared_from_this();
       BasicUI::CallAfter([=] {
+         const auto analyzedClips = RunTempoDetection(resultingReaders, *queue);
          AudacityMirProject mirInterface { *pProj };
-         const auto analyzedClips =
-            RunTempoDetection(resultingReaders, mirInterface, projectWasEmpty);
          MIR::SynchronizeProject(analyzedClips, mirInterface, projectWasEmpty);
       });
    }
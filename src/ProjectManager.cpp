@@ -781,6 +781,11 @@ void ProjectManager::OnTimer(wxTimerEvent& WXUNUSED(event))
       }
    }
 
+   // Release unused space in the project file a little at a time, but not
+   // while the recording or playback threads need the disk
+   if (!gAudioIO->IsBusy())
+      ProjectFileIO::Get(project).CompactIncrementally();
+
    // As also with the TrackPanel timer:  wxTimer may be unreliable without
    // some restarts
    RestartTimer();
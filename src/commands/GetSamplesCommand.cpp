@@ -0,0 +1,130 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  GetSamplesCommand.cpp
+
+**********************************************************************/
+#include "GetSamplesCommand.h"
+
+#include "CommandDispatch.h"
+#include "MenuRegistry.h"
+#include "../CommonCommandFlags.h"
+#include "LoadCommands.h"
+#include "ScriptCommandRelay.h"
+#include "WaveTrack.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <float.h>
+
+#include "SettingsVisitor.h"
+#include "ShuttleGui.h"
+#include "CommandContext.h"
+
+const ComponentInterfaceSymbol GetSamplesCommand::Symbol
+{ XO("Get Samples") };
+
+namespace{ BuiltinCommandsModule::Registration< GetSamplesCommand > reg; }
+
+template<bool Const>
+bool GetSamplesCommand::VisitSettings( SettingsVisitorBase<Const> & S ){
+   S.Define( mTrackIndex,   wxT("Track"),   0, 0, INT_MAX );
+   S.Define( mChannelIndex, wxT("Channel"), 0, 0, 1 );
+   S.Define( mT0,           wxT("Start"),   0.0, 0.0, (double)FLT_MAX );
+   S.Define( mT1,           wxT("End"),     0.0, 0.0, (double)FLT_MAX );
+   return true;
+}
+
+bool GetSamplesCommand::VisitSettings( SettingsVisitor & S )
+   { return VisitSettings<false>(S); }
+
+bool GetSamplesCommand::VisitSettings( ConstSettingsVisitor & S )
+   { return VisitSettings<true>(S); }
+
+void GetSamplesCommand::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      S.TieNumericTextBox(XXO("Track:"), mTrackIndex);
+      S.TieNumericTextBox(XXO("Channel:"), mChannelIndex);
+      S.TieNumericTextBox(XXO("Start Time:"), mT0);
+      S.TieNumericTextBox(XXO("End Time:"), mT1);
+   }
+   S.EndMultiColumn();
+}
+
+bool GetSamplesCommand::Apply(const CommandContext & context)
+{
+   // Tracks are numbered as in the response of GetInfo: Type=Tracks
+   const WaveTrack *pTrack{};
+   int index = 0;
+   for (auto trk : TrackList::Get(context.project))
+      if (index++ == mTrackIndex) {
+         pTrack = dynamic_cast<const WaveTrack *>(trk);
+         break;
+      }
+   if (!pTrack) {
+      context.Error(wxT("Track is not a wave track!"));
+      return false;
+   }
+   if (mChannelIndex < 0 || mChannelIndex >= (int)pTrack->NChannels()) {
+      context.Error(wxT("Track has no such channel!"));
+      return false;
+   }
+
+   const auto s0 = pTrack->TimeToLongSamples(mT0);
+   const auto s1 = std::max(s0, pTrack->TimeToLongSamples(mT1));
+   if (s1 - s0 > sampleCount{ MaxSamples }) {
+      context.Error(wxString::Format(
+         wxT("Too many samples! Get at most %d at once."), int(MaxSamples)));
+      return false;
+   }
+   const auto length = (s1 - s0).as_size_t();
+
+   // Read block by block, so that the binary response needs no more than
+   // one copy of the samples
+   const bool binary = ScriptCommandRelay::CanRespondInBinary();
+   std::vector<char> data;
+   if (binary)
+      data.resize(length * sizeof(float));
+   else
+      context.StartArray();
+   const auto buffSize = pTrack->GetMaxBlockSize();
+   Floats buffer{ buffSize };
+   float *const buffers[]{ buffer.get() };
+   for (size_t done = 0; done < length;) {
+      const auto block = limitSampleBufferSize(
+         pTrack->GetBestBlockSize(s0 + done), length - done);
+      pTrack->GetFloats(mChannelIndex, 1, buffers, s0 + done, block);
+      if (binary)
+         memcpy(data.data() + done * sizeof(float), buffer.get(),
+            block * sizeof(float));
+      else
+         for (size_t ii = 0; ii < block; ++ii)
+            context.AddItem(buffer[ii]);
+      done += block;
+   }
+   if (binary)
+      ScriptCommandRelay::RespondInBinary({ "f32", std::move(data) });
+   else
+      context.EndArray();
+   return true;
+}
+
+namespace {
+using namespace MenuRegistry;
+
+// Register menu items
+
+AttachedItem sAttachment{
+   Command( wxT("GetSamples"), XXO("Get Samples..."),
+      CommandDispatch::OnAudacityCommand, AudioIONotBusyFlag() ),
+   wxT("Optional/Extra/Part2/Scriptables2")
+};
+
+}
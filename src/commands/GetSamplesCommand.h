@@ -0,0 +1,47 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  GetSamplesCommand.h
+
+**********************************************************************/
+#ifndef __GETSAMPLESCOMMAND__
+#define __GETSAMPLESCOMMAND__
+
+#include "Command.h"
+#include "CommandType.h"
+
+//! Command to get the samples of one channel of a wave track in a time range
+/*!
+ In the pipelined protocol of mod-script-pipe, the samples come as one
+ binary frame of 32-bit floats; otherwise as an array of numbers
+ */
+class GetSamplesCommand final : public AudacityCommand
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() const override {return Symbol;}
+   TranslatableString GetDescription() const override {return XO("Gets the samples of a track channel.");};
+   template<bool Const> bool VisitSettings( SettingsVisitorBase<Const> &S );
+   bool VisitSettings( SettingsVisitor & S ) override;
+   bool VisitSettings( ConstSettingsVisitor & S ) override;
+   void PopulateOrExchange(ShuttleGui & S) override;
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override {return L"Extra_Menu:_Scriptables_II#get_samples";}
+   bool Apply(const CommandContext &context) override;
+
+   //! Limits the memory of one response
+   static constexpr size_t MaxSamples = 1 << 24;
+
+public:
+   int mTrackIndex;
+   int mChannelIndex;
+   double mT0;
+   double mT1;
+};
+
+#endif /* End of include guard: __GETSAMPLESCOMMAND__ */
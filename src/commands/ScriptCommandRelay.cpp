@@ -26,7 +26,11 @@ code out of ModuleManager.
 #include "ActiveProject.h"
 #include "AppCommandEvent.h"
 #include "Project.h"
+#include "MemoryX.h"
 #include <wx/app.h>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 /// This is the function which actually obeys one command.
@@ -75,6 +79,96 @@ static int ExecFromMain(wxString *pIn, wxString *pOut)
    return ExecCommand(pIn, pOut, true);
 }
 
+namespace {
+//! Passes the builders of a batch from the main thread to the script thread
+struct BatchBuilders
+{
+   struct Item
+   {
+      //! Null where there was no project
+      std::unique_ptr<CommandBuilder> pBuilder;
+      //! Null where the command may not respond in binary; written in the
+      //! main thread before the response of the builder completes
+      std::unique_ptr<ScriptCommandRelay::BinaryResponse> pBinary;
+   };
+
+   std::mutex mutex;
+   std::condition_variable added;
+   //! Guarded by mutex
+   std::vector<Item> items;
+};
+
+//! Where the command running now in the main thread may respond in binary
+ScriptCommandRelay::BinaryResponse *spBinaryResponse = nullptr;
+}
+
+bool ScriptCommandRelay::CanRespondInBinary()
+{
+   return spBinaryResponse != nullptr;
+}
+
+void ScriptCommandRelay::RespondInBinary(BinaryResponse response)
+{
+   assert(spBinaryResponse); // pre
+   if (spBinaryResponse)
+      *spBinaryResponse = std::move(response);
+}
+
+void ScriptCommandRelay::ExecBatch(const std::vector<wxString> &commands,
+   const std::vector<bool> &binary,
+   const ResponseCallback &onResponse)
+{
+   auto pBatch = std::make_shared<BatchBuilders>();
+
+   // Send all of the commands to the main thread at once.  Each is
+   // interpreted only after the previous ones have run, so that it sees the
+   // project as they left it.
+   wxTheApp->CallAfter([pBatch, commands, binary]{
+      for (size_t ii = 0; ii < commands.size(); ++ii) {
+         BatchBuilders::Item item;
+         if (auto pProject = ::GetActiveProject().lock())
+            item.pBuilder =
+               std::make_unique<CommandBuilder>(*pProject, commands[ii]);
+         OldStyleCommandPointer cmd;
+         if (item.pBuilder && item.pBuilder->WasValid())
+            cmd = item.pBuilder->GetCommand();
+         if (ii < binary.size() && binary[ii])
+            item.pBinary = std::make_unique<BinaryResponse>();
+         const auto pBinary = item.pBinary.get();
+         {
+            std::lock_guard<std::mutex> lock{ pBatch->mutex };
+            pBatch->items.push_back(std::move(item));
+         }
+         pBatch->added.notify_one();
+
+         if (cmd) {
+            AppCommandEvent ev;
+            ev.SetCommand(cmd);
+            spBinaryResponse = pBinary;
+            auto cleanup = finally([]{ spBinaryResponse = nullptr; });
+            wxTheApp->SafelyProcessEvent(ev);
+         }
+      }
+   });
+
+   // Wait for and retrieve the responses
+   for (size_t ii = 0; ii < commands.size(); ++ii) {
+      CommandBuilder *pBuilder{};
+      const BinaryResponse *pBinary{};
+      {
+         std::unique_lock<std::mutex> lock{ pBatch->mutex };
+         pBatch->added.wait(lock,
+            [&]{ return pBatch->items.size() > ii; });
+         pBuilder = pBatch->items[ii].pBuilder.get();
+         pBinary = pBatch->items[ii].pBinary.get();
+      }
+      const auto response = pBuilder ? pBuilder->GetResponse() : wxString{};
+      // The response is complete, so the binary data, if any, is written
+      onResponse(ii, response,
+         pBinary && !pBinary->type.empty() ? pBinary : nullptr);
+   }
+}
+
 /// Starts the script server
 void ScriptCommandRelay::StartScriptServer(tpRegScriptServerFunc scriptFn)
 {
@@ -18,7 +18,10 @@
 
 
 
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 class wxString;
 
@@ -29,6 +32,47 @@ class AUDACITY_DLL_API ScriptCommandRelay
 {
 public:
    static void StartScriptServer(tpRegScriptServerFunc scriptFn);
+
+   //! Data that a command gives as its response in place of text
+   struct BinaryResponse
+   {
+      //! Names the encoding of the data, such as "f32" for 32-bit floats in
+      //! the byte order of the machine
+      std::string type;
+      std::vector<char> data;
+   };
+
+   //! Receives the response to the command at the given index of a batch
+   /*!
+    @param pBinary null, unless the command responded in binary, and then
+    the text response only reports the outcome
+    */
+   using ResponseCallback = std::function<void(size_t index,
+      const wxString &response, const BinaryResponse *pBinary)>;
+
+   //! Executes commands in order in the main thread, from the script thread
+   /*!
+    The main thread runs all of the commands in the handling of one event,
+    instead of one event for each command, each awaited before sending the
+    next.  Each command is interpreted just before it runs, for the project
+    then active, so it sees the changes made by the previous ones.
+    @param binary whether each command may respond in binary; missing
+    entries are false
+    @param onResponse called in this thread with each response in order, as
+    soon as that command is done
+    */
+   static void ExecBatch(const std::vector<wxString> &commands,
+      const std::vector<bool> &binary,
+      const ResponseCallback &onResponse);
+
+   //! Whether the command running now in the main thread may respond in
+   //! binary
+   static bool CanRespondInBinary();
+   //! Gives the response of the command running now in the main thread
+   /*!
+    @pre `CanRespondInBinary()`
+    */
+   static void RespondInBinary(BinaryResponse response);
 };
 
 // The void * return is actually a Lisp LVAL and will be cast to such as needed.
@@ -15,13 +15,14 @@ Vaughan Johnson (Preview)
 
 #include <wx/setup.h> // for wxUSE_* macros
 
-#include "Biquad.h"
+#include "BiquadCascade.h"
 
 #include "StatefulEffectUIServices.h"
 #include "StatefulPerTrackEffect.h"
 #include "ShuttleAutomation.h"
 #include "wxPanelWrapper.h"
 #include <float.h> // for FLT_MAX
+#include <optional>
 
 class wxBitmap;
 class wxChoice;
@@ -103,6 +104,8 @@ private:
    int mOrder;
    int mOrderIndex;
    ArrayOf<Biquad> mpBiquad;
+   //! Copies mpBiquad when processing starts
+   std::optional<BiquadCascade> mCascade;
 
    double mdBMax;
    double mdBMin;
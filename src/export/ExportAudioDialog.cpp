@@ -12,6 +12,8 @@
 
 #include "ExportAudioDialog.h"
 
+#include <algorithm>
+#include <chrono>
 #include <numeric>
 
 #include <wx/frame.h>
@@ -42,6 +44,7 @@
 #include "TagsEditor.h"
 #include "ExportFilePanel.h"
 #include "ExportProgressUI.h"
+#include "ExportScheduler.h"
 #include "ImportExport.h"
 #include "RealtimeEffectList.h"
 #include "WindowAccessible.h"
@@ -508,13 +511,14 @@ void ExportAudioDialog::OnExport(wxCommandEvent &event)
    if(mRangeSplit->GetValue())
    {
       FilePaths exportedFiles;
+      FilePaths skippedFiles;
 
       UpdateExportSettings();
 
       if(mSplitByLabels->GetValue())
-         result = DoExportSplitByLabels(*selectedPlugin, selectedFormat, *parameters, exportedFiles);
+         result = DoExportSplitByLabels(*selectedPlugin, selectedFormat, *parameters, exportedFiles, skippedFiles);
       else if(mSplitByTracks->GetValue())
-         result = DoExportSplitByTracks(*selectedPlugin, selectedFormat, *parameters, exportedFiles);
+         result = DoExportSplitByTracks(*selectedPlugin, selectedFormat, *parameters, exportedFiles, skippedFiles);
 
       auto msg = (result == ExportResult::Success
          ? XO("Successfully exported the following %lld file(s).")
@@ -530,6 +534,12 @@ void ExportAudioDialog::OnExport(wxCommandEvent &event)
       wxString fileList;
       for (auto& path : exportedFiles)
          fileList += path + '\n';
+      if (!skippedFiles.empty()) {
+         fileList += '\n' +
+            XO("The following file(s) were not exported:").Translation() + '\n';
+         for (auto& path : skippedFiles)
+            fileList += path + '\n';
+      }
 
       // TODO: give some warning dialog first, when only some files exported
       // successfully.
@@ -869,39 +879,83 @@ void ExportAudioDialog::UpdateTrackExportSettings(const ExportPlugin& plugin, in
    std::swap(mExportSettings, exportSettings);
 }
 
+namespace
+{
+//! Each scheduled export holds an open file and an encoder until it runs, so
+//! schedule only enough to keep all the threads busy
+size_t ExportBatchSize()
+{
+   return 4 * ExportScheduler::DefaultConcurrency();
+}
+
+//! Whether the export failed without an exception to explain why
+bool IsUnexplainedError(const std::shared_future<ExportResult>& result)
+{
+   if (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      return false;
+   try {
+      return result.get() == ExportResult::Error;
+   }
+   catch (...) {
+      return false;
+   }
+}
+}
+
+struct ExportAudioDialog::ScheduledExport
+{
+   wxString fullPath;
+   wxFileName backup;
+   std::shared_future<ExportResult> result;
+};
+
 ExportResult ExportAudioDialog::DoExportSplitByLabels(const ExportPlugin& plugin,
                                                       int formatIndex,
                                                       const ExportProcessor::Parameters& parameters,
-                                                      FilePaths& exporterFiles)
+                                                      FilePaths& exporterFiles,
+                                                      FilePaths& skippedFiles)
 {
    auto ok = ExportResult::Success;   // did it work?
+   ExportScheduler scheduler;
+   ScheduledExports exports;
    /* Go round again and do the exporting (so this run is slow but
     * non-interactive) */
-   for(auto& activeSetting : mExportSettings)
+   for (size_t ii = 0; ii < mExportSettings.size(); ++ii)
    {
       /* get the settings to use for the export from the array */
+      auto& activeSetting = mExportSettings[ii];
       // Bug 1440 fix.
       if( activeSetting.filename.GetName().empty() )
          continue;
 
-      // Export it
-      ok = DoExport(plugin, formatIndex, parameters, activeSetting.filename, activeSetting.channels,
-         activeSetting.t0, activeSetting.t1, false, activeSetting.tags, exporterFiles);
+      // Export it, with others at once
+      if (!ScheduleExport(scheduler, plugin, formatIndex, parameters, activeSetting.filename, activeSetting.channels,
+         activeSetting.t0, activeSetting.t1, false, activeSetting.tags, exports))
+      {
+         // Export what was scheduled, but no more
+         ok = ExportResult::Error;
+         GetFilesToExport(ii, skippedFiles);
+         break;
+      }
 
-      if (ok == ExportResult::Stopped) {
-         AudacityMessageDialog dlgMessage(
-            nullptr,
-            XO("Continue to export remaining files?"),
-            XO("Export"),
-            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
-         if (dlgMessage.ShowModal() != wxID_YES ) {
-            // User decided not to continue - bail out!
+      if (exports.size() >= ExportBatchSize()) {
+         FilePaths remaining;
+         GetFilesToExport(ii + 1, remaining);
+         ok = RunExports(scheduler, exports, !remaining.empty(),
+            exporterFiles, skippedFiles);
+         if (ok != ExportResult::Success) {
+            skippedFiles.insert(
+               skippedFiles.end(), remaining.begin(), remaining.end());
             break;
          }
       }
-      else if (ok != ExportResult::Success) {
-         break;
-      }
+   }
+
+   if (!exports.empty()) {
+      const auto result =
+         RunExports(scheduler, exports, false, exporterFiles, skippedFiles);
+      if (ok == ExportResult::Success)
+         ok = result;
    }
 
    return ok;
@@ -910,7 +964,8 @@ ExportResult ExportAudioDialog::DoExportSplitByLabels(const ExportPlugin& plugin
 ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin,
                                                       int formatIndex,
                                                       const ExportProcessor::Parameters& parameters,
-                                                      FilePaths& exporterFiles)
+                                                      FilePaths& exporterFiles,
+                                                      FilePaths& skippedFiles)
 {
    auto& tracks = TrackList::Get(mProject);
 
@@ -928,6 +983,8 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
       tr->SetSelected(false);
 
    auto ok = ExportResult::Success;
+   ExportScheduler scheduler;
+   ScheduledExports exports;
 
    int count = 0;
    for (auto tr : waveTracks) {
@@ -940,45 +997,67 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
          continue;
       }
 
-      /* Select the track */
-      SelectionStateChanger changer2{ selectionState, tracks };
-      tr->SetSelected(true);
-
-      // Export the data. "channels" are per track.
-      ok = DoExport(plugin, formatIndex, parameters, activeSetting.filename, activeSetting.channels,
-         activeSetting.t0, activeSetting.t1, true, activeSetting.tags, exporterFiles);
+      bool scheduled;
+      {
+         /* Select the track */
+         SelectionStateChanger changer2{ selectionState, tracks };
+         tr->SetSelected(true);
+
+         // Prepare to export the data. "channels" are per track.  The mixer
+         // of the export takes the selected track now.
+         scheduled = ScheduleExport(scheduler, plugin, formatIndex, parameters, activeSetting.filename, activeSetting.channels,
+            activeSetting.t0, activeSetting.t1, true, activeSetting.tags, exports);
+      }
+      if (!scheduled) {
+         // Export what was scheduled, but no more
+         ok = ExportResult::Error;
+         GetFilesToExport(count, skippedFiles);
+         break;
+      }
 
-      if (ok == ExportResult::Stopped) {
-         AudacityMessageDialog dlgMessage(
-            nullptr,
-            XO("Continue to export remaining files?"),
-            XO("Export"),
-            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
-         if (dlgMessage.ShowModal() != wxID_YES ) {
-            // User decided not to continue - bail out!
+      if (exports.size() >= ExportBatchSize()) {
+         FilePaths remaining;
+         GetFilesToExport(count + 1, remaining);
+         ok = RunExports(scheduler, exports, !remaining.empty(),
+            exporterFiles, skippedFiles);
+         if (ok != ExportResult::Success) {
+            skippedFiles.insert(
+               skippedFiles.end(), remaining.begin(), remaining.end());
             break;
          }
       }
-
-      else if (ok != ExportResult::Success) {
-         break;
-      }
       // increment export counter
       count++;
    }
 
+   if (!exports.empty()) {
+      const auto result =
+         RunExports(scheduler, exports, false, exporterFiles, skippedFiles);
+      if (ok == ExportResult::Success)
+         ok = result;
+   }
 
    return ok ;
 }
 
-ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
-                                         int formatIndex,
-                                         const ExportProcessor::Parameters& parameters,
-                                         const wxFileName& filename,
-                                         int channels,
-                                         double t0, double t1, bool selectedOnly,
-                                         const Tags& tags,
-                                         FilePaths& exportedFiles)
+void ExportAudioDialog::GetFilesToExport(size_t first, FilePaths& files) const
+{
+   for (size_t ii = first; ii < mExportSettings.size(); ++ii) {
+      const auto& filename = mExportSettings[ii].filename;
+      if (!filename.GetName().empty())
+         files.push_back(filename.GetFullPath());
+   }
+}
+
+bool ExportAudioDialog::ScheduleExport(ExportScheduler& scheduler,
+                                       const ExportPlugin& plugin,
+                                       int formatIndex,
+                                       const ExportProcessor::Parameters& parameters,
+                                       const wxFileName& filename,
+                                       int channels,
+                                       double t0, double t1, bool selectedOnly,
+                                       const Tags& tags,
+                                       ScheduledExports& exports)
 {
    wxFileName name;
 
@@ -1007,15 +1086,107 @@ ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
       name = filename;
       int i = 2;
       wxString base(name.GetName());
-      while (name.FileExists()) {
+      // Files of exports scheduled but not yet run don't exist yet
+      const auto scheduled = [&]{
+         return std::any_of(exports.begin(), exports.end(),
+            [&](const ScheduledExport& other)
+            { return other.fullPath == name.GetFullPath(); });
+      };
+      while (name.FileExists() || scheduled()) {
          name.SetName(wxString::Format(wxT("%s-%d"), base, i++));
       }
    }
 
-   bool success{false};
    const wxString fullPath{name.GetFullPath()};
 
-   auto cleanup = finally( [&] {
+   ExportTask task;
+   ExportProgressUI::ExceptionWrappedCall([&]
+   {
+      task = ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
+                                    .SetParameters(parameters)
+                                    .SetRange(t0, t1, selectedOnly)
+                                    .SetTags(&tags)
+                                    .SetNumChannels(channels)
+                                    .SetFileName(fullPath)
+                                    .SetSampleRate(mExportOptionsPanel->GetSampleRate())
+                                    .Build(mProject);
+   });
+   if (!task.valid()) {
+      // Failed, and the user was told why.  Restore the original, or remove
+      // any new file.
+      ::wxRemoveFile(fullPath);
+      if (backup.IsOk())
+         ::wxRenameFile(backup.GetFullPath(), fullPath);
+      return false;
+   }
+
+   exports.push_back({ fullPath, backup, scheduler.Add(std::move(task)) });
+   return true;
+}
+
+ExportResult ExportAudioDialog::RunExports(ExportScheduler& scheduler,
+                                           ScheduledExports& exports,
+                                           bool moreToSchedule,
+                                           FilePaths& exportedFiles,
+                                           FilePaths& skippedFiles)
+{
+   auto result = ExportResult::Error;
+   while (true) {
+      ExportProgressUI::ExceptionWrappedCall([&]
+      {
+         ExportProgressUI::Show(ExportTask(
+            [&](ExportProcessorDelegate& delegate)
+            {
+               result = scheduler.Process(delegate);
+               // The exception of each failed export is shown below.  Let
+               // Show() report an error only if some export has none.
+               const bool unexplained = std::any_of(
+                  exports.begin(), exports.end(),
+                  [](const ScheduledExport& scheduled)
+                  { return IsUnexplainedError(scheduled.result); });
+               return result == ExportResult::Error && !unexplained
+                  ? ExportResult::Success
+                  : result;
+            }));
+      });
+
+      // Stopping lets the running exports finish, but starts no more
+      if (result == ExportResult::Stopped &&
+          (scheduler.HasPending() || moreToSchedule)) {
+         AudacityMessageDialog dlgMessage(
+            nullptr,
+            XO("Continue to export remaining files?"),
+            XO("Export"),
+            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
+         if (dlgMessage.ShowModal() == wxID_YES ) {
+            if (scheduler.HasPending())
+               continue;
+            // The caller schedules more
+            result = ExportResult::Success;
+         }
+         // else user decided not to continue - bail out!
+      }
+      break;
+   }
+   // Close the files of exports that will not run
+   scheduler.DiscardPending();
+
+   for (auto& scheduled : exports) {
+      auto fileResult = ExportResult::Error;
+      ExportProgressUI::ExceptionWrappedCall([&]
+      {
+         try {
+            fileResult = scheduled.result.get();
+         }
+         catch (const std::future_error&) {
+            // The export did not run
+            fileResult = ExportResult::Cancelled;
+         }
+      });
+
+      const bool success = fileResult == ExportResult::Success || fileResult == ExportResult::Stopped;
+      const auto& fullPath = scheduled.fullPath;
+      const auto& backup = scheduled.backup;
       if (backup.IsOk()) {
          if ( success )
             // Remove backup
@@ -1031,25 +1202,13 @@ ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
             // Remove any new, and only partially written, file.
             ::wxRemoveFile(fullPath);
       }
-   } );
-
-   auto result = ExportResult::Error;
-   ExportProgressUI::ExceptionWrappedCall([&]
-   {
-      result = ExportProgressUI::Show(ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
-                                    .SetParameters(parameters)
-                                    .SetRange(t0, t1, selectedOnly)
-                                    .SetTags(&tags)
-                                    .SetNumChannels(channels)
-                                    .SetFileName(fullPath)
-                                    .SetSampleRate(mExportOptionsPanel->GetSampleRate())
-                                    .Build(mProject));
-   });
 
-   success = result == ExportResult::Success || result == ExportResult::Stopped;
-
-   if(success)
-      exportedFiles.push_back(fullPath);
+      if(success)
+         exportedFiles.push_back(fullPath);
+      else
+         skippedFiles.push_back(fullPath);
+   }
+   exports.clear();
 
    return result;
 }
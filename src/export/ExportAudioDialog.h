@@ -23,6 +23,7 @@ class ShuttleGui;
 
 class Exporter;
 class ExportPlugin;
+class ExportScheduler;
 class ExportTaskBuilder;
 
 class ExportOptionsHandler;
@@ -95,21 +96,47 @@ private:
    ExportResult DoExportSplitByLabels(const ExportPlugin& plugin,
                                       int formatIndex,
                                       const ExportProcessor::Parameters& parameters,
-                                      FilePaths& exporterFiles);
+                                      FilePaths& exporterFiles,
+                                      FilePaths& skippedFiles);
    
    ExportResult DoExportSplitByTracks(const ExportPlugin& plugin,
                                       int formatIndex,
                                       const ExportProcessor::Parameters& parameters,
-                                      FilePaths& exporterFiles);
+                                      FilePaths& exporterFiles,
+                                      FilePaths& skippedFiles);
+
+   //! Append the names of the files of the export settings from first on
+   void GetFilesToExport(size_t first, FilePaths& files) const;
    
-   ExportResult DoExport(const ExportPlugin& plugin,
-                         int formatIndex,
-                         const ExportProcessor::Parameters& parameters,
-                         const wxFileName& filename,
-                         int channels,
-                         double t0, double t1, bool selectedOnly,
-                         const Tags& tags,
-                         FilePaths& exportedFiles);
+   struct ScheduledExport;
+   using ScheduledExports = std::vector<ScheduledExport>;
+
+   //! Prepares the file, and adds the task of exporting to it
+   /*! @return false if the task could not be made; the user was told why */
+   bool ScheduleExport(ExportScheduler& scheduler,
+                       const ExportPlugin& plugin,
+                       int formatIndex,
+                       const ExportProcessor::Parameters& parameters,
+                       const wxFileName& filename,
+                       int channels,
+                       double t0, double t1, bool selectedOnly,
+                       const Tags& tags,
+                       ScheduledExports& exports);
+
+   //! Runs the scheduled exports concurrently, then keeps or removes each
+   //! file according to its result
+   /*!
+    If the user stops, and exports remain, whether pending or yet to be
+    scheduled, asks whether to continue.
+    @param moreToSchedule whether the caller has exports for later batches
+    @param skippedFiles receives the files that were not written
+    @return Success if the caller may schedule more
+    */
+   ExportResult RunExports(ExportScheduler& scheduler,
+                           ScheduledExports& exports,
+                           bool moreToSchedule,
+                           FilePaths& exportedFiles,
+                           FilePaths& skippedFiles);
    
    AudacityProject& mProject;
 
@@ -1,4 +1,3 @@
-#include "../Benchmark.h"
 #include "../CommonCommandFlags.h"
 #include "../MenuCreator.h"
 #include "../PluginRegistrationDialog.h"
@@ -200,14 +199,6 @@ void OnManageTools(const CommandContext &context )
    DoManagePluginsMenu(project, EffectTypeTool);
 }
 
-void OnBenchmark(const CommandContext &context)
-{
-   auto &project = context.project;
-   CommandManager::Get(project).RegisterLastTool(context);  //Register Run Benchmark as Last Tool
-   auto &window = GetProjectFrame( project );
-   ::RunBenchmark( &window, project);
-}
-
 void OnSimulateRecordingErrors(const CommandContext &context)
 {
    auto &project = context.project;
@@ -495,16 +486,7 @@ auto ToolsMenu()
       Section( "Other",
          Command( wxT("ConfigReset"), XXO("Reset &Configuration"),
             OnResetConfig,
-            AudioIONotBusyFlag() ),
-
-   // PRL: team consensus for 2.2.0 was, we let end users have this diagnostic,
-   // as they used to in 1.3.x
-   //#ifdef IS_ALPHA
-         // TODO: What should we do here?  Make benchmark a plug-in?
-         // Easy enough to do.  We'd call it mod-self-test.
-         Command( wxT("Benchmark"), XXO("&Run Benchmark..."),
-            OnBenchmark, AudioIONotBusyFlag() )
-   //#endif
+            AudioIONotBusyFlag() )
       ),
 
       Section( "Tools",
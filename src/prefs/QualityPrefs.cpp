@@ -27,6 +27,7 @@
 #include "Dither.h"
 #include "Prefs.h"
 #include "Resample.h"
+#include "SampleBlockCompression.h"
 #include "ShuttleGui.h"
 
 //////////
@@ -104,6 +105,13 @@ void QualityPrefs::PopulateOrExchange(ShuttleGui & S)
       S.EndMultiColumn();
    }
    S.EndStatic();
+
+   S.StartStatic(XO("Project Storage"));
+   {
+      S.TieCheckBox(XXO("&Compress audio in new projects (lossless)"),
+                    CompressSampleBlocks);
+   }
+   S.EndStatic();
    S.EndScroller();
 
 }
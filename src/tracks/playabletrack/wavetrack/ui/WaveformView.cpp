@@ -29,6 +29,7 @@ Paul Licameli split from WaveChannelView.cpp
 #include "SyncLock.h"
 #include "../../../../TrackArt.h"
 #include "../../../../TrackArtist.h"
+#include "../../../../TrackPanel.h"
 #include "../../../../TrackPanelDrawingContext.h"
 #include "../../../../TrackPanelMouseEvent.h"
 #include "ViewInfo.h"
@@ -45,6 +46,7 @@ Paul Licameli split from WaveChannelView.cpp
 #include <wx/dc.h>
 
 #include <wx/dcmemory.h>
+#include <wx/weakref.h>
 #include "waveform/WaveBitmapCache.h"
 #include "waveform/WaveDataCache.h"
 #include "waveform/WavePaintParameters.h"
@@ -233,16 +235,28 @@ public:
 
       mChannelCaches.reserve(nChannels);
 
+      const auto inBackground = WaveformCacheInBackground.Read();
+
       for (auto channelIndex = 0; channelIndex < nChannels; ++channelIndex)
       {
-         auto dataCache = std::make_shared<WaveDataCache>(clip, channelIndex);
+         auto dataCache = std::make_shared<WaveDataCache>(
+            clip, channelIndex, inBackground);
 
          auto bitmapCache = std::make_unique<WaveBitmapCache>(
             clip, dataCache,
             [] { return std::make_unique<WaveBitmapCacheElementWX>(); });
 
+         // Draw again when data computed in the background are ready
+         auto subscription = dataCache->Subscribe(
+            [this](const WaveDataCacheReady&)
+            {
+               if (auto window = mWindow.get())
+                  window->Refresh(false);
+            });
+
          mChannelCaches.push_back(
-            { std::move(dataCache), std::move(bitmapCache) });
+            { std::move(dataCache), std::move(bitmapCache),
+              std::move(subscription) });
       }
 
       return *this;
@@ -255,10 +269,12 @@ public:
    }
 
    void Draw(
-      int channelIndex, wxDC& dc, const WavePaintParameters& params,
-      const ZoomInfo& zoomInfo, const wxRect& targetRect, int leftOffset,
-      double from, double to)
+      wxWindow* window, int channelIndex, wxDC& dc,
+      const WavePaintParameters& params, const ZoomInfo& zoomInfo,
+      const wxRect& targetRect, int leftOffset, double from, double to)
    {
+      mWindow = window;
+
       auto& channelCache = mChannelCaches[channelIndex];
 
       channelCache.BitmapCache->SetPaintParameters(params);
@@ -270,6 +286,9 @@ public:
 
       const auto top = targetRect.y;
 
+      auto sw = FrameStatistics::CreateStopwatch(
+         FrameStatistics::SectionID::WaveBitmapDraw);
+
       wxMemoryDC memdc;
       for (auto it = range.begin(); it != range.end(); ++it)
       {
@@ -279,11 +298,19 @@ public:
          const auto width = WaveBitmapCache::CacheElementWidth -
                             elementLeftOffset - elementRightOffset;
 
-         auto& bitmap = static_cast<WaveBitmapCacheElementWX&>(*it).GetBitmap();
-         memdc.SelectObject(bitmap);
-         dc.Blit(
-            wxPoint(left, targetRect.y), wxSize(width, it->Height()), &memdc,
-            wxPoint(elementLeftOffset, 0));
+         // Columns not yet computed in the background are left blank
+         if (it->AvailableColumns > elementLeftOffset)
+         {
+            const auto drawnWidth =
+               std::min(width, it->AvailableColumns - elementLeftOffset);
+
+            auto& bitmap =
+               static_cast<WaveBitmapCacheElementWX&>(*it).GetBitmap();
+            memdc.SelectObject(bitmap);
+            dc.Blit(
+               wxPoint(left, targetRect.y), wxSize(drawnWidth, it->Height()),
+               &memdc, wxPoint(elementLeftOffset, 0));
+         }
 
          left += width;
       }
@@ -319,11 +346,14 @@ public:
 
 private:
    const WaveClip* mWaveClip {};
+   //! Where the clip was last drawn
+   wxWeakRef<wxWindow> mWindow;
 
    struct ChannelCaches final
    {
       std::shared_ptr<WaveDataCache> DataCache;
       std::unique_ptr<WaveBitmapCache> BitmapCache;
+      Observer::Subscription DataReadySubscription;
    };
 
    std::vector<ChannelCaches> mChannelCaches;
@@ -376,8 +406,8 @@ void DrawWaveform(
       SyncLock::IsSelectedOrSyncLockSelected(track));
 
    clipPainter.Draw(
-      channelIndex, context.dc, paintParameters, zoomInfo, rect, leftOffset,
-      t0 + trimLeft, t1 + trimLeft);
+      artist->parent, channelIndex, context.dc, paintParameters, zoomInfo,
+      rect, leftOffset, t0 + trimLeft, t1 + trimLeft);
 }
 
 
@@ -0,0 +1,110 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BenchmarkProject.cpp
+
+**********************************************************************/
+#include "BenchmarkProject.h"
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "TempDirectory.h"
+#include "Track.h"
+#include "WaveTrack.h"
+
+namespace Benchmarks
+{
+namespace
+{
+//! Keeps the project databases of the benchmarks apart from those of any
+//! running instance, and removes them at exit
+struct Session final
+{
+   Session()
+   {
+      wxFileName dir { wxFileName::GetTempDir(), wxEmptyString };
+      dir.AppendDir(wxString::Format("audacity-benchmarks-%lu",
+         static_cast<unsigned long>(wxGetProcessId())));
+      path = dir.GetPath();
+      Check(
+         wxFileName::Mkdir(path, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL),
+         "Could not make the temporary directory");
+      TempDirectory::SetSessionTempDir(path);
+      Check(ProjectFileIO::InitializeSQL(), "Could not initialize SQLite");
+   }
+
+   ~Session()
+   {
+      wxFileName::Rmdir(path, wxPATH_RMDIR_RECURSIVE);
+   }
+
+   wxString path;
+};
+
+void StartSession()
+{
+   static Session session;
+}
+} // namespace
+
+std::vector<float> MakeSignal(size_t length, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::normal_distribution<double> noise { 0.0, 0.01 };
+   constexpr auto pi = 3.14159265358979323846;
+   std::vector<float> result(length);
+   for (size_t ii = 0; ii < length; ++ii)
+   {
+      const auto t = ii / 44100.0;
+      const auto x = 0.3 * std::sin(2 * pi * 220 * t) +
+                     0.2 * std::sin(2 * pi * 1375 * t + seed) + noise(engine);
+      result[ii] = std::lround(std::clamp(x, -1.0, 1.0) * 32767) / 32768.0f;
+   }
+   return result;
+}
+
+BenchmarkProject::BenchmarkProject(bool openDatabase)
+{
+   StartSession();
+   mpProject = AudacityProject::Create();
+   if (openDatabase)
+      Check(ProjectFileIO::Get(*mpProject).OpenProject(),
+         "Could not open the project database");
+}
+
+BenchmarkProject::~BenchmarkProject()
+{
+   // As when closing a window:  destroy the sample blocks while the database
+   // is still open, without deleting the rows of a saved project
+   auto& projectFileIO = ProjectFileIO::Get(*mpProject);
+   projectFileIO.SetBypass();
+   TrackList::Get(*mpProject).Clear();
+   projectFileIO.CloseProject();
+}
+
+WaveTrack&
+BenchmarkProject::AddTrack(size_t nChannels, size_t length, unsigned seed)
+{
+   auto track = WaveTrackFactory::Get(*mpProject)
+      .Create(nChannels, floatSample, 44100);
+   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+   {
+      const auto signal = MakeSignal(length, seed + iChannel);
+      track->Append(iChannel,
+         reinterpret_cast<constSamplePtr>(signal.data()), floatSample, length,
+         1, int16Sample);
+   }
+   track->Flush();
+   return *TrackList::Get(*mpProject).Add(track);
+}
+} // namespace Benchmarks
@@ -0,0 +1,48 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BenchmarkProject.h
+
+  @brief A project without windows, for benchmarks of its tracks and
+  database
+
+**********************************************************************/
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "SampleFormat.h"
+
+class AudacityProject;
+class WaveTrack;
+
+namespace Benchmarks
+{
+//! A few tones and some noise, quantized as if imported from a 16 bit file
+std::vector<float> MakeSignal(size_t length, unsigned seed);
+
+//! A project with an open, temporary database, in a directory that the
+//! benchmarks remove when they exit
+class BenchmarkProject final
+{
+public:
+   //! @param openDatabase false to leave the project without a database,
+   //! for loading of a saved project
+   explicit BenchmarkProject(bool openDatabase = true);
+   ~BenchmarkProject();
+   BenchmarkProject(const BenchmarkProject&) = delete;
+   BenchmarkProject& operator=(const BenchmarkProject&) = delete;
+
+   AudacityProject& Get() { return *mpProject; }
+
+   //! Add a track to the project, with length samples of MakeSignal()
+   //! in each channel
+   WaveTrack& AddTrack(size_t nChannels, size_t length, unsigned seed);
+
+private:
+   std::shared_ptr<AudacityProject> mpProject;
+};
+} // namespace Benchmarks
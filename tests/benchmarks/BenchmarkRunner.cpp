@@ -0,0 +1,252 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BenchmarkRunner.cpp
+
+**********************************************************************/
+#include "BenchmarkRunner.h"
+
+#include "MockedPrefs.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace Benchmarks
+{
+namespace
+{
+using Groups = std::vector<std::pair<std::string, Registration::Function>>;
+
+Groups& GetGroups()
+{
+   static Groups groups;
+   return groups;
+}
+
+//! Repeat until the timed calls take this long in all
+constexpr double MinimumSeconds = 0.5;
+constexpr size_t MinimumRepetitions = 3;
+constexpr size_t MaximumRepetitions = 100;
+
+double Median(std::vector<double> values)
+{
+   std::sort(values.begin(), values.end());
+   const auto size = values.size();
+   return size % 2 ? values[size / 2] :
+                     (values[size / 2 - 1] + values[size / 2]) / 2;
+}
+
+std::string Quoted(const std::string& str)
+{
+   std::string result { '"' };
+   for (const auto c : str)
+   {
+      if (c == '"' || c == '\\')
+         (result += '\\') += c;
+      else if (static_cast<unsigned char>(c) < 0x20)
+      {
+         char escape[8];
+         snprintf(escape, sizeof(escape), "\\u%04x", c);
+         result += escape;
+      }
+      else
+         result += c;
+   }
+   return result += '"';
+}
+
+std::string Timestamp()
+{
+   const auto now = std::time(nullptr);
+   char buffer[32] {};
+   std::strftime(
+      buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+   return buffer;
+}
+
+void WriteJson(std::ostream& out, const Runner& runner)
+{
+   out << std::setprecision(9);
+   out << "{\n";
+   out << "  \"version\": "
+       << Quoted(
+             std::to_string(AUDACITY_VERSION) + "." +
+             std::to_string(AUDACITY_RELEASE) + "." +
+             std::to_string(AUDACITY_REVISION))
+       << ",\n";
+   out << "  \"timestamp\": " << Quoted(Timestamp()) << ",\n";
+   out << "  \"hardware_threads\": " << std::thread::hardware_concurrency()
+       << ",\n";
+   out << "  \"quick\": " << (runner.IsQuick() ? "true" : "false") << ",\n";
+   out << "  \"results\": [";
+   const char* separator = "\n";
+   for (const auto& result : runner.GetResults())
+   {
+      const auto median = Median(result.seconds);
+      const auto least =
+         *std::min_element(result.seconds.begin(), result.seconds.end());
+      out << separator << "    {\n";
+      out << "      \"name\": " << Quoted(result.name) << ",\n";
+      out << "      \"parameters\": " << Quoted(result.parameters) << ",\n";
+      out << "      \"unit\": " << Quoted(result.unit) << ",\n";
+      out << "      \"items\": " << result.items << ",\n";
+      out << "      \"repetitions\": " << result.seconds.size() << ",\n";
+      out << "      \"median_seconds\": " << median << ",\n";
+      out << "      \"min_seconds\": " << least << ",\n";
+      out << "      \"items_per_second\": "
+          << (median > 0 ? result.items / median : 0) << "\n";
+      out << "    }";
+      separator = ",\n";
+   }
+   out << "\n  ]\n}\n";
+}
+
+void Usage(const char* program)
+{
+   std::cerr
+      << "Usage: " << program
+      << " [--json FILE] [--filter TEXT] [--quick] [--list]\n"
+         "  --json FILE    also write the results to FILE as JSON\n"
+         "  --filter TEXT  run only the groups with TEXT in their names\n"
+         "  --quick        run each benchmark once on small data\n"
+         "  --list         print the names of the groups and exit\n";
+}
+} // namespace
+
+Runner::Runner(bool quick)
+    : mQuick { quick }
+{
+}
+
+void Runner::Measure(
+   const std::string& name, const std::string& parameters, double items,
+   const std::string& unit, const Body& body, const Setup& setup)
+{
+   using namespace std::chrono;
+   Result result { name, parameters, items, unit, {} };
+
+   const auto call = [&] {
+      if (setup)
+         setup();
+      const auto start = steady_clock::now();
+      body();
+      return duration<double>(steady_clock::now() - start).count();
+   };
+
+   if (!mQuick)
+      // Warm up caches and allocators
+      call();
+   double total = 0;
+   do
+   {
+      result.seconds.push_back(call());
+      total += result.seconds.back();
+   } while (!mQuick && result.seconds.size() < MaximumRepetitions &&
+            (total < MinimumSeconds ||
+             result.seconds.size() < MinimumRepetitions));
+
+   const auto median = Median(result.seconds);
+   std::cout << std::left << std::setw(28) << name << std::setw(32)
+             << parameters << std::right << std::fixed << std::setprecision(3)
+             << std::setw(12) << median * 1000 << " ms" << std::setw(16)
+             << std::setprecision(0) << (median > 0 ? items / median : 0)
+             << ' ' << unit << "/s" << std::endl;
+   std::cout.unsetf(std::ios::fixed);
+
+   mResults.push_back(std::move(result));
+}
+
+void Check(bool condition, const char* what)
+{
+   if (!condition)
+      throw std::runtime_error(what);
+}
+
+Registration::Registration(std::string group, Function function)
+{
+   GetGroups().emplace_back(std::move(group), std::move(function));
+}
+} // namespace Benchmarks
+
+int main(int argc, char* argv[])
+{
+   using namespace Benchmarks;
+
+   std::string jsonPath, filter;
+   bool quick = false, list = false;
+   for (int ii = 1; ii < argc; ++ii)
+   {
+      const std::string arg = argv[ii];
+      if (arg == "--json" && ii + 1 < argc)
+         jsonPath = argv[++ii];
+      else if (arg == "--filter" && ii + 1 < argc)
+         filter = argv[++ii];
+      else if (arg == "--quick")
+         quick = true;
+      else if (arg == "--list")
+         list = true;
+      else
+      {
+         Usage(argv[0]);
+         return 2;
+      }
+   }
+
+   // Static initialization registers the groups in unspecified order
+   auto& groups = GetGroups();
+   std::stable_sort(groups.begin(), groups.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+   if (list)
+   {
+      for (const auto& group : groups)
+         std::cout << group.first << '\n';
+      return 0;
+   }
+
+   MockedPrefs prefs;
+   Runner runner { quick };
+   bool failed = false;
+   for (const auto& [name, function] : groups)
+   {
+      if (name.find(filter) == std::string::npos)
+         continue;
+      try
+      {
+         function(runner);
+      }
+      catch (const std::exception& e)
+      {
+         std::cerr << name << " failed: " << e.what() << std::endl;
+         failed = true;
+      }
+      catch (...)
+      {
+         std::cerr << name << " failed" << std::endl;
+         failed = true;
+      }
+   }
+
+   if (!jsonPath.empty())
+   {
+      std::ofstream out { jsonPath };
+      WriteJson(out, runner);
+      if (!out)
+      {
+         std::cerr << "Could not write " << jsonPath << std::endl;
+         return 1;
+      }
+   }
+
+   return failed ? 1 : 0;
+}
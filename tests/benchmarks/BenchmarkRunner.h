@@ -0,0 +1,71 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BenchmarkRunner.h
+
+  @brief Times registered benchmarks and reports them as text and JSON
+
+**********************************************************************/
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Benchmarks
+{
+//! Times the bodies given to Measure() and accumulates the results
+class Runner final
+{
+public:
+   //! Work done before each timed call, not itself timed
+   using Setup = std::function<void()>;
+   using Body = std::function<void()>;
+
+   struct Result
+   {
+      std::string name;
+      //! Free text describing the sizes and options, such as "tracks=8"
+      std::string parameters;
+      //! Units of work in one call of the body, and their name
+      double items;
+      std::string unit;
+      //! Durations of the timed calls, in seconds, in order
+      std::vector<double> seconds;
+   };
+
+   //! @param quick whether to time each benchmark once, without warming up,
+   //! to check only that it runs
+   explicit Runner(bool quick);
+
+   //! Benchmarks should use smaller data when this is true
+   bool IsQuick() const { return mQuick; }
+
+   //! Time repeated calls of body, calling setup before each of them
+   /*!
+    Exceptions propagate, failing the benchmark
+    */
+   void Measure(
+      const std::string& name, const std::string& parameters, double items,
+      const std::string& unit, const Body& body, const Setup& setup = {});
+
+   const std::vector<Result>& GetResults() const { return mResults; }
+
+private:
+   const bool mQuick;
+   std::vector<Result> mResults;
+};
+
+//! Throws if the condition is false, so that a benchmark does not report
+//! the speed of wrong results
+void Check(bool condition, const char* what);
+
+//! Declare a static object of this type to add a group of benchmarks
+struct Registration final
+{
+   using Function = std::function<void(Runner&)>;
+   Registration(std::string group, Function function);
+};
+} // namespace Benchmarks
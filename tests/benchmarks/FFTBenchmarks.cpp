@@ -0,0 +1,99 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  FFTBenchmarks.cpp
+
+  @brief Real FFTs alone, and in the steps by which the spectrogram cache
+  computes its columns
+
+**********************************************************************/
+#include "BenchmarkProject.h"
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "FFT.h"
+#include "RealFFTf.h"
+
+namespace Benchmarks
+{
+namespace
+{
+//! Window, transform, and convert to decibels, as SpecCache::Populate does
+//! for one column of pixels in each frame
+void Spectrogram(
+   const std::vector<float>& signal, size_t hop, const FFTParam* hFFT,
+   const std::vector<float>& window, std::vector<float>& buffer,
+   std::vector<float>& out)
+{
+   const size_t fftLen = hFFT->Points * 2;
+   const size_t nColumns = (signal.size() - fftLen) / hop + 1;
+   for (size_t column = 0; column < nColumns; ++column)
+   {
+      const auto start = signal.data() + column * hop;
+      std::transform(start, start + fftLen, window.begin(), buffer.begin(),
+         std::multiplies<float> {});
+      RealFFTf(buffer.data(), hFFT);
+      float* const results = &out[column * hFFT->Points];
+      results[0] = 10 * log10f(std::max(buffer[0] * buffer[0], 1e-16f));
+      for (size_t jj = 1; jj < hFFT->Points; ++jj)
+      {
+         const auto index = hFFT->BitReversed[jj];
+         const auto re = buffer[index], im = buffer[index + 1];
+         results[jj] = 10 * log10f(std::max(re * re + im * im, 1e-16f));
+      }
+   }
+}
+
+void Run(Runner& runner)
+{
+   const size_t length = (runner.IsQuick() ? 1 : 30) * 44100;
+   const auto signal = MakeSignal(length, 4);
+   const auto wasVectorized = IsFFTVectorized();
+
+   for (const bool vectorized : { false, true })
+   {
+      SetFFTVectorized(vectorized);
+      if (vectorized && !IsFFTVectorized())
+         // Not in this build or on this processor
+         break;
+      for (const size_t fftLen : { 256, 1024, 4096 })
+      {
+         const auto hFFT = GetFFT(fftLen);
+         const auto parameters = "size=" + std::to_string(fftLen) +
+                                 " simd=" + (vectorized ? "1" : "0");
+
+         constexpr size_t nTransforms = 1000;
+         std::vector<float> buffer(fftLen);
+         runner.Measure(
+            "RealFFTf", parameters, nTransforms, "transforms", [&] {
+               for (size_t ii = 0; ii < nTransforms; ++ii)
+               {
+                  std::copy_n(signal.begin(), fftLen, buffer.begin());
+                  RealFFTf(buffer.data(), hFFT.get());
+               }
+            });
+
+         // Overlap the windows by three quarters, as the default settings do
+         const size_t hop = fftLen / 4;
+         const size_t nColumns = (length - fftLen) / hop + 1;
+         std::vector<float> window(fftLen);
+         NewWindowFunc(eWinFuncHann, fftLen, false, window.data());
+         std::vector<float> out(nColumns * hFFT->Points);
+         runner.Measure(
+            "Spectrogram columns", parameters + " hop=" + std::to_string(hop),
+            nColumns, "columns", [&] {
+               Spectrogram(signal, hop, hFFT.get(), window, buffer, out);
+            });
+      }
+   }
+   SetFFTVectorized(wasVectorized);
+}
+
+Registration registration { "FFT", Run };
+} // namespace
+} // namespace Benchmarks
@@ -0,0 +1,82 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LoudnessBenchmarks.cpp
+
+  @brief EBU R 128 integrated loudness, as the Loudness Normalization
+  effect measures it
+
+**********************************************************************/
+#include "BenchmarkProject.h"
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "EBUR128.h"
+
+namespace Benchmarks
+{
+namespace
+{
+void Run(Runner& runner)
+{
+   const size_t length = (runner.IsQuick() ? 1 : 60) * 44100;
+   const std::vector<std::vector<float>> channels {
+      MakeSignal(length, 6), MakeSignal(length, 7)
+   };
+
+   for (const size_t nChannels : { 1, 2 })
+   {
+      const auto parameters =
+         "channels=" + std::to_string(nChannels) + " rate=44100";
+      double bySample = 0;
+      runner.Measure(
+         "EBUR128", parameters, length * nChannels, "samples", [&] {
+            EBUR128 analyser { 44100, nChannels };
+            for (size_t ii = 0; ii < length; ++ii)
+            {
+               for (size_t channel = 0; channel < nChannels; ++channel)
+                  analyser.ProcessSampleFromChannel(
+                     channels[channel][ii], channel);
+               analyser.NextSample();
+            }
+            bySample = analyser.IntegrativeLoudnessToLUFS(
+               analyser.IntegrativeLoudness());
+         });
+      Check(std::isfinite(bySample) && bySample < 0, "Unexpected loudness");
+
+      // In buffers of the size that the Loudness effect reads
+      constexpr size_t bufferSize = 1 << 16;
+      const float* pointers[2] {};
+      for (const bool truePeak : { false, true })
+      {
+         double byBlock = 0;
+         runner.Measure(
+            "EBUR128 block",
+            parameters + " truepeak=" + (truePeak ? "1" : "0"),
+            length * nChannels, "samples", [&] {
+               EBUR128 analyser { 44100, nChannels };
+               if (truePeak)
+                  analyser.EnableTruePeak();
+               for (size_t start = 0; start < length; start += bufferSize)
+               {
+                  for (size_t channel = 0; channel < nChannels; ++channel)
+                     pointers[channel] = channels[channel].data() + start;
+                  analyser.ProcessBlock(pointers, nChannels,
+                     std::min(bufferSize, length - start));
+               }
+               byBlock = analyser.IntegrativeLoudnessToLUFS(
+                  analyser.IntegrativeLoudness());
+            });
+         Check(std::abs(byBlock - bySample) < 1e-9,
+            "Block loudness differs from loudness by sample");
+      }
+   }
+}
+
+Registration registration { "EBUR128", Run };
+} // namespace
+} // namespace Benchmarks
@@ -0,0 +1,58 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MixerBenchmarks.cpp
+
+  @brief Mixing down tracks, as export and Mix and Render do
+
+**********************************************************************/
+#include "BenchmarkProject.h"
+#include "BenchmarkRunner.h"
+
+#include "Mix.h"
+#include "StretchingSequence.h"
+#include "Track.h"
+#include "WaveTrack.h"
+
+namespace Benchmarks
+{
+namespace
+{
+void Run(Runner& runner)
+{
+   const size_t length = (runner.IsQuick() ? 1 : 10) * 44100;
+   const double duration = length / 44100.0;
+   constexpr size_t blockSize = 4096;
+
+   for (const size_t nTracks : { 1, 8, 32 })
+   {
+      BenchmarkProject project;
+      auto& tracks = TrackList::Get(project.Get());
+      for (size_t ii = 0; ii < nTracks; ++ii)
+         project.AddTrack(2, length, static_cast<unsigned>(ii));
+
+      runner.Measure(
+         "Mixer process", "tracks=" + std::to_string(nTracks) + " stereo",
+         nTracks * length, "track samples", [&] {
+            Mixer::Inputs inputs;
+            for (const auto track : tracks.Any<const WaveTrack>())
+               inputs.emplace_back(StretchingSequence::Create(
+                  *track, track->GetClipInterfaces()));
+            Mixer mixer { std::move(inputs), std::nullopt, true,
+                          Mixer::WarpOptions { 1.0, 1.0 }, 0.0, duration, 2,
+                          blockSize, false, 44100, floatSample };
+            size_t total = 0;
+            while (const auto processed = mixer.Process())
+               total += processed;
+            // Allow for rounding of the stop time
+            Check(total + 1 >= length && total <= length + 1,
+               "Mixed the wrong length");
+         });
+   }
+}
+
+Registration registration { "Mixer", Run };
+} // namespace
+} // namespace Benchmarks
@@ -0,0 +1,91 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectBenchmarks.cpp
+
+  @brief Autosave, first save, and load of a project
+
+**********************************************************************/
+#include "BenchmarkProject.h"
+#include "BenchmarkRunner.h"
+
+#include <optional>
+
+#include <wx/filename.h>
+
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "TempDirectory.h"
+#include "Track.h"
+
+namespace Benchmarks
+{
+namespace
+{
+void Run(Runner& runner)
+{
+   const size_t nTracks = runner.IsQuick() ? 2 : 16;
+   const size_t length = (runner.IsQuick() ? 1 : 30) * 44100;
+   const auto parameters = "tracks=" + std::to_string(nTracks) +
+                           " stereo seconds=" + std::to_string(length / 44100);
+   const double items = nTracks * 2 * length;
+
+   std::optional<BenchmarkProject> project;
+   const auto makeProject = [&] {
+      project.reset();
+      project.emplace();
+      for (size_t ii = 0; ii < nTracks; ++ii)
+         project->AddTrack(2, length, static_cast<unsigned>(ii));
+   };
+
+   makeProject();
+   runner.Measure("Project autosave", parameters, items, "samples", [&] {
+      Check(ProjectFileIO::Get(project->Get()).AutoSave(), "Autosave failed");
+   });
+
+   // Save outside the temporary directory, or the project stays temporary
+   wxFileName file { TempDirectory::TempDir(), wxT("benchmark.aup3") };
+   file.AppendDir(wxT("saved"));
+   Check(
+      file.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL),
+      "Could not make the directory for saving");
+   const auto path = file.GetFullPath();
+
+   // A new project, which has autosaved after each edit, saves by renaming
+   // its database and writing the project document
+   runner.Measure(
+      "Project save", parameters, items, "samples",
+      [&] {
+         Check(
+            ProjectFileIO::Get(project->Get()).SaveProject(path, nullptr),
+            "Save failed");
+      },
+      [&] {
+         makeProject();
+         ProjectFileIO::Get(project->Get()).AutoSave();
+         ProjectFileIO::RemoveProject(path);
+      });
+   project.reset();
+
+   runner.Measure(
+      "Project load", parameters, items, "samples",
+      [&] {
+         auto& projectFileIO = ProjectFileIO::Get(project->Get());
+         auto connection = projectFileIO.LoadProject(path, true);
+         Check(connection.has_value(), "Load failed");
+         connection->Commit();
+      },
+      [&] {
+         project.reset();
+         project.emplace(false);
+      });
+   Check(TrackList::Get(project->Get()).Size() == nTracks,
+      "Loaded the wrong tracks");
+   project.reset();
+}
+
+Registration registration { "Project", Run };
+} // namespace
+} // namespace Benchmarks
@@ -0,0 +1,59 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ResampleBenchmarks.cpp
+
+  @brief Sample rate conversion with the fast and the best methods
+
+**********************************************************************/
+#include "BenchmarkProject.h"
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+
+#include "Resample.h"
+
+namespace Benchmarks
+{
+namespace
+{
+void Run(Runner& runner)
+{
+   const size_t length = (runner.IsQuick() ? 1 : 30) * 44100;
+   const auto signal = MakeSignal(length, 5);
+   constexpr size_t chunk = 65536;
+
+   for (const bool best : { false, true })
+      for (const double toRate : { 48000.0, 22050.0 })
+      {
+         const auto factor = toRate / 44100;
+         std::vector<float> out(chunk * 3);
+         runner.Measure(
+            "Resample",
+            std::string { "method=" } + (best ? "best" : "fast") +
+               " from=44100 to=" + std::to_string(static_cast<int>(toRate)),
+            length, "samples", [&] {
+               Resample resample { best, factor, factor };
+               size_t used = 0, made = 0;
+               while (true)
+               {
+                  const auto len = std::min(chunk, length - used);
+                  const bool last = used + len == length;
+                  const auto [inUsed, outMade] = resample.Process(
+                     factor, signal.data() + used, len, last, out.data(),
+                     out.size());
+                  used += inUsed;
+                  made += outMade;
+                  if (last && inUsed == len && outMade == 0)
+                     break;
+               }
+               Check(made + 64 >= length * factor, "Resampled too little");
+            });
+      }
+}
+
+Registration registration { "Resample", Run };
+} // namespace
+} // namespace Benchmarks
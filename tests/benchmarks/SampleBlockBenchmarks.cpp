@@ -0,0 +1,74 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleBlockBenchmarks.cpp
+
+  @brief Committing sample blocks to the project database and reading them
+  back
+
+**********************************************************************/
+#include "BenchmarkProject.h"
+#include "BenchmarkRunner.h"
+
+#include "SampleBlock.h"
+#include "SampleBlockCache.h"
+#include "SampleBlockCompression.h"
+#include "Sequence.h"
+#include "WaveTrack.h"
+
+namespace Benchmarks
+{
+namespace
+{
+void Run(Runner& runner)
+{
+   const size_t nBlocks = runner.IsQuick() ? 4 : 64;
+   const size_t blockLength = Sequence::GetMaxDiskBlockSize() / sizeof(float);
+   const auto signal = MakeSignal(blockLength, 2);
+   const auto samples = reinterpret_cast<constSamplePtr>(signal.data());
+
+   for (const bool compressed : { false, true })
+   {
+      BenchmarkProject project;
+      SampleBlockCompression::Get(project.Get()).SetEnabled(compressed);
+      // Time the reads from the database, not from memory
+      SampleBlockCache::Get(project.Get()).SetBudget(0);
+      const auto& factory =
+         WaveTrackFactory::Get(project.Get()).GetSampleBlockFactory();
+      const auto parameters = "blocks=" + std::to_string(nBlocks) +
+                              " samples=" + std::to_string(blockLength) +
+                              " compressed=" + (compressed ? "1" : "0");
+
+      std::vector<SampleBlockPtr> blocks;
+      runner.Measure(
+         "SampleBlock commit", parameters, nBlocks * blockLength, "samples",
+         [&] {
+            for (size_t ii = 0; ii < nBlocks; ++ii)
+               blocks.push_back(
+                  factory->Create(samples, blockLength, floatSample));
+            // Demanding the ids inserts the pending blocks
+            for (const auto& block : blocks)
+               block->GetBlockID();
+         },
+         [&] { blocks.clear(); });
+
+      // Committed blocks do not keep their samples, and the cache is off
+      std::vector<float> buffer(blockLength);
+      runner.Measure(
+         "SampleBlock read", parameters, nBlocks * blockLength, "samples",
+         [&] {
+            for (const auto& block : blocks)
+               block->GetSamples(
+                  reinterpret_cast<samplePtr>(buffer.data()), floatSample, 0,
+                  blockLength);
+         });
+      Check(buffer == signal, "Read wrong samples");
+      blocks.clear();
+   }
+}
+
+Registration registration { "SampleBlock", Run };
+} // namespace
+} // namespace Benchmarks
@@ -0,0 +1,97 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SequenceBenchmarks.cpp
+
+  @brief Appending to, reading and editing a Sequence backed by the
+  project database
+
+**********************************************************************/
+#include "BenchmarkProject.h"
+#include "BenchmarkRunner.h"
+
+#include <random>
+
+#include "Sequence.h"
+#include "WaveTrack.h"
+
+namespace Benchmarks
+{
+namespace
+{
+std::unique_ptr<Sequence> MakeSequence(const SampleBlockFactoryPtr& factory)
+{
+   return std::make_unique<Sequence>(
+      factory, SampleFormats { int16Sample, floatSample });
+}
+
+void Append(Sequence& sequence, const std::vector<float>& signal)
+{
+   const auto chunk = sequence.GetIdealAppendLen();
+   for (size_t start = 0; start < signal.size(); start += chunk)
+      sequence.Append(
+         reinterpret_cast<constSamplePtr>(signal.data() + start), floatSample,
+         std::min(chunk, signal.size() - start), 1, int16Sample);
+   sequence.Flush();
+}
+
+void Run(Runner& runner)
+{
+   BenchmarkProject project;
+   const auto& factory =
+      WaveTrackFactory::Get(project.Get()).GetSampleBlockFactory();
+   const size_t length = (runner.IsQuick() ? 5 : 60) * 44100;
+   const auto signal = MakeSignal(length, 1);
+   const auto parameters = "seconds=" + std::to_string(length / 44100) +
+                           " block_bytes=" +
+                           std::to_string(Sequence::GetMaxDiskBlockSize());
+
+   std::unique_ptr<Sequence> sequence;
+   runner.Measure(
+      "Sequence append", parameters, length, "samples",
+      [&] { Append(*sequence, signal); },
+      [&] { sequence = MakeSequence(factory); });
+   Check(sequence->GetNumSamples() == length, "Wrong length after appends");
+
+   std::vector<float> buffer(65536);
+   runner.Measure("Sequence read", parameters, length, "samples", [&] {
+      for (size_t start = 0; start < length; start += buffer.size())
+      {
+         const auto len = std::min(buffer.size(), length - start);
+         Check(
+            sequence->Get(
+               reinterpret_cast<samplePtr>(buffer.data()), floatSample, start,
+               len, true),
+            "Read failed");
+      }
+   });
+
+   // Move random ranges about, as cut and paste do
+   constexpr size_t edits = 100;
+   std::mt19937 engine { 3 };
+   runner.Measure(
+      "Sequence edit", parameters, edits, "edits",
+      [&] {
+         for (size_t ii = 0; ii < edits; ++ii)
+         {
+            const auto x0 = engine() % length;
+            const auto xlen = 1 + engine() % (length - x0);
+            auto cut = sequence->Copy(factory, x0, x0 + xlen);
+            sequence->Delete(x0, xlen);
+            const auto y0 = engine() % (length - xlen + 1);
+            sequence->Paste(y0, cut.get());
+         }
+      },
+      [&] {
+         sequence = MakeSequence(factory);
+         Append(*sequence, signal);
+      });
+   Check(sequence->GetNumSamples() == length, "Wrong length after edits");
+   sequence.reset();
+}
+
+Registration registration { "Sequence", Run };
+} // namespace
+} // namespace Benchmarks